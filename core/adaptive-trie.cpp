@@ -0,0 +1,416 @@
+/**
+* adaptive-trie.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <stdexcept>
+#include <cstring>
+#include "adaptive-trie.hpp"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+    ///Children below which a node shrinks to the previous layout. Lower than
+    ///the capacity of the previous layout, so a node does not flip between
+    ///two layouts on every insert and remove
+    const uint16_t kShrink16 = 3;
+    const uint16_t kShrink48 = 12;
+    const uint16_t kShrink256 = 40;
+    
+    ///Returns the position of byte in a sorted key array, or where it should be inserted
+    uint16_t lowerBound (const uint8_t* keys, const uint16_t& n, const uint8_t& byte) {
+        uint16_t i = 0;
+        while ((i < n) && (keys[i] < byte)) {
+            ++i;
+        }
+        return i;
+    }
+    
+    ///Inserts a child in sorted key and child arrays with room for it
+    template <class TNode>
+    void insertSorted (TNode& node, const uint8_t& byte, const uint32_t& child) {
+        uint16_t n = node.h.numChildren;
+        uint16_t pos = lowerBound(node.keys, n, byte);
+        memmove(node.keys + pos + 1, node.keys + pos, n - pos);
+        memmove(node.children + pos + 1, node.children + pos, (n - pos) * sizeof(node.children[0]));
+        node.keys[pos] = byte;
+        node.children[pos] = child;
+        ++node.h.numChildren;
+    }
+    
+    ///Takes a node from the free list, or from the end of the pool, and zeroes it
+    template <class TNode>
+    uint32_t takeNode (vector<TNode>& nodes, vector<uint32_t>& freeList, const uint32_t& maxIndex) {
+        uint32_t idx;
+        if (!freeList.empty()) {
+            idx = freeList.back();
+            freeList.pop_back();
+        }
+        else {
+            if (nodes.size() > maxIndex) {
+                throw length_error("AdaptiveTrie: node pool full");
+            }
+            idx = nodes.size();
+            nodes.emplace_back();
+        }
+        memset(&nodes[idx], 0, sizeof(TNode));
+        return idx;
+    }
+    
+    ///Removes a child from sorted key and child arrays
+    template <class TNode>
+    void eraseSorted (TNode& node, const uint8_t& byte) {
+        uint16_t n = node.h.numChildren;
+        uint16_t pos = lowerBound(node.keys, n, byte);
+        if ((pos < n) && (node.keys[pos] == byte)) {
+            memmove(node.keys + pos, node.keys + pos + 1, n - pos - 1);
+            memmove(node.children + pos, node.children + pos + 1, (n - pos - 1) * sizeof(node.children[0]));
+            --node.h.numChildren;
+        }
+    }
+}
+
+const AdaptiveTrie::TNodeRef AdaptiveTrie::kNoNode;
+const uint32_t AdaptiveTrie::kIndexBits;
+const uint32_t AdaptiveTrie::kIndexMask;
+
+//#/////////////////////////////////////////////////
+// AdaptiveTrie
+//
+void AdaptiveTrie::clear () {
+    pool4 = tPool<tNode4>();
+    pool16 = tPool<tNode16>();
+    pool48 = tPool<tNode48>();
+    pool256 = tPool<tNode256>();
+    dictionarySize = 0;
+    root = newNode(kNode4);
+}
+
+AdaptiveTrie::tHeader& AdaptiveTrie::header (const TNodeRef& ref) {
+    uint32_t idx = ref & kIndexMask;
+    switch (getType(ref)) {
+        case kNode4:
+            return pool4.nodes[idx].h;
+        case kNode16:
+            return pool16.nodes[idx].h;
+        case kNode48:
+            return pool48.nodes[idx].h;
+        default:
+            return pool256.nodes[idx].h;
+    }
+}
+
+AdaptiveTrie::TNodeRef AdaptiveTrie::findChild (const TNodeRef& ref, const uint8_t& byte) const {
+    uint32_t idx = ref & kIndexMask;
+    switch (getType(ref)) {
+        case kNode4: {
+            const tNode4& node = pool4.nodes[idx];
+            for (uint16_t i = 0; i < node.h.numChildren; ++i) {
+                if (node.keys[i] == byte) {
+                    return node.children[i];
+                }
+            }
+            return kNoNode;
+        }
+        case kNode16: {
+            const tNode16& node = pool16.nodes[idx];
+#ifdef __SSE2__
+            //Compare the 16 keys at once, and keep the matches among the used ones
+            __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(node.keys)));
+            uint32_t mask = _mm_movemask_epi8(cmp) & ((1U << node.h.numChildren) - 1);
+            return (mask != 0) ? node.children[__builtin_ctz(mask)] : kNoNode;
+#else
+            uint16_t pos = lowerBound(node.keys, node.h.numChildren, byte);
+            return ((pos < node.h.numChildren) && (node.keys[pos] == byte)) ? node.children[pos] : kNoNode;
+#endif
+        }
+        case kNode48: {
+            const tNode48& node = pool48.nodes[idx];
+            return (node.index[byte] != 0) ? node.children[node.index[byte] - 1] : kNoNode;
+        }
+        default:
+            return pool256.nodes[idx].children[byte];
+    }
+}
+
+AdaptiveTrie::TNodeRef AdaptiveTrie::newNode (const tNodeType& type) {
+    //The last index of Node256 would make kNoNode
+    uint32_t idx;
+    switch (type) {
+        case kNode4:
+            idx = takeNode(pool4.nodes, pool4.freeList, kIndexMask);
+            break;
+        case kNode16:
+            idx = takeNode(pool16.nodes, pool16.freeList, kIndexMask);
+            break;
+        case kNode48:
+            idx = takeNode(pool48.nodes, pool48.freeList, kIndexMask);
+            break;
+        default:
+            idx = takeNode(pool256.nodes, pool256.freeList, kIndexMask - 1);
+            memset(pool256.nodes[idx].children, 0xFF, sizeof(pool256.nodes[idx].children));
+            break;
+    }
+    return (static_cast<uint32_t>(type) << kIndexBits) | idx;
+}
+
+void AdaptiveTrie::freeNode (const TNodeRef& ref) {
+    uint32_t idx = ref & kIndexMask;
+    switch (getType(ref)) {
+        case kNode4:
+            pool4.freeList.push_back(idx);
+            break;
+        case kNode16:
+            pool16.freeList.push_back(idx);
+            break;
+        case kNode48:
+            pool48.freeList.push_back(idx);
+            break;
+        default:
+            pool256.freeList.push_back(idx);
+            break;
+    }
+}
+
+AdaptiveTrie::TNodeRef AdaptiveTrie::convert (const TNodeRef& ref, const tNodeType& type) {
+    //Children in byte order. Taken before the new node, which may move the pools
+    uint8_t keys[256];
+    TNodeRef children[256];
+    uint16_t n = 0;
+    for (uint16_t b = 0; b < 256; ++b) {
+        TNodeRef child = findChild(ref, static_cast<uint8_t>(b));
+        if (child != kNoNode) {
+            keys[n] = static_cast<uint8_t>(b);
+            children[n++] = child;
+        }
+    }
+    bool word = header(ref).wordMarker;
+    TNodeRef converted = newNode(type);
+    uint32_t idx = converted & kIndexMask;
+    switch (type) {
+        case kNode4:
+            memcpy(pool4.nodes[idx].keys, keys, n);
+            memcpy(pool4.nodes[idx].children, children, n * sizeof(TNodeRef));
+            break;
+        case kNode16:
+            memcpy(pool16.nodes[idx].keys, keys, n);
+            memcpy(pool16.nodes[idx].children, children, n * sizeof(TNodeRef));
+            break;
+        case kNode48:
+            for (uint16_t i = 0; i < n; ++i) {
+                pool48.nodes[idx].index[keys[i]] = i + 1;
+                pool48.nodes[idx].children[i] = children[i];
+            }
+            for (uint16_t i = n; i < 48; ++i) {
+                pool48.nodes[idx].children[i] = kNoNode;
+            }
+            break;
+        default:
+            for (uint16_t i = 0; i < n; ++i) {
+                pool256.nodes[idx].children[keys[i]] = children[i];
+            }
+            break;
+    }
+    header(converted).numChildren = n;
+    header(converted).wordMarker = word;
+    freeNode(ref);
+    return converted;
+}
+
+AdaptiveTrie::TNodeRef AdaptiveTrie::addChild (TNodeRef ref, const uint8_t& byte, const TNodeRef& child) {
+    //Grow full nodes to the next layout first
+    static const uint16_t capacity[] = {4, 16, 48, 256};
+    tNodeType type = getType(ref);
+    if (header(ref).numChildren == capacity[type]) {
+        type = static_cast<tNodeType>(type + 1);
+        ref = convert(ref, type);
+    }
+    uint32_t idx = ref & kIndexMask;
+    switch (type) {
+        case kNode4:
+            insertSorted(pool4.nodes[idx], byte, child);
+            break;
+        case kNode16:
+            insertSorted(pool16.nodes[idx], byte, child);
+            break;
+        case kNode48: {
+            tNode48& node = pool48.nodes[idx];
+            uint16_t slot = 0;
+            while (node.children[slot] != kNoNode) {
+                ++slot;
+            }
+            node.children[slot] = child;
+            node.index[byte] = slot + 1;
+            ++node.h.numChildren;
+            break;
+        }
+        default:
+            pool256.nodes[idx].children[byte] = child;
+            ++pool256.nodes[idx].h.numChildren;
+            break;
+    }
+    return ref;
+}
+
+AdaptiveTrie::TNodeRef AdaptiveTrie::removeChild (TNodeRef ref, const uint8_t& byte) {
+    uint32_t idx = ref & kIndexMask;
+    switch (getType(ref)) {
+        case kNode4:
+            eraseSorted(pool4.nodes[idx], byte);
+            return ref;
+        case kNode16:
+            eraseSorted(pool16.nodes[idx], byte);
+            return (pool16.nodes[idx].h.numChildren <= kShrink16) ? convert(ref, kNode4) : ref;
+        case kNode48: {
+            tNode48& node = pool48.nodes[idx];
+            if (node.index[byte] != 0) {
+                node.children[node.index[byte] - 1] = kNoNode;
+                node.index[byte] = 0;
+                --node.h.numChildren;
+            }
+            return (node.h.numChildren <= kShrink48) ? convert(ref, kNode16) : ref;
+        }
+        default: {
+            tNode256& node = pool256.nodes[idx];
+            if (node.children[byte] != kNoNode) {
+                node.children[byte] = kNoNode;
+                --node.h.numChildren;
+            }
+            return (node.h.numChildren <= kShrink256) ? convert(ref, kNode48) : ref;
+        }
+    }
+}
+
+void AdaptiveTrie::replaceChild (const TNodeRef& ref, const uint8_t& byte, const TNodeRef& child) {
+    uint32_t idx = ref & kIndexMask;
+    switch (getType(ref)) {
+        case kNode4: {
+            tNode4& node = pool4.nodes[idx];
+            node.children[lowerBound(node.keys, node.h.numChildren, byte)] = child;
+            break;
+        }
+        case kNode16: {
+            tNode16& node = pool16.nodes[idx];
+            node.children[lowerBound(node.keys, node.h.numChildren, byte)] = child;
+            break;
+        }
+        case kNode48:
+            pool48.nodes[idx].children[pool48.nodes[idx].index[byte] - 1] = child;
+            break;
+        default:
+            pool256.nodes[idx].children[byte] = child;
+            break;
+    }
+}
+
+void AdaptiveTrie::insertWord (const string& word) {
+    TNodeRef parent = kNoNode;
+    TNodeRef current = root;
+    for (uint64_t i = 0; i < word.size(); ++i) {
+        uint8_t byte = word[i];
+        TNodeRef next = findChild(current, byte);
+        if (next == kNoNode) {
+            next = newNode(kNode4);
+            TNodeRef grown = addChild(current, byte, next);
+            if (grown != current) {
+                if (parent == kNoNode) {
+                    root = grown;
+                }
+                else {
+                    replaceChild(parent, word[i - 1], grown);
+                }
+            }
+            current = grown;
+        }
+        parent = current;
+        current = next;
+    }
+    if (!header(current).wordMarker) {
+        header(current).wordMarker = true;
+        ++dictionarySize;
+    }
+}
+
+void AdaptiveTrie::removeWord (const string& word) {
+    //Nodes along the word, the root first
+    vector<TNodeRef> path(1, root);
+    for (auto c : word) {
+        TNodeRef next = findChild(path.back(), c);
+        if (next == kNoNode) {
+            return;
+        }
+        path.push_back(next);
+    }
+    if (!header(path.back()).wordMarker) {
+        return;
+    }
+    header(path.back()).wordMarker = false;
+    --dictionarySize;
+    //Prune the nodes left without words under them
+    uint64_t depth = word.size();
+    while ((depth > 0) && (header(path[depth]).numChildren == 0) && !header(path[depth]).wordMarker) {
+        freeNode(path[depth]);
+        TNodeRef shrunk = removeChild(path[depth - 1], word[depth - 1]);
+        if (shrunk != path[depth - 1]) {
+            if (depth == 1) {
+                root = shrunk;
+            }
+            else {
+                replaceChild(path[depth - 2], word[depth - 2], shrunk);
+            }
+            path[depth - 1] = shrunk;
+        }
+        --depth;
+    }
+}
+
+AdaptiveTrie::TNodeRef AdaptiveTrie::searchWord (const string& word, const bool& isWhole) const {
+    TNodeRef current = root;
+    for (auto c : word) {
+        if ((current = findChild(current, c)) == kNoNode) {
+            return kNoNode;
+        }
+    }
+    return (header(current).wordMarker || !isWhole) ? current : kNoNode;
+}
+
+uint64_t AdaptiveTrie::getNumNodes () const {
+    return getNumNodes(kNode4) + getNumNodes(kNode16) + getNumNodes(kNode48) + getNumNodes(kNode256);
+}
+
+uint64_t AdaptiveTrie::getNumNodes (const tNodeType& type) const {
+    switch (type) {
+        case kNode4:
+            return pool4.nodes.size() - pool4.freeList.size();
+        case kNode16:
+            return pool16.nodes.size() - pool16.freeList.size();
+        case kNode48:
+            return pool48.nodes.size() - pool48.freeList.size();
+        default:
+            return pool256.nodes.size() - pool256.freeList.size();
+    }
+}
+
+uint64_t AdaptiveTrie::getMemoryUsage () const {
+    return pool4.nodes.capacity() * sizeof(tNode4) + pool16.nodes.capacity() * sizeof(tNode16) +
+           pool48.nodes.capacity() * sizeof(tNode48) + pool256.nodes.capacity() * sizeof(tNode256) +
+           (pool4.freeList.capacity() + pool16.freeList.capacity() + pool48.freeList.capacity() + pool256.freeList.capacity()) * sizeof(uint32_t);
+}
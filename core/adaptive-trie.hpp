@@ -0,0 +1,174 @@
+/**
+ * adaptive-trie.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_adaptive_trie_h
+#define dasel_adaptive_trie_h
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Implements a trie over the full byte alphabet with adaptive
+/// radix tree (ART) nodes.
+///
+/// Keys are arbitrary byte strings (URLs, identifiers...), and are case
+/// sensitive. Each node uses the smallest of four layouts that fits its
+/// children:
+///   * Node4 and Node16: sorted arrays of key bytes and child references.
+///     Node16 is searched with a single SSE2 comparison when available.
+///   * Node48: a 256 entry byte index into 48 child slots.
+///   * Node256: a child reference for every byte.
+/// A node grows to the next layout when it is full, and shrinks to the
+/// previous one when removals leave it well below its capacity.
+///
+/// As in Trie, nodes live in pools (one per layout) and are referred to by
+/// 32 bit references: 2 bits of layout and 30 bits of index in the pool.
+/// Removed nodes are reused, and clear() frees the pools in bulk.
+///
+class AdaptiveTrie {
+public:
+    /// Reference to a node: layout in the 2 top bits, index in the pool in the rest
+    typedef uint32_t TNodeRef;
+    /// Reference standing for no node
+    static const TNodeRef kNoNode = UINT32_MAX;
+    /// Node layouts
+    enum tNodeType {
+        kNode4,     ///< Up to 4 children
+        kNode16,    ///< Up to 16 children
+        kNode48,    ///< Up to 48 children
+        kNode256    ///< Up to 256 children
+    };
+    
+    /// Creates an empty trie, with just the root node
+    AdaptiveTrie () { clear(); }
+    ///  \brief Inserts a word in the trie. Words already in the trie are ignored
+    ///
+    ///  \param word Word to be inserted in the tree
+    //
+    void insertWord (const string& word);
+    ///
+    ///  \brief Removes a word from the trie, and the nodes left without words
+    ///
+    ///  \param word Word to be removed from the tree
+    //
+    void removeWord (const string& word);
+    ///
+    ///  \brief Searches a word in the trie
+    ///
+    ///  \param word Word to search for
+    ///  \param isWhole True if it should match whole words only
+    ///  \return Reference to the ending node for the word. kNoNode if the word is not
+    /// part of the trie
+    //
+    TNodeRef searchWord (const string& word, const bool& isWhole=true) const;
+    /// Returns true if the given string is a prefix or word in the dictionary
+    bool isPrefix (const string& prefix) const { return searchWord(prefix, false) != kNoNode; }
+    /// Returns true if the given string is a word in the dictionary
+    bool isWord (const string& word) const { return searchWord(word, true) != kNoNode; }
+    ///Returns the number of whole words in the dictionary
+    uint64_t getDictionarySize () const { return dictionarySize; }
+    ///Removes all words, freeing the node pools in bulk
+    void clear ();
+    ///Returns the layout of a node
+    static tNodeType getType (const TNodeRef& ref) { return static_cast<tNodeType>(ref >> kIndexBits); }
+    ///Returns the root node
+    TNodeRef getRoot () const { return root; }
+    ///Returns the number of children of a node
+    uint64_t getNumChildren (const TNodeRef& ref) const { return header(ref).numChildren; }
+    ///Returns the child of a node for a byte, kNoNode if there is none
+    TNodeRef getChild (const TNodeRef& ref, const uint8_t& byte) const { return findChild(ref, byte); }
+    ///Returns the number of nodes in the trie, the root included
+    uint64_t getNumNodes () const;
+    ///Returns the number of nodes with a given layout
+    uint64_t getNumNodes (const tNodeType& type) const;
+    ///Returns the bytes allocated by the node pools
+    uint64_t getMemoryUsage () const;
+    
+private:
+    static const uint32_t kIndexBits = 30;                      ///Bits of the pool index in a reference
+    static const uint32_t kIndexMask = (1U << kIndexBits) - 1;  ///Mask of the pool index in a reference
+    
+    /// Fields common to all layouts
+    struct tHeader {
+        uint16_t numChildren;   ///Number of children
+        bool wordMarker;        ///True if the node is the end of a whole word
+    };
+    /// Node with up to 4 children, sorted by key byte
+    struct tNode4 {
+        tHeader h;
+        uint8_t keys[4];
+        TNodeRef children[4];
+    };
+    /// Node with up to 16 children, sorted by key byte
+    struct tNode16 {
+        tHeader h;
+        uint8_t keys[16];
+        TNodeRef children[16];
+    };
+    /// Node with up to 48 children. index holds the slot of every byte plus 1, 0 if none
+    struct tNode48 {
+        tHeader h;
+        uint8_t index[256];
+        TNodeRef children[48];
+    };
+    /// Node with a child for every byte
+    struct tNode256 {
+        tHeader h;
+        TNodeRef children[256];
+    };
+    /// Nodes of one layout, with a list of the removed ones
+    template <class TNode>
+    struct tPool {
+        vector<TNode> nodes;        ///All nodes, removed ones included
+        vector<uint32_t> freeList;  ///Indexes of the removed nodes
+    };
+    
+    TNodeRef root;                  ///Root node
+    uint64_t dictionarySize;        ///Number of words
+    tPool<tNode4> pool4;            ///Node4 pool
+    tPool<tNode16> pool16;          ///Node16 pool
+    tPool<tNode48> pool48;          ///Node48 pool
+    tPool<tNode256> pool256;        ///Node256 pool
+    
+    ///Returns the fields common to all layouts of a node
+    tHeader& header (const TNodeRef& ref);
+    const tHeader& header (const TNodeRef& ref) const { return const_cast<AdaptiveTrie*>(this)->header(ref); }
+    ///Returns the child of a node for a byte, kNoNode if there is none
+    TNodeRef findChild (const TNodeRef& ref, const uint8_t& byte) const;
+    ///Creates an empty node of the given layout
+    TNodeRef newNode (const tNodeType& type);
+    ///Returns a node to its pool
+    void freeNode (const TNodeRef& ref);
+    ///Adds a child to a node, growing it if full. Returns the reference of the node, which changes if it grew
+    TNodeRef addChild (TNodeRef ref, const uint8_t& byte, const TNodeRef& child);
+    ///Removes a child from a node, shrinking it if sparse. Returns the reference of the node, which changes if it shrank
+    TNodeRef removeChild (TNodeRef ref, const uint8_t& byte);
+    ///Points the child of a node for a byte to another node
+    void replaceChild (const TNodeRef& ref, const uint8_t& byte, const TNodeRef& child);
+    ///Copies the header and children of a node into an empty node of another layout, and frees the first
+    TNodeRef convert (const TNodeRef& ref, const tNodeType& type);
+};
+
+#endif /* dasel_adaptive_trie_h */
@@ -0,0 +1,144 @@
+/**
+* betweenness.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <cmath>
+#include <numeric>
+#include "betweenness.hpp"
+#include "parallel.hpp"
+#include "rng.hpp"
+
+namespace {
+    ///BFS and dependency state of one thread, reset after every source
+    struct BrandesState {
+        vector<int64_t> dist;   ///BFS level, -1 if not reached
+        vector<double> sigma;   ///Number of shortest paths from the source
+        vector<double> delta;   ///Dependency of the source on the vertex
+        vector<uint64_t> order; ///Vertex in BFS order, used as the queue
+        vector<double> score;   ///Accumulated dependencies of this thread
+        
+        explicit BrandesState (const uint64_t& n) : dist(n, -1), sigma(n, 0), delta(n, 0), score(n, 0) { order.reserve(n); }
+    };
+    
+    void brandesSource (const CompactGraph& g, const uint64_t& s, BrandesState& st) {
+        st.order.clear();
+        st.dist[s] = 0;
+        st.sigma[s] = 1;
+        st.order.push_back(s);
+        for (uint64_t head = 0; head < st.order.size(); ++head) {
+            uint64_t v = st.order[head];
+            for (const uint64_t* a = g.adjBegin(v); a != g.adjEnd(v); ++a) {
+                uint64_t w = *a;
+                if (st.dist[w] < 0) {
+                    st.dist[w] = st.dist[v] + 1;
+                    st.order.push_back(w);
+                }
+                if (st.dist[w] == st.dist[v] + 1) {
+                    st.sigma[w] += st.sigma[v];
+                }
+            }
+        }
+        //Successors are found again through the out edges, so directed
+        //graphs need no in edges or predecessor lists
+        for (uint64_t i = st.order.size(); i-- > 0;) {
+            uint64_t v = st.order[i];
+            double dv = 0;
+            for (const uint64_t* a = g.adjBegin(v); a != g.adjEnd(v); ++a) {
+                uint64_t w = *a;
+                if (st.dist[w] == st.dist[v] + 1) {
+                    dv += st.sigma[v] / st.sigma[w] * (1.0 + st.delta[w]);
+                }
+            }
+            st.delta[v] = dv;
+            if (v != s) {
+                st.score[v] += dv;
+            }
+        }
+        for (auto v : st.order) {
+            st.dist[v] = -1;
+            st.sigma[v] = 0;
+            st.delta[v] = 0;
+        }
+    }
+}
+
+//#/////////////////////////////////////////////////
+// Betweenness
+//
+vector<double> Betweenness::exact () const {
+    vector<uint64_t> sources(graph.getNumVertex());
+    iota(sources.begin(), sources.end(), 0);
+    return accumulate(sources, 1.0);
+}
+
+vector<double> Betweenness::approximate (const uint64_t& numSamples, const uint64_t& seed) const {
+    uint64_t n = graph.getNumVertex();
+    if (numSamples >= n) {
+        return exact();
+    }
+    //Partial Fisher-Yates shuffle
+    vector<uint64_t> sources(n);
+    iota(sources.begin(), sources.end(), 0);
+    SplitMix64 rng(seed);
+    for (uint64_t i = 0; i < numSamples; ++i) {
+        swap(sources[i], sources[i + rng.nextBelow(n - i)]);
+    }
+    sources.resize(numSamples);
+    return accumulate(sources, static_cast<double>(n) / numSamples);
+}
+
+double Betweenness::errorBound (const uint64_t& numVertex, const uint64_t& numSamples, const double& delta) {
+    if (numSamples == 0) {
+        return 1.0;
+    }
+    return sqrt(log(2.0 * numVertex / delta) / (2.0 * numSamples));
+}
+
+uint64_t Betweenness::sampleSize (const uint64_t& numVertex, const double& epsilon, const double& delta) {
+    return static_cast<uint64_t>(ceil(log(2.0 * numVertex / delta) / (2.0 * epsilon * epsilon)));
+}
+
+vector<double> Betweenness::accumulate (const vector<uint64_t>& sources, const double& scale) const {
+    uint64_t n = graph.getNumVertex();
+    unsigned threads = (numThreads == 0) ? getNumThreads() : numThreads;
+    if (threads > sources.size()) {
+        threads = sources.empty() ? 1 : static_cast<unsigned>(sources.size());
+    }
+    vector<BrandesState> states;
+    states.reserve(threads);
+    for (unsigned t = 0; t < threads; ++t) {
+        states.push_back(BrandesState(n));
+    }
+    parallelForThread(0, sources.size(), [&](unsigned tID, uint64_t i) {
+        brandesSource(graph, sources[i], states[tID]);
+    }, 1, threads);
+    //Every pair is found from both ends in an undirected graph
+    double factor = graph.isDirected() ? scale : scale / 2.0;
+    vector<double> score(n, 0);
+    parallelFor(0, n, [&](uint64_t v) {
+        double sum = 0;
+        for (auto& st : states) {
+            sum += st.score[v];
+        }
+        score[v] = sum * factor;
+    }, 4096, threads);
+    return score;
+}
@@ -0,0 +1,86 @@
+/**
+ * betweenness.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_betweenness_h
+#define dasel_betweenness_h
+
+#include <vector>
+#include <stdint.h>
+#include "compact-graph.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Computes betweenness centrality over a CompactGraph with Brandes'
+/// algorithm.
+///
+/// Every source runs a BFS that counts shortest paths, and then adds its
+/// dependencies in reverse BFS order. Sources are split over threads, each
+/// thread keeping its own BFS state and its own accumulator vector, which are
+/// summed at the end. The BFS state lives in per-thread vectors indexed by
+/// vertex index, so it does not use the Vertex::visited flag and the graph is
+/// only read.
+///
+/// Scores are indexed by vertex index. For an undirected graph each pair is
+/// counted once, so the scores are half the directed ones.
+///
+/// For big graphs, approximate() runs the BFS from a uniform sample of k
+/// sources and scales the result by n / k. By Hoeffding's inequality and a
+/// union bound over the vertex, with probability 1 - delta every estimate is
+/// within errorBound() * n * (n - 2) of the exact score (half of it for
+/// undirected graphs).
+///
+class Betweenness {
+    const CompactGraph& graph;  ///Graph to analyse
+    unsigned numThreads;        ///Number of threads, 0 for all hardware threads
+    
+public:
+    ///Creates the calculator over the given graph. The graph must outlive it
+    explicit Betweenness (const CompactGraph& g, const unsigned& threads=0) : graph(g), numThreads(threads) { }
+    ///Returns the exact betweenness of every vertex, running a BFS from all of them
+    vector<double> exact () const;
+    ///
+    /// \brief Returns the estimated betweenness of every vertex
+    ///
+    /// \param numSamples Number of sources, drawn without replacement. If it
+    ///        is not smaller than the number of vertex the result is exact
+    /// \param seed Seed to draw the sources
+    //
+    vector<double> approximate (const uint64_t& numSamples, const uint64_t& seed=0) const;
+    ///
+    /// \brief Returns the error bound of approximate(), as a fraction of n * (n - 2)
+    ///
+    /// \param numVertex Number of vertex in the graph
+    /// \param numSamples Number of sources sampled
+    /// \param delta Probability of any estimate being out of the bound
+    //
+    static double errorBound (const uint64_t& numVertex, const uint64_t& numSamples, const double& delta);
+    ///Returns the number of samples needed to get errorBound() <= epsilon
+    static uint64_t sampleSize (const uint64_t& numVertex, const double& epsilon, const double& delta);
+    
+private:
+    ///Runs Brandes' BFS and dependency accumulation from every source, and
+    ///returns the summed dependencies multiplied by "scale"
+    vector<double> accumulate (const vector<uint64_t>& sources, const double& scale) const;
+};
+
+#endif /* dasel_betweenness_h */
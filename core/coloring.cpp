@@ -0,0 +1,333 @@
+/**
+* coloring.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include "coloring.hpp"
+#include "parallel.hpp"
+#include "rng.hpp"
+
+namespace {
+    ///Color of the vertex not colored yet
+    const uint64_t kNoColor = UINT64_MAX;
+    
+    ///Seconds elapsed since "start"
+    double secondsSince (const chrono::steady_clock::time_point& start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    
+    ///Sets the number of colors of a result
+    void countColors (GraphColoring::tResult& result) {
+        result.numColors = 0;
+        for (auto c : result.color) {
+            result.numColors = max(result.numColors, c + 1);
+        }
+    }
+}
+
+//#/////////////////////////////////////////////////
+// GraphColoring
+//
+GraphColoring::GraphColoring (const UndirectedGraph& g, const uint64_t& rngSeed, const unsigned& threads) :
+    graph(g), seed(rngSeed), numThreads(threads) {
+}
+
+GraphColoring::GraphColoring (const CompactGraph& g, const uint64_t& rngSeed, const unsigned& threads) :
+    graph(g), seed(rngSeed), numThreads(threads) {
+    if (graph.isDirected()) {
+        throw invalid_argument("GraphColoring: graph must be undirected");
+    }
+}
+
+vector<uint64_t> GraphColoring::ranks (const tOrdering& ordering) const {
+    uint64_t n = graph.getNumVertex();
+    vector<uint64_t> order(n);
+    if (ordering == kSmallestLast) {
+        //Bucket queue by remaining degree, as in the k-core decomposition
+        vector<uint64_t> deg(n);
+        uint64_t maxDeg = 0;
+        for (uint64_t v = 0; v < n; ++v) {
+            deg[v] = graph.getDeg(v) - (graph.isEdge(v, v) ? 1 : 0);
+            maxDeg = max(maxDeg, deg[v]);
+        }
+        vector<uint64_t> bin(maxDeg + 2, 0);
+        for (uint64_t v = 0; v < n; ++v) {
+            ++bin[deg[v] + 1];
+        }
+        partial_sum(bin.begin(), bin.end(), bin.begin());
+        vector<uint64_t> pos(n);
+        vector<uint64_t> queue(n);
+        {
+            vector<uint64_t> next(bin.begin(), bin.end() - 1);
+            for (uint64_t v = 0; v < n; ++v) {
+                pos[v] = next[deg[v]]++;
+                queue[pos[v]] = v;
+            }
+        }
+        //A neighbour with a bigger degree moves to the start of its bin, and
+        //the bin shrinks by one
+        for (uint64_t i = 0; i < n; ++i) {
+            uint64_t v = queue[i];
+            for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+                uint64_t u = *a;
+                if (deg[u] > deg[v]) {
+                    uint64_t du = deg[u];
+                    uint64_t pu = pos[u];
+                    uint64_t pw = bin[du];
+                    uint64_t w = queue[pw];
+                    if (u != w) {
+                        queue[pu] = w;
+                        pos[w] = pu;
+                        queue[pw] = u;
+                        pos[u] = pw;
+                    }
+                    ++bin[du];
+                    --deg[u];
+                }
+            }
+        }
+        //Removed last, colored first
+        for (uint64_t i = 0; i < n; ++i) {
+            order[i] = queue[n - 1 - i];
+        }
+    }
+    else {
+        vector<uint64_t> hash(n);
+        parallelFor(0, n, [&](uint64_t v) { hash[v] = streamSeed(seed, v); }, 4096, numThreads);
+        iota(order.begin(), order.end(), 0);
+        if (ordering == kLargestFirst) {
+            sort(order.begin(), order.end(), [&](const uint64_t& a, const uint64_t& b) {
+                return (graph.getDeg(a) != graph.getDeg(b)) ? (graph.getDeg(a) > graph.getDeg(b)) : (hash[a] < hash[b]); });
+        }
+        else {
+            sort(order.begin(), order.end(), [&](const uint64_t& a, const uint64_t& b) { return hash[a] < hash[b]; });
+        }
+    }
+    vector<uint64_t> rank(n);
+    for (uint64_t i = 0; i < n; ++i) {
+        rank[order[i]] = i;
+    }
+    return rank;
+}
+
+uint64_t GraphColoring::firstFit (const uint64_t& v, const vector<uint64_t>& color, vector<uint8_t>& mark) const {
+    uint64_t limit = graph.getDeg(v) + 1;
+    for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+        uint64_t c = color[*a];
+        if ((*a != v) && (c < limit)) {
+            mark[c] = 1;
+        }
+    }
+    uint64_t c = 0;
+    while (mark[c]) {
+        ++c;
+    }
+    for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+        uint64_t ac = color[*a];
+        if (ac < limit) {
+            mark[ac] = 0;
+        }
+    }
+    return c;
+}
+
+bool GraphColoring::isValid (const vector<uint64_t>& color) const {
+    for (uint64_t v = 0; v < graph.getNumVertex(); ++v) {
+        if (color[v] == kNoColor) {
+            return false;
+        }
+        for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+            if ((*a != v) && (color[*a] == color[v])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+GraphColoring::tResult GraphColoring::sequential (const tOrdering& ordering) const {
+    uint64_t n = graph.getNumVertex();
+    tResult result;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<uint64_t> rank = ranks(ordering);
+    vector<uint64_t> order(n);
+    for (uint64_t v = 0; v < n; ++v) {
+        order[rank[v]] = v;
+    }
+    result.orderingSeconds = secondsSince(start);
+    start = chrono::steady_clock::now();
+    result.color.assign(n, kNoColor);
+    vector<uint8_t> mark(n + 1, 0);
+    for (auto v : order) {
+        result.color[v] = firstFit(v, result.color, mark);
+    }
+    result.coloringSeconds = secondsSince(start);
+    result.conflictSeconds = 0;
+    result.rounds = 1;
+    countColors(result);
+    return result;
+}
+
+GraphColoring::tResult GraphColoring::speculative (const tOrdering& ordering) const {
+    uint64_t n = graph.getNumVertex();
+    unsigned threads = (numThreads == 0) ? getNumThreads() : numThreads;
+    tResult result;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<uint64_t> rank = ranks(ordering);
+    vector<uint64_t> pending(n);
+    for (uint64_t v = 0; v < n; ++v) {
+        pending[rank[v]] = v;
+    }
+    result.orderingSeconds = secondsSince(start);
+    result.coloringSeconds = 0;
+    result.conflictSeconds = 0;
+    result.rounds = 0;
+    //Colors are read while neighbours write them, so they are atomic
+    unique_ptr<atomic<uint64_t>[]> color(new atomic<uint64_t>[n]);
+    for (uint64_t v = 0; v < n; ++v) {
+        color[v].store(kNoColor, memory_order_relaxed);
+    }
+    vector<vector<uint8_t> > marks(threads);
+    vector<vector<uint64_t> > conflicts(threads);
+    while (!pending.empty()) {
+        ++result.rounds;
+        start = chrono::steady_clock::now();
+        parallelForThread(0, pending.size(), [&](unsigned tID, uint64_t i) {
+            uint64_t v = pending[i];
+            vector<uint8_t>& mark = marks[tID];
+            uint64_t limit = graph.getDeg(v) + 1;
+            if (mark.size() < limit + 1) {
+                mark.resize(limit + 1, 0);
+            }
+            for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+                uint64_t c = color[*a].load(memory_order_relaxed);
+                if ((*a != v) && (c < limit)) {
+                    mark[c] = 1;
+                }
+            }
+            uint64_t c = 0;
+            while (mark[c]) {
+                ++c;
+            }
+            fill(mark.begin(), mark.begin() + limit, 0);
+            color[v].store(c, memory_order_relaxed);
+        }, 256, threads);
+        result.coloringSeconds += secondsSince(start);
+        //A vertex keeps its color unless a neighbour with higher priority has the same
+        start = chrono::steady_clock::now();
+        parallelForThread(0, pending.size(), [&](unsigned tID, uint64_t i) {
+            uint64_t v = pending[i];
+            uint64_t c = color[v].load(memory_order_relaxed);
+            for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+                if ((*a != v) && (rank[*a] < rank[v]) && (color[*a].load(memory_order_relaxed) == c)) {
+                    conflicts[tID].push_back(v);
+                    return;
+                }
+            }
+        }, 256, threads);
+        pending.clear();
+        for (auto& c : conflicts) {
+            pending.insert(pending.end(), c.begin(), c.end());
+            c.clear();
+        }
+        sort(pending.begin(), pending.end(), [&](const uint64_t& a, const uint64_t& b) { return rank[a] < rank[b]; });
+        result.conflictSeconds += secondsSince(start);
+    }
+    result.color.resize(n);
+    for (uint64_t v = 0; v < n; ++v) {
+        result.color[v] = color[v].load(memory_order_relaxed);
+    }
+    countColors(result);
+    return result;
+}
+
+GraphColoring::tResult GraphColoring::jonesPlassmann (const tOrdering& ordering) const {
+    uint64_t n = graph.getNumVertex();
+    unsigned threads = (numThreads == 0) ? getNumThreads() : numThreads;
+    tResult result;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<uint64_t> rank = ranks(ordering);
+    result.orderingSeconds = secondsSince(start);
+    start = chrono::steady_clock::now();
+    //Number of neighbours with higher priority still without color
+    unique_ptr<atomic<uint64_t>[]> waiting(new atomic<uint64_t>[n]);
+    vector<vector<uint64_t> > ready(threads);
+    parallelForThread(0, n, [&](unsigned tID, uint64_t v) {
+        uint64_t count = 0;
+        for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+            count += (rank[*a] < rank[v]);
+        }
+        waiting[v].store(count, memory_order_relaxed);
+        if (count == 0) {
+            ready[tID].push_back(v);
+        }
+    }, 1024, threads);
+    result.color.assign(n, kNoColor);
+    vector<vector<uint8_t> > marks(threads);
+    vector<uint64_t> frontier;
+    for (auto& r : ready) {
+        frontier.insert(frontier.end(), r.begin(), r.end());
+        r.clear();
+    }
+    result.rounds = 0;
+    //Colors of higher priority neighbours were written in earlier rounds,
+    //and a round is joined before the next starts
+    while (!frontier.empty()) {
+        ++result.rounds;
+        parallelForThread(0, frontier.size(), [&](unsigned tID, uint64_t i) {
+            uint64_t v = frontier[i];
+            vector<uint8_t>& mark = marks[tID];
+            if (mark.size() < graph.getDeg(v) + 2) {
+                mark.resize(graph.getDeg(v) + 2, 0);
+            }
+            uint64_t c = 0;
+            uint64_t limit = graph.getDeg(v) + 1;
+            for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+                if ((rank[*a] < rank[v]) && (result.color[*a] < limit)) {
+                    mark[result.color[*a]] = 1;
+                }
+            }
+            while (mark[c]) {
+                ++c;
+            }
+            fill(mark.begin(), mark.begin() + limit, 0);
+            result.color[v] = c;
+            for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+                if ((rank[*a] > rank[v]) && (waiting[*a].fetch_sub(1, memory_order_relaxed) == 1)) {
+                    ready[tID].push_back(*a);
+                }
+            }
+        }, 64, threads);
+        frontier.clear();
+        for (auto& r : ready) {
+            frontier.insert(frontier.end(), r.begin(), r.end());
+            r.clear();
+        }
+    }
+    result.coloringSeconds = secondsSince(start);
+    result.conflictSeconds = 0;
+    countColors(result);
+    return result;
+}
@@ -0,0 +1,107 @@
+/**
+ * coloring.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_coloring_h
+#define dasel_coloring_h
+
+#include <vector>
+#include <stdint.h>
+#include "compact-graph.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Colors an undirected graph so that adjacent vertex get different
+/// colors, with greedy first-fit algorithms.
+///
+/// Vertex are prioritised by an ordering:
+///   * kRandom: a hash of the vertex index and the seed.
+///   * kLargestFirst: larger degree first, ties by hash.
+///   * kSmallestLast: reverse of a degeneracy order, in which vertex of
+///     smallest remaining degree are removed first. It is computed
+///     sequentially with the degree buckets of the k-core decomposition, in
+///     O(V + E), and bounds the colors by the degeneracy plus one.
+///
+/// Coloring algorithms:
+///   * sequential(): first fit in priority order. The reference result.
+///   * speculative(): all pending vertex are colored in parallel with first
+///     fit, then conflicting vertex (same color as a neighbour with higher
+///     priority) are colored again in the next round.
+///   * jonesPlassmann(): a vertex is colored once all its neighbours with
+///     higher priority are. Every vertex keeps an atomic count of those
+///     neighbours, and the ones reaching zero form the next round. It gives
+///     the same colors as sequential() with the same ordering.
+///
+/// Self loops are ignored. The graph is a snapshot, never modified.
+///
+class GraphColoring {
+public:
+    /// Vertex orderings
+    enum tOrdering {
+        kRandom,        ///< Random priorities
+        kLargestFirst,  ///< Largest degree first
+        kSmallestLast   ///< Smallest last (degeneracy) order
+    };
+    /// Result of a coloring
+    struct tResult {
+        vector<uint64_t> color;     ///<Color of every vertex index, in [0, numColors)
+        uint64_t numColors;         ///<Number of colors used
+        uint64_t rounds;            ///<Parallel rounds run
+        double orderingSeconds;     ///<Time spent computing the ordering
+        double coloringSeconds;     ///<Time spent assigning colors
+        double conflictSeconds;     ///<Time spent finding conflicts (speculative only)
+    };
+    
+    ///
+    /// \brief Creates a coloring calculator for an undirected graph
+    ///
+    /// \param g Graph to color
+    /// \param rngSeed Seed for the random priorities and tie breaking
+    /// \param threads Number of threads. 0 uses all hardware threads
+    //
+    explicit GraphColoring (const UndirectedGraph& g, const uint64_t& rngSeed=0, const unsigned& threads=0);
+    ///Creates a coloring calculator for an undirected compact graph
+    explicit GraphColoring (const CompactGraph& g, const uint64_t& rngSeed=0, const unsigned& threads=0);
+    ///Returns the snapshot being colored
+    const CompactGraph& getGraph () const { return graph; }
+    ///Colors the graph sequentially in priority order
+    tResult sequential (const tOrdering& ordering=kLargestFirst) const;
+    ///Colors the graph with speculative iterative rounds
+    tResult speculative (const tOrdering& ordering=kLargestFirst) const;
+    ///Colors the graph with Jones-Plassmann
+    tResult jonesPlassmann (const tOrdering& ordering=kLargestFirst) const;
+    ///Returns true if no edge joins two vertex of the same color
+    bool isValid (const vector<uint64_t>& color) const;
+    
+private:
+    CompactGraph graph;     ///Snapshot of the graph
+    uint64_t seed;          ///Seed for the priorities
+    unsigned numThreads;    ///Number of threads, 0 for all hardware threads
+    
+    ///Returns the rank of every vertex index in the ordering, 0 colored first
+    vector<uint64_t> ranks (const tOrdering& ordering) const;
+    ///Returns the smallest color not used by the already colored neighbours
+    ///of v. "mark" must have space for deg(v) + 1 entries and holds zeros
+    uint64_t firstFit (const uint64_t& v, const vector<uint64_t>& color, vector<uint8_t>& mark) const;
+};
+
+#endif /* dasel_coloring_h */
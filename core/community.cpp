@@ -0,0 +1,262 @@
+/**
+* community.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include "community.hpp"
+#include "parallel.hpp"
+#include "rng.hpp"
+
+namespace {
+    ///Labels and per-vertex "needs a visit" flags shared by the sweeps
+    struct tSweepState {
+        unique_ptr<atomic<uint64_t>[]> label;
+        unique_ptr<atomic<uint8_t>[]> active;
+        
+        explicit tSweepState (const uint64_t& n) : label(new atomic<uint64_t>[n]), active(new atomic<uint8_t>[n]) {
+            for (uint64_t v = 0; v < n; ++v) {
+                label[v].store(v, memory_order_relaxed);
+                active[v].store(1, memory_order_relaxed);
+            }
+        }
+    };
+    
+    ///Fills buffer with the sorted labels of the neighbours of v, self loops excluded
+    void neighbourLabels (const CompactGraph& g, const uint64_t& v, const tSweepState& st, vector<uint64_t>& buffer) {
+        buffer.clear();
+        for (const uint64_t* a = g.adjBegin(v); a != g.adjEnd(v); ++a) {
+            if (*a != v) {
+                buffer.push_back(st.label[*a].load(memory_order_relaxed));
+            }
+        }
+        sort(buffer.begin(), buffer.end());
+    }
+    
+    ///Marks the neighbours of v to be visited in the next sweep
+    void activateNeighbours (const CompactGraph& g, const uint64_t& v, tSweepState& st) {
+        for (const uint64_t* a = g.adjBegin(v); a != g.adjEnd(v); ++a) {
+            st.active[*a].store(1, memory_order_relaxed);
+        }
+    }
+}
+
+//#/////////////////////////////////////////////////
+// CommunityDetector
+//
+CommunityDetector::CommunityDetector (const UndirectedGraph& g, const uint64_t& rngSeed, const unsigned& threads) :
+    graph(g), seed(rngSeed), numThreads(threads) {
+}
+
+CommunityDetector::CommunityDetector (const CompactGraph& g, const uint64_t& rngSeed, const unsigned& threads) :
+    graph(g), seed(rngSeed), numThreads(threads) {
+    if (graph.isDirected()) {
+        throw invalid_argument("CommunityDetector: graph must be undirected");
+    }
+}
+
+CommunityDetector::tResult CommunityDetector::labelPropagation (const uint64_t& maxIterations, const double& minChangeFraction) const {
+    uint64_t n = graph.getNumVertex();
+    unsigned threads = (numThreads == 0) ? getNumThreads() : numThreads;
+    tSweepState st(n);
+    vector<vector<uint64_t> > buffers(threads);
+    tResult result;
+    result.iterations = 0;
+    while (result.iterations < maxIterations) {
+        uint64_t iterSeed = streamSeed(seed, result.iterations);
+        atomic<uint64_t> changes(0);
+        parallelForThread(0, n, [&](unsigned tID, uint64_t v) {
+            if (!st.active[v].exchange(0, memory_order_relaxed)) {
+                return;
+            }
+            vector<uint64_t>& buffer = buffers[tID];
+            neighbourLabels(graph, v, st, buffer);
+            if (buffer.empty()) {
+                return;
+            }
+            uint64_t current = st.label[v].load(memory_order_relaxed);
+            //Keep the current label if it is among the most frequent ones
+            uint64_t best = current;
+            uint64_t bestCount = 0;
+            uint64_t bestHash = 0;
+            for (uint64_t i = 0; i < buffer.size();) {
+                uint64_t j = i;
+                while ((j < buffer.size()) && (buffer[j] == buffer[i])) {
+                    ++j;
+                }
+                uint64_t count = j - i;
+                if (buffer[i] == current) {
+                    count = count * 2 + 1;      //Wins any tie
+                }
+                else {
+                    count *= 2;
+                }
+                uint64_t h = streamSeed(iterSeed, buffer[i]);
+                if ((count > bestCount) || ((count == bestCount) && (h < bestHash))) {
+                    best = buffer[i];
+                    bestCount = count;
+                    bestHash = h;
+                }
+                i = j;
+            }
+            if (best != current) {
+                st.label[v].store(best, memory_order_relaxed);
+                activateNeighbours(graph, v, st);
+                changes.fetch_add(1, memory_order_relaxed);
+            }
+        }, 256, threads);
+        ++result.iterations;
+        if (changes.load() <= minChangeFraction * n) {
+            break;
+        }
+    }
+    vector<uint64_t> labels(n);
+    for (uint64_t v = 0; v < n; ++v) {
+        labels[v] = st.label[v].load(memory_order_relaxed);
+    }
+    finish(labels, result);
+    return result;
+}
+
+CommunityDetector::tResult CommunityDetector::louvain (const uint64_t& maxIterations, const double& minChangeFraction) const {
+    uint64_t n = graph.getNumVertex();
+    unsigned threads = (numThreads == 0) ? getNumThreads() : numThreads;
+    double twoM = static_cast<double>(graph.getAdjacency().size());
+    tSweepState st(n);
+    //Sum of the degrees of the vertex in every community
+    unique_ptr<atomic<uint64_t>[]> total(new atomic<uint64_t>[n]);
+    for (uint64_t v = 0; v < n; ++v) {
+        total[v].store(graph.getDeg(v), memory_order_relaxed);
+    }
+    unique_ptr<atomic<uint64_t>[]> members(new atomic<uint64_t>[n]);
+    for (uint64_t v = 0; v < n; ++v) {
+        members[v].store(1, memory_order_relaxed);
+    }
+    vector<vector<uint64_t> > buffers(threads);
+    tResult result;
+    result.iterations = 0;
+    while ((result.iterations < maxIterations) && (twoM > 0)) {
+        atomic<uint64_t> changes(0);
+        parallelForThread(0, n, [&](unsigned tID, uint64_t v) {
+            if (!st.active[v].exchange(0, memory_order_relaxed)) {
+                return;
+            }
+            vector<uint64_t>& buffer = buffers[tID];
+            neighbourLabels(graph, v, st, buffer);
+            if (buffer.empty()) {
+                return;
+            }
+            uint64_t current = st.label[v].load(memory_order_relaxed);
+            double kv = static_cast<double>(graph.getDeg(v));
+            //Gain of joining c, once v is out of its community: k_v,c - tot_c * k_v / 2m
+            double bestGain = 0;
+            uint64_t best = current;
+            for (uint64_t i = 0; i < buffer.size();) {
+                uint64_t j = i;
+                while ((j < buffer.size()) && (buffer[j] == buffer[i])) {
+                    ++j;
+                }
+                double tot = static_cast<double>(total[buffer[i]].load(memory_order_relaxed));
+                if (buffer[i] == current) {
+                    tot -= kv;
+                }
+                double gain = (j - i) - tot * kv / twoM;
+                if (buffer[i] == current) {
+                    gain += 1e-12;      //Stay on ties
+                }
+                if ((gain > bestGain) || ((gain == bestGain) && (buffer[i] < best))) {
+                    bestGain = gain;
+                    best = buffer[i];
+                }
+                i = j;
+            }
+            if (best == current) {
+                return;
+            }
+            //Two singletons swapping into each other's community would both
+            //end up alone again. Only the move towards the smaller label is allowed
+            if ((members[current].load(memory_order_relaxed) == 1) && (members[best].load(memory_order_relaxed) == 1) && (best > current)) {
+                return;
+            }
+            uint64_t deg = graph.getDeg(v);
+            total[current].fetch_sub(deg, memory_order_relaxed);
+            total[best].fetch_add(deg, memory_order_relaxed);
+            members[current].fetch_sub(1, memory_order_relaxed);
+            members[best].fetch_add(1, memory_order_relaxed);
+            st.label[v].store(best, memory_order_relaxed);
+            activateNeighbours(graph, v, st);
+            changes.fetch_add(1, memory_order_relaxed);
+        }, 256, threads);
+        ++result.iterations;
+        if (changes.load() <= minChangeFraction * n) {
+            break;
+        }
+    }
+    vector<uint64_t> labels(n);
+    for (uint64_t v = 0; v < n; ++v) {
+        labels[v] = st.label[v].load(memory_order_relaxed);
+    }
+    finish(labels, result);
+    return result;
+}
+
+double CommunityDetector::modularity (const vector<uint64_t>& community) const {
+    uint64_t n = graph.getNumVertex();
+    double twoM = static_cast<double>(graph.getAdjacency().size());
+    if (twoM == 0) {
+        return 0;
+    }
+    uint64_t numCommunities = 0;
+    for (auto c : community) {
+        numCommunities = max(numCommunities, c + 1);
+    }
+    vector<double> inside(numCommunities, 0);
+    vector<double> total(numCommunities, 0);
+    for (uint64_t v = 0; v < n; ++v) {
+        total[community[v]] += graph.getDeg(v);
+        for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+            if (community[*a] == community[v]) {
+                inside[community[v]] += 1;
+            }
+        }
+    }
+    double q = 0;
+    for (uint64_t c = 0; c < numCommunities; ++c) {
+        q += inside[c] / twoM - (total[c] / twoM) * (total[c] / twoM);
+    }
+    return q;
+}
+
+void CommunityDetector::finish (const vector<uint64_t>& labels, tResult& result) const {
+    unordered_map<uint64_t, uint64_t> renumber;
+    result.community.resize(labels.size());
+    for (uint64_t v = 0; v < labels.size(); ++v) {
+        unordered_map<uint64_t, uint64_t>::iterator it = renumber.find(labels[v]);
+        if (it == renumber.end()) {
+            it = renumber.insert(make_pair(labels[v], renumber.size())).first;
+        }
+        result.community[v] = it->second;
+    }
+    result.numCommunities = renumber.size();
+    result.modularity = modularity(result.community);
+}
@@ -0,0 +1,102 @@
+/**
+ * community.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_community_h
+#define dasel_community_h
+
+#include <vector>
+#include <stdint.h>
+#include "compact-graph.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Finds communities in an undirected graph.
+///
+/// Two parallel methods are available, both updating labels in place
+/// (asynchronously) while threads sweep consecutive ranges of vertex, so
+/// that label and adjacency reads follow memory order:
+///   * labelPropagation(): every vertex takes the most frequent label among
+///     its neighbours. Ties are broken by a hash of the label, the seed and
+///     the iteration.
+///   * louvain(): first phase of Louvain. Every vertex moves to the
+///     neighbouring community with the largest modularity gain. Community
+///     degree totals are kept in atomic counters.
+/// Neighbour labels are counted by sorting them in a per-thread buffer. Only
+/// vertex with a neighbour that changed in the last sweep are visited again.
+/// Both stop after a sweep where fewer than minChangeFraction * n vertex
+/// changed, or after maxIterations sweeps.
+///
+/// With a single thread the result only depends on the seed. With more
+/// threads the order of the asynchronous updates may change it slightly.
+///
+/// The detector works on a snapshot, so the source graph is never modified.
+///
+class CommunityDetector {
+public:
+    /// Result of a community detection
+    struct tResult {
+        vector<uint64_t> community; ///<Community of every vertex index, in [0, numCommunities)
+        uint64_t numCommunities;    ///<Number of communities
+        double modularity;          ///<Modularity of the partition
+        uint64_t iterations;        ///<Sweeps run
+    };
+    
+    ///
+    /// \brief Creates a detector for an undirected graph
+    ///
+    /// \param g Graph to analyse
+    /// \param rngSeed Seed for tie breaking
+    /// \param threads Number of threads. 0 uses all hardware threads
+    //
+    explicit CommunityDetector (const UndirectedGraph& g, const uint64_t& rngSeed=0, const unsigned& threads=0);
+    ///Creates a detector for an undirected compact graph
+    explicit CommunityDetector (const CompactGraph& g, const uint64_t& rngSeed=0, const unsigned& threads=0);
+    ///Returns the snapshot communities are computed on
+    const CompactGraph& getGraph () const { return graph; }
+    ///
+    /// \brief Runs asynchronous label propagation
+    ///
+    /// \param maxIterations Maximum number of sweeps
+    /// \param minChangeFraction Convergence cutoff, as a fraction of the vertex
+    //
+    tResult labelPropagation (const uint64_t& maxIterations=20, const double& minChangeFraction=0.001) const;
+    ///
+    /// \brief Runs the local moving phase of Louvain
+    ///
+    /// \param maxIterations Maximum number of sweeps
+    /// \param minChangeFraction Convergence cutoff, as a fraction of the vertex
+    //
+    tResult louvain (const uint64_t& maxIterations=20, const double& minChangeFraction=0.001) const;
+    ///Returns the modularity of a partition, given the community of every vertex index
+    double modularity (const vector<uint64_t>& community) const;
+    
+private:
+    CompactGraph graph;     ///Snapshot of the graph
+    uint64_t seed;          ///Seed for tie breaking
+    unsigned numThreads;    ///Number of threads, 0 for all hardware threads
+    
+    ///Renumbers labels to [0, numCommunities) and fills the rest of the result
+    void finish (const vector<uint64_t>& labels, tResult& result) const;
+};
+
+#endif /* dasel_community_h */
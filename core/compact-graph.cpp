@@ -0,0 +1,229 @@
+/**
+ * compact-graph.cpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include "compact-graph.hpp"
+#include "parallel.hpp"
+#include "prefetch.hpp"
+
+namespace {
+    ///Adjacency entries between the one being checked and the one whose
+    ///distance is prefetched
+    const uint64_t kPrefetchAhead = 8;
+}
+
+
+//#/////////////////////////////////////////////////
+// CompactGraph
+//
+CompactGraph::CompactGraph (const UndirectedGraph& uGraph) {
+    *this = uGraph.inducedSubgraph(uGraph.getVertexIDs());
+}
+
+CompactGraph::CompactGraph (const DirectedGraph& dGraph) {
+    *this = dGraph.inducedSubgraph(dGraph.getVertexIDs());
+}
+
+CompactGraph::CompactGraph (vector<uint64_t>&& ids, vector<uint64_t>&& offs, vector<uint64_t>&& adj, const bool& isDirected) :
+    directed(isDirected), numEdges(0), vertexIDs(move(ids)), offsets(move(offs)), adjacency(move(adj)) {
+    if (directed) {
+        numEdges = adjacency.size();
+    }
+    else {
+        //Every edge is stored twice, but self loops only once
+        uint64_t loops = 0;
+        for (uint64_t i = 0; i < vertexIDs.size(); ++i) {
+            if (isEdge(i, i)) {
+                ++loops;
+            }
+        }
+        numEdges = (adjacency.size() + loops) / 2;
+    }
+}
+
+CompactGraph CompactGraph::fromEdges (const uint64_t& numVertex, const vector<pair<uint64_t, uint64_t> >& edges, const bool& isDirected) {
+    //Count the entries of every adjacency list
+    unique_ptr<atomic<uint64_t>[]> slot(new atomic<uint64_t>[numVertex]);
+    parallelFor(0, numVertex, [&](uint64_t i) { slot[i].store(0, memory_order_relaxed); }, 4096);
+    parallelFor(0, edges.size(), [&](uint64_t i) {
+        slot[edges[i].first].fetch_add(1, memory_order_relaxed);
+        if (!isDirected && (edges[i].first != edges[i].second)) {
+            slot[edges[i].second].fetch_add(1, memory_order_relaxed);
+        }
+    }, 4096);
+    vector<uint64_t> offsets(numVertex + 1, 0);
+    for (uint64_t i = 0; i < numVertex; ++i) {
+        offsets[i + 1] = offsets[i] + slot[i].load(memory_order_relaxed);
+        slot[i].store(offsets[i], memory_order_relaxed);
+    }
+    //Scatter every entry into its list
+    vector<uint64_t> adjacency(offsets[numVertex]);
+    parallelFor(0, edges.size(), [&](uint64_t i) {
+        adjacency[slot[edges[i].first].fetch_add(1, memory_order_relaxed)] = edges[i].second;
+        if (!isDirected && (edges[i].first != edges[i].second)) {
+            adjacency[slot[edges[i].second].fetch_add(1, memory_order_relaxed)] = edges[i].first;
+        }
+    }, 4096);
+    slot.reset();
+    //Sort every list and drop duplicates
+    vector<uint64_t> degree(numVertex + 1, 0);
+    parallelFor(0, numVertex, [&](uint64_t i) {
+        uint64_t* first = adjacency.data() + offsets[i];
+        uint64_t* last = adjacency.data() + offsets[i + 1];
+        sort(first, last);
+        degree[i + 1] = unique(first, last) - first;
+    }, 256);
+    partial_sum(degree.begin(), degree.end(), degree.begin());
+    if (degree[numVertex] != offsets[numVertex]) {
+        vector<uint64_t> compacted(degree[numVertex]);
+        parallelFor(0, numVertex, [&](uint64_t i) {
+            copy(adjacency.data() + offsets[i], adjacency.data() + offsets[i] + (degree[i + 1] - degree[i]), compacted.data() + degree[i]);
+        }, 256);
+        adjacency.swap(compacted);
+    }
+    vector<uint64_t> ids(numVertex);
+    iota(ids.begin(), ids.end(), 0);
+    return CompactGraph(move(ids), move(degree), move(adjacency), isDirected);
+}
+
+CompactGraph CompactGraph::inducedSubgraph (const vector<uint64_t>& indexes) const {
+    uint64_t n = indexes.size();
+    vector<uint64_t> newIndex(getNumVertex(), kNoVertex);
+    vector<uint64_t> ids(n);
+    for (uint64_t i = 0; i < n; ++i) {
+        newIndex[indexes[i]] = i;
+        ids[i] = vertexIDs[indexes[i]];
+    }
+    vector<uint64_t> offs(n + 1, 0);
+    parallelFor(0, n, [&](uint64_t i) {
+        uint64_t count = 0;
+        for (const uint64_t* a = adjBegin(indexes[i]); a != adjEnd(indexes[i]); ++a) {
+            count += (newIndex[*a] != kNoVertex);
+        }
+        offs[i + 1] = count;
+    });
+    partial_sum(offs.begin(), offs.end(), offs.begin());
+    vector<uint64_t> adj(offs[n]);
+    parallelFor(0, n, [&](uint64_t i) {
+        uint64_t pos = offs[i];
+        for (const uint64_t* a = adjBegin(indexes[i]); a != adjEnd(indexes[i]); ++a) {
+            if (newIndex[*a] != kNoVertex) {
+                adj[pos++] = newIndex[*a];
+            }
+        }
+    });
+    return CompactGraph(move(ids), move(offs), move(adj), directed);
+}
+
+CompactGraph CompactGraph::transpose (const unsigned& numThreads) const {
+    if (!directed) {
+        return *this;
+    }
+    uint64_t n = getNumVertex();
+    unsigned threads = (numThreads != 0) ? numThreads : getNumThreads();
+    //Count the in connections of every vertex
+    unique_ptr<atomic<uint64_t>[]> slot(new atomic<uint64_t>[n]);
+    parallelFor(0, n, [&](uint64_t i) { slot[i].store(0, memory_order_relaxed); }, 4096, threads);
+    parallelFor(0, adjacency.size(), [&](uint64_t i) {
+        slot[adjacency[i]].fetch_add(1, memory_order_relaxed);
+    }, 4096, threads);
+    vector<uint64_t> offs(n + 1, 0);
+    for (uint64_t i = 0; i < n; ++i) {
+        offs[i + 1] = offs[i] + slot[i].load(memory_order_relaxed);
+        slot[i].store(offs[i], memory_order_relaxed);
+    }
+    //Scatter every source into the list of its targets
+    vector<uint64_t> adj(adjacency.size());
+    parallelFor(0, n, [&](uint64_t i) {
+        for (const uint64_t* a = adjBegin(i); a != adjEnd(i); ++a) {
+            adj[slot[*a].fetch_add(1, memory_order_relaxed)] = i;
+        }
+    }, 1024, threads);
+    slot.reset();
+    //A single thread scatters the sources in increasing order, so the lists
+    //are only out of order when several threads took part
+    if (threads > 1) {
+        parallelFor(0, n, [&](uint64_t i) { sort(adj.data() + offs[i], adj.data() + offs[i + 1]); }, 256, threads);
+    }
+    vector<uint64_t> ids(vertexIDs);
+    return CompactGraph(move(ids), move(offs), move(adj), true);
+}
+
+uint64_t CompactGraph::bfs (const uint64_t& srcIdx, vector<uint64_t>& dist, const uint64_t& groupSize) const {
+    uint64_t n = getNumVertex();
+    dist.assign(n, kNoVertex);
+    vector<uint64_t> queue;
+    queue.reserve(n);
+    queue.push_back(srcIdx);
+    dist[srcIdx] = 0;
+    if (groupSize == 0) {
+        for (uint64_t head = 0; head < queue.size(); ++head) {
+            uint64_t v = queue[head];
+            for (const uint64_t* a = adjBegin(v); a != adjEnd(v); ++a) {
+                if (dist[*a] == kNoVertex) {
+                    dist[*a] = dist[v] + 1;
+                    queue.push_back(*a);
+                }
+            }
+        }
+        return queue.size();
+    }
+    //A group can be cut short by the end of the queue, so the next one starts where it ended
+    for (uint64_t head = 0, end = 0; head < queue.size(); head = end) {
+        end = min<uint64_t>(head + groupSize, queue.size());
+        //Vertex records of the next group, adjacency blocks of this one
+        for (uint64_t i = end; i < min<uint64_t>(end + groupSize, queue.size()); ++i) {
+            prefetchRead(&offsets[queue[i]]);
+        }
+        for (uint64_t i = head; i < end; ++i) {
+            prefetchRead(adjBegin(queue[i]));
+        }
+        for (uint64_t i = head; i < end; ++i) {
+            uint64_t v = queue[i];
+            const uint64_t* first = adjBegin(v);
+            const uint64_t* last = adjEnd(v);
+            for (const uint64_t* a = first; (a != last) && (a < first + kPrefetchAhead); ++a) {
+                prefetchRead(&dist[*a]);
+            }
+            for (const uint64_t* a = first; a != last; ++a) {
+                if (last - a > static_cast<int64_t>(kPrefetchAhead)) {
+                    prefetchRead(&dist[a[kPrefetchAhead]]);
+                }
+                if (dist[*a] == kNoVertex) {
+                    dist[*a] = dist[v] + 1;
+                    queue.push_back(*a);
+                }
+            }
+        }
+    }
+    return queue.size();
+}
+
+uint64_t CompactGraph::getIndex (const uint64_t& vID) const {
+    vector<uint64_t>::const_iterator it = lower_bound(vertexIDs.begin(), vertexIDs.end(), vID);
+    if ((it != vertexIDs.end()) && (*it == vID)) {
+        return it - vertexIDs.begin();
+    }
+    return kNoVertex;
+}
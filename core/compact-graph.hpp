@@ -0,0 +1,153 @@
+/**
+ * compact-graph.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_compact_graph_h
+#define dasel_compact_graph_h
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "graph.hpp"
+
+using namespace std;
+
+/// Returned by CompactGraph::getIndex() for IDs not in the graph
+const uint64_t kNoVertex = UINT64_MAX;
+
+//#//////////////////////////////////////////////
+/// \brief Implements an immutable graph in compressed sparse row (CSR) form.
+///
+/// Vertex are identified by their index, in [0, getNumVertex()), assigned in
+/// increasing order of vertex ID. All adjacency lists are stored back to back
+/// in a single vector, and the offsets vector holds where the list of each
+/// vertex starts. Adjacency lists contain vertex indexes, sorted.
+///
+/// An undirected graph stores each edge in the lists of both ends (self
+/// loops only once), as UndirectedGraph does. A directed graph stores the
+/// out edges only.
+///
+/// Being contiguous and read only, it is the representation used by the
+/// parallel algorithms, which can keep per-vertex state in plain vectors
+/// indexed by vertex index.
+///
+class CompactGraph {
+    bool directed;                  ///True for a directed graph
+    uint64_t numEdges;              ///Total number of edges in the graph
+    vector<uint64_t> vertexIDs;     ///Vertex ID for every vertex index, sorted
+    vector<uint64_t> offsets;       ///Start of the adjacency list for each vertex, plus the end of the last one
+    vector<uint64_t> adjacency;     ///All adjacency lists, back to back
+
+public:
+    //#//////////////////////////////////////////////
+    // Constructors
+    /// Default constructor, creates an empty undirected graph
+    CompactGraph (): directed(false), numEdges(0), offsets(1, 0) { }
+    /// Creates a snapshot of an undirected graph
+    explicit CompactGraph (const UndirectedGraph& uGraph);
+    /// Creates a snapshot of a directed graph, keeping the out edges
+    explicit CompactGraph (const DirectedGraph& dGraph);
+    ///
+    /// \brief Creates a graph from its CSR arrays, taking ownership of them
+    ///
+    /// \param ids Sorted vertex IDs
+    /// \param offs Offsets of each adjacency list, with ids.size()+1 elements
+    /// \param adj Adjacency lists, with sorted vertex indexes
+    /// \param isDirected True for a directed graph
+    //
+    CompactGraph (vector<uint64_t>&& ids, vector<uint64_t>&& offs, vector<uint64_t>&& adj, const bool& isDirected);
+    ///
+    /// \brief Builds a graph with vertex IDs 0 to numVertex-1 from an edge list
+    ///
+    /// Uses a parallel counting sort by source vertex, so the cost is linear
+    /// in the number of edges. Duplicated edges are dropped.
+    ///
+    /// \param numVertex Number of vertex. All edge ends must be smaller
+    /// \param edges Pairs of <fromID, toID>
+    /// \param isDirected True for a directed graph
+    //
+    static CompactGraph fromEdges (const uint64_t& numVertex, const vector<pair<uint64_t, uint64_t> >& edges, const bool& isDirected);
+    //#//////////////////////////////////////////////
+    // Access
+    ///Returns true for a directed graph
+    bool isDirected () const { return directed; }
+    ///Returns the number of vertex in the graph
+    uint64_t getNumVertex () const { return vertexIDs.size(); }
+    ///Returns the number of edges in the graph
+    uint64_t getNumEdges () const { return numEdges; }
+    ///Returns the vertex ID for the given vertex index
+    uint64_t getId (const uint64_t& idx) const { return vertexIDs[idx]; }
+    ///Returns the vertex index for the given vertex ID, or kNoVertex if it is
+    ///not part of the graph
+    uint64_t getIndex (const uint64_t& vID) const;
+    ///Returns the (out) degree of the vertex
+    uint64_t getDeg (const uint64_t& idx) const { return offsets[idx + 1] - offsets[idx]; }
+    ///Returns a pointer to the first element of the adjacency list of the vertex
+    const uint64_t* adjBegin (const uint64_t& idx) const { return adjacency.data() + offsets[idx]; }
+    ///Returns a pointer past the last element of the adjacency list of the vertex
+    const uint64_t* adjEnd (const uint64_t& idx) const { return adjacency.data() + offsets[idx + 1]; }
+    ///Returns the index of the adjacent vertex in the given position of the adjacency list
+    uint64_t getAdj (const uint64_t& idx, const uint64_t& pos) const { return adjacency[offsets[idx] + pos]; }
+    ///Returns true if there is an edge between the 2 vertex indexes
+    bool isEdge (const uint64_t& fromIdx, const uint64_t& toIdx) const {
+        return binary_search(adjBegin(fromIdx), adjEnd(fromIdx), toIdx); }
+    ///Returns all vertex IDs, indexed by vertex index
+    const vector<uint64_t>& getVertexIDs () const { return vertexIDs; }
+    ///Returns the offsets vector of the CSR representation
+    const vector<uint64_t>& getOffsets () const { return offsets; }
+    ///Returns the adjacency vector of the CSR representation
+    const vector<uint64_t>& getAdjacency () const { return adjacency; }
+    ///
+    /// \brief Returns the subgraph induced by a set of vertex
+    ///
+    /// \param indexes Vertex indexes in the subgraph, sorted and without duplicates
+    /// \return Induced subgraph, keeping the vertex IDs
+    //
+    CompactGraph inducedSubgraph (const vector<uint64_t>& indexes) const;
+    ///
+    /// \brief Returns the graph with every edge reversed, keeping vertex IDs
+    ///
+    /// Uses a parallel counting sort by target vertex, so the cost is linear
+    /// in the number of edges. The adjacency list of each vertex in the
+    /// result holds its in connections. An undirected graph is returned as is.
+    ///
+    /// \param numThreads Number of threads. 0 uses all hardware threads
+    //
+    CompactGraph transpose (const unsigned& numThreads=0) const;
+    ///
+    /// \brief Runs a BFS, computing the distance to every vertex
+    ///
+    /// With a group size, the queue is consumed in groups: the offsets of the
+    /// next group and the adjacency blocks of the current one are prefetched
+    /// before they are needed, and the distance entries of the neighbours are
+    /// prefetched a few positions ahead while walking each list. This keeps
+    /// several cache misses in flight, which pays off when the graph is much
+    /// bigger than the CPU caches.
+    ///
+    /// \param srcIdx Index of the source vertex
+    /// \param dist Output, distance to every vertex index, kNoVertex if unreached
+    /// \param groupSize Queue entries handled together. 0 runs a plain BFS
+    /// \return Number of vertex reached, the source included
+    //
+    uint64_t bfs (const uint64_t& srcIdx, vector<uint64_t>& dist, const uint64_t& groupSize=0) const;
+};
+
+#endif /* dasel_compact_graph_h */
@@ -0,0 +1,256 @@
+/**
+* diameter.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include "diameter.hpp"
+#include "parallel.hpp"
+
+namespace {
+    ///Returns the vertex index with the largest value of dist, among the reached ones
+    uint64_t farthest (const vector<uint64_t>& dist) {
+        uint64_t best = 0;
+        for (uint64_t v = 0; v < dist.size(); ++v) {
+            if ((dist[v] != kNoVertex) && ((dist[best] == kNoVertex) || (dist[v] > dist[best]))) {
+                best = v;
+            }
+        }
+        return best;
+    }
+}
+
+//#/////////////////////////////////////////////////
+// DiameterCalculator
+//
+DiameterCalculator::DiameterCalculator (const CompactGraph& g, const uint64_t& startIdx, const unsigned& threads) :
+    numThreads(threads), numBFS(0) {
+    uint64_t n = g.getNumVertex();
+    if (n == 0) {
+        return;
+    }
+    uint64_t start = startIdx;
+    if (start == kNoVertex) {
+        start = 0;
+        for (uint64_t v = 1; v < n; ++v) {
+            if (g.getDeg(v) > g.getDeg(start)) {
+                start = v;
+            }
+        }
+    }
+    claimed.reset(new atomic<uint8_t>[n]);
+    vector<uint64_t> fwd;
+    bfs(g, start, fwd);
+    vector<uint64_t> members;
+    if (g.isDirected()) {
+        CompactGraph rg = g.transpose(numThreads);
+        vector<uint64_t> bwd;
+        bfs(rg, start, bwd);
+        for (uint64_t v = 0; v < n; ++v) {
+            if ((fwd[v] != kNoVertex) && (bwd[v] != kNoVertex)) {
+                members.push_back(v);
+            }
+        }
+    }
+    else {
+        for (uint64_t v = 0; v < n; ++v) {
+            if (fwd[v] != kNoVertex) {
+                members.push_back(v);
+            }
+        }
+    }
+    numBFS = 0;     //Finding the component is not part of the count
+    component = g.inducedSubgraph(members);
+    if (component.isDirected()) {
+        reverse = component.transpose(numThreads);
+    }
+    claimed.reset(new atomic<uint8_t>[component.getNumVertex()]);
+}
+
+uint64_t DiameterCalculator::bfs (const CompactGraph& g, const uint64_t& src, vector<uint64_t>& dist) {
+    ++numBFS;
+    uint64_t n = g.getNumVertex();
+    unsigned threads = (numThreads == 0) ? getNumThreads() : numThreads;
+    dist.assign(n, kNoVertex);
+    parallelFor(0, n, [&](uint64_t v) { claimed[v].store(0, memory_order_relaxed); }, 4096, threads);
+    vector<vector<uint64_t> > found(threads);
+    vector<uint64_t> frontier(1, src);
+    claimed[src].store(1, memory_order_relaxed);
+    dist[src] = 0;
+    uint64_t level = 0;
+    while (true) {
+        //Only the thread claiming a vertex writes its distance
+        parallelForThread(0, frontier.size(), [&](unsigned tID, uint64_t i) {
+            uint64_t v = frontier[i];
+            for (const uint64_t* a = g.adjBegin(v); a != g.adjEnd(v); ++a) {
+                if (!claimed[*a].load(memory_order_relaxed) && !claimed[*a].exchange(1, memory_order_relaxed)) {
+                    dist[*a] = level + 1;
+                    found[tID].push_back(*a);
+                }
+            }
+        }, 64, threads);
+        frontier.clear();
+        for (auto& f : found) {
+            frontier.insert(frontier.end(), f.begin(), f.end());
+            f.clear();
+        }
+        if (frontier.empty()) {
+            return level;
+        }
+        ++level;
+    }
+}
+
+uint64_t DiameterCalculator::diameter () {
+    uint64_t n = component.getNumVertex();
+    if (n <= 1) {
+        return 0;
+    }
+    if (!ecc.empty()) {
+        return *max_element(ecc.begin(), ecc.end());
+    }
+    const CompactGraph& bg = backward();
+    vector<uint64_t> dist;
+    vector<uint64_t> parent;
+    //Double sweep: the farthest vertex from a high degree vertex, and the farthest from it
+    uint64_t start = 0;
+    for (uint64_t v = 1; v < n; ++v) {
+        if (component.getDeg(v) > component.getDeg(start)) {
+            start = v;
+        }
+    }
+    bfs(component, start, dist);
+    uint64_t a = farthest(dist);
+    uint64_t lb = bfs(component, a, dist);
+    uint64_t b = farthest(dist);
+    //Central vertex: halfway on a shortest path from a to b, walking back from b
+    vector<uint64_t> back;
+    bfs(bg, b, back);
+    uint64_t u = a;
+    uint64_t half = dist[b] / 2;
+    while (dist[u] < half) {
+        for (const uint64_t* x = component.adjBegin(u); x != component.adjEnd(u); ++x) {
+            if ((dist[*x] == dist[u] + 1) && (back[*x] + 1 == back[u])) {
+                u = *x;
+                break;
+            }
+        }
+    }
+    //iFUB / DiFUB from u
+    vector<uint64_t> fwd, bwd;
+    uint64_t eccF = bfs(component, u, fwd);
+    uint64_t eccB = component.isDirected() ? bfs(bg, u, bwd) : eccF;
+    if (!component.isDirected()) {
+        bwd = fwd;
+    }
+    uint64_t i = max(eccF, eccB);
+    lb = max(lb, i);
+    uint64_t ub = 2 * i;
+    vector<uint64_t> scratch;
+    while (ub > lb) {
+        //Vertex at forward level i: their backward eccentricity. At backward
+        //level i: their forward eccentricity. Equal for undirected graphs
+        uint64_t bi = 0;
+        for (uint64_t v = 0; v < n; ++v) {
+            if (fwd[v] == i) {
+                bi = max(bi, bfs(bg, v, scratch));
+            }
+            if (component.isDirected() && (bwd[v] == i)) {
+                bi = max(bi, bfs(component, v, scratch));
+            }
+        }
+        lb = max(lb, bi);
+        if (lb > 2 * (i - 1)) {
+            return lb;
+        }
+        ub = 2 * (i - 1);
+        --i;
+    }
+    return lb;
+}
+
+const vector<uint64_t>& DiameterCalculator::eccentricities () {
+    uint64_t n = component.getNumVertex();
+    if (!ecc.empty() || (n == 0)) {
+        return ecc;
+    }
+    const CompactGraph& bg = backward();
+    vector<uint64_t> lower(n, 0);
+    vector<uint64_t> upper(n, UINT64_MAX);
+    vector<uint8_t> done(n, 0);
+    uint64_t remaining = n;
+    vector<uint64_t> fwd, bwd;
+    bool pickUpper = false;
+    while (remaining) {
+        //Alternate the candidate with the smallest lower bound and the one
+        //with the largest upper bound. Ties go to the largest degree
+        uint64_t v = kNoVertex;
+        for (uint64_t w = 0; w < n; ++w) {
+            if (done[w]) {
+                continue;
+            }
+            if (v == kNoVertex) {
+                v = w;
+            }
+            else if (pickUpper ? ((upper[w] > upper[v]) || ((upper[w] == upper[v]) && (component.getDeg(w) > component.getDeg(v))))
+                               : ((lower[w] < lower[v]) || ((lower[w] == lower[v]) && (component.getDeg(w) > component.getDeg(v))))) {
+                v = w;
+            }
+        }
+        pickUpper = !pickUpper;
+        uint64_t e = bfs(component, v, fwd);
+        if (component.isDirected()) {
+            bfs(bg, v, bwd);
+        }
+        const vector<uint64_t>& to = component.isDirected() ? bwd : fwd;
+        //ecc(w) >= d(w, v), ecc(w) >= ecc(v) - d(v, w), ecc(w) <= d(w, v) + ecc(v)
+        for (uint64_t w = 0; w < n; ++w) {
+            if (done[w]) {
+                continue;
+            }
+            uint64_t lo = max(to[w], (e > fwd[w]) ? e - fwd[w] : 0);
+            lower[w] = max(lower[w], lo);
+            upper[w] = min(upper[w], to[w] + e);
+            if ((w == v) || (lower[w] == upper[w])) {
+                lower[w] = (w == v) ? e : lower[w];
+                done[w] = 1;
+                --remaining;
+            }
+        }
+    }
+    ecc.swap(lower);
+    return ecc;
+}
+
+uint64_t DiameterCalculator::radius () {
+    const vector<uint64_t>& e = eccentricities();
+    return e.empty() ? 0 : *min_element(e.begin(), e.end());
+}
+
+uint64_t DiameterCalculator::eccentricity (const uint64_t& vID) {
+    uint64_t idx = component.getIndex(vID);
+    if (idx == kNoVertex) {
+        return kNoVertex;
+    }
+    if (!ecc.empty()) {
+        return ecc[idx];
+    }
+    vector<uint64_t> dist;
+    return bfs(component, idx, dist);
+}
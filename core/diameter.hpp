@@ -0,0 +1,90 @@
+/**
+ * diameter.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_diameter_h
+#define dasel_diameter_h
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include "compact-graph.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Computes exact diameter, radius and eccentricities with few BFS.
+///
+/// The work is done on the connected component (strongly connected for a
+/// directed graph) containing a start vertex, by default the one with the
+/// largest degree. Eccentricities are measured along out edges.
+///
+/// diameter() uses a double sweep for a first lower bound and then iFUB
+/// (undirected) or DiFUB (directed): BFS from the vertex in the outermost
+/// levels of a BFS from a central vertex, stopping as soon as the lower bound
+/// exceeds twice the next level. eccentricities() keeps a lower and an upper
+/// bound for every vertex, refined after each BFS, and only runs BFS until
+/// all bounds meet (BoundingDiameters). Both usually need a small fraction
+/// of the BFS that an all-pairs computation would.
+///
+/// Every BFS is level synchronous and expands the frontier in parallel.
+/// getNumBFS() reports how many full BFS have been run.
+///
+class DiameterCalculator {
+    CompactGraph component;         ///Component of the start vertex
+    CompactGraph reverse;           ///Component with the edges reversed, for directed graphs
+    unsigned numThreads;            ///Number of threads, 0 for all hardware threads
+    uint64_t numBFS;                ///Number of BFS run
+    vector<uint64_t> ecc;           ///Eccentricities, once computed
+    unique_ptr<atomic<uint8_t>[]> claimed;  ///BFS visited flags
+    
+public:
+    ///
+    /// \brief Prepares the computation on a graph
+    ///
+    /// \param g Graph to analyse
+    /// \param startIdx Vertex index inside the component to analyse. kNoVertex
+    ///        selects the vertex with the largest degree
+    /// \param threads Number of threads. 0 uses all hardware threads
+    //
+    explicit DiameterCalculator (const CompactGraph& g, const uint64_t& startIdx=kNoVertex, const unsigned& threads=0);
+    ///Returns the component analysed. Its vertex IDs are the ones of the original graph
+    const CompactGraph& getComponent () const { return component; }
+    ///Returns the exact diameter of the component
+    uint64_t diameter ();
+    ///Returns the exact radius of the component
+    uint64_t radius ();
+    ///Returns the eccentricity of every vertex, indexed by component vertex index
+    const vector<uint64_t>& eccentricities ();
+    ///Returns the eccentricity of the vertex ID, or kNoVertex if it is outside the component
+    uint64_t eccentricity (const uint64_t& vID);
+    ///Returns the number of BFS run so far
+    uint64_t getNumBFS () const { return numBFS; }
+    
+private:
+    ///Runs a parallel BFS, filling dist (kNoVertex if unreached). Returns the eccentricity of src
+    uint64_t bfs (const CompactGraph& g, const uint64_t& src, vector<uint64_t>& dist);
+    ///Returns the graph to use for backward BFS
+    const CompactGraph& backward () const { return component.isDirected() ? reverse : component; }
+};
+
+#endif /* dasel_diameter_h */
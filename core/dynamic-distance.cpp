@@ -0,0 +1,316 @@
+/**
+* dynamic-distance.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <queue>
+#include <stdexcept>
+#include <functional>
+#include "dynamic-distance.hpp"
+#include "parallel.hpp"
+
+namespace {
+    ///Vertex states during a removal
+    const uint8_t kSettled = 0;     ///Distance known
+    const uint8_t kAffected = 1;    ///In the subtree cut off, not checked yet
+    const uint8_t kDirty = 2;       ///In the subtree cut off, without parent at the same distance
+}
+
+//#/////////////////////////////////////////////////
+// DynamicDistances
+//
+DynamicDistances::DynamicDistances (UndirectedGraph& g, const unsigned& threads) : graph(g), numThreads(threads) {
+    rebuild();
+}
+
+void DynamicDistances::addRoot (const uint64_t& vID) {
+    if (!graph.isVertex(vID)) {
+        throw invalid_argument("DynamicDistances: the root is not in the graph");
+    }
+    for (auto& r : roots) {
+        if (r.id == vID) {
+            return;
+        }
+    }
+    slotOf(vID);
+    roots.push_back(tRoot());
+    roots.back().id = vID;
+    resizeRoots();
+    bfs(roots.back());
+}
+
+void DynamicDistances::removeRoot (const uint64_t& vID) {
+    for (vector<tRoot>::iterator it = roots.begin(); it != roots.end(); ++it) {
+        if (it->id == vID) {
+            roots.erase(it);
+            return;
+        }
+    }
+}
+
+vector<uint64_t> DynamicDistances::getRoots () const {
+    vector<uint64_t> ids;
+    for (auto& r : roots) {
+        ids.push_back(r.id);
+    }
+    return ids;
+}
+
+void DynamicDistances::rebuild () {
+    slot.clear();
+    slotID.clear();
+    for (auto vID : graph.getVertexIDs()) {
+        slotOf(vID);
+    }
+    //Roots removed from the graph are dropped
+    vector<tRoot> kept;
+    for (auto& r : roots) {
+        if (graph.isVertex(r.id)) {
+            kept.push_back(tRoot());
+            kept.back().id = r.id;
+        }
+    }
+    roots.swap(kept);
+    resizeRoots();
+    parallelFor(0, roots.size(), [&](uint64_t i) { bfs(roots[i]); }, 1, numThreads);
+}
+
+DynamicDistances::tUpdate DynamicDistances::addEdge (const uint64_t& from, const uint64_t& to) {
+    if (graph.isEdge(from, to)) {
+        return tUpdate{0, 0, 0};
+    }
+    graph.addVertex(from);
+    graph.addVertex(to);
+    graph.addEdge(from, to);
+    uint64_t a = slotOf(from);
+    uint64_t b = slotOf(to);
+    resizeRoots();
+    return updateRoots([&](tRoot& r, tUpdate& work) { insertUpdate(r, a, b, work); });
+}
+
+DynamicDistances::tUpdate DynamicDistances::removeEdge (const uint64_t& from, const uint64_t& to) {
+    if (!graph.isEdge(from, to)) {
+        return tUpdate{0, 0, 0};
+    }
+    graph.removeEdge(from, to);
+    uint64_t a = slotOf(from);
+    uint64_t b = slotOf(to);
+    return updateRoots([&](tRoot& r, tUpdate& work) { removeUpdate(r, a, b, work); });
+}
+
+uint64_t DynamicDistances::getDistance (const uint64_t& rootID, const uint64_t& vID) const {
+    const tRoot& r = getRoot(rootID);
+    unordered_map<uint64_t, uint64_t>::const_iterator it = slot.find(vID);
+    return (it != slot.end()) ? r.dist[it->second] : kNoVertex;
+}
+
+uint64_t DynamicDistances::getParent (const uint64_t& rootID, const uint64_t& vID) const {
+    const tRoot& r = getRoot(rootID);
+    unordered_map<uint64_t, uint64_t>::const_iterator it = slot.find(vID);
+    if ((it == slot.end()) || (r.parent[it->second] == kNoVertex)) {
+        return kNoVertex;
+    }
+    return slotID[r.parent[it->second]];
+}
+
+vector<uint64_t> DynamicDistances::getPath (const uint64_t& rootID, const uint64_t& vID) const {
+    const tRoot& r = getRoot(rootID);
+    vector<uint64_t> path;
+    unordered_map<uint64_t, uint64_t>::const_iterator it = slot.find(vID);
+    if ((it == slot.end()) || (r.dist[it->second] == kNoVertex)) {
+        return path;
+    }
+    for (uint64_t s = it->second; s != kNoVertex; s = r.parent[s]) {
+        path.push_back(slotID[s]);
+    }
+    reverse(path.begin(), path.end());
+    return path;
+}
+
+uint64_t DynamicDistances::slotOf (const uint64_t& vID) {
+    pair<unordered_map<uint64_t, uint64_t>::iterator, bool> it = slot.emplace(vID, slotID.size());
+    if (it.second) {
+        slotID.push_back(vID);
+    }
+    return it.first->second;
+}
+
+const DynamicDistances::tRoot& DynamicDistances::getRoot (const uint64_t& rootID) const {
+    for (auto& r : roots) {
+        if (r.id == rootID) {
+            return r;
+        }
+    }
+    throw out_of_range("DynamicDistances: unknown root");
+}
+
+void DynamicDistances::resizeRoots () {
+    for (auto& r : roots) {
+        r.dist.resize(slotID.size(), kNoVertex);
+        r.parent.resize(slotID.size(), kNoVertex);
+        r.state.resize(slotID.size(), kSettled);
+    }
+}
+
+template <class TFunc>
+void DynamicDistances::forEachAdj (const uint64_t& s, TFunc f) const {
+    const UndirectedGraph::Vertex* v = graph.findVertex(slotID[s]);
+    v->forEachAdj([&](const uint64_t& adjID) { f(slot.find(adjID)->second); });
+}
+
+template <class TFunc>
+DynamicDistances::tUpdate DynamicDistances::updateRoots (TFunc update) {
+    vector<tUpdate> work(roots.size(), tUpdate{0, 0, 0});
+    parallelFor(0, roots.size(), [&](uint64_t i) { update(roots[i], work[i]); }, 1, numThreads);
+    tUpdate total = {0, 0, 0};
+    for (auto& w : work) {
+        total.touched += w.touched;
+        total.changed += w.changed;
+        total.scanned += w.scanned;
+    }
+    return total;
+}
+
+void DynamicDistances::bfs (tRoot& r) const {
+    fill(r.dist.begin(), r.dist.end(), kNoVertex);
+    fill(r.parent.begin(), r.parent.end(), kNoVertex);
+    uint64_t root = slot.find(r.id)->second;
+    vector<uint64_t> queue(1, root);
+    r.dist[root] = 0;
+    for (uint64_t head = 0; head < queue.size(); ++head) {
+        uint64_t u = queue[head];
+        forEachAdj(u, [&](const uint64_t& w) {
+            if (r.dist[w] == kNoVertex) {
+                r.dist[w] = r.dist[u] + 1;
+                r.parent[w] = u;
+                queue.push_back(w);
+            }
+        });
+    }
+}
+
+void DynamicDistances::insertUpdate (tRoot& r, const uint64_t& a, const uint64_t& b, tUpdate& work) const {
+    //Only the farther end can get closer, through the other one
+    uint64_t from = (r.dist[a] <= r.dist[b]) ? a : b;
+    uint64_t to = (from == a) ? b : a;
+    if ((r.dist[from] == kNoVertex) || (r.dist[from] + 1 >= r.dist[to])) {
+        return;
+    }
+    r.dist[to] = r.dist[from] + 1;
+    r.parent[to] = from;
+    vector<uint64_t> queue(1, to);
+    for (uint64_t head = 0; head < queue.size(); ++head) {
+        uint64_t u = queue[head];
+        forEachAdj(u, [&](const uint64_t& w) {
+            ++work.scanned;
+            if (r.dist[u] + 1 < r.dist[w]) {
+                r.dist[w] = r.dist[u] + 1;
+                r.parent[w] = u;
+                queue.push_back(w);
+            }
+        });
+    }
+    work.touched += queue.size();
+    work.changed += queue.size();
+}
+
+void DynamicDistances::removeUpdate (tRoot& r, const uint64_t& a, const uint64_t& b, tUpdate& work) const {
+    //Removing an edge outside the tree keeps every shortest path in the tree
+    uint64_t cut;
+    if (r.parent[b] == a) {
+        cut = b;
+    }
+    else if (r.parent[a] == b) {
+        cut = a;
+    }
+    else {
+        return;
+    }
+    //Collect the subtree below the edge. Children are neighbours pointing
+    //back as parent, and the BFS order keeps distances non decreasing
+    vector<uint64_t> subtree(1, cut);
+    r.state[cut] = kAffected;
+    for (uint64_t head = 0; head < subtree.size(); ++head) {
+        uint64_t u = subtree[head];
+        forEachAdj(u, [&](const uint64_t& w) {
+            ++work.scanned;
+            if ((r.parent[w] == u) && (r.state[w] == kSettled)) {
+                r.state[w] = kAffected;
+                subtree.push_back(w);
+            }
+        });
+    }
+    //Closest to the root first, look for a settled parent at the same distance
+    vector<uint64_t> dirty;
+    for (auto u : subtree) {
+        uint64_t newParent = kNoVertex;
+        forEachAdj(u, [&](const uint64_t& w) {
+            ++work.scanned;
+            if ((newParent == kNoVertex) && (r.state[w] == kSettled) && (r.dist[w] + 1 == r.dist[u])) {
+                newParent = w;
+            }
+        });
+        if (newParent != kNoVertex) {
+            r.parent[u] = newParent;
+            r.state[u] = kSettled;
+        }
+        else {
+            r.state[u] = kDirty;
+            dirty.push_back(u);
+        }
+    }
+    //New distances for the rest: seeded from settled neighbours, then Dijkstra among them
+    typedef pair<uint64_t, uint64_t> tItem;
+    priority_queue<tItem, vector<tItem>, greater<tItem> > heap;
+    for (auto u : dirty) {
+        r.dist[u] = kNoVertex;
+        r.parent[u] = kNoVertex;
+        forEachAdj(u, [&](const uint64_t& w) {
+            ++work.scanned;
+            if ((r.state[w] == kSettled) && (r.dist[w] != kNoVertex) && (r.dist[w] + 1 < r.dist[u])) {
+                r.dist[u] = r.dist[w] + 1;
+                r.parent[u] = w;
+            }
+        });
+        if (r.dist[u] != kNoVertex) {
+            heap.push(make_pair(r.dist[u], u));
+        }
+    }
+    while (!heap.empty()) {
+        tItem top = heap.top();
+        heap.pop();
+        if (top.first != r.dist[top.second]) {
+            continue;
+        }
+        forEachAdj(top.second, [&](const uint64_t& w) {
+            ++work.scanned;
+            if ((r.state[w] == kDirty) && (top.first + 1 < r.dist[w])) {
+                r.dist[w] = top.first + 1;
+                r.parent[w] = top.second;
+                heap.push(make_pair(r.dist[w], w));
+            }
+        });
+    }
+    for (auto u : dirty) {
+        r.state[u] = kSettled;
+    }
+    work.touched += subtree.size();
+    work.changed += dirty.size();
+}
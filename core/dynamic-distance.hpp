@@ -0,0 +1,158 @@
+/**
+ * dynamic-distance.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_dynamic_distance_h
+#define dasel_dynamic_distance_h
+
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include "graph.hpp"
+#include "compact-graph.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Keeps the BFS distances from a set of roots up to date while edges
+/// are added to or removed from an undirected graph.
+///
+/// Every root keeps the distance and the parent in a shortest path tree of
+/// every vertex. Edges must be added and removed through this class, which
+/// changes the graph and repairs the trees of all roots in parallel:
+///
+///  * Adding an edge can only shorten distances. When it does, the change is
+///    propagated from the closer end with a BFS which stops at the vertex
+///    whose distance does not improve.
+///  * Removing an edge which is not in the tree of a root changes nothing for
+///    it. Otherwise, the vertex of the subtree below it look for another
+///    parent at the same distance, closest to the root first. Only the
+///    vertex left without one get new distances, computed with a Dijkstra
+///    pass seeded from their neighbours outside the subtree.
+///
+/// Each update reports how many vertex it touched, so the cost can be
+/// compared with a full BFS. Any other change to the graph requires a call to
+/// rebuild().
+///
+class DynamicDistances {
+public:
+    /// Work done by an update, added over all roots
+    struct tUpdate {
+        uint64_t touched;   ///< Vertex visited by the repair
+        uint64_t changed;   ///< Vertex whose distance changed
+        uint64_t scanned;   ///< Adjacency entries examined
+    };
+    
+    ///
+    /// \brief Creates the structure over a graph, with no roots
+    ///
+    /// \param g Graph to follow. Must outlive this object
+    /// \param numThreads Number of threads updating the roots. 0 uses all hardware threads
+    //
+    explicit DynamicDistances (UndirectedGraph& g, const unsigned& numThreads=0);
+    //#//////////////////////////////////////////////
+    // Roots
+    ///
+    /// \brief Registers a root, computing its distances with a full BFS
+    ///
+    /// \param vID Vertex ID of the root. Registering a root twice has no effect
+    /// \throw invalid_argument if the vertex is not in the graph
+    //
+    void addRoot (const uint64_t& vID);
+    ///Unregisters a root. Unknown IDs are ignored
+    void removeRoot (const uint64_t& vID);
+    ///Returns the IDs of the registered roots, in registration order
+    vector<uint64_t> getRoots () const;
+    ///Recomputes the distances of every root from scratch, after changes
+    ///made to the graph directly
+    void rebuild ();
+    //#//////////////////////////////////////////////
+    // Updates
+    ///
+    /// \brief Adds an edge to the graph and updates the distances
+    ///
+    /// \param from Vertex ID of one end. Added to the graph if needed
+    /// \param to Vertex ID of the other end. Added to the graph if needed
+    /// \return Work done. All zero if the edge already existed
+    //
+    tUpdate addEdge (const uint64_t& from, const uint64_t& to);
+    ///
+    /// \brief Removes an edge from the graph and updates the distances
+    ///
+    /// \param from Vertex ID of one end
+    /// \param to Vertex ID of the other end
+    /// \return Work done. All zero if the edge did not exist
+    //
+    tUpdate removeEdge (const uint64_t& from, const uint64_t& to);
+    //#//////////////////////////////////////////////
+    // Queries
+    ///
+    /// \brief Returns the distance from a root to a vertex
+    ///
+    /// \throw out_of_range if the root is not registered
+    /// \return Number of edges in the shortest path, kNoVertex if unreachable
+    //
+    uint64_t getDistance (const uint64_t& rootID, const uint64_t& vID) const;
+    ///Returns the vertex before vID in a shortest path from the root, or
+    ///kNoVertex for the root itself and for unreachable vertex. Throws
+    ///out_of_range if the root is not registered
+    uint64_t getParent (const uint64_t& rootID, const uint64_t& vID) const;
+    ///Returns the vertex IDs in a shortest path from the root to vID, both
+    ///included, or an empty path if unreachable. Throws out_of_range if the
+    ///root is not registered
+    vector<uint64_t> getPath (const uint64_t& rootID, const uint64_t& vID) const;
+    
+private:
+    /// Shortest path tree of a root. Indexed by vertex slot
+    struct tRoot {
+        uint64_t id;                ///Vertex ID of the root
+        vector<uint64_t> dist;      ///Distance from the root, kNoVertex if unreachable
+        vector<uint64_t> parent;    ///Parent slot in the tree, kNoVertex if none
+        vector<uint8_t> state;      ///Scratch state of the vertex during a removal
+    };
+    
+    UndirectedGraph& graph;                 ///Graph followed
+    unsigned numThreads;                    ///Threads updating the roots
+    unordered_map<uint64_t, uint64_t> slot; ///Dense slot of every vertex ID
+    vector<uint64_t> slotID;                ///Vertex ID of every slot
+    vector<tRoot> roots;                    ///Trees of the registered roots
+    
+    ///Returns the slot of a vertex, assigning one if it has none
+    uint64_t slotOf (const uint64_t& vID);
+    ///Returns the tree of a registered root. Throws out_of_range otherwise
+    const tRoot& getRoot (const uint64_t& rootID) const;
+    ///Grows the trees of all roots to the number of slots
+    void resizeRoots ();
+    ///Calls f(slot) for every neighbour of the vertex in the given slot
+    template <class TFunc>
+    void forEachAdj (const uint64_t& s, TFunc f) const;
+    ///Computes the tree of a root with a full BFS
+    void bfs (tRoot& r) const;
+    ///Repairs the tree of a root after adding the edge between 2 slots
+    void insertUpdate (tRoot& r, const uint64_t& a, const uint64_t& b, tUpdate& work) const;
+    ///Repairs the tree of a root after removing the edge between 2 slots
+    void removeUpdate (tRoot& r, const uint64_t& a, const uint64_t& b, tUpdate& work) const;
+    ///Applies an update to every root in parallel, adding up the work done
+    template <class TFunc>
+    tUpdate updateRoots (TFunc update);
+};
+
+#endif /* dasel_dynamic_distance_h */
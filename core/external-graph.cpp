@@ -0,0 +1,512 @@
+/**
+* external-graph.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <stdexcept>
+#include <sstream>
+#include <deque>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include "external-graph.hpp"
+
+//#/////////////////////////////////////////////////
+// File format helpers
+//
+namespace {
+    const char kMagic[8] = {'D', 'A', 'S', 'E', 'L', 'E', 'X', 'T'};
+    const uint64_t kVersion = 1;
+    
+    ///Fixed size header at the start of the file
+    struct tHeader {
+        char magic[8];
+        uint64_t version;
+        uint64_t directed;
+        uint64_t numVertex;
+        uint64_t numEdges;
+        uint64_t numBlocks;
+        uint64_t dataStart;     //File position of the first block
+        uint64_t indexStart;    //File position of the vertex IDs
+    };
+    
+    ///Appends v as a variable length integer (7 bits per byte, little endian)
+    void putVarint (vector<uint8_t>& buf, uint64_t v) {
+        while (v >= 0x80) {
+            buf.push_back(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        buf.push_back(static_cast<uint8_t>(v));
+    }
+    
+    ///Reads a variable length integer, advancing p
+    uint64_t getVarint (const uint8_t*& p) {
+        uint64_t v = 0;
+        uint8_t shift = 0;
+        while (*p & 0x80) {
+            v |= static_cast<uint64_t>(*p++ & 0x7F) << shift;
+            shift += 7;
+        }
+        v |= static_cast<uint64_t>(*p++) << shift;
+        return v;
+    }
+    
+    template <class T>
+    void writeVector (ofstream& out, const vector<T>& v) {
+        out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+    }
+    
+    template <class T>
+    void readVector (ifstream& in, vector<T>& v, const uint64_t& size) {
+        v.resize(size);
+        in.read(reinterpret_cast<char*>(v.data()), size * sizeof(T));
+    }
+    
+    //#/////////////////////////////////////////////////
+    /// Reads a list of blocks in a background thread, keeping up to
+    /// "readahead" blocks ready ahead of the consumer
+    //
+    class BlockPrefetcher {
+        ifstream& file;
+        const vector<uint64_t>& blocks;
+        const vector<uint64_t>& blockOffset;
+        uint64_t dataStart;
+        uint64_t readahead;
+        deque<pair<uint64_t, vector<uint8_t> > > ready;
+        uint64_t numRead;
+        bool stop;
+        mutex lock;
+        condition_variable changed;
+        thread worker;
+        
+        void run () {
+            for (auto b : blocks) {
+                vector<uint8_t> data(blockOffset[b + 1] - blockOffset[b]);
+                file.seekg(dataStart + blockOffset[b]);
+                file.read(reinterpret_cast<char*>(data.data()), data.size());
+                unique_lock<mutex> guard(lock);
+                changed.wait(guard, [this] { return stop || (ready.size() < readahead); });
+                if (stop) {
+                    return;
+                }
+                ready.push_back(make_pair(b, move(data)));
+                ++numRead;
+                changed.notify_all();
+            }
+        }
+        
+    public:
+        BlockPrefetcher (ifstream& f, const vector<uint64_t>& blockList, const vector<uint64_t>& offsets, const uint64_t& start, const uint64_t& ahead) :
+            file(f), blocks(blockList), blockOffset(offsets), dataStart(start), readahead(ahead), numRead(0), stop(false) {
+            worker = thread(&BlockPrefetcher::run, this);
+        }
+        ~BlockPrefetcher () {
+            {
+                lock_guard<mutex> guard(lock);
+                stop = true;
+            }
+            changed.notify_all();
+            worker.join();
+        }
+        ///Gets the next block in the list. Returns false when all were consumed
+        bool next (uint64_t& block, vector<uint8_t>& data) {
+            unique_lock<mutex> guard(lock);
+            changed.wait(guard, [this] { return !ready.empty() || (numRead == blocks.size()); });
+            if (ready.empty()) {
+                return false;
+            }
+            block = ready.front().first;
+            data.swap(ready.front().second);
+            ready.pop_front();
+            changed.notify_all();
+            return true;
+        }
+    };
+    
+    //#/////////////////////////////////////////////////
+    /// Sequential reader of a sorted run of edges, for the external merge
+    //
+    class RunReader {
+        ifstream in;
+        vector<pair<uint64_t, uint64_t> > buffer;
+        uint64_t pos;
+    public:
+        RunReader (const string& name) : in(name.c_str(), ios::binary), pos(0) { fill(); }
+        void fill () {
+            buffer.resize(1 << 16);
+            in.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(buffer[0]));
+            buffer.resize(in.gcount() / sizeof(buffer[0]));
+            pos = 0;
+        }
+        bool empty () const { return pos == buffer.size(); }
+        const pair<uint64_t, uint64_t>& front () const { return buffer[pos]; }
+        void pop () { if (++pos == buffer.size()) fill(); }
+    };
+    
+    //#/////////////////////////////////////////////////
+    /// K-way merge of sorted runs, dropping duplicates
+    //
+    class RunMerger {
+        typedef pair<pair<uint64_t, uint64_t>, uint64_t> tItem;   //Edge, run
+        vector<unique_ptr<RunReader> > runs;
+        priority_queue<tItem, vector<tItem>, greater<tItem> > heap;
+        bool hasLast;
+        pair<uint64_t, uint64_t> last;
+    public:
+        RunMerger (const vector<string>& names) : hasLast(false) {
+            for (auto& name : names) {
+                runs.push_back(unique_ptr<RunReader>(new RunReader(name)));
+                if (!runs.back()->empty()) {
+                    heap.push(make_pair(runs.back()->front(), runs.size() - 1));
+                }
+            }
+        }
+        ///Gets the next distinct edge. Returns false at the end
+        bool next (pair<uint64_t, uint64_t>& edge) {
+            while (!heap.empty()) {
+                tItem item = heap.top();
+                heap.pop();
+                RunReader& run = *runs[item.second];
+                run.pop();
+                if (!run.empty()) {
+                    heap.push(make_pair(run.front(), item.second));
+                }
+                if (!hasLast || (item.first != last)) {
+                    hasLast = true;
+                    last = item.first;
+                    edge = item.first;
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+    
+    ///Sorts a run and writes it to a new run file
+    void writeRun (vector<pair<uint64_t, uint64_t> >& run, const string& baseName, vector<string>& names) {
+        sort(run.begin(), run.end());
+        run.erase(unique(run.begin(), run.end()), run.end());
+        ostringstream name;
+        name << baseName << ".run" << names.size();
+        names.push_back(name.str());
+        ofstream out(names.back().c_str(), ios::binary);
+        if (!out) {
+            throw runtime_error("ExternalGraph: cannot write file " + names.back());
+        }
+        writeVector(out, run);
+        run.clear();
+    }
+}
+
+//#/////////////////////////////////////////////////
+// ExternalGraph
+//
+const uint64_t ExternalGraph::kDefaultBlockSize;
+
+ExternalGraph::ExternalGraph (const string& name) : fileName(name), file(name.c_str(), ios::binary),
+    readahead(8), bytesRead(0), blocksRead(0) {
+    tHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.magic, kMagic, sizeof(kMagic)) ||
+        (header.version != kVersion)) {
+        throw runtime_error("ExternalGraph: cannot read graph file " + name);
+    }
+    directed = header.directed;
+    numEdges = header.numEdges;
+    dataStart = header.dataStart;
+    file.seekg(header.indexStart);
+    readVector(file, vertexIDs, header.numVertex);
+    readVector(file, degree, header.numVertex);
+    readVector(file, blockFirst, header.numBlocks + 1);
+    readVector(file, blockOffset, header.numBlocks + 1);
+    if (!file) {
+        throw runtime_error("ExternalGraph: truncated graph file " + name);
+    }
+}
+
+void ExternalGraph::writeFile (const string& name, const vector<uint64_t>& ids, const vector<uint64_t>& degrees,
+                               const uint64_t& edges, const bool& isDirected, const uint64_t& blockSize, TListSource source) {
+    ofstream out(name.c_str(), ios::binary | ios::trunc);
+    if (!out) {
+        throw runtime_error("ExternalGraph: cannot write file " + name);
+    }
+    tHeader header;
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.directed = isDirected;
+    header.numVertex = ids.size();
+    header.numEdges = edges;
+    header.dataStart = sizeof(header);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    
+    vector<uint64_t> first(1, 0);
+    vector<uint64_t> offset(1, 0);
+    vector<uint8_t> block;
+    vector<uint64_t> list;
+    for (uint64_t v = 0; v < ids.size(); ++v) {
+        source(v, list);
+        uint64_t previous = 0;
+        for (uint64_t i = 0; i < list.size(); ++i) {
+            putVarint(block, list[i] - previous);
+            previous = list[i];
+        }
+        if ((block.size() >= blockSize) || (v + 1 == ids.size())) {
+            out.write(reinterpret_cast<const char*>(block.data()), block.size());
+            first.push_back(v + 1);
+            offset.push_back(offset.back() + block.size());
+            block.clear();
+        }
+    }
+    if (ids.empty()) {
+        first.push_back(0);
+        offset.push_back(0);
+    }
+    header.numBlocks = first.size() - 1;
+    header.indexStart = header.dataStart + offset.back();
+    writeVector(out, ids);
+    writeVector(out, degrees);
+    writeVector(out, first);
+    writeVector(out, offset);
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!out) {
+        throw runtime_error("ExternalGraph: error writing file " + name);
+    }
+}
+
+void ExternalGraph::write (const CompactGraph& g, const string& name, const uint64_t& blockSize) {
+    vector<uint64_t> degrees(g.getNumVertex());
+    for (uint64_t v = 0; v < g.getNumVertex(); ++v) {
+        degrees[v] = g.getDeg(v);
+    }
+    writeFile(name, g.getVertexIDs(), degrees, g.getNumEdges(), g.isDirected(), blockSize,
+              [&g](const uint64_t& v, vector<uint64_t>& list) { list.assign(g.adjBegin(v), g.adjEnd(v)); });
+}
+
+void ExternalGraph::build (const string& edgeListFile, const string& name, const bool& isDirected,
+                           const uint64_t& runEdges, const uint64_t& blockSize) {
+    ifstream in(edgeListFile.c_str());
+    if (!in) {
+        throw runtime_error("ExternalGraph: cannot read file " + edgeListFile);
+    }
+    //Split the input in sorted runs. Every edge is stored by both ends when
+    //undirected. A directed edge also stores (toID, kNoVertex), so that
+    //vertex with no out edges are listed too
+    vector<string> runNames;
+    vector<pair<uint64_t, uint64_t> > run;
+    run.reserve(2 * runEdges);
+    string line;
+    uint64_t fromID, toID;
+    while (getline(in, line)) {
+        if (line.empty() || (line[0] == '#')) {
+            continue;
+        }
+        istringstream iss(line);
+        if (!(iss >> fromID >> toID)) {
+            continue;
+        }
+        run.push_back(make_pair(fromID, toID));
+        run.push_back(isDirected ? make_pair(toID, kNoVertex) : make_pair(toID, fromID));
+        if (run.size() >= 2 * runEdges) {
+            writeRun(run, name, runNames);
+        }
+    }
+    if (!run.empty() || runNames.empty()) {
+        writeRun(run, name, runNames);
+    }
+    vector<pair<uint64_t, uint64_t> >().swap(run);
+    
+    //First merge: vertex IDs and degrees
+    vector<uint64_t> ids;
+    vector<uint64_t> degrees;
+    uint64_t entries = 0, loops = 0;
+    {
+        RunMerger merger(runNames);
+        pair<uint64_t, uint64_t> edge;
+        while (merger.next(edge)) {
+            if (ids.empty() || (ids.back() != edge.first)) {
+                ids.push_back(edge.first);
+                degrees.push_back(0);
+            }
+            if (edge.second != kNoVertex) {
+                ++degrees.back();
+                ++entries;
+                loops += (edge.first == edge.second);
+            }
+        }
+    }
+    //Second merge: adjacency lists, with IDs translated to vertex indexes
+    {
+        RunMerger merger(runNames);
+        pair<uint64_t, uint64_t> edge;
+        bool pending = merger.next(edge);
+        writeFile(name, ids, degrees, isDirected ? entries : (entries + loops) / 2, isDirected, blockSize,
+                  [&](const uint64_t& v, vector<uint64_t>& list) {
+                      list.clear();
+                      while (pending && (edge.first == ids[v])) {
+                          if (edge.second != kNoVertex) {
+                              list.push_back(lower_bound(ids.begin(), ids.end(), edge.second) - ids.begin());
+                          }
+                          pending = merger.next(edge);
+                      }
+                      sort(list.begin(), list.end());
+                  });
+    }
+    for (auto& runName : runNames) {
+        remove(runName.c_str());
+    }
+}
+
+uint64_t ExternalGraph::getIndex (const uint64_t& vID) const {
+    vector<uint64_t>::const_iterator it = lower_bound(vertexIDs.begin(), vertexIDs.end(), vID);
+    if ((it != vertexIDs.end()) && (*it == vID)) {
+        return it - vertexIDs.begin();
+    }
+    return kNoVertex;
+}
+
+void ExternalGraph::scanBlocks (const vector<uint64_t>& blocks, function<bool (const uint64_t&, const vector<uint64_t>&)> visit) {
+    file.clear();
+    BlockPrefetcher prefetcher(file, blocks, blockOffset, dataStart, readahead);
+    uint64_t b;
+    vector<uint8_t> data;
+    vector<uint64_t> list;
+    while (prefetcher.next(b, data)) {
+        bytesRead += data.size();
+        ++blocksRead;
+        const uint8_t* p = data.data();
+        for (uint64_t v = blockFirst[b]; v < blockFirst[b + 1]; ++v) {
+            list.resize(degree[v]);
+            uint64_t previous = 0;
+            for (uint64_t i = 0; i < list.size(); ++i) {
+                previous += getVarint(p);
+                list[i] = previous;
+            }
+            if (!visit(v, list)) {
+                break;
+            }
+        }
+    }
+}
+
+vector<uint64_t> ExternalGraph::getAdjacency (const uint64_t& idx) {
+    bytesRead = blocksRead = 0;
+    vector<uint64_t> result;
+    vector<uint64_t> blocks(1, blockOf(idx));
+    scanBlocks(blocks, [&](const uint64_t& v, const vector<uint64_t>& list) {
+        if (v == idx) {
+            result = list;
+            return false;
+        }
+        return true;
+    });
+    return result;
+}
+
+vector<uint32_t> ExternalGraph::bfs (const uint64_t& rootIdx, const uint64_t& stopIdx) {
+    bytesRead = blocksRead = 0;
+    vector<uint32_t> dist(getNumVertex(), kUnreached);
+    if (rootIdx >= getNumVertex()) {
+        return dist;
+    }
+    vector<uint64_t> frontier(1, rootIdx);
+    vector<uint64_t> next;
+    vector<uint64_t> blocks;
+    dist[rootIdx] = 0;
+    
+    bool stop = (stopIdx < getNumVertex());
+    for (uint32_t level = 0; !frontier.empty() && (!stop || (dist[stopIdx] == kUnreached)); ++level) {
+        //Frontier is sorted, so the blocks come out in file order
+        blocks.clear();
+        for (auto v : frontier) {
+            uint64_t b = blockOf(v);
+            if (blocks.empty() || (blocks.back() != b)) {
+                blocks.push_back(b);
+            }
+        }
+        uint64_t pos = 0;
+        next.clear();
+        scanBlocks(blocks, [&](const uint64_t& v, const vector<uint64_t>& list) {
+            if (v != frontier[pos]) {
+                return true;
+            }
+            for (auto adj : list) {
+                if (dist[adj] == kUnreached) {
+                    dist[adj] = level + 1;
+                    next.push_back(adj);
+                }
+            }
+            ++pos;
+            //Done with this block once past its last frontier vertex
+            return (pos < frontier.size()) && (frontier[pos] < blockFirst[blockOf(v) + 1]);
+        });
+        sort(next.begin(), next.end());
+        frontier.swap(next);
+    }
+    return dist;
+}
+
+int64_t ExternalGraph::distance (const uint64_t& fromIdx, const uint64_t& toIdx) {
+    if (toIdx >= getNumVertex()) {
+        return -1;
+    }
+    vector<uint32_t> dist = bfs(fromIdx, toIdx);
+    return (dist[toIdx] == kUnreached) ? -1 : static_cast<int64_t>(dist[toIdx]);
+}
+
+vector<uint64_t> ExternalGraph::components () {
+    bytesRead = blocksRead = 0;
+    vector<uint64_t> parent(getNumVertex());
+    for (uint64_t v = 0; v < parent.size(); ++v) {
+        parent[v] = v;
+    }
+    auto find = [&parent](uint64_t v) {
+        while (parent[v] != v) {
+            parent[v] = parent[parent[v]];     //Path halving
+            v = parent[v];
+        }
+        return v;
+    };
+    vector<uint64_t> blocks(getNumBlocks());
+    for (uint64_t b = 0; b < blocks.size(); ++b) {
+        blocks[b] = b;
+    }
+    scanBlocks(blocks, [&](const uint64_t& v, const vector<uint64_t>& list) {
+        for (auto adj : list) {
+            uint64_t rootV = find(v);
+            uint64_t rootAdj = find(adj);
+            //The smallest index is kept as root, so it labels the component
+            if (rootV < rootAdj) {
+                parent[rootAdj] = rootV;
+            }
+            else if (rootAdj < rootV) {
+                parent[rootV] = rootAdj;
+            }
+        }
+        return true;
+    });
+    for (uint64_t v = 0; v < parent.size(); ++v) {
+        parent[v] = find(v);
+    }
+    return parent;
+}
@@ -0,0 +1,173 @@
+/**
+ * external-graph.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_external_graph_h
+#define dasel_external_graph_h
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <functional>
+#include <stdint.h>
+#include "compact-graph.hpp"
+
+using namespace std;
+
+/// Distance returned by ExternalGraph::bfs() for vertex not reachable from the root
+const uint32_t kUnreached = UINT32_MAX;
+
+//#//////////////////////////////////////////////
+/// \brief Implements a semi-external graph: vertex data in memory, adjacency
+/// lists on disk.
+///
+/// Only the vertex IDs, the degrees and a small block index are kept in
+/// memory. Adjacency lists, with vertex indexes as in CompactGraph, are
+/// stored in a file sorted by vertex, split in blocks of roughly
+/// "blockSize" bytes. Within a block, every list is gap encoded with
+/// variable length integers. A list never spans 2 blocks.
+///
+/// Queries read whole blocks, in increasing file position, through a
+/// background thread which keeps up to getReadahead() blocks in flight.
+/// Each query records the bytes and blocks it read from disk.
+///
+/// The file uses the native byte order. Layout: fixed header, data blocks,
+/// then vertex IDs, degrees and the block index.
+///
+class ExternalGraph {
+public:
+    /// Default size of a data block, in bytes
+    static const uint64_t kDefaultBlockSize = 64 * 1024;
+    /// Callback used to write a graph: fills the sorted adjacency list (vertex
+    /// indexes) of the given vertex index. Called once per vertex, in order
+    typedef function<void (const uint64_t&, vector<uint64_t>&)> TListSource;
+
+    ///
+    /// \brief Opens a graph file for reading
+    ///
+    /// \param fileName File created by write() or build()
+    /// \throw runtime_error if the file cannot be read or has a wrong format
+    //
+    explicit ExternalGraph (const string& fileName);
+    ///
+    /// \brief Writes a graph held in memory to disk
+    ///
+    /// \param g Graph to write
+    /// \param fileName Output file
+    /// \param blockSize Target size of the data blocks, in bytes
+    //
+    static void write (const CompactGraph& g, const string& fileName, const uint64_t& blockSize=kDefaultBlockSize);
+    ///
+    /// \brief Builds a graph file from a text edge list too big to fit in memory
+    ///
+    /// The input holds one "fromID toID" pair per line. Lines starting with
+    /// '#' are ignored. Edges are sorted on disk: sorted runs of "runEdges"
+    /// edges are written next to the output file, merged, and removed. Only
+    /// the list of vertex IDs has to fit in memory.
+    ///
+    /// \param edgeListFile Text input file
+    /// \param fileName Output file
+    /// \param isDirected True to build a directed graph
+    /// \param runEdges Number of edges sorted in memory at a time
+    /// \param blockSize Target size of the data blocks, in bytes
+    /// \throw runtime_error if a file cannot be read or written
+    //
+    static void build (const string& edgeListFile, const string& fileName, const bool& isDirected,
+                       const uint64_t& runEdges=(1 << 24), const uint64_t& blockSize=kDefaultBlockSize);
+    //#//////////////////////////////////////////////
+    // Access
+    ///Returns true for a directed graph
+    bool isDirected () const { return directed; }
+    ///Returns the number of vertex in the graph
+    uint64_t getNumVertex () const { return vertexIDs.size(); }
+    ///Returns the number of edges in the graph
+    uint64_t getNumEdges () const { return numEdges; }
+    ///Returns the vertex ID for the given vertex index
+    uint64_t getId (const uint64_t& idx) const { return vertexIDs[idx]; }
+    ///Returns the vertex index for the given vertex ID, or kNoVertex if it is
+    ///not part of the graph
+    uint64_t getIndex (const uint64_t& vID) const;
+    ///Returns the (out) degree of the vertex
+    uint64_t getDeg (const uint64_t& idx) const { return degree[idx]; }
+    ///Returns the number of data blocks in the file
+    uint64_t getNumBlocks () const { return blockFirst.size() - 1; }
+    ///Returns the number of blocks read ahead of the one being processed
+    uint64_t getReadahead () const { return readahead; }
+    ///Sets the number of blocks read ahead of the one being processed
+    void setReadahead (const uint64_t& blocks) { readahead = (blocks == 0) ? 1 : blocks; }
+    ///Returns the bytes read from disk by the last query
+    uint64_t getBytesRead () const { return bytesRead; }
+    ///Returns the blocks read from disk by the last query
+    uint64_t getBlocksRead () const { return blocksRead; }
+    //#//////////////////////////////////////////////
+    // Queries
+    ///Returns the adjacency list (vertex indexes) of a vertex, reading its block
+    vector<uint64_t> getAdjacency (const uint64_t& idx);
+    ///
+    /// \brief Breadth-first search over (out) edges
+    ///
+    /// Each level reads only the blocks holding frontier vertex, in file order.
+    ///
+    /// \param rootIdx Vertex index to start from
+    /// \param stopIdx Stops after the level where this vertex is reached.
+    /// kNoVertex explores the whole reachable set
+    /// \return Distance from the root per vertex index, kUnreached if not reached
+    //
+    vector<uint32_t> bfs (const uint64_t& rootIdx, const uint64_t& stopIdx=kNoVertex);
+    ///Returns the distance between 2 vertex indexes, or -1 if not reachable
+    int64_t distance (const uint64_t& fromIdx, const uint64_t& toIdx);
+    ///
+    /// \brief Computes the (weakly) connected components with one sequential
+    /// scan of the file, using an in-memory union-find over vertex indexes
+    ///
+    /// \return Component per vertex index, labeled by its smallest vertex index
+    //
+    vector<uint64_t> components ();
+    
+private:
+    string fileName;                ///Graph file
+    ifstream file;                  ///Open graph file
+    bool directed;                  ///True for a directed graph
+    uint64_t numEdges;              ///Total number of edges in the graph
+    uint64_t dataStart;             ///File position of the first block
+    vector<uint64_t> vertexIDs;     ///Vertex ID for every vertex index, sorted
+    vector<uint64_t> degree;        ///Degree for every vertex index
+    vector<uint64_t> blockFirst;    ///First vertex index in each block, plus numVertex
+    vector<uint64_t> blockOffset;   ///Offset of each block from dataStart, plus the end of the data
+    uint64_t readahead;             ///Blocks read ahead
+    uint64_t bytesRead;             ///Bytes read by the last query
+    uint64_t blocksRead;            ///Blocks read by the last query
+    
+    ///Writes a graph file from a list source. Common part of write() and build()
+    static void writeFile (const string& fileName, const vector<uint64_t>& ids, const vector<uint64_t>& degrees,
+                           const uint64_t& numEdges, const bool& isDirected, const uint64_t& blockSize, TListSource source);
+    ///
+    /// Reads the given blocks, in order, with readahead, and calls
+    /// visit(vertexIdx, list) for the vertex of each block until visit
+    /// returns false, or the block ends. Updates the I/O statistics
+    //
+    void scanBlocks (const vector<uint64_t>& blocks, function<bool (const uint64_t&, const vector<uint64_t>&)> visit);
+    ///Returns the block holding the adjacency list of a vertex
+    uint64_t blockOf (const uint64_t& idx) const {
+        return upper_bound(blockFirst.begin(), blockFirst.end(), idx) - blockFirst.begin() - 1; }
+};
+
+#endif /* dasel_external_graph_h */
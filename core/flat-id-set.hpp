@@ -0,0 +1,153 @@
+/**
+ * flat-id-set.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_flat_id_set_h
+#define dasel_flat_id_set_h
+
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+#include "prefetch.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Hash set of 64 bit IDs with open addressing.
+///
+/// The IDs are kept in a flat power of 2 array, with linear probing and at
+/// most half of the slots used, so a set of n IDs takes 16 to 32 bytes per
+/// ID and no allocation per entry. The slot where an ID is probed first is
+/// known before touching the array, so prefetch() can start that miss while
+/// other work is done. Erasing shifts back the entries of the probe run, so
+/// there are no deleted markers.
+///
+/// UINT64_MAX marks empty slots, and cannot be stored.
+///
+class FlatIDSet {
+    enum : uint64_t { kEmpty = UINT64_MAX };    ///Free slot
+    vector<uint64_t> slots;     ///Power of 2 array of IDs
+    uint64_t mask;              ///slots.size() - 1
+    uint64_t numIDs;
+    
+    ///Returns the first slot probed for an ID
+    uint64_t home (const uint64_t& id) const { return (id * 0x9E3779B97F4A7C15ULL) >> 17 & mask; }
+    ///Rebuilds the array with the given number of slots
+    void rehash (const uint64_t& numSlots) {
+        vector<uint64_t> old(numSlots, kEmpty);
+        old.swap(slots);
+        mask = numSlots - 1;
+        for (auto id : old) {
+            if (id != kEmpty) {
+                uint64_t i = home(id);
+                while (slots[i] != kEmpty) {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = id;
+            }
+        }
+    }
+    
+public:
+    /// Creates an empty set
+    FlatIDSet () : slots(16, kEmpty), mask(15), numIDs(0) { }
+    ///Returns the number of IDs in the set
+    uint64_t size () const { return numIDs; }
+    ///Returns true if the set holds no ID
+    bool empty () const { return numIDs == 0; }
+    ///Returns 1 if the ID is in the set, 0 otherwise
+    uint64_t count (const uint64_t& id) const {
+        for (uint64_t i = home(id); slots[i] != kEmpty; i = (i + 1) & mask) {
+            if (slots[i] == id) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    ///
+    /// \brief Adds an ID to the set
+    ///
+    /// \return True if the ID was not in the set
+    /// \throw invalid_argument if the ID is UINT64_MAX
+    //
+    bool insert (const uint64_t& id) {
+        if (id == kEmpty) {
+            throw invalid_argument("FlatIDSet: ID out of range");
+        }
+        uint64_t i = home(id);
+        for (; slots[i] != kEmpty; i = (i + 1) & mask) {
+            if (slots[i] == id) {
+                return false;
+            }
+        }
+        slots[i] = id;
+        if (2 * ++numIDs > slots.size()) {
+            rehash(2 * slots.size());
+        }
+        return true;
+    }
+    ///Removes an ID from the set. Returns true if it was in the set
+    bool erase (const uint64_t& id) {
+        uint64_t i = home(id);
+        for (; slots[i] != id; i = (i + 1) & mask) {
+            if (slots[i] == kEmpty) {
+                return false;
+            }
+        }
+        //Move back every later entry of the run which may sit in the hole
+        for (uint64_t j = (i + 1) & mask; slots[j] != kEmpty; j = (j + 1) & mask) {
+            if (((j - home(slots[j])) & mask) >= ((j - i) & mask)) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i] = kEmpty;
+        --numIDs;
+        return true;
+    }
+    ///Removes all IDs, keeping the array
+    void clear () { slots.assign(slots.size(), kEmpty); numIDs = 0; }
+    ///Makes room for the given number of IDs without growing
+    void reserve (const uint64_t& n) {
+        uint64_t numSlots = slots.size();
+        while (numSlots < 2 * n) {
+            numSlots *= 2;
+        }
+        if (numSlots != slots.size()) {
+            rehash(numSlots);
+        }
+    }
+    ///Starts loading the slot where an ID is probed first
+    void prefetch (const uint64_t& id) const { prefetchRead(&slots[home(id)]); }
+    ///Returns the bytes used by the slot array
+    uint64_t getMemoryUsage () const { return slots.size() * sizeof(uint64_t); }
+    ///Calls f(id) for every ID in the set, in no particular order
+    template <class TFunction>
+    void forEach (TFunction f) const {
+        for (auto id : slots) {
+            if (id != kEmpty) {
+                f(id);
+            }
+        }
+    }
+};
+
+#endif /* dasel_flat_id_set_h */
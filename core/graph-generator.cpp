@@ -0,0 +1,188 @@
+/**
+* graph-generator.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <cmath>
+#include <algorithm>
+#include "graph-generator.hpp"
+#include "parallel.hpp"
+#include "rng.hpp"
+
+//#/////////////////////////////////////////////////
+// GraphGenerator
+//
+const uint64_t GraphGenerator::kMaxRejectDensity;
+
+GraphGenerator::TEdgeList GraphGenerator::rmat (const uint8_t& scale, const uint64_t& edgeFactor, const double& a, const double& b, const double& c) const {
+    TEdgeList edges(edgeFactor << scale);
+    double ab = a + b;
+    double abc = a + b + c;
+    
+    parallelFor(0, edges.size(), [&](uint64_t i) {
+        SplitMix64 rng(streamSeed(seed, i));
+        uint64_t from = 0, to = 0;
+        for (uint8_t level = 0; level < scale; ++level) {
+            double r = rng.nextDouble();
+            from <<= 1;
+            to <<= 1;
+            if (r >= abc) {
+                from |= 1;
+                to |= 1;
+            }
+            else if (r >= ab) {
+                from |= 1;
+            }
+            else if (r >= a) {
+                to |= 1;
+            }
+        }
+        edges[i] = make_pair(from, to);
+    }, 4096);
+    return edges;
+}
+
+GraphGenerator::TEdgeList GraphGenerator::gnp (const uint64_t& n, const double& p, const bool& directed) const {
+    const uint64_t kBlock = 1024;   //Source vertex per work item
+    uint64_t numBlocks = (n + kBlock - 1) / kBlock;
+    vector<TEdgeList> blocks(numBlocks);
+    if (p <= 0) {
+        return TEdgeList();
+    }
+    double logQ = log(1.0 - p);
+    
+    parallelFor(0, numBlocks, [&](uint64_t blk) {
+        uint64_t last = min(n, (blk + 1) * kBlock);
+        for (uint64_t from = blk * kBlock; from < last; ++from) {
+            SplitMix64 rng(streamSeed(seed, from));
+            uint64_t limit = directed ? n : from;
+            //Candidate targets are [0, limit), skipping "from" if directed
+            uint64_t candidate = 0;
+            while (true) {
+                if (p < 1.0) {
+                    double skip = floor(log(1.0 - rng.nextDouble()) / logQ);
+                    if (skip >= static_cast<double>(limit - candidate)) {
+                        break;
+                    }
+                    candidate += static_cast<uint64_t>(skip);
+                }
+                if (candidate >= limit) {
+                    break;
+                }
+                if (candidate != from) {
+                    blocks[blk].push_back(make_pair(from, candidate));
+                }
+                ++candidate;
+            }
+        }
+    }, 1);
+    TEdgeList edges;
+    for (auto& blk : blocks) {
+        edges.insert(edges.end(), blk.begin(), blk.end());
+        TEdgeList().swap(blk);
+    }
+    return edges;
+}
+
+GraphGenerator::TEdgeList GraphGenerator::gnm (const uint64_t& n, uint64_t m, const bool& directed) const {
+    uint64_t maxEdges = (n < 2) ? 0 : (directed ? n * (n - 1) : n * (n - 1) / 2);
+    m = min(m, maxEdges);
+    if (m <= maxEdges / kMaxRejectDensity) {
+        return sampleEdges(n, m, directed);
+    }
+    //Dense graph: selection sampling (Knuth's algorithm S) over all the
+    //possible edges in order, keeping each one with probability
+    //(edges still needed) / (edges still to visit)
+    SplitMix64 rng(streamSeed(seed, 0));
+    TEdgeList edges;
+    edges.reserve(m);
+    uint64_t left = maxEdges;
+    for (uint64_t from = 0; (from < n) && (edges.size() < m); ++from) {
+        for (uint64_t to = 0; to < (directed ? n : from); ++to) {
+            if (to != from) {
+                if (rng.nextBelow(left--) < m - edges.size()) {
+                    edges.push_back(make_pair(from, to));
+                }
+            }
+        }
+    }
+    return edges;
+}
+
+GraphGenerator::TEdgeList GraphGenerator::sampleEdges (const uint64_t& n, const uint64_t& m, const bool& directed) const {
+    //Candidates are kept with the order in which they were drawn, so that
+    //keeping the first m distinct ones is a uniform choice
+    typedef pair<pair<uint64_t, uint64_t>, uint64_t> TCandidate;
+    vector<TCandidate> found;
+    uint64_t drawn = 0;
+    for (uint64_t round = 0; found.size() < m; ++round) {
+        uint64_t need = m - found.size();
+        need += need / 8 + 16;
+        uint64_t first = found.size();
+        uint64_t roundSeed = streamSeed(seed, round);
+        found.resize(first + need);
+        parallelFor(0, need, [&](uint64_t i) {
+            SplitMix64 rng(streamSeed(roundSeed, i));
+            uint64_t from, to;
+            do {
+                from = rng.nextBelow(n);
+                to = rng.nextBelow(n);
+            } while (from == to);
+            if (!directed && (from < to)) {
+                swap(from, to);
+            }
+            found[first + i] = make_pair(make_pair(from, to), drawn + i);
+        }, 4096);
+        drawn += need;
+        //Drop duplicates keeping the earliest draw
+        sort(found.begin(), found.end());
+        found.erase(unique(found.begin(), found.end(), [](const TCandidate& x, const TCandidate& y) { return x.first == y.first; }), found.end());
+    }
+    if (found.size() > m) {
+        sort(found.begin(), found.end(), [](const TCandidate& x, const TCandidate& y) { return x.second < y.second; });
+        found.resize(m);
+        sort(found.begin(), found.end());
+    }
+    TEdgeList edges(found.size());
+    for (uint64_t i = 0; i < found.size(); ++i) {
+        edges[i] = found[i].first;
+    }
+    return edges;
+}
+
+GraphGenerator::TEdgeList GraphGenerator::barabasiAlbert (const uint64_t& n, const uint64_t& d) const {
+    //Edge i owns the edge ends 2i (its source, vertex i/d) and 2i+1 (its
+    //target). The target copies a random earlier end, in [0, 2i]
+    TEdgeList edges(n * d);
+    parallelFor(0, edges.size(), [&](uint64_t i) {
+        uint64_t edge = i;
+        uint64_t end;
+        while (true) {
+            SplitMix64 rng(streamSeed(seed, edge));
+            end = rng.nextBelow(2 * edge + 1);
+            if (!(end & 1)) {
+                break;
+            }
+            edge = end / 2;     //Copy the target of an earlier edge
+        }
+        edges[i] = make_pair(i / d, (end / 2) / d);
+    }, 4096);
+    return edges;
+}
@@ -0,0 +1,113 @@
+/**
+ * graph-generator.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_graph_generator_h
+#define dasel_graph_generator_h
+
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Generates synthetic graphs for benchmarking and stress tests.
+///
+/// Every generator returns an edge list with vertex IDs in [0, n), ready to
+/// be loaded with CompactGraph::fromEdges() or the addEdges() bulk methods of
+/// the graph classes. Edges are generated in parallel, and each edge (or
+/// source vertex) draws from its own random stream, so the output depends
+/// only on the seed and the parameters, not on the number of threads.
+///
+class GraphGenerator {
+    uint64_t seed;  ///Seed for all random streams
+    /// Inverse of the density from which gnm() stops drawing edges at random
+    static const uint64_t kMaxRejectDensity = 32;
+    
+public:
+    ///List of edges, as pairs of <fromID, toID>
+    typedef vector<pair<uint64_t, uint64_t> > TEdgeList;
+    
+    ///Creates a generator with the given seed
+    GraphGenerator (const uint64_t& rngSeed=0) : seed(rngSeed) { }
+    ///Changes the seed used by all following graphs
+    void setSeed (const uint64_t& rngSeed) { seed = rngSeed; }
+    ///
+    /// \brief Generates an R-MAT (recursive matrix / Kronecker) graph
+    ///
+    /// Each edge picks one quadrant of the adjacency matrix per level, with
+    /// probabilities a, b, c and 1-a-b-c. The defaults are the Graph500 ones.
+    /// The result may contain duplicated edges and self loops.
+    ///
+    /// \param scale The graph has 2^scale vertex
+    /// \param edgeFactor The graph has edgeFactor * 2^scale edges
+    //
+    TEdgeList rmat (const uint8_t& scale, const uint64_t& edgeFactor, const double& a=0.57, const double& b=0.19, const double& c=0.19) const;
+    ///
+    /// \brief Generates an Erdos-Renyi G(n, p) graph, each possible edge
+    /// being present with probability p. No self loops.
+    ///
+    /// Uses geometric skipping, so the cost is linear in the number of
+    /// generated edges instead of n^2.
+    ///
+    /// \param n Number of vertex
+    /// \param p Edge probability
+    /// \param directed If false, only edges with fromID > toID are generated
+    //
+    TEdgeList gnp (const uint64_t& n, const double& p, const bool& directed=false) const;
+    ///
+    /// \brief Generates an Erdos-Renyi G(n, m) graph: m distinct edges chosen
+    /// uniformly. No self loops.
+    ///
+    /// Sparse graphs draw edges at random and redraw the repeated ones. When
+    /// m is more than 1/kMaxRejectDensity of the possible edges, where
+    /// repeats would dominate, every possible edge is visited once and kept
+    /// with the right probability instead (selection sampling), so the cost
+    /// stays within kMaxRejectDensity times the output size.
+    ///
+    /// \param n Number of vertex
+    /// \param m Number of edges. Capped to the number of possible edges
+    /// \param directed If false, only edges with fromID > toID are generated
+    //
+    TEdgeList gnm (const uint64_t& n, uint64_t m, const bool& directed=false) const;
+    ///
+    /// \brief Generates a Barabasi-Albert preferential attachment graph
+    ///
+    /// Vertex i brings d edges, each one attached to an earlier edge end
+    /// chosen uniformly, which is choosing a vertex with probability
+    /// proportional to its degree. The end is found by following the random
+    /// choices of earlier edges, which are recomputed from their own random
+    /// streams, so all edges are generated independently and in parallel
+    /// (Sanders and Schulz). The result may contain duplicated edges and self
+    /// loops.
+    ///
+    /// \param n Number of vertex
+    /// \param d Edges added with every vertex
+    //
+    TEdgeList barabasiAlbert (const uint64_t& n, const uint64_t& d) const;
+    
+private:
+    ///Draws m distinct edges uniformly, by rejection of the repeated ones.
+    ///Fast while few draws repeat. The result is sorted
+    TEdgeList sampleEdges (const uint64_t& n, const uint64_t& m, const bool& directed) const;
+};
+
+#endif /* dasel_graph_generator_h */
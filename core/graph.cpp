@@ -21,62 +21,791 @@
 */
 
 #include <queue>
+#include <numeric>
 #include "iostream"
 #include "graph.hpp"
+#include "compact-graph.hpp"
+#include "parallel.hpp"
+#include "prefetch.hpp"
+#include "flat-id-set.hpp"
 
+//#/////////////////////////////////////////////////
+// Adjacency list helpers
+//
+namespace {
+    ///
+    ///Returns the entry in position "pos" of the list, skipping tombstones.
+    ///"cursor" packs a position (high 32 bits) and the list index of its
+    ///entry (low 32 bits), found by an earlier call. The scan starts there
+    ///when it is not past "pos", so increasing positions cost constant time
+    ///each. A cursor is always consistent as a whole, so concurrent readers
+    ///can share it. Any change to the list that may add tombstones resets it
+    //
+    uint64_t liveAdjID (const vector<uint64_t>& adjList, const uint64_t& numTombstones, atomic<uint64_t>& cursor, const uint64_t& pos) {
+        if (!numTombstones) {
+            return adjList[pos];
+        }
+        uint64_t hint = cursor.load(memory_order_relaxed);
+        uint64_t count = hint >> 32;
+        uint64_t i = hint & UINT32_MAX;
+        if (count > pos) {
+            count = 0;
+            i = 0;
+        }
+        for (; i < adjList.size(); ++i) {
+            if (!isTombstone(adjList[i])) {
+                if (count == pos) {
+                    if ((pos <= UINT32_MAX) && (i <= UINT32_MAX)) {
+                        cursor.store((pos << 32) | i, memory_order_relaxed);
+                    }
+                    return adjList[i];
+                }
+                ++count;
+            }
+        }
+        return adjList[pos];    //Out of range, same behaviour as vector::operator[]
+    }
+
+    ///Inserts vID keeping the list sorted. Revives a tombstone for vID if
+    ///there is one. Returns the number of tombstones revived
+    uint64_t insertAdj (vector<uint64_t>& adjList, uint64_t& numTombstones, atomic<uint64_t>& cursor, const uint64_t& vID) {
+        cursor.store(0, memory_order_relaxed);
+        vector<uint64_t>::iterator it = adjLowerBound(adjList.begin(), adjList.end(), vID);
+        if ((it != adjList.end()) && ((*it & ~kTombstone) == vID)) {
+            if (isTombstone(*it)) {
+                *it = vID;
+                --numTombstones;
+                return 1;
+            }
+        }
+        else {
+            adjList.insert(it, vID);
+        }
+        return 0;
+    }
+
+    ///Erases vID from the list, live or tombstone. Returns the number of
+    ///tombstones dropped
+    uint64_t eraseAdj (vector<uint64_t>& adjList, uint64_t& numTombstones, atomic<uint64_t>& cursor, const uint64_t& vID) {
+        cursor.store(0, memory_order_relaxed);
+        vector<uint64_t>::iterator it = adjLowerBound(adjList.begin(), adjList.end(), vID);
+        if ((it != adjList.end()) && ((*it & ~kTombstone) == vID)) {
+            uint64_t dropped = isTombstone(*it);
+            numTombstones -= dropped;
+            adjList.erase(it);
+            return dropped;
+        }
+        return 0;
+    }
+
+    ///Marks vID as a tombstone. Returns true if it was present and not a tombstone
+    bool markAdj (vector<uint64_t>& adjList, uint64_t& numTombstones, atomic<uint64_t>& cursor, const uint64_t& vID) {
+        cursor.store(0, memory_order_relaxed);
+        vector<uint64_t>::iterator it = adjLowerBound(adjList.begin(), adjList.end(), vID);
+        if ((it != adjList.end()) && (*it == vID)) {
+            *it |= kTombstone;
+            ++numTombstones;
+            return true;
+        }
+        return false;
+    }
+
+    ///Drops all tombstones from the list
+    void compactAdj (vector<uint64_t>& adjList, uint64_t& numTombstones) {
+        if (numTombstones) {
+            adjList.erase(remove_if(adjList.begin(), adjList.end(), isTombstone), adjList.end());
+            numTombstones = 0;
+        }
+    }
+
+    ///
+    ///Merges the entries appended to the list since position "sortedEnd"
+    ///into the sorted part, dropping duplicates. The list must have no
+    ///tombstones. Returns the number of entries actually added
+    //
+    uint64_t mergeAppended (vector<uint64_t>& adjList, const uint64_t& sortedEnd) {
+        vector<uint64_t>::iterator middle = adjList.begin() + sortedEnd;
+        sort(middle, adjList.end());
+        //Entries appended past the end of the list need no merge
+        if ((middle != adjList.begin()) && (middle != adjList.end()) && (*(middle - 1) > *middle)) {
+            inplace_merge(adjList.begin(), middle, adjList.end());
+        }
+        adjList.erase(unique(adjList.begin(), adjList.end()), adjList.end());
+        return adjList.size() - sortedEnd;
+    }
+
+    ///
+    ///Merges the sorted, distinct IDs in [first, last) into the sorted list,
+    ///skipping those already in it, with a single backward pass and no
+    ///temporary buffer. The list must have no tombstones. Returns the
+    ///number of entries added
+    //
+    template <class TIter, class TGetID>
+    uint64_t mergeSorted (vector<uint64_t>& adjList, TIter first, TIter last, TGetID getID) {
+        //Count the IDs not in the list yet, to know where the merge ends
+        uint64_t oldSize = adjList.size();
+        uint64_t numNew = 0;
+        for (TIter it = first; it != last; ++it) {
+            numNew += !binary_search(adjList.begin(), adjList.begin() + oldSize, getID(*it));
+        }
+        if (numNew == 0) {
+            return 0;
+        }
+        adjList.resize(oldSize + numNew);
+        uint64_t out = adjList.size();
+        uint64_t in = oldSize;
+        TIter it = last;
+        while (numNew) {
+            uint64_t id = getID(*(it - 1));
+            if ((in > 0) && (adjList[in - 1] >= id)) {
+                if (adjList[in - 1] == id) {
+                    --it;   //Already in the list
+                }
+                adjList[--out] = adjList[--in];
+            }
+            else {
+                adjList[--out] = id;
+                --it;
+                --numNew;
+            }
+        }
+        return adjList.size() - oldSize;
+    }
+    
+    ///
+    ///Sorts pairs by first, then second, and drops duplicates. Large inputs
+    ///of 32 bit IDs are packed in single 64 bit keys, and sorted with a
+    ///least significant digit radix sort over 11 bit digits, small enough
+    ///for the counters to stay in cache. Digits above the highest key, or
+    ///shared by all the keys, are skipped: IDs below 2^22 take 4 passes at
+    ///most
+    //
+    void sortPairs (vector<pair<uint64_t, uint64_t> >& pairs) {
+        const uint64_t kMinRadix = 1 << 12;     //Smaller inputs use std::sort
+        const uint8_t kDigitBits = 11;
+        const uint8_t kDigits = (64 + kDigitBits - 1) / kDigitBits;
+        const uint64_t kDigitMask = (1 << kDigitBits) - 1;
+        uint64_t bits = 0;
+        for (auto& p : pairs) {
+            bits |= p.first | p.second;
+        }
+        if ((pairs.size() < kMinRadix) || (bits >> 32)) {
+            sort(pairs.begin(), pairs.end());
+        }
+        else {
+            vector<uint64_t> keys(pairs.size());
+            vector<uint64_t> buffer(pairs.size());
+            //One sweep counts every digit
+            vector<uint64_t> count(kDigits << kDigitBits);
+            for (uint64_t i = 0; i < pairs.size(); ++i) {
+                keys[i] = pairs[i].first << 32 | pairs[i].second;
+                for (uint8_t d = 0; d < kDigits; ++d) {
+                    ++count[(d << kDigitBits) + (keys[i] >> (d * kDigitBits) & kDigitMask)];
+                }
+            }
+            for (uint8_t d = 0; d < kDigits; ++d) {
+                uint64_t shift = d * kDigitBits;
+                uint64_t* digitCount = &count[d << kDigitBits];
+                if (digitCount[keys[0] >> shift & kDigitMask] == keys.size()) {
+                    continue;
+                }
+                uint64_t sum = 0;
+                for (uint64_t c = 0; c <= kDigitMask; ++c) {
+                    uint64_t n = digitCount[c];
+                    digitCount[c] = sum;
+                    sum += n;
+                }
+                for (auto key : keys) {
+                    buffer[digitCount[key >> shift & kDigitMask]++] = key;
+                }
+                keys.swap(buffer);
+            }
+            for (uint64_t i = 0; i < pairs.size(); ++i) {
+                pairs[i] = make_pair(keys[i] >> 32, keys[i] & UINT32_MAX);
+            }
+        }
+        pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+    }
+
+    ///Compacts the vertex listed in "dirty" that still exist in the graph,
+    ///using one parallel sweep
+    template <class TVertex>
+    void compactVertices (unordered_map<uint64_t, TVertex>& vertexList, vector<uint64_t>& dirty) {
+        sort(dirty.begin(), dirty.end());
+        dirty.erase(unique(dirty.begin(), dirty.end()), dirty.end());
+        vector<TVertex*> affected;
+        affected.reserve(dirty.size());
+        for (auto vID : dirty) {
+            typename unordered_map<uint64_t, TVertex>::iterator it = vertexList.find(vID);
+            if ((it != vertexList.end()) && it->second.hasTombstones()) {
+                affected.push_back(&it->second);
+            }
+        }
+        parallelFor(0, affected.size(), [&affected](uint64_t i) { affected[i]->compact(); }, 64);
+        dirty.clear();
+    }
+}
 
 //#/////////////////////////////////////////////////
-// UndirectedGraph::Vertex
+// Edge index helpers
+//
+namespace {
+    ///Pairs handled together by batchedIsEdge()
+    const uint64_t kEdgeBatchGroup = 16;
+    
+    ///
+    /// Checks a batch of edges in groups. The source vertex of a group are
+    /// located first, prefetching the hub set slot of the target ID, or the
+    /// first probe of the binary search over the adjacency list. The binary
+    /// searches then advance together, one step per list in turn, each step
+    /// prefetching the next probe of its list, so the misses of the whole
+    /// group overlap all along the search paths. "adjList(v)" returns the
+    /// list of a vertex
+    //
+    template <class TVertex, class TList>
+    vector<uint8_t> batchedIsEdge (const unordered_map<uint64_t, TVertex>& vertexList, const HubEdgeIndex& index,
+                                   const vector<pair<uint64_t, uint64_t> >& pairs, TList adjList) {
+        vector<uint8_t> result(pairs.size(), 0);
+        const FlatIDSet* hub[kEdgeBatchGroup];
+        const uint64_t* first[kEdgeBatchGroup];     //Lower bound search range of each list
+        const uint64_t* last[kEdgeBatchGroup];
+        uint64_t len[kEdgeBatchGroup];
+        for (uint64_t base = 0; base < pairs.size(); base += kEdgeBatchGroup) {
+            uint64_t count = min(kEdgeBatchGroup, pairs.size() - base);
+            bool searching = false;
+            for (uint64_t i = 0; i < count; ++i) {
+                typename unordered_map<uint64_t, TVertex>::const_iterator it = vertexList.find(pairs[base + i].first);
+                hub[i] = (it != vertexList.end()) ? index.find(pairs[base + i].first) : nullptr;
+                first[i] = last[i] = nullptr;
+                len[i] = 0;
+                if (hub[i] != nullptr) {
+                    hub[i]->prefetch(pairs[base + i].second);
+                }
+                else if (it != vertexList.end()) {
+                    const vector<uint64_t>& adj = adjList(it->second);
+                    first[i] = adj.data();
+                    last[i] = adj.data() + adj.size();
+                    len[i] = adj.size();
+                    if (len[i] != 0) {
+                        prefetchRead(first[i] + len[i] / 2);
+                        searching = true;
+                    }
+                }
+            }
+            //Same steps as adjLowerBound()
+            while (searching) {
+                searching = false;
+                for (uint64_t i = 0; i < count; ++i) {
+                    if (len[i] != 0) {
+                        uint64_t half = len[i] >> 1;
+                        if ((first[i][half] & ~kTombstone) < pairs[base + i].second) {
+                            first[i] += half + 1;
+                            len[i] -= half + 1;
+                        }
+                        else {
+                            len[i] = half;
+                        }
+                        if (len[i] != 0) {
+                            prefetchRead(first[i] + len[i] / 2);
+                            searching = true;
+                        }
+                    }
+                }
+            }
+            for (uint64_t i = 0; i < count; ++i) {
+                uint64_t toID = pairs[base + i].second;
+                result[base + i] = (hub[i] != nullptr) ? (hub[i]->count(toID) != 0) :
+                                   ((first[i] != last[i]) && (*first[i] == toID));
+            }
+        }
+        return result;
+    }
+    
+    ///Builds, in parallel, the index sets of the given vertex which reached
+    ///the degree threshold and are not hubs yet. The sets of existing hubs
+    ///are left to the caller, which only adds the new entries. "degree(v)"
+    ///returns the degree to compare, "walkAdj(v, f)" calls f on every
+    ///adjacent ID
+    template <class TVertex, class TDeg, class TWalk>
+    void indexNewHubs (const vector<const TVertex*>& vertices, HubEdgeIndex& index, TDeg degree, TWalk walkAdj) {
+        if (!index.isEnabled()) {
+            return;
+        }
+        vector<pair<const TVertex*, FlatIDSet*> > hubs;
+        for (auto v : vertices) {
+            if (!index.isHub(v->getId()) && (degree(*v) >= index.getMinDegree())) {
+                hubs.push_back(make_pair(v, &index.makeHub(v->getId())));
+            }
+        }
+        parallelFor(0, hubs.size(), [&](uint64_t i) {
+            FlatIDSet& adj = *hubs[i].second;
+            adj.reserve(degree(*hubs[i].first));
+            walkAdj(*hubs[i].first, [&adj](const uint64_t& adjID) { adj.insert(adjID); });
+        }, 1);
+    }
+}
+
+//#/////////////////////////////////////////////////
+// Subgraph extraction helpers
 //
-void UndirectedGraph::Vertex::addAdjacent (const uint64_t& vID) {
-    if (!isAdjacent(vID)){
-        adjList.push_back(vID);
-        sort(adjList.begin(), adjList.end());
+namespace {
+    ///Walks the adjacency list of an undirected graph vertex
+    struct UndirectedAdj {
+        template <class TFunc>
+        void operator() (const UndirectedGraph::Vertex& v, TFunc f) const { v.forEachAdj(f); }
+    };
+    ///Walks the out adjacency list of a directed graph vertex
+    struct OutAdj {
+        template <class TFunc>
+        void operator() (const DirectedGraph::Vertex& v, TFunc f) const { v.forEachOutAdj(f); }
+    };
+
+    ///Returns the sorted IDs of all vertex in the list
+    template <class TVertex>
+    vector<uint64_t> sortedIDs (const unordered_map<uint64_t, TVertex>& vertexList) {
+        vector<uint64_t> ids;
+        ids.reserve(vertexList.size());
+        for (auto& m : vertexList) {
+            ids.push_back(m.first);
+        }
+        sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    ///Returns the sorted IDs in "ids" which are part of the graph
+    template <class TVertex>
+    vector<uint64_t> existingIDs (const unordered_map<uint64_t, TVertex>& vertexList, const vector<uint64_t>& ids) {
+        vector<uint64_t> result;
+        result.reserve(ids.size());
+        for (auto vID : ids) {
+            if (vertexList.count(vID)) {
+                result.push_back(vID);
+            }
+        }
+        sort(result.begin(), result.end());
+        result.erase(unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    ///
+    /// Builds the CSR representation of the subgraph induced by "ids".
+    /// Every adjacency list is joined with the sorted ID list (both are
+    /// sorted, so the search window only moves forward), first to count the
+    /// edges of each vertex, then to fill them in. Vertex are processed in
+    /// parallel.
+    //
+    template <class TVertex, class TAdj>
+    CompactGraph buildInduced (const unordered_map<uint64_t, TVertex>& vertexList, vector<uint64_t>&& ids, TAdj walkAdj, const bool& directed,
+                               const unsigned& numThreads=0) {
+        uint64_t n = ids.size();
+        vector<const TVertex*> vertexPtr(n);
+        vector<uint64_t> offsets(n + 1, 0);
+        const uint64_t* idsBegin = ids.data();
+        const uint64_t* idsEnd = idsBegin + n;
+        
+        parallelFor(0, n, [&](uint64_t i) {
+            vertexPtr[i] = &vertexList.find(ids[i])->second;
+            const uint64_t* lo = idsBegin;
+            uint64_t count = 0;
+            walkAdj(*vertexPtr[i], [&](const uint64_t& adjID) {
+                lo = lower_bound(lo, idsEnd, adjID);
+                if ((lo != idsEnd) && (*lo == adjID)) {
+                    ++count;
+                }
+            });
+            offsets[i + 1] = count;
+        }, 1024, numThreads);
+        partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        vector<uint64_t> adjacency(offsets[n]);
+        parallelFor(0, n, [&](uint64_t i) {
+            const uint64_t* lo = idsBegin;
+            uint64_t pos = offsets[i];
+            walkAdj(*vertexPtr[i], [&](const uint64_t& adjID) {
+                lo = lower_bound(lo, idsEnd, adjID);
+                if ((lo != idsEnd) && (*lo == adjID)) {
+                    adjacency[pos++] = lo - idsBegin;
+                }
+            });
+        }, 1024, numThreads);
+        return CompactGraph(move(ids), move(offsets), move(adjacency), directed);
+    }
+
+    ///
+    /// Returns the sorted IDs of the vertex up to k hops away from the seeds.
+    /// Each level is expanded in parallel into per-thread buffers, which are
+    /// then sorted and merged into the set of vertex found so far.
+    //
+    template <class TVertex, class TAdj>
+    vector<uint64_t> kHopVertices (const unordered_map<uint64_t, TVertex>& vertexList, const vector<uint64_t>& seeds,
+                                   const uint8_t& k, const uint64_t& maxVertices, TAdj walkAdj, unsigned numThreads) {
+        vector<uint64_t> frontier = existingIDs(vertexList, seeds);
+        if (frontier.size() > maxVertices) {
+            frontier.resize(maxVertices);
+        }
+        vector<uint64_t> selected(frontier);
+        if (numThreads == 0) {
+            numThreads = getNumThreads();
+        }
+        vector<vector<uint64_t> > found(numThreads);
+        
+        for (uint8_t level = 0; (level < k) && !frontier.empty() && (selected.size() < maxVertices); ++level) {
+            parallelForThread(0, frontier.size(), [&](unsigned tID, uint64_t i) {
+                typename unordered_map<uint64_t, TVertex>::const_iterator it = vertexList.find(frontier[i]);
+                if (it != vertexList.end()) {
+                    walkAdj(it->second, [&](const uint64_t& adjID) {
+                        if (!binary_search(selected.begin(), selected.end(), adjID)) {
+                            found[tID].push_back(adjID);
+                        }
+                    });
+                }
+            }, 64, numThreads);
+            frontier.clear();
+            for (auto& f : found) {
+                frontier.insert(frontier.end(), f.begin(), f.end());
+                f.clear();
+            }
+            sort(frontier.begin(), frontier.end());
+            frontier.erase(unique(frontier.begin(), frontier.end()), frontier.end());
+            if (selected.size() + frontier.size() > maxVertices) {
+                frontier.resize(maxVertices - selected.size());
+            }
+            uint64_t middle = selected.size();
+            selected.insert(selected.end(), frontier.begin(), frontier.end());
+            inplace_merge(selected.begin(), selected.begin() + middle, selected.end());
+        }
+        return selected;
     }
 }
 
-void UndirectedGraph::Vertex::removeAdjacent(const uint64_t& vID) {
-    vector<uint64_t>::iterator it=find(adjList.begin(),adjList.end(),vID);
-    if (it!=adjList.end()){
-        adjList.erase(it);
+//#/////////////////////////////////////////////////
+// Traversal helpers
+//
+namespace {
+    ///
+    /// Level synchronous BFS distance which expands the frontier in groups.
+    /// The vertex of a whole group are looked up first and their adjacency
+    /// blocks prefetched, so those misses overlap, before any list is walked.
+    /// The visited set is a FlatIDSet, so the slot of each neighbour is
+    /// prefetched a few entries ahead of its probe.
+    /// "adjList(v)" returns the list of a vertex. Tombstones are skipped
+    //
+    template <class TVertex, class TList>
+    int16_t groupedDistance (const unordered_map<uint64_t, TVertex>& vertexList, const uint64_t& from, const uint64_t& to,
+                             uint64_t groupSize, TList adjList) {
+        const uint64_t kAhead = 8;      //Neighbours between a prefetch and its probe
+        if (!vertexList.count(from)) {
+            return -1;
+        }
+        if (from == to) {
+            return 0;
+        }
+        if (groupSize == 0) {
+            groupSize = 1;
+        }
+        FlatIDSet visited;
+        visited.insert(from);
+        vector<uint64_t> frontier(1, from);
+        vector<uint64_t> next;
+        vector<const vector<uint64_t>*> lists(groupSize);
+        for (int16_t d = 1; !frontier.empty(); ++d) {
+            for (uint64_t base = 0; base < frontier.size(); base += groupSize) {
+                uint64_t count = min(groupSize, frontier.size() - base);
+                //std::unordered_map offers no way to prefetch a bucket, but
+                //the finds are independent, so their misses can overlap
+                for (uint64_t i = 0; i < count; ++i) {
+                    typename unordered_map<uint64_t, TVertex>::const_iterator it = vertexList.find(frontier[base + i]);
+                    lists[i] = &adjList(it->second);
+                    if (!lists[i]->empty()) {
+                        prefetchRead(lists[i]->data());
+                    }
+                }
+                for (uint64_t i = 0; i < count; ++i) {
+                    const vector<uint64_t>& list = *lists[i];
+                    for (uint64_t j = 0; j < min(kAhead, list.size()); ++j) {
+                        visited.prefetch(list[j] & ~kTombstone);
+                    }
+                    for (uint64_t j = 0; j < list.size(); ++j) {
+                        if (j + kAhead < list.size()) {
+                            visited.prefetch(list[j + kAhead] & ~kTombstone);
+                        }
+                        uint64_t adjID = list[j];
+                        if (!isTombstone(adjID) && visited.insert(adjID)) {
+                            if (adjID == to) {
+                                return d;
+                            }
+                            next.push_back(adjID);
+                        }
+                    }
+                }
+            }
+            frontier.swap(next);
+            next.clear();
+        }
+        return -1;
     }
 }
 
+
+//#/////////////////////////////////////////////////
+// UndirectedGraph::Vertex
+//
+uint64_t UndirectedGraph::Vertex::getAdjID (const uint64_t& pos) const {
+    return liveAdjID(adjList, numTombstones, cursor, pos);
+}
+
+uint64_t UndirectedGraph::Vertex::addAdjacent (const uint64_t& vID) {
+    return insertAdj(adjList, numTombstones, cursor, vID);
+}
+
+uint64_t UndirectedGraph::Vertex::removeAdjacent(const uint64_t& vID) {
+    return eraseAdj(adjList, numTombstones, cursor, vID);
+}
+
+bool UndirectedGraph::Vertex::markRemoved (const uint64_t& vID) {
+    return markAdj(adjList, numTombstones, cursor, vID);
+}
+
+void UndirectedGraph::Vertex::compact () {
+    compactAdj(adjList, numTombstones);
+}
+
 //#/////////////////////////////////////////////////
 // UndirectedGraph
 //
-bool UndirectedGraph::isEdge(const uint64_t& fromID, const uint64_t& toID){
-    if (!(isVertex(fromID) && isVertex(toID))){
+bool UndirectedGraph::isEdge(const uint64_t& fromID, const uint64_t& toID) const {
+    const Vertex* fV = findVertex(fromID);
+    if (fV == nullptr) {
         return false;
     }
-    return vertexList[fromID].isAdjacent(toID);
+    const FlatIDSet* hub = edgeIndex.find(fromID);
+    return (hub != nullptr) ? (hub->count(toID) != 0) : fV->isAdjacent(toID);
+}
+
+vector<uint8_t> UndirectedGraph::areEdges(const vector<pair<uint64_t, uint64_t> >& pairs) const {
+    return batchedIsEdge(vertexList, edgeIndex, pairs, [](const Vertex& v) -> const vector<uint64_t>& { return v.adjList; });
+}
+
+void UndirectedGraph::enableEdgeIndex(const uint64_t& minDegree) {
+    edgeIndex.reset(minDegree);
+    vector<const Vertex*> vertices;
+    vertices.reserve(vertexList.size());
+    for (auto& m : vertexList) {
+        vertices.push_back(&m.second);
+    }
+    indexNewHubs(vertices, edgeIndex, [](const Vertex& v) { return v.getDeg(); }, UndirectedAdj());
+}
+
+void UndirectedGraph::indexAdj(const Vertex& v, const uint64_t& adjID) {
+    if (!edgeIndex.isEnabled()) {
+        return;
+    }
+    if (edgeIndex.isHub(v.id)) {
+        edgeIndex.insert(v.id, adjID);
+    }
+    else if (v.getDeg() >= edgeIndex.getMinDegree()) {
+        FlatIDSet& adj = edgeIndex.makeHub(v.id);
+        v.forEachAdj([&adj](const uint64_t& id) { adj.insert(id); });
+    }
+}
+
+vector<uint64_t> UndirectedGraph::getVertexIDs() const {
+    return sortedIDs(vertexList);
 }
 
 UndirectedGraph::Vertex& UndirectedGraph::addVertex(const uint64_t& vID) {
     
-    if (!vertexList.count(vID)){
-        Vertex newVertex(vID);
-        vertexList.insert(pair<uint64_t, Vertex>(vID, newVertex));
+    unordered_map<uint64_t, Vertex>::iterator it = vertexList.find(vID);
+    if (it == vertexList.end()){
+        it = vertexList.insert(pair<uint64_t, Vertex>(vID, Vertex(vID))).first;
         if (vID > maxID) {
             maxID = vID;
         }
     }
-    return vertexList[vID];
+    return it->second;
 }
 
 void UndirectedGraph::removeVertex(const uint64_t& vID) {
     unordered_map<uint64_t, Vertex>::iterator it = vertexList.find(vID);
     if (it != vertexList.end()) {
+        edgeIndex.eraseHub(vID);
         //Remove in-edges to the vertex
         for (auto i : it->second.adjList){
+            if (isTombstone(i)) {
+                continue;
+            }
             if (i!=vID){
                 Vertex& adj = getVertex(i);
-                adj.removeAdjacent(vID);
+                numTombstones -= adj.removeAdjacent(vID);
+                edgeIndex.erase(i, vID);
+            }
+            --numEdges;
+        }
+        numTombstones -= it->second.numTombstones;
+        vertexList.erase(it);
+    }
+}
+
+void UndirectedGraph::removeVertices(const vector<uint64_t>& ids, const bool& deferCompaction) {
+    for (auto vID : ids) {
+        unordered_map<uint64_t, Vertex>::iterator it = vertexList.find(vID);
+        if (it == vertexList.end()) {
+            continue;
+        }
+        edgeIndex.eraseHub(vID);
+        for (auto i : it->second.adjList) {
+            if (isTombstone(i)) {
+                continue;
+            }
+            if (i != vID) {
+                unordered_map<uint64_t, Vertex>::iterator adjIt = vertexList.find(i);
+                if ((adjIt != vertexList.end()) && adjIt->second.markRemoved(vID)) {
+                    setDirty(adjIt->second);
+                }
+                edgeIndex.erase(i, vID);
             }
             --numEdges;
         }
+        numTombstones -= it->second.numTombstones;
         vertexList.erase(it);
     }
+    if (!deferCompaction) {
+        compact();
+    }
+}
+
+void UndirectedGraph::removeEdges(const vector<pair<uint64_t, uint64_t> >& edges, const bool& deferCompaction,
+                                  vector<uint64_t>* isolated) {
+    //As in addEdges(), sorted entries visit every touched list once
+    vector<pair<uint64_t, uint64_t> > entries;
+    entries.reserve(2 * edges.size());
+    for (auto& e : edges) {
+        entries.push_back(e);
+        if (e.first != e.second) {
+            entries.push_back(make_pair(e.second, e.first));
+        }
+    }
+    sortPairs(entries);
+    vector<Vertex*> lists;
+    vector<uint64_t> first;
+    for (uint64_t i = 0; i < entries.size(); ++i) {
+        if ((i == 0) || (entries[i].first != entries[i - 1].first)) {
+            unordered_map<uint64_t, Vertex>::iterator it = vertexList.find(entries[i].first);
+            if (it != vertexList.end()) {
+                lists.push_back(&it->second);
+                first.push_back(i);
+            }
+        }
+    }
+    first.push_back(entries.size());
+    uint64_t removedEntries = 0;
+    uint64_t removedLoops = 0;
+    for (uint64_t i = 0; i < lists.size(); ++i) {
+        //Lists are random in memory: fetch the vertex, then its list, ahead
+        if (i + 16 < lists.size()) {
+            prefetchRead(lists[i + 16]);
+        }
+        if ((i + 8 < lists.size()) && !lists[i + 8]->adjList.empty()) {
+            prefetchRead(lists[i + 8]->adjList.data());
+        }
+        Vertex& v = *lists[i];
+        for (uint64_t pos = first[i]; (pos < entries.size()) && (entries[pos].first == v.id); ++pos) {
+            if (v.markRemoved(entries[pos].second)) {
+                setDirty(v);
+                edgeIndex.erase(v.id, entries[pos].second);
+                if (entries[pos].second == v.id) {
+                    ++removedLoops;
+                }
+                else {
+                    ++removedEntries;
+                }
+            }
+        }
+        if ((isolated != nullptr) && (v.getDeg() == 0)) {
+            isolated->push_back(v.id);
+        }
+    }
+    //Every edge was removed from the lists of both ends, self loops only once
+    numEdges -= removedEntries / 2 + removedLoops;
+    if (!deferCompaction) {
+        compact();
+    }
+}
+
+void UndirectedGraph::addEdges(const vector<pair<uint64_t, uint64_t> >& edges) {
+    //Every edge gives an entry for the list of each end, self loops only one.
+    //Sorted, the entries of each list are together and in order
+    vector<pair<uint64_t, uint64_t> > entries;
+    entries.reserve(2 * edges.size());
+    for (auto& e : edges) {
+        entries.push_back(e);
+        if (e.first != e.second) {
+            entries.push_back(make_pair(e.second, e.first));
+        }
+    }
+    sortPairs(entries);
+    //Locate every touched list once: the vertex, and where its entries start
+    vector<Vertex*> lists;
+    vector<uint64_t> first;
+    for (uint64_t i = 0; i < entries.size(); ++i) {
+        if ((i == 0) || (entries[i].first != entries[i - 1].first)) {
+            Vertex& v = addVertex(entries[i].first);
+            if (v.hasTombstones()) {
+                numTombstones -= v.numTombstones;
+                v.compact();
+            }
+            lists.push_back(&v);
+            first.push_back(i);
+        }
+    }
+    first.push_back(entries.size());
+    //Existing hubs only take the new entries
+    vector<FlatIDSet*> hubs(edgeIndex.getNumHubs() ? lists.size() : 0);
+    for (uint64_t i = 0; i < hubs.size(); ++i) {
+        hubs[i] = edgeIndex.find(lists[i]->id);
+    }
+    vector<uint64_t> added(lists.size());
+    vector<uint8_t> addedLoop(lists.size());
+    parallelFor(0, lists.size(), [&](uint64_t i) {
+        //Lists are random in memory: fetch the vertex, then its list, ahead
+        if (i + 16 < lists.size()) {
+            prefetchRead(lists[i + 16]);
+        }
+        if ((i + 8 < lists.size()) && !lists[i + 8]->adjList.empty()) {
+            prefetchRead(lists[i + 8]->adjList.data());
+        }
+        Vertex& v = *lists[i];
+        bool hadLoop = binary_search(v.adjList.begin(), v.adjList.end(), v.id);
+        added[i] = mergeSorted(v.adjList, entries.begin() + first[i], entries.begin() + first[i + 1],
+                               [](const pair<uint64_t, uint64_t>& e) { return e.second; });
+        addedLoop[i] = !hadLoop && v.isAdjacent(v.id);
+        if (!hubs.empty() && (hubs[i] != nullptr)) {
+            for (uint64_t pos = first[i]; pos < first[i + 1]; ++pos) {
+                hubs[i]->insert(entries[pos].second);
+            }
+        }
+    }, 64);
+    //Every new edge was added to the lists of both ends, self loops only once
+    uint64_t newEntries = 0;
+    for (uint64_t i = 0; i < lists.size(); ++i) {
+        newEntries += added[i] + addedLoop[i];
+    }
+    numEdges += newEntries / 2;
+    if (edgeIndex.isEnabled()) {
+        vector<const Vertex*> vertices(lists.begin(), lists.end());
+        indexNewHubs(vertices, edgeIndex, [](const Vertex& v) { return v.getDeg(); }, UndirectedAdj());
+    }
+}
+
+void UndirectedGraph::compact() {
+    compactVertices(vertexList, dirtyVertex);
+    numTombstones = 0;
+}
+
+void UndirectedGraph::setDirty(Vertex& v) {
+    ++numTombstones;
+    if (v.numTombstones == 1) {
+        dirtyVertex.push_back(v.id);
+    }
 }
 
 void UndirectedGraph::addEdge (const uint64_t& from, const uint64_t& to) {
@@ -84,8 +813,10 @@ void UndirectedGraph::addEdge (const uint64_t& from, const uint64_t& to) {
         Vertex& fV = vertexList[from];
         Vertex& tV = vertexList[to];
         if (!(fV.isAdjacent(to) && tV.isAdjacent(from))) {
-            fV.addAdjacent(to);
-            tV.addAdjacent(from);
+            numTombstones -= fV.addAdjacent(to);
+            numTombstones -= tV.addAdjacent(from);
+            indexAdj(fV, to);
+            indexAdj(tV, from);
             ++numEdges;
         }
     }
@@ -95,8 +826,10 @@ void UndirectedGraph::removeEdge (const uint64_t& from, const uint64_t& to) {
     if (isVertex(from) && isVertex(to)){
         Vertex& fV = vertexList[from];
         Vertex& tV = vertexList[to];
-        fV.removeAdjacent(to);
-        tV.removeAdjacent(from);
+        numTombstones -= fV.removeAdjacent(to);
+        numTombstones -= tV.removeAdjacent(from);
+        edgeIndex.erase(from, to);
+        edgeIndex.erase(to, from);
         --numEdges;
     }
 }
@@ -107,11 +840,12 @@ void UndirectedGraph::clearVisited() {
     }
 }
 
-void UndirectedGraph::printGraph(const uint64_t& root, const uint8_t& depth) {
-    Vertex& rootVertex = getVertex(root);
-    
-    clearVisited();
-    printDFS (rootVertex, depth, 0);
+void UndirectedGraph::printGraph(const uint64_t& root, const uint8_t& depth) const {
+    const Vertex* rootVertex = findVertex(root);
+    if (rootVertex != nullptr) {
+        unordered_set<uint64_t> visited;
+        printDFS (*rootVertex, depth, 0, visited);
+    }
 }
 
 void UndirectedGraph::printDFS (UndirectedGraph::Vertex& v, const uint8_t& depth, const uint8_t& level) {
@@ -124,8 +858,11 @@ void UndirectedGraph::printDFS (UndirectedGraph::Vertex& v, const uint8_t& depth
         }
         indent += "|- ";
         cout << indent << v.getId() << "\n";
-        for (uint64_t i = 0; i < v.getDeg(); ++i){
-            UndirectedGraph::Vertex& adj = getVertex(v.getAdjID(i));
+        for (auto adjID : v.adjList){
+            if (isTombstone(adjID)) {
+                continue;
+            }
+            UndirectedGraph::Vertex& adj = getVertex(adjID);
             if (!adj.isVisited()) {
                 printDFS (adj, depth, level+1);
             }
@@ -133,30 +870,60 @@ void UndirectedGraph::printDFS (UndirectedGraph::Vertex& v, const uint8_t& depth
     }
 }
 
-int16_t UndirectedGraph::distance(const uint64_t& from, const uint64_t& to){
+void UndirectedGraph::printDFS (const Vertex& v, const uint8_t& depth, const uint8_t& level, unordered_set<uint64_t>& visited) const {
+    
+    visited.insert(v.getId());
+    if (level<=depth){
+        string indent;
+        for (int i=0; i<level; ++i){
+            indent += "|  ";
+        }
+        indent += "|- ";
+        cout << indent << v.getId() << "\n";
+        for (auto adjID : v.adjList){
+            if (!isTombstone(adjID) && !visited.count(adjID)) {
+                printDFS (*findVertex(adjID), depth, level+1, visited);
+            }
+        }
+    }
+}
+
+CompactGraph UndirectedGraph::inducedSubgraph(const vector<uint64_t>& ids) const {
+    return buildInduced(vertexList, existingIDs(vertexList, ids), UndirectedAdj(), false);
+}
+
+CompactGraph UndirectedGraph::kHopSubgraph(const vector<uint64_t>& seeds, const uint8_t& k, const uint64_t& maxVertices,
+                                   const unsigned& numThreads) const {
+    return buildInduced(vertexList, kHopVertices(vertexList, seeds, k, maxVertices, UndirectedAdj(), numThreads), UndirectedAdj(), false, numThreads);
+}
+
+int16_t UndirectedGraph::distance(const uint64_t& from, const uint64_t& to, const uint64_t& groupSize) const {
+    return groupedDistance(vertexList, from, to, groupSize, [](const Vertex& v) -> const vector<uint64_t>& { return v.adjList; });
+}
+
+int16_t UndirectedGraph::distance(const uint64_t& from, const uint64_t& to) const {
     typedef struct {
         uint64_t    vID;   //Vertex ID
         int16_t     d;     //distance to "from"
     }tNodeInfo;
     queue<tNodeInfo> q;
-    UndirectedGraph::Vertex& v = getVertex(from);
+    unordered_set<uint64_t> visited;
     
-    clearVisited();
+    if (!isVertex(from)) {
+        return -1;
+    }
     q.push({from, 0});
-    v.setVisited(true);
+    visited.insert(from);
     while(!q.empty()) {
         tNodeInfo nodeInfo = q.front();
         q.pop();
         if (nodeInfo.vID == to){
             return nodeInfo.d;
         }
-        v = getVertex(nodeInfo.vID);
-        for (uint64_t i = 0; i < v.getDeg(); ++i){
-            tNodeInfo child = {v.getAdjID(i), static_cast<int16_t>(nodeInfo.d + 1)};
-            UndirectedGraph::Vertex& adj = getVertex(child.vID);
-            if (!adj.isVisited()) {
-                adj.setVisited(true);
-                q.push(child);
+        const Vertex* v = findVertex(nodeInfo.vID);
+        for (auto adjID : v->adjList){
+            if (!isTombstone(adjID) && visited.insert(adjID).second) {
+                q.push({adjID, static_cast<int16_t>(nodeInfo.d + 1)});
             }
         }
     }
@@ -166,85 +933,277 @@ int16_t UndirectedGraph::distance(const uint64_t& from, const uint64_t& to){
 //#/////////////////////////////////////////////////
 // DirectedGraph::Vertex
 //
-void DirectedGraph::Vertex::addOutEdge (const uint64_t& vID) {
-    if (!isOutEdge(vID)){
-        adjList.push_back(vID);
-        sort(adjList.begin(), adjList.end());
-    }
+uint64_t DirectedGraph::Vertex::getOutAdjID (const uint64_t& pos) const {
+    return liveAdjID(adjList, numOutTombstones, outCursor, pos);
 }
 
-void DirectedGraph::Vertex::removeOutEdge(const uint64_t& vID) {
-    vector<uint64_t>::iterator it=find(adjList.begin(),adjList.end(),vID);
-    if (it!=adjList.end()){
-        adjList.erase(it);
-    }
+uint64_t DirectedGraph::Vertex::getInAdjID (const uint64_t& pos) const {
+    checkInList();
+    return liveAdjID(inAdjList, numInTombstones, inCursor, pos);
 }
 
-void DirectedGraph::Vertex::addInEdge (const uint64_t& vID) {
-    if (!isInEdge(vID)){
-        inAdjList.push_back(vID);
-        sort(inAdjList.begin(), inAdjList.end());
-    }
+uint64_t DirectedGraph::Vertex::addOutEdge (const uint64_t& vID) {
+    return insertAdj(adjList, numOutTombstones, outCursor, vID);
 }
 
-void DirectedGraph::Vertex::removeInEdge (const uint64_t& vID) {
-    vector<uint64_t>::iterator it=find(inAdjList.begin(), inAdjList.end(), vID);
-    if (it!=inAdjList.end()){
-        inAdjList.erase(it);
-    }
+uint64_t DirectedGraph::Vertex::removeOutEdge(const uint64_t& vID) {
+    return eraseAdj(adjList, numOutTombstones, outCursor, vID);
+}
+
+uint64_t DirectedGraph::Vertex::addInEdge (const uint64_t& vID) {
+    return insertAdj(inAdjList, numInTombstones, inCursor, vID);
+}
+
+uint64_t DirectedGraph::Vertex::removeInEdge (const uint64_t& vID) {
+    return eraseAdj(inAdjList, numInTombstones, inCursor, vID);
+}
+
+bool DirectedGraph::Vertex::markOutRemoved (const uint64_t& vID) {
+    return markAdj(adjList, numOutTombstones, outCursor, vID);
+}
+
+bool DirectedGraph::Vertex::markInRemoved (const uint64_t& vID) {
+    return markAdj(inAdjList, numInTombstones, inCursor, vID);
+}
+
+void DirectedGraph::Vertex::compact () {
+    compactAdj(adjList, numOutTombstones);
+    compactAdj(inAdjList, numInTombstones);
 }
 
 //#/////////////////////////////////////////////////
 // DirectedGraph
 //
-bool DirectedGraph::isEdge(const uint64_t& fromID, const uint64_t& toID){
-    if (!(isVertex(fromID) && isVertex(toID))){
+bool DirectedGraph::isEdge(const uint64_t& fromID, const uint64_t& toID) const {
+    const Vertex* fV = findVertex(fromID);
+    if (fV == nullptr) {
         return false;
     }
-    return vertexList[fromID].isOutEdge(toID);
+    const FlatIDSet* hub = edgeIndex.find(fromID);
+    return (hub != nullptr) ? (hub->count(toID) != 0) : fV->isOutEdge(toID);
+}
+
+vector<uint8_t> DirectedGraph::areEdges(const vector<pair<uint64_t, uint64_t> >& pairs) const {
+    return batchedIsEdge(vertexList, edgeIndex, pairs, [](const Vertex& v) -> const vector<uint64_t>& { return v.adjList; });
+}
+
+void DirectedGraph::enableEdgeIndex(const uint64_t& minDegree) {
+    edgeIndex.reset(minDegree);
+    vector<const Vertex*> vertices;
+    vertices.reserve(vertexList.size());
+    for (auto& m : vertexList) {
+        vertices.push_back(&m.second);
+    }
+    indexNewHubs(vertices, edgeIndex, [](const Vertex& v) { return v.getOutDeg(); }, OutAdj());
 }
+
+void DirectedGraph::indexAdj(const Vertex& v, const uint64_t& adjID) {
+    if (!edgeIndex.isEnabled()) {
+        return;
+    }
+    if (edgeIndex.isHub(v.id)) {
+        edgeIndex.insert(v.id, adjID);
+    }
+    else if (v.getOutDeg() >= edgeIndex.getMinDegree()) {
+        FlatIDSet& adj = edgeIndex.makeHub(v.id);
+        v.forEachOutAdj([&adj](const uint64_t& id) { adj.insert(id); });
+    }
+}
+vector<uint64_t> DirectedGraph::getVertexIDs() const {
+    return sortedIDs(vertexList);
+}
+
 DirectedGraph::Vertex& DirectedGraph::addVertex(const uint64_t& vID) {
     
     if (!vertexList.count(vID)){
         DirectedGraph::Vertex newVertex(vID);
+        newVertex.hasInList = (storage == kOutAndIn);
         vertexList.insert(pair<uint64_t, DirectedGraph::Vertex>(vID, newVertex));
         if (vID > maxID) {
             maxID = vID;
         }
+        invalidateTranspose();
     }
     return vertexList[vID];
 }
 
 void DirectedGraph::removeVertex(const uint64_t& vID) {
     unordered_map<uint64_t, Vertex>::iterator it = vertexList.find(vID);
-    if (it != vertexList.end()) {
+    if ((it != vertexList.end()) && (storage == kOutOnly)) {
+        removeVertexSet(unordered_set<uint64_t>({vID}), false);
+    }
+    else if (it != vertexList.end()) {
+        invalidateTranspose();
+        edgeIndex.eraseHub(vID);
         //Remove all in-edges to the vertex
         for (auto i : it->second.inAdjList){
-            if (i!=vID){
+            if (!isTombstone(i) && (i!=vID)){
                 DirectedGraph::Vertex& adj = getVertex(i);
-                adj.removeOutEdge(vID);
+                numTombstones -= adj.removeOutEdge(vID);
+                edgeIndex.erase(i, vID);
                 --numEdges;     //For self only decremented once for out
             }
         }
         //Remove all out-edges to the vertex
         for (auto i : it->second.adjList){
+            if (isTombstone(i)) {
+                continue;
+            }
             if (i!=vID){
                 DirectedGraph::Vertex& adj = getVertex(i);
-                adj.removeInEdge(vID);
+                numTombstones -= adj.removeInEdge(vID);
             }
             --numEdges;     //For self only decremented once for out
         }
+        numTombstones -= it->second.numOutTombstones + it->second.numInTombstones;
         vertexList.erase(it);
     }
 }
 
+void DirectedGraph::removeVertices(const vector<uint64_t>& ids, const bool& deferCompaction) {
+    if (storage == kOutOnly) {
+        unordered_set<uint64_t> existing;
+        for (auto vID : ids) {
+            if (vertexList.count(vID)) {
+                existing.insert(vID);
+            }
+        }
+        removeVertexSet(existing, deferCompaction);
+        return;
+    }
+    invalidateTranspose();
+    for (auto vID : ids) {
+        unordered_map<uint64_t, Vertex>::iterator it = vertexList.find(vID);
+        if (it == vertexList.end()) {
+            continue;
+        }
+        edgeIndex.eraseHub(vID);
+        //Mark all in-edges to the vertex
+        for (auto i : it->second.inAdjList) {
+            if (!isTombstone(i) && (i != vID)) {
+                unordered_map<uint64_t, Vertex>::iterator adjIt = vertexList.find(i);
+                if ((adjIt != vertexList.end()) && adjIt->second.markOutRemoved(vID)) {
+                    setDirty(adjIt->second);
+                }
+                edgeIndex.erase(i, vID);
+                --numEdges;     //For self only decremented once for out
+            }
+        }
+        //Mark all out-edges from the vertex
+        for (auto i : it->second.adjList) {
+            if (isTombstone(i)) {
+                continue;
+            }
+            if (i != vID) {
+                unordered_map<uint64_t, Vertex>::iterator adjIt = vertexList.find(i);
+                if ((adjIt != vertexList.end()) && adjIt->second.markInRemoved(vID)) {
+                    setDirty(adjIt->second);
+                }
+            }
+            --numEdges;
+        }
+        numTombstones -= it->second.numOutTombstones + it->second.numInTombstones;
+        vertexList.erase(it);
+    }
+    if (!deferCompaction) {
+        compact();
+    }
+}
+
+void DirectedGraph::removeEdges(const vector<pair<uint64_t, uint64_t> >& edges, const bool& deferCompaction) {
+    invalidateTranspose();
+    for (auto& e : edges) {
+        unordered_map<uint64_t, Vertex>::iterator fIt = vertexList.find(e.first);
+        unordered_map<uint64_t, Vertex>::iterator tIt = vertexList.find(e.second);
+        if ((fIt == vertexList.end()) || (tIt == vertexList.end())) {
+            continue;
+        }
+        if (fIt->second.markOutRemoved(e.second)) {
+            setDirty(fIt->second);
+            if (tIt->second.markInRemoved(e.first)) {
+                setDirty(tIt->second);
+            }
+            edgeIndex.erase(e.first, e.second);
+            --numEdges;
+        }
+    }
+    if (!deferCompaction) {
+        compact();
+    }
+}
+
+void DirectedGraph::addEdges(const vector<pair<uint64_t, uint64_t> >& edges) {
+    //Append the new entries, remembering where the sorted part of each touched list ends
+    unordered_map<Vertex*, pair<uint64_t, uint64_t> > touched;
+    for (auto& e : edges) {
+        Vertex* ends[2] = {&addVertex(e.first), &addVertex(e.second)};
+        for (uint8_t i = 0; i < 2; ++i) {
+            if (!touched.count(ends[i])) {
+                if (ends[i]->hasTombstones()) {
+                    numTombstones -= ends[i]->numOutTombstones + ends[i]->numInTombstones;
+                    ends[i]->compact();
+                }
+                touched[ends[i]] = make_pair(ends[i]->adjList.size(), ends[i]->inAdjList.size());
+            }
+        }
+        ends[0]->adjList.push_back(e.second);
+        if (storage == kOutAndIn) {
+            ends[1]->inAdjList.push_back(e.first);
+        }
+    }
+    vector<pair<Vertex*, pair<uint64_t, uint64_t> > > lists(touched.begin(), touched.end());
+    //Existing hubs only take the appended entries
+    vector<FlatIDSet*> hubs(edgeIndex.getNumHubs() ? lists.size() : 0);
+    for (uint64_t i = 0; i < hubs.size(); ++i) {
+        hubs[i] = edgeIndex.find(lists[i].first->id);
+    }
+    vector<uint64_t> added(lists.size());
+    parallelFor(0, lists.size(), [&](uint64_t i) {
+        Vertex& v = *lists[i].first;
+        if (!hubs.empty() && (hubs[i] != nullptr)) {
+            for (uint64_t pos = lists[i].second.first; pos < v.adjList.size(); ++pos) {
+                hubs[i]->insert(v.adjList[pos]);
+            }
+        }
+        added[i] = mergeAppended(v.adjList, lists[i].second.first);
+        mergeAppended(v.inAdjList, lists[i].second.second);
+    }, 64);
+    for (auto a : added) {
+        numEdges += a;
+    }
+    if (edgeIndex.isEnabled()) {
+        vector<const Vertex*> vertices;
+        for (auto& l : lists) {
+            vertices.push_back(l.first);
+        }
+        indexNewHubs(vertices, edgeIndex, [](const Vertex& v) { return v.getOutDeg(); }, OutAdj());
+    }
+    invalidateTranspose();
+}
+
+void DirectedGraph::compact() {
+    compactVertices(vertexList, dirtyVertex);
+    numTombstones = 0;
+}
+
+void DirectedGraph::setDirty(Vertex& v) {
+    ++numTombstones;
+    if ((v.numOutTombstones + v.numInTombstones) == 1) {
+        dirtyVertex.push_back(v.id);
+    }
+}
+
 void DirectedGraph::addEdge (const uint64_t& from, const uint64_t& to) {
     if (isVertex(from) && isVertex(to)){
         Vertex& fV = vertexList[from];
         Vertex& tV = vertexList[to];
         if (!fV.isOutEdge(to)) {
-            fV.addOutEdge(to);
-            tV.addInEdge(from);
+            numTombstones -= fV.addOutEdge(to);
+            if (storage == kOutAndIn) {
+                numTombstones -= tV.addInEdge(from);
+            }
+            indexAdj(fV, to);
+            invalidateTranspose();
             ++numEdges;
         }
     }
@@ -254,20 +1213,115 @@ void DirectedGraph::removeEdge (const uint64_t& from, const uint64_t& to) {
     if (isVertex(from) && isVertex(to)){
         Vertex& fV = vertexList[from];
         Vertex& tV = vertexList[to];
-        fV.removeOutEdge(to);
-        tV.removeInEdge(from);
+        numTombstones -= fV.removeOutEdge(to);
+        if (storage == kOutAndIn) {
+            numTombstones -= tV.removeInEdge(from);
+        }
+        edgeIndex.erase(from, to);
+        invalidateTranspose();
         --numEdges;
     }
 }
 
+void DirectedGraph::removeVertexSet(const unordered_set<uint64_t>& ids, const bool& deferCompaction) {
+    invalidateTranspose();
+    vector<Vertex*> vertices;
+    vertices.reserve(vertexList.size());
+    for (auto& m : vertexList) {
+        if (!ids.count(m.first)) {
+            vertices.push_back(&m.second);
+        }
+    }
+    //Find the edges pointing to the removed vertex. Lists longer than the
+    //removed set are binary searched, shorter ones walked
+    vector<vector<pair<Vertex*, uint64_t> > > found(getNumThreads());
+    parallelForThread(0, vertices.size(), [&](unsigned tID, uint64_t i) {
+        Vertex* v = vertices[i];
+        if (ids.size() < v->adjList.size()) {
+            for (auto vID : ids) {
+                if (v->isOutEdge(vID)) {
+                    found[tID].push_back(make_pair(v, vID));
+                }
+            }
+        }
+        else {
+            v->forEachOutAdj([&](const uint64_t& adjID) {
+                if (ids.count(adjID)) {
+                    found[tID].push_back(make_pair(v, adjID));
+                }
+            });
+        }
+    }, 256);
+    for (auto& f : found) {
+        for (auto& e : f) {
+            e.first->markOutRemoved(e.second);
+            setDirty(*e.first);
+            edgeIndex.erase(e.first->id, e.second);
+            --numEdges;
+        }
+    }
+    for (auto vID : ids) {
+        unordered_map<uint64_t, Vertex>::iterator it = vertexList.find(vID);
+        edgeIndex.eraseHub(vID);
+        numEdges -= it->second.getOutDeg();
+        numTombstones -= it->second.numOutTombstones + it->second.numInTombstones;
+        vertexList.erase(it);
+    }
+    if (!deferCompaction) {
+        compact();
+    }
+}
+
+void DirectedGraph::setStorage(const tStorage& policy, const unsigned& numThreads) {
+    if (policy == storage) {
+        return;
+    }
+    storage = policy;
+    for (auto& m : vertexList) {
+        m.second.hasInList = (storage == kOutAndIn);
+    }
+    if (storage == kOutAndIn) {
+        buildInEdges(numThreads);
+        return;
+    }
+    for (auto& m : vertexList) {
+        numTombstones -= m.second.numInTombstones;
+        m.second.numInTombstones = 0;
+        vector<uint64_t>().swap(m.second.inAdjList);
+    }
+}
+
+shared_ptr<const CompactGraph> DirectedGraph::transpose(const unsigned& numThreads) const {
+    lock_guard<mutex> guard(transposeLock);
+    if (!transposed) {
+        CompactGraph out = buildInduced(vertexList, sortedIDs(vertexList), OutAdj(), true, numThreads);
+        transposed = make_shared<const CompactGraph>(out.transpose(numThreads));
+    }
+    return transposed;
+}
+
+void DirectedGraph::buildInEdges(const unsigned& numThreads) {
+    shared_ptr<const CompactGraph> in = transpose(numThreads);
+    parallelFor(0, in->getNumVertex(), [&](uint64_t i) {
+        Vertex& v = vertexList.find(in->getId(i))->second;
+        v.inAdjList.resize(in->getDeg(i));
+        for (uint64_t pos = 0; pos < v.inAdjList.size(); ++pos) {
+            v.inAdjList[pos] = in->getId(in->getAdj(i, pos));
+        }
+    }, 256, numThreads);
+}
+
 void DirectedGraph::clearVisited() {
     for (auto& m : vertexList){
         m.second.setVisited(false);
     }
 }
-void DirectedGraph::printGraph(const uint64_t& root, const uint8_t& depth) {
-    Vertex& rootVertex = getVertex(root);
-    printDFS (rootVertex, depth);
+void DirectedGraph::printGraph(const uint64_t& root, const uint8_t& depth) const {
+    const Vertex* rootVertex = findVertex(root);
+    if (rootVertex != nullptr) {
+        unordered_set<uint64_t> visited;
+        printDFS (*rootVertex, depth, 0, visited);
+    }
 }
 
 void DirectedGraph::printDFS (DirectedGraph::Vertex& v, const uint8_t& depth, const uint8_t& level) {
@@ -280,8 +1334,11 @@ void DirectedGraph::printDFS (DirectedGraph::Vertex& v, const uint8_t& depth, co
         }
         indent += "|-> ";
         cout << indent << v.getId() << "\n";
-        for (uint64_t i = 0; i < v.getDeg(); ++i){
-            DirectedGraph::Vertex& adj = getVertex(v.getOutAdjID(i));
+        for (auto adjID : v.adjList){
+            if (isTombstone(adjID)) {
+                continue;
+            }
+            DirectedGraph::Vertex& adj = getVertex(adjID);
             if (!adj.isVisited()) {
                 printDFS (adj, depth, level+1);
             }
@@ -289,30 +1346,60 @@ void DirectedGraph::printDFS (DirectedGraph::Vertex& v, const uint8_t& depth, co
     }
 }
 
-int16_t DirectedGraph::distance(const uint64_t& from, const uint64_t& to){
+void DirectedGraph::printDFS (const Vertex& v, const uint8_t& depth, const uint8_t& level, unordered_set<uint64_t>& visited) const {
+    
+    visited.insert(v.getId());
+    if (level<=depth){
+        string indent;
+        for (int i=0; i<level; ++i){
+            indent += "|  ";
+        }
+        indent += "|-> ";
+        cout << indent << v.getId() << "\n";
+        for (auto adjID : v.adjList){
+            if (!isTombstone(adjID) && !visited.count(adjID)) {
+                printDFS (*findVertex(adjID), depth, level+1, visited);
+            }
+        }
+    }
+}
+
+CompactGraph DirectedGraph::inducedSubgraph(const vector<uint64_t>& ids) const {
+    return buildInduced(vertexList, existingIDs(vertexList, ids), OutAdj(), true);
+}
+
+CompactGraph DirectedGraph::kHopSubgraph(const vector<uint64_t>& seeds, const uint8_t& k, const uint64_t& maxVertices,
+                                   const unsigned& numThreads) const {
+    return buildInduced(vertexList, kHopVertices(vertexList, seeds, k, maxVertices, OutAdj(), numThreads), OutAdj(), true, numThreads);
+}
+
+int16_t DirectedGraph::distance(const uint64_t& from, const uint64_t& to, const uint64_t& groupSize) const {
+    return groupedDistance(vertexList, from, to, groupSize, [](const Vertex& v) -> const vector<uint64_t>& { return v.adjList; });
+}
+
+int16_t DirectedGraph::distance(const uint64_t& from, const uint64_t& to) const {
     typedef struct {
         uint64_t    vID;   //Vertex ID
         int16_t     d;     //distance to "from"
     }tNodeInfo;
     queue<tNodeInfo> q;
-    DirectedGraph::Vertex& v = getVertex(from);
+    unordered_set<uint64_t> visited;
     
-    clearVisited();
+    if (!isVertex(from)) {
+        return -1;
+    }
     q.push({from, 0});
-    v.setVisited(true);
+    visited.insert(from);
     while(!q.empty()) {
         tNodeInfo nodeInfo = q.front();
         q.pop();
         if (nodeInfo.vID == to){
             return nodeInfo.d;
         }
-        v = getVertex(nodeInfo.vID);
-        for (uint64_t i = 0; i < v.getDeg(); ++i){
-            tNodeInfo child = {v.getOutAdjID(i), static_cast<int16_t>(nodeInfo.d + 1)};
-            DirectedGraph::Vertex& adj = getVertex(child.vID);
-            if (!adj.isVisited()) {
-                adj.setVisited(true);
-                q.push(child);
+        const Vertex* v = findVertex(nodeInfo.vID);
+        for (auto adjID : v->adjList){
+            if (!isTombstone(adjID) && visited.insert(adjID).second) {
+                q.push({adjID, static_cast<int16_t>(nodeInfo.d + 1)});
             }
         }
     }
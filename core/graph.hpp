@@ -25,11 +25,98 @@
 
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <stdexcept>
 #include <stdint.h>
+#include "flat-id-set.hpp"
 
 using namespace std;
 
+class CompactGraph;
+
+/// Bit set on an adjacency list entry to mark it as removed (tombstone) until
+/// the list is compacted. Vertex IDs must be smaller than 2^63.
+const uint64_t kTombstone = 0x8000000000000000ULL;
+
+/// Returns true if the adjacency list entry is a tombstone
+inline bool isTombstone (const uint64_t& adjID) { return (adjID & kTombstone) != 0; }
+
+///
+/// \brief Returns the position of the first entry in a sorted adjacency list
+/// which is not smaller than vID, ignoring the tombstone marks.
+///
+/// Marking an entry as a tombstone keeps its position, so the list stays
+/// sorted by vertex ID and can still be binary searched.
+//
+template <class TIter>
+TIter adjLowerBound (TIter first, TIter last, const uint64_t& vID) {
+    return lower_bound(first, last, vID, [](const uint64_t& a, const uint64_t& b) { return (a & ~kTombstone) < b; });
+}
+
+//#//////////////////////////////////////////////
+/// \brief Optional edge membership index for high degree (hub) vertex.
+///
+/// Keeps a hash set with the adjacent IDs of every vertex whose degree (out
+/// degree in a directed graph) reached a threshold, so isEdge() on a hub is
+/// one hash lookup instead of a binary search over a long list. The sets
+/// are FlatIDSet, a flat array of IDs taking 16 to 32 bytes per edge, with
+/// no node allocated per entry. The graph
+/// classes keep it in sync on every edge and vertex change made through
+/// them. A vertex stays indexed if its degree drops again below the
+/// threshold. Changes made directly on a Vertex are not tracked.
+///
+class HubEdgeIndex {
+    uint64_t minDegree;     ///Degree from which a vertex is indexed. 0 when disabled
+    unordered_map<uint64_t, FlatIDSet> hubs;    ///Adjacent IDs of every indexed vertex
+    
+public:
+    /// Default constructor, creates a disabled index
+    HubEdgeIndex () : minDegree(0) { }
+    ///Returns true if the index is enabled
+    bool isEnabled () const { return minDegree != 0; }
+    ///Returns the degree from which a vertex is indexed
+    uint64_t getMinDegree () const { return minDegree; }
+    ///Returns the number of indexed vertex
+    uint64_t getNumHubs () const { return hubs.size(); }
+    ///Drops all hubs and sets the threshold. 0 disables the index
+    void reset (const uint64_t& degree) { minDegree = degree; hubs.clear(); }
+    ///Returns the adjacent IDs of the vertex, or nullptr if it is not indexed
+    const FlatIDSet* find (const uint64_t& vID) const {
+        if (hubs.empty()) {
+            return nullptr;
+        }
+        unordered_map<uint64_t, FlatIDSet>::const_iterator it = hubs.find(vID);
+        return (it != hubs.end()) ? &it->second : nullptr; }
+    FlatIDSet* find (const uint64_t& vID) {
+        return const_cast<FlatIDSet*>(static_cast<const HubEdgeIndex*>(this)->find(vID)); }
+    ///Returns true if the vertex is indexed
+    bool isHub (const uint64_t& vID) const { return find(vID) != nullptr; }
+    ///Returns the empty set of a vertex that becomes indexed
+    FlatIDSet& makeHub (const uint64_t& vID) { FlatIDSet& adj = hubs[vID]; adj.clear(); return adj; }
+    ///Adds adjID to the set of vID, if it is indexed
+    void insert (const uint64_t& vID, const uint64_t& adjID) {
+        unordered_map<uint64_t, FlatIDSet>::iterator it = hubs.find(vID);
+        if (it != hubs.end()) {
+            it->second.insert(adjID);
+        }
+    }
+    ///Removes adjID from the set of vID, if it is indexed
+    void erase (const uint64_t& vID, const uint64_t& adjID) {
+        if (!hubs.empty()) {
+            unordered_map<uint64_t, FlatIDSet>::iterator it = hubs.find(vID);
+            if (it != hubs.end()) {
+                it->second.erase(adjID);
+            }
+        }
+    }
+    ///Stops indexing a vertex
+    void eraseHub (const uint64_t& vID) { hubs.erase(vID); }
+};
+
 //#//////////////////////////////////////////////
 /// \brief Implements an undirected graph. It contains a vertex class and an iterator
 ///
@@ -54,15 +141,21 @@ public:
     class Vertex{
         uint64_t id;     // Vertex ID
         vector<uint64_t> adjList;   // Adjacency list
+        uint64_t numTombstones;     // Entries in adjList marked as removed
+        mutable atomic<uint64_t> cursor;    // Last position found by getAdjID() while there are tombstones
         bool visited;   // Visited flag. Used by graph search algorithms
 
     public:
         /// Default constructor
-        Vertex () : id (0), visited(false) { }
+        Vertex () : id (0), numTombstones(0), cursor(0), visited(false) { }
         ///Create a vertex with id = vID
-        Vertex (const uint64_t& vID) : id (vID), visited(false) { }
+        Vertex (const uint64_t& vID) : id (vID), numTombstones(0), cursor(0), visited(false) { }
         ///Copy constructor
-        Vertex (const Vertex& copyVertex) : id (copyVertex.id), adjList(copyVertex.adjList), visited(copyVertex.visited) { }
+        Vertex (const Vertex& copyVertex) : id (copyVertex.id), adjList(copyVertex.adjList), numTombstones(copyVertex.numTombstones), cursor(0), visited(copyVertex.visited) { }
+        ///Assignment operator
+        Vertex& operator = (const Vertex& copyVertex) {
+            id = copyVertex.id; adjList = copyVertex.adjList; numTombstones = copyVertex.numTombstones;
+            cursor.store(0, memory_order_relaxed); visited = copyVertex.visited; return *this; }
         ///Access method for the vertex ID
         uint64_t getId () const {return id;}
         ///Returns the visited state for the vertex
@@ -70,19 +163,36 @@ public:
         ///Sets the visited state of the vertex to "state"
         void setVisited (const bool& state) {visited = state;}
         ///Get the degree of the vertex
-        uint64_t getDeg() const { return adjList.size(); }
+        uint64_t getDeg() const { return adjList.size() - numTombstones; }
         ///Gets the in-degree of the vertex (equal to the degree for an undirected graph
         uint64_t getInDeg() const { return getDeg(); }
         ///Gets the out-degree of the vertex (equal to the degree for an undirected graph
         uint64_t getOutDeg() const { return getDeg(); }
         ///Returns true if the vertex with the given ID is adjacent
-        bool isAdjacent (const uint64_t& vID) const { return binary_search(adjList.begin(), adjList.end(), vID); }
-        ///Returns the adjacent vertex ID in the given position of the adjacency list
-        uint64_t getAdjID (const uint64_t& pos) const { return adjList[pos]; }
-        ///Adds an edge to the given vertex ID by adding a new element to the adjacency list
-        void addAdjacent (const uint64_t& vID);
-        ///Removes edge to the given vertex ID from the adjacency list
-        void removeAdjacent (const uint64_t&vID);
+        bool isAdjacent (const uint64_t& vID) const {
+            vector<uint64_t>::const_iterator it = adjLowerBound(adjList.begin(), adjList.end(), vID);
+            return (it != adjList.end()) && (*it == vID); }
+        ///Returns the adjacent vertex ID in the given position of the adjacency
+        ///list. Entries pending removal are skipped. While there are some, the
+        ///vertex remembers the last position found, so walking the positions
+        ///in increasing order takes constant time per call
+        uint64_t getAdjID (const uint64_t& pos) const;
+        ///Calls f(adjID) for every adjacent vertex, in increasing ID order
+        template <class TFunc>
+        void forEachAdj (TFunc f) const { for (auto adjID : adjList) { if (!isTombstone(adjID)) f(adjID); } }
+        ///Adds an edge to the given vertex ID by adding a new element to the adjacency list.
+        ///Returns the number of tombstones revived (0 or 1)
+        uint64_t addAdjacent (const uint64_t& vID);
+        ///Removes edge to the given vertex ID from the adjacency list. Returns
+        ///the number of tombstones dropped (0 or 1)
+        uint64_t removeAdjacent (const uint64_t&vID);
+        ///Marks the edge to the given vertex ID as removed, without modifying
+        ///the adjacency list. Returns true if the edge existed
+        bool markRemoved (const uint64_t& vID);
+        ///Returns true if the adjacency list contains entries pending removal
+        bool hasTombstones () const { return numTombstones != 0; }
+        ///Drops the entries marked as removed from the adjacency list
+        void compact ();
         friend class UndirectedGraph;
     };
     //#//////////////////////////////////////////////
@@ -115,25 +225,51 @@ private:
     unordered_map<uint64_t, Vertex> vertexList; ///Hash table containing all vertex in the graph
     uint64_t numEdges;  ///Total number of edges in the graph
     uint64_t maxID;     ///Bigger than any vertex ID in the graph
+    uint64_t numTombstones;         ///Adjacency entries pending compaction
+    vector<uint64_t> dirtyVertex;   ///IDs of the vertex with tombstones in their adjacency list
+    HubEdgeIndex edgeIndex;         ///Optional hash sets for the adjacency of hub vertex
 public:
     //#//////////////////////////////////////////////
     // Constructors
-    UndirectedGraph (): vertexList(), numEdges(0), maxID(0) { }
+    UndirectedGraph (): vertexList(), numEdges(0), maxID(0), numTombstones(0) { }
     ///Copy constructor
-    UndirectedGraph (const UndirectedGraph& uGraph): vertexList (uGraph.vertexList), numEdges (uGraph.numEdges), maxID(uGraph.maxID) { }
+    UndirectedGraph (const UndirectedGraph& uGraph): vertexList (uGraph.vertexList), numEdges (uGraph.numEdges), maxID(uGraph.maxID),
+        numTombstones(uGraph.numTombstones), dirtyVertex(uGraph.dirtyVertex), edgeIndex(uGraph.edgeIndex) { }
     ///Constructor that reserves memory for "n" number of vertex
-    UndirectedGraph (const uint64_t& n) : numEdges(0), maxID(0) {vertexList.reserve(n);}
+    UndirectedGraph (const uint64_t& n) : numEdges(0), maxID(0), numTombstones(0) {vertexList.reserve(n);}
     //#//////////////////////////////////////////////
     // Operators
     ///Asignment operator
     UndirectedGraph& operator = (const UndirectedGraph& uGraph) {
-        if (&uGraph != this) {vertexList = uGraph.vertexList; numEdges = uGraph.numEdges; maxID = uGraph.maxID;} return *this;}
+        if (&uGraph != this) {vertexList = uGraph.vertexList; numEdges = uGraph.numEdges; maxID = uGraph.maxID;
+            numTombstones = uGraph.numTombstones; dirtyVertex = uGraph.dirtyVertex; edgeIndex = uGraph.edgeIndex;} return *this;}
     //#//////////////////////////////////////////////
     // Access & Modifiers
     ///Return true if there is a vertex with the given ID
     bool isVertex (const uint64_t& id) const {return vertexList.count(id);}
     ///Returns true if there is an edge between the 2 vertex passed as parameters
-    bool isEdge (const uint64_t& fromID, const uint64_t& toID);
+    bool isEdge (const uint64_t& fromID, const uint64_t& toID) const;
+    ///
+    /// \brief Checks a batch of edges
+    ///
+    /// Pairs are processed in small groups: the source vertex of the whole
+    /// group are located and their adjacency lists prefetched before any of
+    /// them is searched, so the cache misses overlap.
+    ///
+    /// \param pairs Pairs of <fromID, toID>
+    /// \return 1 for every pair which is an edge, 0 otherwise
+    //
+    vector<uint8_t> areEdges (const vector<pair<uint64_t, uint64_t> >& pairs) const;
+    ///
+    /// \brief Enables the hub edge index (see HubEdgeIndex)
+    ///
+    /// \param minDegree Vertex with this degree or more are indexed. 0 disables the index
+    //
+    void enableEdgeIndex (const uint64_t& minDegree);
+    ///Drops the hub edge index
+    void disableEdgeIndex () { edgeIndex.reset(0); }
+    ///Returns the hub edge index
+    const HubEdgeIndex& getEdgeIndex () const { return edgeIndex; }
     ///Returns the number of vertex in the graph
     size_t getNumVertex () const { return vertexList.size();}
     ///Returns the number of edges in the graph
@@ -144,6 +280,13 @@ public:
     // ToDo: Find alternative that returns something indicating it does not exists
     // instead of adding a new element
     Vertex& getVertex(const uint64_t& vID) { return addVertex(vID); }
+    ///Returns a pointer to the vertex with the provided ID, or nullptr if it
+    ///is not part of the graph. Never modifies the graph
+    const Vertex* findVertex(const uint64_t& vID) const {
+        unordered_map<uint64_t, Vertex>::const_iterator it = vertexList.find(vID);
+        return (it != vertexList.end()) ? &it->second : nullptr; }
+    ///Returns the IDs of all vertex in the graph, sorted
+    vector<uint64_t> getVertexIDs() const;
     ///Adds a vertex to the graph with the given ID if the vertex does not exist
     /// and returns a reference to the vertex
     Vertex& addVertex(const uint64_t& newID);
@@ -153,6 +296,47 @@ public:
     void addEdge (const uint64_t& from, const uint64_t& to);
     ///Removes an edge between 2 vertex in the graph
     void removeEdge (const uint64_t& from, const uint64_t& to);
+    ///
+    /// \brief Adds a batch of edges
+    ///
+    /// Vertex not in the graph are added. The new entries are appended to
+    /// the adjacency lists and each touched list is sorted and merged once,
+    /// in parallel, instead of once per edge.
+    ///
+    /// \param edges Pairs of <fromID, toID>. Duplicates are ignored
+    //
+    void addEdges (const vector<pair<uint64_t, uint64_t> >& edges);
+    ///
+    /// \brief Removes a batch of vertex, and all the edges pointing to them
+    ///
+    /// The entries pointing to the removed vertex are marked as tombstones in
+    /// the adjacency list of their neighbours, and skipped by any traversal
+    /// until compact() runs.
+    ///
+    /// \param ids IDs of the vertex to remove. Unknown IDs are ignored
+    /// \param deferCompaction If false, compacts the affected adjacency lists
+    /// before returning
+    //
+    void removeVertices (const vector<uint64_t>& ids, const bool& deferCompaction=false);
+    ///
+    /// \brief Removes a batch of edges, marking them as tombstones
+    ///
+    /// The batch is sorted by vertex, so every touched list is looked up
+    /// once, and the lists are prefetched ahead of their updates.
+    ///
+    /// \param edges Pairs of <fromID, toID>. Edges not in the graph are ignored
+    /// \param deferCompaction If false, compacts the affected adjacency lists
+    /// before returning
+    /// \param isolated If not null, receives the IDs of the touched vertex
+    /// left without edges
+    //
+    void removeEdges (const vector<pair<uint64_t, uint64_t> >& edges, const bool& deferCompaction=false,
+                      vector<uint64_t>* isolated=nullptr);
+    ///Drops all tombstones from the adjacency lists, in one parallel sweep over
+    ///the affected vertex
+    void compact ();
+    ///Returns the number of adjacency entries pending compaction
+    uint64_t getNumTombstones () const { return numTombstones; }
     /// Returns a vertex iterator to the first node - unordered_map<uint64_t, vertex>
     /// pair - in the graph
     VertexIterator begin()  { return VertexIterator(vertexList.begin()); }
@@ -165,20 +349,67 @@ public:
     void clearVisited();
     /// Returns a uint64_t which is equal or bigger to the biggest vertex ID in
     /// the graph
-    uint64_t getMaxID () { return maxID;}
+    uint64_t getMaxID () const { return maxID;}
     //#//////////////////////////////////////////////
     // Search
     ///Uses a Depth-first traversal to print the connections for a vertex to std_out, up to the specified depth
-    void printGraph (const uint64_t& root, const uint8_t& depth);
+    void printGraph (const uint64_t& root, const uint8_t& depth) const;
     void printDFS (Vertex& v, const uint8_t& depth, const uint8_t& level);
-    ///Returns the distance between 2 vertex, using a Breath-first traversal
-    int16_t distance (const uint64_t& from, const uint64_t& to);
+    ///
+    /// \brief Returns the subgraph induced by the given vertex, in compact form
+    ///
+    /// \param ids IDs of the vertex in the subgraph. IDs not in the graph are ignored
+    //
+    CompactGraph inducedSubgraph (const vector<uint64_t>& ids) const;
+    ///
+    /// \brief Extracts the k-hop neighbourhood of a set of seeds
+    ///
+    /// Expands the frontier from the seeds level by level, in parallel, and
+    /// returns the subgraph induced by all vertex found.
+    ///
+    /// \param seeds IDs of the vertex to start from
+    /// \param k Number of hops to expand
+    /// \param maxVertices Cap on the number of vertex in the result. The last
+    /// level is truncated, keeping the smallest IDs, when the cap is reached
+    /// \param numThreads Number of threads. 0 uses all hardware threads
+    /// \return Induced subgraph, in compact form
+    //
+    CompactGraph kHopSubgraph (const vector<uint64_t>& seeds, const uint8_t& k, const uint64_t& maxVertices=UINT64_MAX,
+                               const unsigned& numThreads=0) const;
+    ///Returns the distance between 2 vertex, using a Breath-first traversal.
+    ///Returns -1 if there is no path. Never modifies the graph, so it can be
+    ///called concurrently from several threads
+    int16_t distance (const uint64_t& from, const uint64_t& to) const;
+    ///
+    /// \brief Returns the distance between 2 vertex, expanding each BFS level
+    /// in groups of vertex
+    ///
+    /// All vertex of a group are looked up and their adjacency lists
+    /// prefetched before the lists are walked, so several memory accesses
+    /// are in flight at once. Faster than distance() on graphs much bigger
+    /// than the CPU caches.
+    ///
+    /// \param from Source vertex ID
+    /// \param to Target vertex ID
+    /// \param groupSize Number of frontier vertex handled together
+    /// \return Number of edges in the shortest path, or -1 if there is none
+    //
+    int16_t distance (const uint64_t& from, const uint64_t& to, const uint64_t& groupSize) const;
     
     // ToDo:
     //  * Save method: saves graph to a file formatted: 2 columns fromID<space>toID
     //  * Constructor building the graph from a stream
     //  * addVertex() method with initial edge list
     
+private:
+    ///Keeps track of a vertex getting its first tombstone
+    void setDirty (Vertex& v);
+    ///Adds a new adjacent vertex to the edge index, indexing the vertex if
+    ///it just reached the degree threshold
+    void indexAdj (const Vertex& v, const uint64_t& adjID);
+    ///Depth-first print used by printGraph. Keeps the visited vertex in a
+    ///local set instead of the vertex flags
+    void printDFS (const Vertex& v, const uint8_t& depth, const uint8_t& level, unordered_set<uint64_t>& visited) const;
 };
 
 
@@ -195,13 +426,27 @@ public:
 /// A C++ unordered_map uses a hash function over the ID, typically allowing O(1)
 /// search.
 ///
+/// With the kOutOnly storage policy the vertex keep no in connection list,
+/// halving the memory and the insert cost of the adjacency. Algorithms
+/// needing the in connections get them from transpose(), which is built on
+/// demand and cached until the next change to the graph. Removing a vertex
+/// then requires a scan of the whole graph.
+///
 class DirectedGraph {
 public:
+    /// Adjacency lists kept by every vertex
+    enum tStorage {
+        kOutAndIn,  ///< Out and in connection lists
+        kOutOnly    ///< Out connection list only
+    };
     //#//////////////////////////////////////////////
     /// \brief Vertex class for a directed graph.
     ///
     /// Contains the adjacency list, both for in and out connections, and
-    /// vertex ID. It is up to the user to
+    /// vertex ID. There is no in connection list when the graph uses the
+    /// kOutOnly storage policy: the accessors for in connections and
+    /// getDeg() then throw logic_error, and the in connections have to be
+    /// taken from DirectedGraph::transpose(). It is up to the user to
     /// maintain a data structure mapping the
     /// IDs to any additional content.
     //ToDo: Convert into a templete to hold content data of any type
@@ -209,14 +454,33 @@ public:
         uint64_t id;     /// Vertex ID
         vector<uint64_t> adjList;   // Adjacency list
         vector<uint64_t> inAdjList; // In connection list
+        uint64_t numOutTombstones;  // Entries in adjList marked as removed
+        uint64_t numInTombstones;   // Entries in inAdjList marked as removed
+        mutable atomic<uint64_t> outCursor; // Last position found by getOutAdjID() while there are tombstones
+        mutable atomic<uint64_t> inCursor;  // Last position found by getInAdjID() while there are tombstones
         bool visited;   // Visited flag. Used by graph search algorithms
+        bool hasInList; // False when the graph uses the kOutOnly storage policy
+        ///Throws if the vertex keeps no in connection list
+        void checkInList () const {
+            if (!hasInList) {
+                throw logic_error("DirectedGraph::Vertex: no in connections with the kOutOnly storage, use DirectedGraph::transpose()");
+            }
+        }
         
     public:
-        Vertex () : id (0), visited(false) { }
+        Vertex () : id (0), numOutTombstones(0), numInTombstones(0), outCursor(0), inCursor(0), visited(false), hasInList(true) { }
         ///Create a vertex with id = vID
-        Vertex (const uint64_t& vID) : id (vID), visited(false) { }
+        Vertex (const uint64_t& vID) : id (vID), numOutTombstones(0), numInTombstones(0), outCursor(0), inCursor(0), visited(false), hasInList(true) { }
         ///Copy constructor
-        Vertex (const Vertex& copyVertex) : id (copyVertex.id), adjList(copyVertex.adjList), inAdjList(copyVertex.inAdjList), visited(copyVertex.id) { }
+        Vertex (const Vertex& copyVertex) : id (copyVertex.id), adjList(copyVertex.adjList), inAdjList(copyVertex.inAdjList),
+            numOutTombstones(copyVertex.numOutTombstones), numInTombstones(copyVertex.numInTombstones), outCursor(0), inCursor(0),
+            visited(copyVertex.visited), hasInList(copyVertex.hasInList) { }
+        ///Assignment operator
+        Vertex& operator = (const Vertex& copyVertex) {
+            id = copyVertex.id; adjList = copyVertex.adjList; inAdjList = copyVertex.inAdjList;
+            numOutTombstones = copyVertex.numOutTombstones; numInTombstones = copyVertex.numInTombstones;
+            outCursor.store(0, memory_order_relaxed); inCursor.store(0, memory_order_relaxed);
+            visited = copyVertex.visited; hasInList = copyVertex.hasInList; return *this; }
         ///Access method for the vertex ID
         uint64_t getId () const {return id;}
         ///Returns the visited state for the vertex
@@ -224,27 +488,58 @@ public:
         ///Sets the visited state of the vertex to "state"
         void setVisited (const bool& state) {visited = state;}
         ///Get the output degree of the vertex
-        uint16_t getOutDeg() const {return adjList.size();}
-        ///Get the input degree of the vertex
-        uint16_t getInDeg() const {return inAdjList.size();}
-        ///Get the degree of the vertex
+        uint64_t getOutDeg() const {return adjList.size() - numOutTombstones;}
+        ///Get the input degree of the vertex. Throws logic_error with the kOutOnly storage
+        uint64_t getInDeg() const { checkInList(); return inAdjList.size() - numInTombstones;}
+        ///Get the degree of the vertex. Throws logic_error with the kOutOnly storage
         uint64_t getDeg() const { return getInDeg() + getOutDeg();}
-        ///Returns true if the vertex with the given ID is an input connection to the current vertex
-        bool isInEdge (const uint16_t& vID) const { return binary_search(inAdjList.begin(), inAdjList.end(), vID); }
+        ///Returns true if the vertex with the given ID is an input connection
+        ///to the current vertex. Throws logic_error with the kOutOnly storage
+        bool isInEdge (const uint64_t& vID) const {
+            checkInList();
+            vector<uint64_t>::const_iterator it = adjLowerBound(inAdjList.begin(), inAdjList.end(), vID);
+            return (it != inAdjList.end()) && (*it == vID); }
         ///Returns true if the vertex with the given ID is adjacent
-        bool isOutEdge (const uint64_t& vID) const { return binary_search(adjList.begin(), adjList.end(), vID); }
-        ///Returns the adjacent vertex ID in the given position of the adjacency list
-        uint64_t getOutAdjID (const uint64_t& pos) const { return adjList[pos]; }
-        ///Returns the adjacent vertex ID in the given position of the adjacency list
-        uint64_t getInAdjID (const uint64_t& pos) const { return inAdjList[pos]; }
-        ///Adds an edge to the given vertex ID by adding a new element to the adjacency list
-        void addOutEdge (const uint64_t& vID);
-        ///Removes edge to the given vertex ID from the adjacency list
-        void removeOutEdge (const uint64_t&vID);
-        ///Adds an input edge from the given vertex ID by adding a new element to the in adjacency list
-        void addInEdge (const uint64_t& vID);
-        ///Removes an input edge to the given vertex ID from the in adjacency list
-        void removeInEdge (const uint64_t&vID);
+        bool isOutEdge (const uint64_t& vID) const {
+            vector<uint64_t>::const_iterator it = adjLowerBound(adjList.begin(), adjList.end(), vID);
+            return (it != adjList.end()) && (*it == vID); }
+        ///Returns the adjacent vertex ID in the given position of the adjacency
+        ///list. Entries pending removal are skipped, in constant time per call
+        ///when walking the positions in increasing order, as in getAdjID()
+        uint64_t getOutAdjID (const uint64_t& pos) const;
+        ///Returns the adjacent vertex ID in the given position of the in
+        ///adjacency list. Entries pending removal are skipped. Throws
+        ///logic_error with the kOutOnly storage
+        uint64_t getInAdjID (const uint64_t& pos) const;
+        ///Calls f(adjID) for every out connection, in increasing ID order
+        template <class TFunc>
+        void forEachOutAdj (TFunc f) const { for (auto adjID : adjList) { if (!isTombstone(adjID)) f(adjID); } }
+        ///Calls f(adjID) for every in connection, in increasing ID order.
+        ///Throws logic_error with the kOutOnly storage
+        template <class TFunc>
+        void forEachInAdj (TFunc f) const { checkInList(); for (auto adjID : inAdjList) { if (!isTombstone(adjID)) f(adjID); } }
+        ///Adds an edge to the given vertex ID by adding a new element to the adjacency list.
+        ///Returns the number of tombstones revived (0 or 1)
+        uint64_t addOutEdge (const uint64_t& vID);
+        ///Removes edge to the given vertex ID from the adjacency list. Returns
+        ///the number of tombstones dropped (0 or 1)
+        uint64_t removeOutEdge (const uint64_t&vID);
+        ///Adds an input edge from the given vertex ID by adding a new element to the in adjacency list.
+        ///Returns the number of tombstones revived (0 or 1)
+        uint64_t addInEdge (const uint64_t& vID);
+        ///Removes an input edge to the given vertex ID from the in adjacency list. Returns
+        ///the number of tombstones dropped (0 or 1)
+        uint64_t removeInEdge (const uint64_t&vID);
+        ///Marks the out edge to the given vertex ID as removed. Returns true if
+        ///the edge existed
+        bool markOutRemoved (const uint64_t& vID);
+        ///Marks the in edge from the given vertex ID as removed. Returns true
+        ///if the edge existed
+        bool markInRemoved (const uint64_t& vID);
+        ///Returns true if any adjacency list contains entries pending removal
+        bool hasTombstones () const { return (numOutTombstones + numInTombstones) != 0; }
+        ///Drops the entries marked as removed from both adjacency lists
+        void compact ();
         friend class DirectedGraph;
     };
     //#//////////////////////////////////////////////
@@ -276,26 +571,60 @@ private:
     unordered_map<uint64_t, Vertex> vertexList; ///Hash table containing all vertex in the graph
     uint64_t numEdges;  ///Total number of edges in the graph
     uint64_t maxID;     ///Bigger than any vertex ID in the graph
+    uint64_t numTombstones;         ///Adjacency entries pending compaction
+    vector<uint64_t> dirtyVertex;   ///IDs of the vertex with tombstones in their adjacency lists
+    HubEdgeIndex edgeIndex;         ///Optional hash sets for the out adjacency of hub vertex
+    tStorage storage;               ///Adjacency lists kept by the vertex
+    mutable shared_ptr<const CompactGraph> transposed;  ///Cached result of transpose(), null when out of date
+    mutable mutex transposeLock;    ///Protects the build of the cached transpose
 public:
     //#//////////////////////////////////////////////
     // Constructors
     /// Default constructor
-    DirectedGraph (): vertexList(), numEdges(0), maxID(0) { }
+    DirectedGraph (): vertexList(), numEdges(0), maxID(0), numTombstones(0), storage(kOutAndIn) { }
+    ///Creates an empty graph with the given storage policy
+    explicit DirectedGraph (const tStorage& policy): numEdges(0), maxID(0), numTombstones(0), storage(policy) { }
     ///Copy constructor
-    DirectedGraph (const DirectedGraph& dGraph): vertexList (dGraph.vertexList), numEdges (dGraph.numEdges), maxID(dGraph.maxID) { }
+    DirectedGraph (const DirectedGraph& dGraph): vertexList (dGraph.vertexList), numEdges (dGraph.numEdges), maxID(dGraph.maxID),
+        numTombstones(dGraph.numTombstones), dirtyVertex(dGraph.dirtyVertex), edgeIndex(dGraph.edgeIndex), storage(dGraph.storage),
+        transposed(dGraph.getCachedTranspose()) { }
     ///Constructor that reserves memory for "n" number of vertex
-    DirectedGraph (const uint64_t& n) : numEdges(0), maxID(0) {vertexList.reserve(n);}
+    DirectedGraph (const uint64_t& n, const tStorage& policy=kOutAndIn) : numEdges(0), maxID(0), numTombstones(0), storage(policy) {
+        vertexList.reserve(n);}
     //#//////////////////////////////////////////////
     // Operators
     ///Asignment operator
     DirectedGraph& operator = (const DirectedGraph& dGraph) {
-        if (&dGraph != this) {vertexList = dGraph.vertexList; numEdges = dGraph.numEdges; maxID = dGraph.maxID;} return *this;}
+        if (&dGraph != this) {vertexList = dGraph.vertexList; numEdges = dGraph.numEdges; maxID = dGraph.maxID;
+            numTombstones = dGraph.numTombstones; dirtyVertex = dGraph.dirtyVertex; edgeIndex = dGraph.edgeIndex;
+            storage = dGraph.storage; transposed = dGraph.getCachedTranspose();} return *this;}
     //#//////////////////////////////////////////////
     // Access & Modifiers
     ///Return true if there is a vertex with the given ID
     bool isVertex (const uint64_t& id) const {return vertexList.count(id);}
     ///Returns true if there is an edge between the 2 vertex passed as parameters
-    bool isEdge (const uint64_t& fromID, const uint64_t& toID);
+    bool isEdge (const uint64_t& fromID, const uint64_t& toID) const;
+    ///
+    /// \brief Checks a batch of edges
+    ///
+    /// Pairs are processed in small groups: the source vertex of the whole
+    /// group are located and their adjacency lists prefetched before any of
+    /// them is searched, so the cache misses overlap.
+    ///
+    /// \param pairs Pairs of <fromID, toID>
+    /// \return 1 for every pair which is an edge, 0 otherwise
+    //
+    vector<uint8_t> areEdges (const vector<pair<uint64_t, uint64_t> >& pairs) const;
+    ///
+    /// \brief Enables the hub edge index (see HubEdgeIndex)
+    ///
+    /// \param minDegree Vertex with this out degree or more are indexed. 0 disables the index
+    //
+    void enableEdgeIndex (const uint64_t& minDegree);
+    ///Drops the hub edge index
+    void disableEdgeIndex () { edgeIndex.reset(0); }
+    ///Returns the hub edge index
+    const HubEdgeIndex& getEdgeIndex () const { return edgeIndex; }
     ///Returns the number of vertex in the graph
     size_t getNumVertex () const { return vertexList.size();}
     ///Returns the number of edges in the graph
@@ -306,6 +635,13 @@ public:
     // ToDo: Find alternative that returns something indicating it does not exists
     // instead of adding a new element
     Vertex& getVertex(const uint64_t& vID) { return addVertex(vID); }
+    ///Returns a pointer to the vertex with the provided ID, or nullptr if it
+    ///is not part of the graph. Never modifies the graph
+    const Vertex* findVertex(const uint64_t& vID) const {
+        unordered_map<uint64_t, Vertex>::const_iterator it = vertexList.find(vID);
+        return (it != vertexList.end()) ? &it->second : nullptr; }
+    ///Returns the IDs of all vertex in the graph, sorted
+    vector<uint64_t> getVertexIDs() const;
     ///Adds a vertex to the graph with the given ID if the vertex does not exist
     /// and returns a reference to the vertex
     Vertex& addVertex(const uint64_t& newID);
@@ -315,6 +651,66 @@ public:
     void addEdge (const uint64_t& from, const uint64_t& to);
     ///Removes an edge between 2 vertex in the graph
     void removeEdge (const uint64_t& from, const uint64_t& to);
+    ///
+    /// \brief Adds a batch of directed edges
+    ///
+    /// Vertex not in the graph are added. The new entries are appended to
+    /// the out and in adjacency lists, and each touched list is sorted and
+    /// merged once, in parallel, instead of once per edge.
+    ///
+    /// \param edges Pairs of <fromID, toID>. Duplicates are ignored
+    //
+    void addEdges (const vector<pair<uint64_t, uint64_t> >& edges);
+    ///
+    /// \brief Removes a batch of vertex, and all the edges from or to them
+    ///
+    /// The entries pointing to the removed vertex are marked as tombstones in
+    /// the adjacency lists of their neighbours, and skipped by any traversal
+    /// until compact() runs.
+    ///
+    /// \param ids IDs of the vertex to remove. Unknown IDs are ignored
+    /// \param deferCompaction If false, compacts the affected adjacency lists
+    /// before returning
+    //
+    void removeVertices (const vector<uint64_t>& ids, const bool& deferCompaction=false);
+    ///
+    /// \brief Removes a batch of edges, marking them as tombstones
+    ///
+    /// \param edges Pairs of <fromID, toID>. Edges not in the graph are ignored
+    /// \param deferCompaction If false, compacts the affected adjacency lists
+    /// before returning
+    //
+    void removeEdges (const vector<pair<uint64_t, uint64_t> >& edges, const bool& deferCompaction=false);
+    ///Drops all tombstones from the adjacency lists, in one parallel sweep over
+    ///the affected vertex
+    void compact ();
+    ///Returns the number of adjacency entries pending compaction
+    uint64_t getNumTombstones () const { return numTombstones; }
+    ///Returns the storage policy of the graph
+    tStorage getStorage () const { return storage; }
+    ///
+    /// \brief Changes the storage policy of the graph
+    ///
+    /// Switching to kOutOnly frees the in connection lists. Switching to
+    /// kOutAndIn rebuilds them from transpose(), in one parallel pass.
+    ///
+    /// \param policy New storage policy
+    /// \param numThreads Number of threads. 0 uses all hardware threads
+    //
+    void setStorage (const tStorage& policy, const unsigned& numThreads=0);
+    ///
+    /// \brief Returns the graph with every edge reversed, in compact form
+    ///
+    /// The adjacency list of each vertex in the result holds its in
+    /// connections. It is built from the out connections with a parallel
+    /// counting sort, whatever the storage policy, and cached: later calls
+    /// return the same graph until the next change made through the methods
+    /// of this class. Changes made directly on a Vertex are not tracked.
+    /// Can be called concurrently from several threads.
+    ///
+    /// \param numThreads Number of threads. 0 uses all hardware threads
+    //
+    shared_ptr<const CompactGraph> transpose (const unsigned& numThreads=0) const;
     /// Returns a vertex iterator to the first node - unordered_map<uint64_t, vertex>
     /// pair - in the graph
     VertexIterator begin()  { return VertexIterator(vertexList.begin()); }
@@ -327,20 +723,80 @@ public:
     void clearVisited();
     /// Returns a uint64_t which is equal or bigger to the biggest vertex ID in
     /// the graph
-    uint64_t getMaxID () { return maxID;}
+    uint64_t getMaxID () const { return maxID;}
     //#//////////////////////////////////////////////
     // Search
     ///Uses a Depth-first traversal to print the connections for a vertex to std_out, up to the specified depth
-    void printGraph (const uint64_t& root, const uint8_t& depth);
+    void printGraph (const uint64_t& root, const uint8_t& depth) const;
     void printDFS (Vertex& v, const uint8_t& depth, const uint8_t& level=0);
-    ///Returns the distance between 2 vertex, using a Breath-first traversal
-    int16_t distance (const uint64_t& from, const uint64_t& to);
+    ///
+    /// \brief Returns the subgraph induced by the given vertex, in compact
+    /// form. Only out edges are kept
+    ///
+    /// \param ids IDs of the vertex in the subgraph. IDs not in the graph are ignored
+    //
+    CompactGraph inducedSubgraph (const vector<uint64_t>& ids) const;
+    ///
+    /// \brief Extracts the k-hop out neighbourhood of a set of seeds
+    ///
+    /// Expands the frontier from the seeds following out edges, level by
+    /// level in parallel, and returns the subgraph induced by all vertex found.
+    ///
+    /// \param seeds IDs of the vertex to start from
+    /// \param k Number of hops to expand
+    /// \param maxVertices Cap on the number of vertex in the result. The last
+    /// level is truncated, keeping the smallest IDs, when the cap is reached
+    /// \param numThreads Number of threads. 0 uses all hardware threads
+    /// \return Induced subgraph, in compact form
+    //
+    CompactGraph kHopSubgraph (const vector<uint64_t>& seeds, const uint8_t& k, const uint64_t& maxVertices=UINT64_MAX,
+                               const unsigned& numThreads=0) const;
+    ///Returns the distance between 2 vertex, using a Breath-first traversal.
+    ///Returns -1 if there is no path. Never modifies the graph, so it can be
+    ///called concurrently from several threads
+    int16_t distance (const uint64_t& from, const uint64_t& to) const;
+    ///
+    /// \brief Returns the distance between 2 vertex, expanding each BFS level
+    /// in groups of vertex
+    ///
+    /// All vertex of a group are looked up and their adjacency lists
+    /// prefetched before the lists are walked, so several memory accesses
+    /// are in flight at once. Faster than distance() on graphs much bigger
+    /// than the CPU caches.
+    ///
+    /// \param from Source vertex ID
+    /// \param to Target vertex ID
+    /// \param groupSize Number of frontier vertex handled together
+    /// \return Number of edges in the shortest path, or -1 if there is none
+    //
+    int16_t distance (const uint64_t& from, const uint64_t& to, const uint64_t& groupSize) const;
     
     // ToDo:
     //  * Save method: saves graph to a file formatted: 2 columns fromID<space>toID
     //  * Constructor building the graph from a stream
     //  * addVertex() method with initial edge list
     
+private:
+    ///Keeps track of a vertex getting its first tombstone
+    void setDirty (Vertex& v);
+    ///Adds a new adjacent vertex to the edge index, indexing the vertex if
+    ///it just reached the degree threshold
+    void indexAdj (const Vertex& v, const uint64_t& adjID);
+    ///Depth-first print used by printGraph. Keeps the visited vertex in a
+    ///local set instead of the vertex flags
+    void printDFS (const Vertex& v, const uint8_t& depth, const uint8_t& level, unordered_set<uint64_t>& visited) const;
+    ///Returns the cached transpose, null if it is out of date
+    shared_ptr<const CompactGraph> getCachedTranspose () const {
+        lock_guard<mutex> guard(transposeLock); return transposed; }
+    ///Drops the cached transpose. Called on every change to the graph
+    void invalidateTranspose () { transposed.reset(); }
+    ///Fills the in connection lists of all vertex from transpose(). The
+    ///lists must be empty, as they are with the kOutOnly policy
+    void buildInEdges (const unsigned& numThreads);
+    ///Removes the given vertex, which must be in the graph, finding the
+    ///edges pointing to them with a parallel scan of all adjacency lists.
+    ///Used by the kOutOnly policy, where there are no in connection lists
+    void removeVertexSet (const unordered_set<uint64_t>& ids, const bool& deferCompaction);
 };
 
 
@@ -0,0 +1,170 @@
+/**
+* hyper-anf.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "hyper-anf.hpp"
+#include "parallel.hpp"
+#include "rng.hpp"
+
+namespace {
+    const uint64_t kHighBits = 0x8080808080808080ULL;
+    
+    ///Register-wise maximum of 8 registers packed in a word. Registers are
+    ///always below 128, so subtracting with the high bit of every byte set
+    ///never borrows across bytes, and leaves it set where a >= b
+    inline uint64_t maxBytes (const uint64_t& a, const uint64_t& b) {
+        uint64_t ge = ((a | kHighBits) - b) & kHighBits;
+        uint64_t mask = (ge >> 7) * 0xFF;
+        return (a & mask) | (b & ~mask);
+    }
+    
+    ///Merges src into dst. Returns true if dst changed
+    inline bool mergeCounter (uint8_t* dst, const uint8_t* src, const uint64_t& m) {
+        uint64_t changed = 0;
+        for (uint64_t i = 0; i < m; i += 8) {
+            uint64_t a, b;
+            memcpy(&a, dst + i, 8);
+            memcpy(&b, src + i, 8);
+            uint64_t r = maxBytes(a, b);
+            changed |= r ^ a;
+            memcpy(dst + i, &r, 8);
+        }
+        return changed != 0;
+    }
+}
+
+//#/////////////////////////////////////////////////
+// HyperANF
+//
+HyperANF::HyperANF (const CompactGraph& g, const uint8_t& registerBits, const uint64_t& hashSeed, const unsigned& threads) :
+    graph(g), log2m(registerBits), seed(hashSeed), numThreads(threads) {
+    if ((log2m < 4) || (log2m > 16)) {
+        throw out_of_range("HyperANF: register bits must be in [4, 16]");
+    }
+}
+
+double HyperANF::estimate (const uint8_t* registers) const {
+    uint64_t m = 1ULL << log2m;
+    double alpha = (m == 16) ? 0.673 : (m == 32) ? 0.697 : (m == 64) ? 0.709 : 0.7213 / (1.0 + 1.079 / m);
+    double sum = 0;
+    uint64_t zeros = 0;
+    for (uint64_t i = 0; i < m; ++i) {
+        sum += ldexp(1.0, -registers[i]);
+        zeros += (registers[i] == 0);
+    }
+    double e = alpha * m * m / sum;
+    if ((e <= 2.5 * m) && zeros) {
+        e = m * log(static_cast<double>(m) / zeros);   //Linear counting for small sets
+    }
+    return e;
+}
+
+uint64_t HyperANF::run (const uint64_t& maxIterations) {
+    uint64_t n = graph.getNumVertex();
+    uint64_t m = 1ULL << log2m;
+    vector<uint8_t> cur(n * m, 0);
+    vector<uint8_t> next(n * m, 0);
+    vector<uint8_t> changed(n, 1);
+    vector<uint8_t> nextChanged(n, 0);
+    reachable.assign(n, 0);
+    nf.clear();
+    //Every counter starts with its own vertex
+    parallelFor(0, n, [&](uint64_t v) {
+        uint64_t h = streamSeed(seed, v);
+        uint64_t reg = h & (m - 1);
+        uint64_t rest = h >> log2m;
+        uint8_t rank = 1;
+        while ((rank <= 64 - log2m) && !(rest & 1)) {
+            ++rank;
+            rest >>= 1;
+        }
+        cur[v * m + reg] = rank;
+        reachable[v] = estimate(&cur[v * m]);
+    }, 1024, numThreads);
+    double total = 0;
+    for (auto r : reachable) {
+        total += r;
+    }
+    nf.push_back(total);
+    
+    uint64_t iterations = 0;
+    bool anyChange = true;
+    while (anyChange && (iterations < maxIterations)) {
+        atomic<bool> modified(false);
+        parallelFor(0, n, [&](uint64_t v) {
+            uint8_t* dst = &next[v * m];
+            memcpy(dst, &cur[v * m], m);
+            bool vChanged = false;
+            for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+                if (changed[*a]) {
+                    vChanged |= mergeCounter(dst, &cur[*a * m], m);
+                }
+            }
+            nextChanged[v] = vChanged;
+            if (vChanged) {
+                reachable[v] = estimate(dst);
+                modified.store(true, memory_order_relaxed);
+            }
+        }, 256, numThreads);
+        anyChange = modified.load();
+        if (anyChange) {
+            ++iterations;
+            cur.swap(next);
+            changed.swap(nextChanged);
+            total = 0;
+            for (auto r : reachable) {
+                total += r;
+            }
+            nf.push_back(total);
+        }
+    }
+    return iterations;
+}
+
+double HyperANF::getAverageDistance () const {
+    if (nf.size() < 2) {
+        return 0;
+    }
+    double sum = 0;
+    for (uint64_t t = 1; t < nf.size(); ++t) {
+        sum += t * (nf[t] - nf[t - 1]);
+    }
+    return sum / (nf.back() - nf.front());
+}
+
+double HyperANF::getEffectiveDiameter (const double& fraction) const {
+    if (nf.size() < 2) {
+        return 0;
+    }
+    double target = fraction * nf.back();
+    for (uint64_t t = 1; t < nf.size(); ++t) {
+        if (nf[t] >= target) {
+            if (nf[t - 1] >= target) {
+                return t - 1;
+            }
+            return (t - 1) + (target - nf[t - 1]) / (nf[t] - nf[t - 1]);
+        }
+    }
+    return nf.size() - 1;
+}
@@ -0,0 +1,88 @@
+/**
+ * hyper-anf.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_hyper_anf_h
+#define dasel_hyper_anf_h
+
+#include <vector>
+#include <stdint.h>
+#include "compact-graph.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Approximates the neighbourhood function of a graph with HyperANF.
+///
+/// Every vertex keeps a HyperLogLog counter with the set of vertex reachable
+/// from it in at most t steps. Iteration t+1 merges into each counter the
+/// counters of its (out) neighbours, which is a register-wise maximum. The
+/// neighbourhood function N(t), the number of pairs at distance t or less,
+/// is the sum of all counter estimates. The iterations stop when no counter
+/// changes, so the number of passes over the edges is the diameter plus one.
+///
+/// Registers are bytes. Merges work on 8 registers at a time packed in a
+/// 64 bit word, and vertex are split over threads. Vertex whose neighbours
+/// did not change in the last iteration are not merged again.
+///
+/// The relative standard error of every counter is about 1.04 / sqrt(m),
+/// with m = 2^log2m registers per vertex.
+///
+class HyperANF {
+    const CompactGraph& graph;      ///Graph to analyse
+    uint8_t log2m;                  ///Log2 of the number of registers per counter
+    uint64_t seed;                  ///Seed of the vertex hashes
+    unsigned numThreads;            ///Number of threads, 0 for all hardware threads
+    vector<double> nf;              ///N(t) for every iteration t
+    vector<double> reachable;       ///Final estimate of the reachable set of every vertex
+    
+public:
+    ///
+    /// \brief Creates the estimator. The graph must outlive it
+    ///
+    /// \param g Graph to analyse
+    /// \param registerBits Log2 of the number of registers per vertex, in [4, 16]
+    /// \param hashSeed Seed for the vertex hashes
+    /// \param threads Number of threads. 0 uses all hardware threads
+    //
+    HyperANF (const CompactGraph& g, const uint8_t& registerBits=6, const uint64_t& hashSeed=0, const unsigned& threads=0);
+    ///
+    /// \brief Runs the iterations
+    ///
+    /// \param maxIterations Stops after this many iterations even if counters keep changing
+    /// \return Number of iterations run
+    //
+    uint64_t run (const uint64_t& maxIterations=UINT64_MAX);
+    ///Returns N(t) for t in [0, number of iterations]. Empty before run()
+    const vector<double>& getNeighbourhoodFunction () const { return nf; }
+    ///Returns the estimated number of vertex reachable from the vertex index, itself included
+    double getReachableSize (const uint64_t& idx) const { return reachable[idx]; }
+    ///Returns the estimated average distance between connected pairs of different vertex
+    double getAverageDistance () const;
+    ///Returns the (interpolated) smallest distance within which "fraction" of the connected pairs are
+    double getEffectiveDiameter (const double& fraction=0.9) const;
+    
+private:
+    ///Returns the HyperLogLog estimate of a counter with m registers
+    double estimate (const uint8_t* registers) const;
+};
+
+#endif /* dasel_hyper_anf_h */
@@ -0,0 +1,170 @@
+/**
+* kcore.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include "kcore.hpp"
+#include "parallel.hpp"
+
+//#/////////////////////////////////////////////////
+// CoreDecomposition
+//
+CoreDecomposition::CoreDecomposition (const UndirectedGraph& g, const tAlgorithm& algorithm, const unsigned& numThreads) :
+    graph(g), maxCore(0) {
+    decompose(algorithm, numThreads);
+}
+
+CoreDecomposition::CoreDecomposition (const CompactGraph& g, const tAlgorithm& algorithm, const unsigned& numThreads) :
+    graph(g), maxCore(0) {
+    decompose(algorithm, numThreads);
+}
+
+void CoreDecomposition::decompose (const tAlgorithm& algorithm, const unsigned& numThreads) {
+    core.assign(graph.getNumVertex(), 0);
+    if (algorithm == kBucket) {
+        bucketCores();
+    }
+    else {
+        peelingCores(numThreads);
+    }
+    for (auto c : core) {
+        maxCore = max(maxCore, c);
+    }
+}
+
+uint64_t CoreDecomposition::getCoreNumber (const uint64_t& vID) const {
+    uint64_t idx = graph.getIndex(vID);
+    return (idx == kNoVertex) ? 0 : core[idx];
+}
+
+CompactGraph CoreDecomposition::getCore (const uint64_t& k) const {
+    vector<uint64_t> selected;
+    for (uint64_t v = 0; v < core.size(); ++v) {
+        if (core[v] >= k) {
+            selected.push_back(v);
+        }
+    }
+    return graph.inducedSubgraph(selected);
+}
+
+void CoreDecomposition::bucketCores () {
+    uint64_t n = graph.getNumVertex();
+    vector<uint64_t>& deg = core;   //Degrees become the core numbers in place
+    uint64_t maxDeg = 0;
+    for (uint64_t v = 0; v < n; ++v) {
+        deg[v] = degreeNoLoops(v);
+        maxDeg = max(maxDeg, deg[v]);
+    }
+    //Sort the vertex by degree (bin sort). bin[d] is where the vertex of degree d start
+    vector<uint64_t> bin(maxDeg + 2, 0);
+    for (uint64_t v = 0; v < n; ++v) {
+        ++bin[deg[v] + 1];
+    }
+    partial_sum(bin.begin(), bin.end(), bin.begin());
+    vector<uint64_t> order(n);
+    vector<uint64_t> pos(n);
+    {
+        vector<uint64_t> next(bin.begin(), bin.end() - 1);
+        for (uint64_t v = 0; v < n; ++v) {
+            pos[v] = next[deg[v]]++;
+            order[pos[v]] = v;
+        }
+    }
+    //Take vertex in order of current degree. A neighbour with a bigger
+    //degree moves to the start of its bin, and the bin shrinks by one
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t v = order[i];
+        for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+            uint64_t u = *a;
+            if (deg[u] > deg[v]) {
+                uint64_t du = deg[u];
+                uint64_t pu = pos[u];
+                uint64_t pw = bin[du];
+                uint64_t w = order[pw];
+                if (u != w) {
+                    order[pu] = w;
+                    pos[w] = pu;
+                    order[pw] = u;
+                    pos[u] = pw;
+                }
+                ++bin[du];
+                --deg[u];
+            }
+        }
+    }
+}
+
+void CoreDecomposition::peelingCores (const unsigned& numThreads) {
+    uint64_t n = graph.getNumVertex();
+    unique_ptr<atomic<uint64_t>[]> deg(new atomic<uint64_t>[n]);
+    vector<uint8_t> removed(n, 0);
+    parallelFor(0, n, [&](uint64_t v) { deg[v].store(degreeNoLoops(v), memory_order_relaxed); }, 1024, numThreads);
+    
+    unsigned threads = (numThreads == 0) ? getNumThreads() : numThreads;
+    vector<vector<uint64_t> > found(threads);
+    vector<uint64_t> frontier;
+    uint64_t remaining = n;
+    uint64_t k = 0;
+    while (remaining) {
+        //Start the level with all remaining vertex of degree k or less
+        parallelForThread(0, n, [&](unsigned tID, uint64_t v) {
+            if (!removed[v] && (deg[v].load(memory_order_relaxed) <= k)) {
+                found[tID].push_back(v);
+            }
+        }, 4096, threads);
+        frontier.clear();
+        for (auto& f : found) {
+            frontier.insert(frontier.end(), f.begin(), f.end());
+            f.clear();
+        }
+        while (!frontier.empty()) {
+            for (auto v : frontier) {
+                removed[v] = 1;
+                core[v] = k;
+            }
+            remaining -= frontier.size();
+            //A neighbour going from k+1 to k joins the next round, exactly once
+            parallelForThread(0, frontier.size(), [&](unsigned tID, uint64_t i) {
+                uint64_t v = frontier[i];
+                for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+                    if (!removed[*a] && (deg[*a].fetch_sub(1, memory_order_relaxed) == k + 1)) {
+                        found[tID].push_back(*a);
+                    }
+                }
+            }, 64, threads);
+            frontier.clear();
+            for (auto& f : found) {
+                frontier.insert(frontier.end(), f.begin(), f.end());
+                f.clear();
+            }
+        }
+        //Jump to the smallest degree left
+        uint64_t next = UINT64_MAX;
+        for (uint64_t v = 0; v < n; ++v) {
+            if (!removed[v]) {
+                next = min(next, deg[v].load(memory_order_relaxed));
+            }
+        }
+        k = max(k + 1, next);
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ * kcore.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_kcore_h
+#define dasel_kcore_h
+
+#include <vector>
+#include <stdint.h>
+#include "compact-graph.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Computes the k-core decomposition of an undirected graph.
+///
+/// The core number of a vertex is the largest k such that the vertex
+/// belongs to a subgraph where every vertex has degree k or more. Self loops
+/// are not counted in the degree.
+///
+/// Two algorithms are available:
+///   * Batagelj-Zaversnik: sequential, O(V + E), keeps the vertex in buckets
+///     by current degree and always removes one with the smallest degree.
+///   * Parallel peeling: for increasing k, removes all vertex of degree k or
+///     less in rounds. Each round decrements the degree of the neighbours in
+///     parallel with atomic operations, and the vertex whose degree drops to
+///     k form the next round.
+///
+/// The decomposition works on a CompactGraph snapshot, so the source graph
+/// is never modified.
+///
+class CoreDecomposition {
+public:
+    /// Algorithm used to compute the core numbers
+    enum tAlgorithm {
+        kBucket,    ///< Sequential Batagelj-Zaversnik
+        kPeeling    ///< Parallel peeling
+    };
+    ///
+    /// \brief Computes the decomposition of an undirected graph
+    ///
+    /// \param g Graph to decompose. Its initial degrees come from getDeg()
+    /// \param algorithm Algorithm to use
+    /// \param numThreads Number of threads for kPeeling. 0 uses all hardware threads
+    //
+    explicit CoreDecomposition (const UndirectedGraph& g, const tAlgorithm& algorithm=kPeeling, const unsigned& numThreads=0);
+    ///Computes the decomposition of an undirected compact graph
+    explicit CoreDecomposition (const CompactGraph& g, const tAlgorithm& algorithm=kPeeling, const unsigned& numThreads=0);
+    ///Returns the largest core number in the graph
+    uint64_t getMaxCore () const { return maxCore; }
+    ///Returns the core number of the vertex with the given ID, 0 if it is not in the graph
+    uint64_t getCoreNumber (const uint64_t& vID) const;
+    ///Returns the core numbers, indexed by vertex index of getGraph()
+    const vector<uint64_t>& getCoreNumbers () const { return core; }
+    ///Returns the snapshot the decomposition was computed on
+    const CompactGraph& getGraph () const { return graph; }
+    ///Returns the subgraph induced by the vertex with core number k or more
+    CompactGraph getCore (const uint64_t& k) const;
+    ///Returns the subgraph induced by the vertex in the max core
+    CompactGraph getMaxCoreSubgraph () const { return getCore(maxCore); }
+    
+private:
+    CompactGraph graph;     ///Snapshot of the decomposed graph
+    vector<uint64_t> core;  ///Core number per vertex index
+    uint64_t maxCore;       ///Largest core number
+    
+    ///Computes the core numbers with the selected algorithm
+    void decompose (const tAlgorithm& algorithm, const unsigned& numThreads);
+    ///Batagelj-Zaversnik bucket algorithm
+    void bucketCores ();
+    ///Parallel level-by-level peeling
+    void peelingCores (const unsigned& numThreads);
+    ///Returns the degree of a vertex ignoring self loops
+    uint64_t degreeNoLoops (const uint64_t& v) const { return graph.getDeg(v) - (graph.isEdge(v, v) ? 1 : 0); }
+};
+
+#endif /* dasel_kcore_h */
@@ -0,0 +1,292 @@
+/**
+* louds-trie.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+
+#include <stdexcept>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "louds-trie.hpp"
+
+const LoudsTrie::TNodeIndex LoudsTrie::kNoNode;
+const uint64_t LoudsTrie::kSuperBits;
+const uint64_t LoudsTrie::kSelectSample;
+const uint64_t LoudsTrie::kLetterBits;
+
+//#/////////////////////////////////////////////////
+// File format helpers
+//
+namespace {
+    const char kMagic[8] = {'D', 'A', 'S', 'E', 'L', 'L', 'D', 'S'};
+    const uint64_t kVersion = 1;
+    
+    ///Fixed size header at the start of the file
+    struct tHeader {
+        char magic[8];
+        uint64_t version;
+        uint64_t numNodes;
+        uint64_t dictionarySize;
+        uint64_t size;          //Bytes of the whole file
+    };
+    
+    ///Sizes of the arrays following the header, in 64 bit words
+    struct tLayout {
+        uint64_t loudsWords;
+        uint64_t wordWords;
+        uint64_t letterWords;
+        uint64_t numSuper;
+        uint64_t rankWords;
+        uint64_t numSamples;
+        uint64_t sampleWords;
+        uint64_t size;          //Bytes of the whole file
+        tLayout (const uint64_t& numNodes, const uint64_t& superBits, const uint64_t& selectSample, const uint64_t& letterBits) {
+            //A 1 per node but the root, and a 0 per node
+            loudsWords = (2 * numNodes - 1 + 63) / 64;
+            wordWords = (numNodes + 63) / 64;
+            //One spare word, so a letter can always be read with 2 words
+            letterWords = ((numNodes - 1) * letterBits + 63) / 64 + 1;
+            numSuper = (loudsWords * 64 + superBits - 1) / superBits;
+            rankWords = (numSuper + 1) / 2;
+            numSamples = (numNodes + selectSample - 1) / selectSample;
+            sampleWords = (numSamples + 1) / 2;
+            size = sizeof(tHeader) + 8 * (loudsWords + wordWords + letterWords + rankWords + sampleWords);
+        }
+    };
+}
+
+void LoudsTrie::freeze (const Trie& trie, const string& fileName) {
+    //Number the nodes in level order, children in alphabetical order
+    vector<Trie::TNodeIndex> order(1, 0);
+    order.reserve(trie.getNumNodes());
+    uint64_t numNodes = trie.getNumNodes();
+    tLayout layout(numNodes, kSuperBits, kSelectSample, kLetterBits);
+    vector<uint64_t> loudsBits(layout.loudsWords, ~0ULL);
+    vector<uint64_t> words(layout.wordWords, 0);
+    vector<uint64_t> letterBits(layout.letterWords, 0);
+    uint64_t pos = 0;
+    for (uint64_t x = 0; x < order.size(); ++x) {
+        const Trie::TrieNode& node = trie.getNode(order[x]);
+        if (node.isWord()) {
+            words[x >> 6] |= 1ULL << (x & 63);
+        }
+        for (char c = 'a'; c <= 'z'; ++c) {
+            Trie::TNodeIndex child = node.getChild(c);
+            if (child != Trie::kNoNode) {
+                //Letter of node order.size(), stored at position order.size() - 1
+                uint64_t bit = (order.size() - 1) * kLetterBits;
+                uint64_t letter = c - 'a';
+                letterBits[bit >> 6] |= letter << (bit & 63);
+                if ((bit & 63) > 64 - kLetterBits) {
+                    letterBits[(bit >> 6) + 1] |= letter >> (64 - (bit & 63));
+                }
+                order.push_back(child);
+                ++pos;
+            }
+        }
+        loudsBits[pos >> 6] &= ~(1ULL << (pos & 63));
+        ++pos;
+    }
+    //Rank and select indexes of the 0 bits
+    vector<uint32_t> rank(2 * layout.rankWords, 0);
+    vector<uint32_t> samples(2 * layout.sampleWords, 0);
+    uint64_t zeros = 0;
+    for (uint64_t w = 0; w < layout.loudsWords; ++w) {
+        if (w % (kSuperBits / 64) == 0) {
+            rank[w / (kSuperBits / 64)] = static_cast<uint32_t>(zeros);
+        }
+        uint64_t z = __builtin_popcountll(~loudsBits[w]);
+        //Samples falling in this word: zero number s * kSelectSample + 1
+        for (uint64_t s = (zeros + kSelectSample - 1) / kSelectSample; s * kSelectSample < zeros + z; ++s) {
+            samples[s] = static_cast<uint32_t>(w / (kSuperBits / 64));
+        }
+        zeros += z;
+    }
+    tHeader header;
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.numNodes = numNodes;
+    header.dictionarySize = trie.getDictionarySize();
+    header.size = layout.size;
+    ofstream out(fileName, ios::binary | ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(loudsBits.data()), loudsBits.size() * 8);
+    out.write(reinterpret_cast<const char*>(words.data()), words.size() * 8);
+    out.write(reinterpret_cast<const char*>(letterBits.data()), letterBits.size() * 8);
+    out.write(reinterpret_cast<const char*>(rank.data()), rank.size() * 4);
+    out.write(reinterpret_cast<const char*>(samples.data()), samples.size() * 4);
+    out.close();
+    if (!out) {
+        throw runtime_error("LoudsTrie: cannot write file " + fileName);
+    }
+}
+
+LoudsTrie::LoudsTrie (const string& fileName) : mapping(nullptr) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    struct stat st;
+    if ((fd < 0) || (fstat(fd, &st) != 0) || (st.st_size == 0)) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw runtime_error("LoudsTrie: cannot read file " + fileName);
+    }
+    size = st.st_size;
+    mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw runtime_error("LoudsTrie: cannot map file " + fileName);
+    }
+    try {
+        load(mapping, size);
+    }
+    catch (...) {
+        munmap(mapping, size);
+        throw;
+    }
+}
+
+LoudsTrie::LoudsTrie (const void* data, const uint64_t& bytes) : mapping(nullptr) {
+    load(data, bytes);
+}
+
+LoudsTrie::~LoudsTrie () {
+    if (mapping != nullptr) {
+        munmap(mapping, size);
+    }
+}
+
+void LoudsTrie::load (const void* data, const uint64_t& bytes) {
+    const tHeader* header = static_cast<const tHeader*>(data);
+    if ((reinterpret_cast<uintptr_t>(data) % 8 != 0) || (bytes < sizeof(tHeader)) ||
+        (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) || (header->version != kVersion) ||
+        (header->numNodes == 0) || (header->size != bytes)) {
+        throw runtime_error("LoudsTrie: wrong format");
+    }
+    tLayout layout(header->numNodes, kSuperBits, kSelectSample, kLetterBits);
+    if (layout.size != bytes) {
+        throw runtime_error("LoudsTrie: wrong format");
+    }
+    size = bytes;
+    numNodes = header->numNodes;
+    dictionarySize = header->dictionarySize;
+    loudsWords = layout.loudsWords;
+    numSuper = layout.numSuper;
+    numSamples = layout.numSamples;
+    louds = reinterpret_cast<const uint64_t*>(header + 1);
+    wordBits = louds + layout.loudsWords;
+    letters = wordBits + layout.wordWords;
+    rank0 = reinterpret_cast<const uint32_t*>(letters + layout.letterWords);
+    select0Samples = reinterpret_cast<const uint32_t*>(letters + layout.letterWords + layout.rankWords);
+}
+
+uint64_t LoudsTrie::select0 (const uint64_t& k) const {
+    //The samples narrow the search to a few blocks, and the rank of the
+    //blocks to one
+    uint64_t s = (k - 1) / kSelectSample;
+    if (s >= numSamples) {
+        throw runtime_error("LoudsTrie: corrupt data");
+    }
+    uint64_t lo = select0Samples[s];
+    uint64_t hi = (s + 1 < numSamples) ? select0Samples[s + 1] + 1 : numSuper;
+    //A corrupt index must not lead outside the arrays
+    if ((lo >= hi) || (hi > numSuper) || (rank0[lo] > k - 1)) {
+        throw runtime_error("LoudsTrie: corrupt data");
+    }
+    uint64_t block = upper_bound(rank0 + lo, rank0 + hi, k - 1) - rank0 - 1;
+    uint64_t left = k - rank0[block];
+    //Nor a degree sequence lacking the 0 bit
+    for (uint64_t w = block * (kSuperBits / 64); w < loudsWords; ++w) {
+        uint64_t bits = ~louds[w];
+        uint64_t z = __builtin_popcountll(bits);
+        if (left <= z) {
+            for (; left > 1; --left) {
+                bits &= bits - 1;
+            }
+            return w * 64 + __builtin_ctzll(bits);
+        }
+        left -= z;
+    }
+    throw runtime_error("LoudsTrie: corrupt data");
+}
+
+uint64_t LoudsTrie::nextZero (uint64_t pos) const {
+    if ((pos >> 6) >= loudsWords) {
+        throw runtime_error("LoudsTrie: corrupt data");
+    }
+    uint64_t bits = ~louds[pos >> 6] >> (pos & 63);
+    if (bits != 0) {
+        return pos + __builtin_ctzll(bits);
+    }
+    for (uint64_t w = (pos >> 6) + 1; w < loudsWords; ++w) {
+        if (louds[w] != ~0ULL) {
+            return w * 64 + __builtin_ctzll(~louds[w]);
+        }
+    }
+    throw runtime_error("LoudsTrie: corrupt data");
+}
+
+uint8_t LoudsTrie::getLetter (const uint64_t& i) const {
+    uint64_t bit = i * kLetterBits;
+    uint64_t v = letters[bit >> 6] >> (bit & 63);
+    if ((bit & 63) > 64 - kLetterBits) {
+        v |= letters[(bit >> 6) + 1] << (64 - (bit & 63));
+    }
+    return v & ((1 << kLetterBits) - 1);
+}
+
+uint64_t LoudsTrie::getNumChildren (const TNodeIndex& idx) const {
+    uint64_t start = (idx == 0) ? 0 : select0(idx) + 1;
+    return nextZero(start) - start;
+}
+
+LoudsTrie::TNodeIndex LoudsTrie::getChild (const TNodeIndex& idx, const char& letter) const {
+    char c = tolower(letter);
+    if ((c < 'a') || (c > 'z')) {
+        throw out_of_range("LoudsTrie: Character out of range");
+    }
+    //The block of node idx follows its idx-th 0, and its 1s are the nodes
+    //numbered from the 1s before it, plus one
+    uint64_t start = (idx == 0) ? 0 : select0(idx) + 1;
+    uint64_t end = nextZero(start);
+    for (uint64_t child = start - idx + 1; child <= end - idx; ++child) {
+        uint8_t l = getLetter(child - 1);
+        if (l >= c - 'a') {
+            return (l == c - 'a') ? child : kNoNode;
+        }
+    }
+    return kNoNode;
+}
+
+LoudsTrie::TNodeIndex LoudsTrie::searchWord (const string& word, const bool& isWhole) const {
+    TNodeIndex current = 0;
+    for (auto c : word) {
+        if ((current = getChild(current, c)) == kNoNode) {
+            return kNoNode;
+        }
+    }
+    return (!isWhole || isWordNode(current)) ? current : kNoNode;
+}
@@ -0,0 +1,146 @@
+/**
+ * louds-trie.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_louds_trie_h
+#define dasel_louds_trie_h
+
+#include <string>
+#include <stdint.h>
+#include "trie.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Implements a static succinct trie, in the LOUDS (level order
+/// unary degree sequence) representation, read straight from a file.
+///
+/// freeze() writes the words of a Trie to a file. The trie shape is stored
+/// as a bit string: the nodes in level order, each one as a 1 per child
+/// followed by a 0. Nodes are numbered in the same order, root 0. The
+/// children of node x are described after the x-th 0, and are numbered
+/// consecutively from the position of that block, so one select on the 0
+/// bits finds both the degree and the first child of a node. Letters take
+/// 5 bits per node, and whole words 1 bit per node, which adds up to about
+/// 8.2 bits per node, plus some 7% for the select index.
+///
+/// The file is a header followed by arrays of 64 bit words, in the native
+/// byte order, which are used in place: the constructor maps the file in
+/// memory, and lookups read the mapped pages with no deserialisation. The
+/// mapping is shared by all the processes opening the same file.
+///
+/// The trie is read only. It supports the lookups of Trie, with the same
+/// alphabet of english letters, not case sensitive. Lookups never read
+/// past the degree sequence: on a corrupt file they throw runtime_error.
+///
+class LoudsTrie {
+public:
+    /// Index of a node, in level order
+    typedef uint64_t TNodeIndex;
+    /// Index standing for no node
+    static const TNodeIndex kNoNode = UINT64_MAX;
+    
+    ///
+    /// \brief Opens a file created by freeze(), mapping it in memory
+    ///
+    /// \param fileName File to open
+    /// \throw runtime_error if the file cannot be read or has a wrong format
+    //
+    explicit LoudsTrie (const string& fileName);
+    ///
+    /// \brief Uses the contents of a file created by freeze(), already in
+    /// memory. The bytes are not copied, and must outlive the trie
+    ///
+    /// \param data Contents of the file, aligned to 8 bytes
+    /// \param size Size of the contents, in bytes
+    /// \throw runtime_error if the contents have a wrong format
+    //
+    LoudsTrie (const void* data, const uint64_t& size);
+    /// Unmaps the file, if any
+    ~LoudsTrie ();
+    LoudsTrie (const LoudsTrie&) = delete;
+    LoudsTrie& operator = (const LoudsTrie&) = delete;
+    ///
+    /// \brief Writes the words of a trie to a file
+    ///
+    /// \param trie Trie to write
+    /// \param fileName Output file
+    /// \throw runtime_error if the file cannot be written
+    //
+    static void freeze (const Trie& trie, const string& fileName);
+    
+    ///
+    ///  \brief Searches a word in the trie
+    ///
+    ///  \param word Word to search for
+    ///  \param isWhole True if it should match whole words only
+    ///  \return Index of the ending node for the word. kNoNode if the word
+    /// is not part of the trie
+    //
+    TNodeIndex searchWord (const string& word, const bool& isWhole=true) const;
+    /// Returns true if the given string is a prefix or word in the dictionary
+    bool isPrefix (const string& prefix) const { return searchWord(prefix, false) != kNoNode; }
+    /// Returns true if the given string is a word in the dictionary
+    bool isWord (const string& word) const { return searchWord(word, true) != kNoNode; }
+    ///Returns the number of whole words in the dictionary
+    uint64_t getDictionarySize () const { return dictionarySize; }
+    ///Returns the root node
+    TNodeIndex getRoot () const { return 0; }
+    ///Returns the letter of the edge into a node, 0 for the root
+    char getContent (const TNodeIndex& idx) const { return (idx == 0) ? 0 : 'a' + getLetter(idx - 1); }
+    ///Indicates if the node represents the end of a whole word
+    bool isWordNode (const TNodeIndex& idx) const { return (wordBits[idx >> 6] >> (idx & 63)) & 1; }
+    ///Returns the number of direct descendants of a node
+    uint64_t getNumChildren (const TNodeIndex& idx) const;
+    ///Returns the child of a node for a letter, kNoNode if there is none
+    TNodeIndex getChild (const TNodeIndex& idx, const char& letter) const;
+    ///Returns the number of nodes in the trie, the root included
+    uint64_t getNumNodes () const { return numNodes; }
+    ///Returns the size of the file, in bytes
+    uint64_t getMemoryUsage () const { return size; }
+    
+private:
+    static const uint64_t kSuperBits = 512;     ///Bits per block of the rank index
+    static const uint64_t kSelectSample = 512;  ///0 bits per sample of the select index
+    static const uint64_t kLetterBits = 5;      ///Bits per letter
+    void* mapping;              ///Mapped file, null if the data belongs to the caller
+    uint64_t size;              ///Bytes of data
+    uint64_t numNodes;
+    uint64_t dictionarySize;
+    const uint64_t* louds;      ///Degree sequence, padded with 1s
+    uint64_t loudsWords;
+    const uint64_t* wordBits;   ///Whole word marker per node
+    const uint64_t* letters;    ///Letter per node but the root, kLetterBits each
+    const uint32_t* rank0;      ///0 bits before each block of kSuperBits
+    uint64_t numSuper;
+    const uint32_t* select0Samples; ///Block holding each kSelectSample-th 0 bit
+    uint64_t numSamples;
+    ///Points the arrays into the data, checking its format
+    void load (const void* data, const uint64_t& bytes);
+    ///Returns the position of the k-th 0 bit, counting from 1
+    uint64_t select0 (const uint64_t& k) const;
+    ///Returns the position of the first 0 bit from a position on
+    uint64_t nextZero (uint64_t pos) const;
+    ///Returns the letter index of the i-th node after the root
+    uint8_t getLetter (const uint64_t& i) const;
+};
+
+#endif /* dasel_louds_trie_h */
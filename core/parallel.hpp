@@ -0,0 +1,115 @@
+/**
+ * parallel.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_parallel_h
+#define dasel_parallel_h
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <stdint.h>
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Minimal helpers to run loops over several threads, using only the
+/// C++11 standard library.
+///
+/// Work is handed out in chunks of consecutive indexes through an atomic
+/// counter, so threads that finish early keep taking work from the rest
+/// (dynamic scheduling).
+///
+
+/// Returns the number of worker threads used by default (at least 1)
+inline unsigned getNumThreads () {
+    unsigned n = thread::hardware_concurrency();
+    return (n == 0) ? 1 : n;
+}
+
+///
+/// \brief Runs "f(threadID)" once on each of "numThreads" threads, and waits
+/// for all of them to finish. Thread 0 runs on the calling thread.
+///
+/// \param numThreads Number of threads. 0 uses getNumThreads()
+/// \param f Callable receiving the thread index in [0, numThreads)
+//
+template <class TFunc>
+void parallelRun (unsigned numThreads, TFunc f) {
+    if (numThreads == 0) {
+        numThreads = getNumThreads();
+    }
+    vector<thread> workers;
+    workers.reserve(numThreads - 1);
+    for (unsigned t = 1; t < numThreads; ++t) {
+        workers.push_back(thread(f, t));
+    }
+    f(0u);
+    for (auto& w : workers) {
+        w.join();
+    }
+}
+
+///
+/// \brief Calls "f(threadID, i)" for every i in [begin, end), splitting the
+/// range in chunks of "grain" indexes over several threads.
+///
+/// \param begin First index
+/// \param end Past-the-end index
+/// \param f Callable receiving the thread index and the loop index
+/// \param grain Number of consecutive indexes taken by a thread at a time
+/// \param numThreads Number of threads. 0 uses getNumThreads()
+//
+template <class TFunc>
+void parallelForThread (const uint64_t& begin, const uint64_t& end, TFunc f, const uint64_t& grain=1024, unsigned numThreads=0) {
+    if (begin >= end) {
+        return;
+    }
+    if (numThreads == 0) {
+        numThreads = getNumThreads();
+    }
+    uint64_t numChunks = (end - begin + grain - 1) / grain;
+    if (numChunks < numThreads) {
+        numThreads = static_cast<unsigned>(numChunks);
+    }
+    atomic<uint64_t> next(begin);
+    parallelRun(numThreads, [&](unsigned tID) {
+        uint64_t first;
+        while ((first = next.fetch_add(grain)) < end) {
+            uint64_t last = (end - first < grain) ? end : first + grain;
+            for (uint64_t i = first; i < last; ++i) {
+                f(tID, i);
+            }
+        }
+    });
+}
+
+///
+/// \brief Calls "f(i)" for every i in [begin, end) over several threads.
+///
+/// See parallelForThread() for the meaning of the parameters
+//
+template <class TFunc>
+void parallelFor (const uint64_t& begin, const uint64_t& end, TFunc f, const uint64_t& grain=1024, unsigned numThreads=0) {
+    parallelForThread(begin, end, [&f](unsigned, uint64_t i) { f(i); }, grain, numThreads);
+}
+
+#endif /* dasel_parallel_h */
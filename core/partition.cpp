@@ -0,0 +1,138 @@
+/**
+* partition.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include "partition.hpp"
+#include "rng.hpp"
+
+namespace {
+    ///Exponent of the Fennel part size penalty
+    const double kFennelGamma = 1.5;
+}
+
+//#/////////////////////////////////////////////////
+// GraphPartitioner
+//
+GraphPartitioner::GraphPartitioner (const UndirectedGraph& g, const uint64_t& rngSeed) : graph(g), seed(rngSeed) {
+}
+
+GraphPartitioner::GraphPartitioner (const DirectedGraph& g, const uint64_t& rngSeed) : graph(g), reverse(graph.transpose()), seed(rngSeed) {
+}
+
+GraphPartitioner::GraphPartitioner (const CompactGraph& g, const uint64_t& rngSeed) : graph(g), seed(rngSeed) {
+    if (graph.isDirected()) {
+        reverse = graph.transpose();
+    }
+}
+
+GraphPartitioner::tPartition GraphPartitioner::partition (const uint64_t& numParts, const tMethod& method, const uint64_t& passes, const double& slack) const {
+    if ((numParts == 0) || (passes == 0) || !(slack >= 1.0)) {
+        throw invalid_argument("GraphPartitioner: numParts and passes must be positive, and slack at least 1");
+    }
+    uint64_t n = graph.getNumVertex();
+    //Random stream order
+    vector<uint64_t> order(n);
+    iota(order.begin(), order.end(), 0);
+    SplitMix64 rng(seed);
+    for (uint64_t i = n; i > 1; --i) {
+        swap(order[i - 1], order[rng.nextBelow(i)]);
+    }
+    double capacity = max(1.0, ceil(slack * n / numParts));
+    double alpha = (n == 0) ? 0 : sqrt(static_cast<double>(numParts)) * graph.getNumEdges() / pow(static_cast<double>(n), kFennelGamma);
+    vector<uint64_t> part(n, kNoVertex);
+    vector<uint64_t> size(numParts, 0);
+    vector<uint64_t> count(numParts, 0);
+    vector<uint64_t> touched;
+    auto countNeighbours = [&](const CompactGraph& g, const uint64_t& v) {
+        for (const uint64_t* a = g.adjBegin(v); a != g.adjEnd(v); ++a) {
+            if ((*a != v) && (part[*a] != kNoVertex) && (count[part[*a]]++ == 0)) {
+                touched.push_back(part[*a]);
+            }
+        }
+    };
+    for (uint64_t pass = 0; pass < passes; ++pass) {
+        for (auto v : order) {
+            if (part[v] != kNoVertex) {
+                --size[part[v]];
+            }
+            countNeighbours(graph, v);
+            if (graph.isDirected()) {
+                countNeighbours(reverse, v);
+            }
+            uint64_t best = kNoVertex;
+            double bestScore = 0;
+            for (uint64_t p = 0; p < numParts; ++p) {
+                if (size[p] >= capacity) {
+                    continue;
+                }
+                double score;
+                if (method == kLDG) {
+                    score = count[p] * (1.0 - size[p] / capacity);
+                }
+                else {
+                    score = count[p] - alpha * kFennelGamma * pow(static_cast<double>(size[p]), kFennelGamma - 1);
+                }
+                if ((best == kNoVertex) || (score > bestScore) || ((score == bestScore) && (size[p] < size[best]))) {
+                    best = p;
+                    bestScore = score;
+                }
+            }
+            part[v] = best;
+            ++size[best];
+            for (auto p : touched) {
+                count[p] = 0;
+            }
+            touched.clear();
+        }
+    }
+    return evaluate(part, numParts);
+}
+
+GraphPartitioner::tPartition GraphPartitioner::evaluate (const vector<uint64_t>& part, const uint64_t& numParts) const {
+    uint64_t n = graph.getNumVertex();
+    if ((numParts == 0) || (part.size() != n)) {
+        throw invalid_argument("GraphPartitioner: one part per vertex expected");
+    }
+    tPartition result;
+    result.part = part;
+    result.numParts = numParts;
+    result.partSize.assign(numParts, 0);
+    result.edgeCut = 0;
+    for (uint64_t v = 0; v < n; ++v) {
+        if (part[v] >= numParts) {
+            throw invalid_argument("GraphPartitioner: part out of range");
+        }
+        ++result.partSize[part[v]];
+        for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+            //Undirected edges are stored from both ends, count them from the smaller one
+            if ((graph.isDirected() || (*a > v)) && (part[*a] != part[v])) {
+                ++result.edgeCut;
+            }
+        }
+    }
+    result.cutFraction = (graph.getNumEdges() == 0) ? 0 : static_cast<double>(result.edgeCut) / graph.getNumEdges();
+    uint64_t biggest = *max_element(result.partSize.begin(), result.partSize.end());
+    result.balance = (n == 0) ? 1 : biggest * static_cast<double>(numParts) / n;
+    return result;
+}
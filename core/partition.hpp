@@ -0,0 +1,107 @@
+/**
+ * partition.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_partition_h
+#define dasel_partition_h
+
+#include <vector>
+#include <stdint.h>
+#include "compact-graph.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Splits a graph into K parts with a streaming edge-cut partitioner.
+///
+/// Vertex are visited once per pass, in a random order, and placed in the
+/// part with the best score given the parts of their neighbours already
+/// placed (both edge directions count in a directed graph):
+///   * LDG (Linear Deterministic Greedy): neighbours in the part times
+///     (1 - partSize / capacity).
+///   * Fennel: neighbours in the part minus alpha * gamma * partSize^(gamma-1),
+///     with gamma = 1.5 and alpha = sqrt(K) * E / V^1.5.
+/// Ties go to the smallest part. No part grows past the capacity,
+/// slack * V / K. Later passes restream the vertex: each one is taken out of
+/// its part and placed again, now seeing all its neighbours, which lowers
+/// the cut of the first pass.
+///
+/// The cost of a pass is O(E + V * K). The partitioner works on a snapshot,
+/// so the source graph is never modified.
+///
+class GraphPartitioner {
+public:
+    /// Scoring function used to place the vertex
+    enum tMethod {
+        kLDG,       ///< Linear Deterministic Greedy
+        kFennel     ///< Fennel
+    };
+    /// Assignment of the vertex to parts, and its quality
+    struct tPartition {
+        vector<uint64_t> part;      ///< Part of every vertex index, in [0, numParts)
+        uint64_t numParts;          ///< Number of parts
+        vector<uint64_t> partSize;  ///< Vertex in every part
+        uint64_t edgeCut;           ///< Edges with their ends in different parts
+        double cutFraction;         ///< Fraction of the edges cut
+        double balance;             ///< Biggest part over the average part. 1 is perfect
+    };
+    
+    ///
+    /// \brief Creates a partitioner for an undirected graph
+    ///
+    /// \param g Graph to partition
+    /// \param rngSeed Seed for the stream order
+    //
+    explicit GraphPartitioner (const UndirectedGraph& g, const uint64_t& rngSeed=0);
+    ///Creates a partitioner for a directed graph
+    explicit GraphPartitioner (const DirectedGraph& g, const uint64_t& rngSeed=0);
+    ///Creates a partitioner for a compact graph
+    explicit GraphPartitioner (const CompactGraph& g, const uint64_t& rngSeed=0);
+    ///Returns the snapshot being partitioned
+    const CompactGraph& getGraph () const { return graph; }
+    ///Returns the in connections of every vertex for a directed graph, and an empty graph otherwise
+    const CompactGraph& getReverse () const { return reverse; }
+    ///
+    /// \brief Partitions the graph
+    ///
+    /// \param numParts Number of parts, 1 or more
+    /// \param method Scoring function
+    /// \param passes Streaming passes, 1 or more
+    /// \param slack Capacity of a part over the average part size, 1 or more
+    /// \throw invalid_argument if a parameter is out of range
+    //
+    tPartition partition (const uint64_t& numParts, const tMethod& method=kFennel, const uint64_t& passes=2, const double& slack=1.05) const;
+    ///
+    /// \brief Computes the quality of a given assignment
+    ///
+    /// \param part Part of every vertex index
+    /// \param numParts Number of parts. Every element of part must be smaller
+    /// \return Partition with the given assignment and its statistics
+    //
+    tPartition evaluate (const vector<uint64_t>& part, const uint64_t& numParts) const;
+    
+private:
+    CompactGraph graph;     ///Snapshot of the graph
+    CompactGraph reverse;   ///In connections for a directed graph
+    uint64_t seed;          ///Seed for the stream order
+};
+
+#endif /* dasel_partition_h */
@@ -0,0 +1,546 @@
+/**
+* persistent-graph.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <stdexcept>
+#include <fstream>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "persistent-graph.hpp"
+
+//#/////////////////////////////////////////////////
+// File format helpers
+//
+namespace {
+    const char kSnapshotMagic[8] = {'D', 'A', 'S', 'E', 'L', 'S', 'N', 'P'};
+    const uint64_t kVersion = 1;
+    
+    ///Log record kinds
+    const uint8_t kAddVertex = 1;
+    const uint8_t kRemoveVertex = 2;
+    const uint8_t kAddEdge = 3;
+    const uint8_t kRemoveEdge = 4;
+    ///Size of a log record: kind and 2 IDs
+    const uint64_t kRecordSize = 1 + 2 * sizeof(uint64_t);
+    ///Edges per batch when loading a snapshot
+    const uint64_t kLoadBatch = 1 << 20;
+    
+    ///Fixed size header at the start of a snapshot file
+    struct tSnapshotHeader {
+        char magic[8];
+        uint64_t version;
+        uint64_t segment;       //First log segment not covered by the snapshot
+        uint64_t numVertex;
+        uint64_t numEdges;
+    };
+    
+    ///Header of a log frame
+    struct tFrameHeader {
+        uint64_t size;          //Bytes of records in the frame
+        uint64_t checksum;      //FNV-1a of the records
+    };
+    
+    ///Returns the 64 bit FNV-1a hash of a buffer
+    uint64_t checksum (const uint8_t* data, const uint64_t& size) {
+        uint64_t h = 0xCBF29CE484222325ULL;
+        for (uint64_t i = 0; i < size; ++i) {
+            h = (h ^ data[i]) * 0x100000001B3ULL;
+        }
+        return h;
+    }
+    
+    ///Writes the whole buffer to a file descriptor
+    void writeAll (const int& fd, const void* data, uint64_t size, const string& name) {
+        const char* p = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t written = ::write(fd, p, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw runtime_error("PersistentGraph: error writing file " + name);
+            }
+            p += written;
+            size -= written;
+        }
+    }
+    
+    ///Flushes a file, or a directory entry, to disk
+    void syncFile (const int& fd, const string& name) {
+        if (fsync(fd) != 0) {
+            throw runtime_error("PersistentGraph: cannot sync file " + name);
+        }
+    }
+    
+    ///Flushes the entries of a directory to disk, so renames and new files survive a crash
+    void syncDirectory (const string& dir) {
+        int fd = open(dir.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            fsync(fd);
+            close(fd);
+        }
+    }
+    
+    ///Writes a snapshot: to a temporary file first, renamed once complete and on disk
+    void writeSnapshot (const string& dir, const string& name, const uint64_t& segment, const vector<uint64_t>& ids,
+                        const vector<pair<uint64_t, uint64_t> >& edges) {
+        string tmp = name + ".tmp";
+        int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw runtime_error("PersistentGraph: cannot write file " + tmp);
+        }
+        try {
+            tSnapshotHeader header;
+            memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+            header.version = kVersion;
+            header.segment = segment;
+            header.numVertex = ids.size();
+            header.numEdges = edges.size();
+            writeAll(fd, &header, sizeof(header), tmp);
+            writeAll(fd, ids.data(), ids.size() * sizeof(uint64_t), tmp);
+            writeAll(fd, edges.data(), edges.size() * sizeof(edges[0]), tmp);
+            syncFile(fd, tmp);
+        }
+        catch (...) {
+            close(fd);
+            remove(tmp.c_str());
+            throw;
+        }
+        close(fd);
+        if (rename(tmp.c_str(), name.c_str()) != 0) {
+            throw runtime_error("PersistentGraph: cannot rename file " + tmp);
+        }
+        syncDirectory(dir);
+    }
+    
+    ///Lists the numbers of the files named prefix<number>suffix in a directory, sorted
+    vector<uint64_t> listFiles (const string& dir, const string& prefix, const string& suffix) {
+        vector<uint64_t> numbers;
+        DIR* d = opendir(dir.c_str());
+        if (d == nullptr) {
+            throw runtime_error("PersistentGraph: cannot read directory " + dir);
+        }
+        for (dirent* entry = readdir(d); entry != nullptr; entry = readdir(d)) {
+            string name(entry->d_name);
+            if ((name.size() > prefix.size() + suffix.size()) && (name.compare(0, prefix.size(), prefix) == 0) &&
+                (name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)) {
+                string digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+                if (digits.find_first_not_of("0123456789") == string::npos) {
+                    numbers.push_back(stoull(digits));
+                }
+            }
+        }
+        closedir(d);
+        sort(numbers.begin(), numbers.end());
+        return numbers;
+    }
+    
+    //#/////////////////////////////////////////////////
+    /// Applies log records to a graph, grouping consecutive records of the
+    /// same kind into one batch call
+    //
+    class RecordReplayer {
+        UndirectedGraph& graph;
+        uint8_t kind;                               //Kind of the records pending
+        vector<pair<uint64_t, uint64_t> > edges;    //Pending edge records
+        vector<uint64_t> ids;                       //Pending vertex records
+    public:
+        RecordReplayer (UndirectedGraph& g) : graph(g), kind(0) { }
+        ///Queues a record, applying the pending ones first if of another kind
+        void add (const uint8_t& op, const uint64_t& a, const uint64_t& b) {
+            if (op != kind) {
+                apply();
+                kind = op;
+            }
+            if ((op == kAddEdge) || (op == kRemoveEdge)) {
+                edges.push_back(make_pair(a, b));
+            }
+            else {
+                ids.push_back(a);
+            }
+        }
+        ///Applies the pending records
+        void apply () {
+            switch (kind) {
+                case kAddVertex:
+                    for (auto vID : ids) {
+                        graph.addVertex(vID);
+                    }
+                    break;
+                case kRemoveVertex:
+                    graph.removeVertices(ids, true);
+                    break;
+                case kAddEdge:
+                    graph.addEdges(edges);
+                    break;
+                case kRemoveEdge:
+                    graph.removeEdges(edges, true);
+                    break;
+            }
+            edges.clear();
+            ids.clear();
+            kind = 0;
+        }
+    };
+}
+
+//#/////////////////////////////////////////////////
+// PersistentGraph
+//
+PersistentGraph::PersistentGraph (const string& directory, const uint64_t& groupBytes, const uint64_t& checkpointBytes, const bool& syncCommit) :
+    dir(directory), groupSize(groupBytes), checkpointSize(checkpointBytes), syncMode(syncCommit), lastLSN(0), durableLSN(0),
+    flushing(false), logFailed(false), logFile(-1), segment(0), logBytes(0), numFrames(0), maxFrameRecords(0), snapshotRunning(false), numCheckpoints(0) {
+    if ((mkdir(dir.c_str(), 0755) != 0) && (errno != EEXIST)) {
+        throw runtime_error("PersistentGraph: cannot create directory " + dir);
+    }
+    recover();
+}
+
+PersistentGraph::~PersistentGraph () {
+    try {
+        commit();
+    }
+    catch (...) {
+        //Nothing can be reported from a destructor. Uncommitted records are lost
+    }
+    waitCheckpoint();
+    if (logFile >= 0) {
+        close(logFile);
+    }
+}
+
+void PersistentGraph::addVertex (const uint64_t& vID) {
+    unique_lock<mutex> guard(lock);
+    checkLog();
+    graph.addVertex(vID);
+    logRecord(kAddVertex, vID, 0);
+    endMutation(guard);
+}
+
+void PersistentGraph::removeVertex (const uint64_t& vID) {
+    unique_lock<mutex> guard(lock);
+    checkLog();
+    graph.removeVertex(vID);
+    logRecord(kRemoveVertex, vID, 0);
+    endMutation(guard);
+}
+
+void PersistentGraph::addEdge (const uint64_t& from, const uint64_t& to) {
+    unique_lock<mutex> guard(lock);
+    checkLog();
+    graph.addVertex(from);
+    graph.addVertex(to);
+    graph.addEdge(from, to);
+    logRecord(kAddEdge, from, to);
+    endMutation(guard);
+}
+
+void PersistentGraph::removeEdge (const uint64_t& from, const uint64_t& to) {
+    unique_lock<mutex> guard(lock);
+    checkLog();
+    if (graph.isEdge(from, to)) {
+        graph.removeEdge(from, to);
+    }
+    logRecord(kRemoveEdge, from, to);
+    endMutation(guard);
+}
+
+void PersistentGraph::addEdges (const vector<pair<uint64_t, uint64_t> >& edges) {
+    unique_lock<mutex> guard(lock);
+    checkLog();
+    graph.addEdges(edges);
+    buffer.reserve(buffer.size() + edges.size() * kRecordSize);
+    for (auto& e : edges) {
+        logRecord(kAddEdge, e.first, e.second);
+    }
+    endMutation(guard);
+}
+
+void PersistentGraph::commit () {
+    unique_lock<mutex> guard(lock);
+    checkLog();
+    waitDurable(guard, lastLSN);
+}
+
+bool PersistentGraph::checkpoint () {
+    unique_lock<mutex> guard(lock);
+    return startCheckpoint(guard);
+}
+
+void PersistentGraph::waitCheckpoint () {
+    unique_lock<mutex> guard(lock);
+    if (snapshotWorker.joinable()) {
+        snapshotWorker.join();
+    }
+}
+
+void PersistentGraph::checkLog () const {
+    if (logFailed) {
+        throw runtime_error("PersistentGraph: the log failed, and takes no more mutations");
+    }
+}
+
+void PersistentGraph::logRecord (const uint8_t& op, const uint64_t& a, const uint64_t& b) {
+    uint8_t record[kRecordSize];
+    record[0] = op;
+    memcpy(record + 1, &a, sizeof(a));
+    memcpy(record + 1 + sizeof(a), &b, sizeof(b));
+    buffer.insert(buffer.end(), record, record + kRecordSize);
+    ++lastLSN;
+}
+
+void PersistentGraph::endMutation (unique_lock<mutex>& guard) {
+    if (syncMode || (buffer.size() >= groupSize)) {
+        waitDurable(guard, lastLSN);
+    }
+    if ((checkpointSize != 0) && (logBytes >= checkpointSize) && !snapshotRunning) {
+        startCheckpoint(guard);
+    }
+}
+
+void PersistentGraph::waitDurable (unique_lock<mutex>& guard, const uint64_t& lsn) {
+    while (durableLSN < lsn) {
+        checkLog();
+        if (flushing) {
+            flushed.wait(guard);
+            continue;
+        }
+        //Lead the group: write everything buffered so far, for all waiting threads
+        flushing = true;
+        vector<uint8_t> frame;
+        frame.swap(buffer);
+        uint64_t upTo = lastLSN;
+        int fd = logFile;
+        string name = path("wal-", segment, ".log");
+        guard.unlock();
+        off_t end = -1;
+        try {
+            if ((end = lseek(fd, 0, SEEK_END)) < 0) {
+                throw runtime_error("PersistentGraph: error writing file " + name);
+            }
+            tFrameHeader header = {frame.size(), checksum(frame.data(), frame.size())};
+            writeAll(fd, &header, sizeof(header), name);
+            writeAll(fd, frame.data(), frame.size(), name);
+            syncFile(fd, name);
+        }
+        catch (...) {
+            //A torn frame would stop recovery before any later frame: cut it,
+            //and keep its records ahead of those buffered meanwhile
+            bool cut = (end >= 0) && (ftruncate(fd, end) == 0);
+            guard.lock();
+            if (cut) {
+                frame.insert(frame.end(), buffer.begin(), buffer.end());
+                buffer.swap(frame);
+            }
+            else {
+                logFailed = true;
+            }
+            flushing = false;
+            flushed.notify_all();
+            throw;
+        }
+        guard.lock();
+        durableLSN = upTo;
+        logBytes += sizeof(tFrameHeader) + frame.size();
+        ++numFrames;
+        maxFrameRecords = max<uint64_t>(maxFrameRecords, frame.size() / kRecordSize);
+        flushing = false;
+        flushed.notify_all();
+    }
+}
+
+bool PersistentGraph::startCheckpoint (unique_lock<mutex>& guard) {
+    if (snapshotRunning) {
+        return false;
+    }
+    if (snapshotWorker.joinable()) {
+        snapshotWorker.join();
+    }
+    //The segment being closed must hold every record before the snapshot
+    while (flushing || (durableLSN < lastLSN)) {
+        waitDurable(guard, lastLSN);
+    }
+    openSegment(segment + 1);
+    logBytes = 0;
+    //Copy the graph, each edge once from its smaller end
+    shared_ptr<vector<uint64_t> > ids(new vector<uint64_t>());
+    shared_ptr<vector<pair<uint64_t, uint64_t> > > edges(new vector<pair<uint64_t, uint64_t> >());
+    ids->reserve(graph.getNumVertex());
+    edges->reserve(graph.getNumEdges());
+    for (UndirectedGraph::VertexIterator it = graph.begin(); it != graph.end(); it++) {
+        uint64_t vID = it->first;
+        ids->push_back(vID);
+        it->second.forEachAdj([&](const uint64_t& adjID) {
+            if (adjID >= vID) {
+                edges->push_back(make_pair(vID, adjID));
+            }
+        });
+    }
+    snapshotRunning = true;
+    uint64_t number = segment;
+    snapshotWorker = thread([this, ids, edges, number]() {
+        try {
+            writeSnapshot(dir, path("snapshot-", number, ".bin"), number, *ids, *edges);
+            //Older snapshots and segments are no longer needed
+            for (auto n : listFiles(dir, "snapshot-", ".bin")) {
+                if (n < number) {
+                    remove(path("snapshot-", n, ".bin").c_str());
+                }
+            }
+            for (auto n : listFiles(dir, "wal-", ".log")) {
+                if (n < number) {
+                    remove(path("wal-", n, ".log").c_str());
+                }
+            }
+            ++numCheckpoints;
+        }
+        catch (...) {
+            //The previous snapshot and segments are kept, so nothing is lost
+        }
+        snapshotRunning = false;
+    });
+    return true;
+}
+
+void PersistentGraph::openSegment (const uint64_t& number) {
+    string name = path("wal-", number, ".log");
+    int fd = open(name.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        throw runtime_error("PersistentGraph: cannot write file " + name);
+    }
+    syncDirectory(dir);
+    if (logFile >= 0) {
+        close(logFile);
+    }
+    logFile = fd;
+    segment = number;
+}
+
+void PersistentGraph::recover () {
+    recovery = tRecovery{0, 0, 0, 0, 0, 0, 0, 0};
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    //Leftovers of a checkpoint interrupted by a crash
+    for (auto n : listFiles(dir, "snapshot-", ".bin.tmp")) {
+        remove(path("snapshot-", n, ".bin.tmp").c_str());
+    }
+    //Latest complete snapshot
+    vector<uint64_t> snapshots = listFiles(dir, "snapshot-", ".bin");
+    for (vector<uint64_t>::reverse_iterator n = snapshots.rbegin(); n != snapshots.rend(); ++n) {
+        string name = path("snapshot-", *n, ".bin");
+        ifstream in(name.c_str(), ios::binary | ios::ate);
+        uint64_t fileSize = in.tellg();
+        in.seekg(0);
+        tSnapshotHeader header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) ||
+            (header.version != kVersion) ||
+            (fileSize != sizeof(header) + (header.numVertex + 2 * header.numEdges) * sizeof(uint64_t))) {
+            continue;
+        }
+        vector<uint64_t> ids(header.numVertex);
+        in.read(reinterpret_cast<char*>(ids.data()), ids.size() * sizeof(uint64_t));
+        graph = UndirectedGraph(header.numVertex);
+        for (auto vID : ids) {
+            graph.addVertex(vID);
+        }
+        vector<pair<uint64_t, uint64_t> > edges;
+        for (uint64_t done = 0; done < header.numEdges; done += edges.size()) {
+            edges.resize(min(kLoadBatch, header.numEdges - done));
+            in.read(reinterpret_cast<char*>(edges.data()), edges.size() * sizeof(edges[0]));
+            graph.addEdges(edges);
+        }
+        if (!in) {
+            throw runtime_error("PersistentGraph: cannot read file " + name);
+        }
+        recovery.snapshot = header.segment;
+        recovery.snapshotVertex = header.numVertex;
+        recovery.snapshotEdges = header.numEdges;
+        break;
+    }
+    chrono::steady_clock::time_point loaded = chrono::steady_clock::now();
+    recovery.loadSeconds = chrono::duration<double>(loaded - start).count();
+    //Log segments written after the snapshot, in order
+    RecordReplayer replayer(graph);
+    uint64_t last = recovery.snapshot;
+    bool torn = false;
+    for (auto n : listFiles(dir, "wal-", ".log")) {
+        string name = path("wal-", n, ".log");
+        if ((n < recovery.snapshot) || torn) {
+            remove(name.c_str());
+            continue;
+        }
+        ifstream in(name.c_str(), ios::binary);
+        vector<uint8_t> data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        if (data.empty()) {
+            //Opened but never written, usually by the previous recovery
+            remove(name.c_str());
+            continue;
+        }
+        uint64_t pos = 0;
+        while (pos < data.size()) {
+            tFrameHeader header;
+            if (data.size() - pos < sizeof(header)) {
+                break;
+            }
+            memcpy(&header, data.data() + pos, sizeof(header));
+            const uint8_t* records = data.data() + pos + sizeof(header);
+            if ((header.size > data.size() - pos - sizeof(header)) || (header.size % kRecordSize != 0) ||
+                (checksum(records, header.size) != header.checksum)) {
+                break;
+            }
+            for (uint64_t r = 0; r < header.size; r += kRecordSize) {
+                uint64_t a, b;
+                memcpy(&a, records + r + 1, sizeof(a));
+                memcpy(&b, records + r + 1 + sizeof(a), sizeof(b));
+                replayer.add(records[r], a, b);
+                ++recovery.records;
+            }
+            pos += sizeof(header) + header.size;
+        }
+        if (pos < data.size()) {
+            //A crash in the middle of a frame. Nothing after it was ever acknowledged
+            recovery.truncatedBytes += data.size() - pos;
+            if (truncate(name.c_str(), pos) != 0) {
+                throw runtime_error("PersistentGraph: cannot truncate file " + name);
+            }
+            torn = true;
+        }
+        ++recovery.segments;
+        last = max(last, n);
+    }
+    replayer.apply();
+    graph.compact();
+    recovery.replaySeconds = chrono::duration<double>(chrono::steady_clock::now() - loaded).count();
+    openSegment(last + 1);
+}
+
+string PersistentGraph::path (const string& prefix, const uint64_t& number, const string& suffix) const {
+    char digits[24];
+    snprintf(digits, sizeof(digits), "%020llu", static_cast<unsigned long long>(number));
+    return dir + "/" + prefix + digits + suffix;
+}
@@ -0,0 +1,183 @@
+/**
+ * persistent-graph.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_persistent_graph_h
+#define dasel_persistent_graph_h
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <stdint.h>
+#include "graph.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Keeps an undirected graph durable with a write-ahead log and
+/// snapshot checkpoints.
+///
+/// All state lives in a directory. Every mutation is applied to the graph in
+/// memory and appended to the current log segment as a fixed size binary
+/// record. Records are buffered and written in frames, each with its length
+/// and checksum, followed by an fsync:
+///
+///  * With group commit (syncCommit), a mutation returns once its record is
+///    on disk. Concurrent mutations share the write and fsync of one frame:
+///    the first thread to wait flushes the whole buffer for the others.
+///  * Otherwise, a frame is flushed when the buffer reaches groupBytes, or on
+///    commit().
+///
+/// A frame whose write or fsync fails is cut from the segment, and its
+/// records go back to the buffer, so the error is thrown to the caller and
+/// a later commit() writes them again. If the segment cannot be cut back,
+/// the log is failed: every later mutation and commit() throws.
+///
+/// A checkpoint starts a new log segment and copies the graph to a flat list
+/// of vertex and edges in memory. A background thread writes it to a
+/// snapshot file, and then deletes the older segments and snapshots.
+/// Mutations only wait for the copy, never for the disk. A checkpoint
+/// starts on its own once the log since the last one reaches checkpointBytes.
+///
+/// Opening a directory recovers the graph: the latest complete snapshot is
+/// loaded and the log segments after it are replayed. Consecutive records of
+/// the same kind are applied as one batch (addEdges, removeEdges,
+/// removeVertices), so restart time is dominated by the snapshot load. A
+/// torn frame at the end of the log, left by a crash, is truncated.
+///
+/// Mutations can be called from several threads. The graph returned by
+/// getGraph() must not be read while a mutation is running.
+///
+class PersistentGraph {
+public:
+    /// What recovery found when the directory was opened
+    struct tRecovery {
+        uint64_t snapshot;          ///< Segment the loaded snapshot precedes, 0 if none
+        uint64_t snapshotVertex;    ///< Vertex loaded from the snapshot
+        uint64_t snapshotEdges;     ///< Edges loaded from the snapshot
+        uint64_t segments;          ///< Log segments replayed
+        uint64_t records;           ///< Log records replayed
+        uint64_t truncatedBytes;    ///< Bytes dropped from a torn log tail
+        double loadSeconds;         ///< Time loading the snapshot
+        double replaySeconds;       ///< Time replaying the log
+    };
+    
+    ///
+    /// \brief Opens a graph directory, creating it if needed, and recovers its state
+    ///
+    /// \param directory Directory holding the snapshots and log segments
+    /// \param groupBytes Buffered log bytes which trigger a write without group commit
+    /// \param checkpointBytes Log bytes since the last checkpoint which trigger a new one. 0 disables
+    /// \param syncCommit True to return from each mutation only once it is durable
+    /// \throw runtime_error if the directory or its files cannot be read or written
+    //
+    explicit PersistentGraph (const string& directory, const uint64_t& groupBytes=(1 << 16),
+                              const uint64_t& checkpointBytes=(1 << 26), const bool& syncCommit=false);
+    ///Commits the buffered records and waits for a running checkpoint
+    ~PersistentGraph ();
+    //#//////////////////////////////////////////////
+    // Mutations
+    ///Adds a vertex. Existing IDs are ignored
+    void addVertex (const uint64_t& vID);
+    ///Removes a vertex and its edges. Unknown IDs are ignored
+    void removeVertex (const uint64_t& vID);
+    ///Adds an edge, adding its ends if needed
+    void addEdge (const uint64_t& from, const uint64_t& to);
+    ///Removes an edge. Edges not in the graph are ignored
+    void removeEdge (const uint64_t& from, const uint64_t& to);
+    ///Adds a batch of edges, adding their ends if needed, with a single batch insert
+    void addEdges (const vector<pair<uint64_t, uint64_t> >& edges);
+    //#//////////////////////////////////////////////
+    // Durability
+    ///Makes every mutation so far durable
+    /// \throw runtime_error if the log cannot be written
+    void commit ();
+    ///
+    /// \brief Starts a checkpoint
+    ///
+    /// \return False if a checkpoint was already running, and nothing was done
+    //
+    bool checkpoint ();
+    ///Waits for the running checkpoint, if any, to be on disk
+    void waitCheckpoint ();
+    //#//////////////////////////////////////////////
+    // Access
+    ///Returns the graph
+    const UndirectedGraph& getGraph () const { return graph; }
+    ///Returns what recovery found when the directory was opened
+    const tRecovery& getRecovery () const { return recovery; }
+    ///Returns the current log segment
+    uint64_t getSegment () const { return segment; }
+    ///Returns the number of checkpoints completed since the directory was opened
+    uint64_t getNumCheckpoints () const { return numCheckpoints; }
+    ///Returns the number of log frames written since the directory was opened
+    uint64_t getNumFrames () const { return numFrames; }
+    ///Returns the largest number of records written in one log frame
+    uint64_t getMaxFrameRecords () const { return maxFrameRecords; }
+    
+private:
+    string dir;                 ///Graph directory
+    uint64_t groupSize;         ///Buffered bytes triggering a write
+    uint64_t checkpointSize;    ///Log bytes triggering a checkpoint
+    bool syncMode;              ///True for group commit
+    UndirectedGraph graph;      ///Graph in memory
+    tRecovery recovery;         ///Recovery statistics
+    
+    mutex lock;                 ///Protects the graph, the buffer and the log file
+    condition_variable flushed; ///Signaled when a frame is on disk
+    vector<uint8_t> buffer;     ///Records not written yet
+    uint64_t lastLSN;           ///Sequence number of the last record appended
+    uint64_t durableLSN;        ///Sequence number of the last record on disk
+    bool flushing;              ///True while a thread writes a frame
+    bool logFailed;             ///True once a failed frame could not be cut from the log
+    int logFile;                ///Descriptor of the current log segment
+    uint64_t segment;           ///Number of the current log segment
+    uint64_t logBytes;          ///Log bytes written since the last checkpoint
+    uint64_t numFrames;         ///Frames written
+    uint64_t maxFrameRecords;   ///Largest number of records in a frame
+    
+    thread snapshotWorker;          ///Writes the snapshot of the running checkpoint
+    atomic<bool> snapshotRunning;   ///True while a checkpoint is being written
+    atomic<uint64_t> numCheckpoints;///Checkpoints completed
+    
+    ///Throws if the log failed. Called with the lock held
+    void checkLog () const;
+    ///Appends a record to the buffer. Called with the lock held
+    void logRecord (const uint8_t& op, const uint64_t& a, const uint64_t& b);
+    ///Commits the records appended by a mutation as configured, and starts a
+    ///checkpoint if due. Called with the lock held
+    void endMutation (unique_lock<mutex>& guard);
+    ///Waits until the given record is on disk, writing the buffer if no other thread is
+    void waitDurable (unique_lock<mutex>& guard, const uint64_t& lsn);
+    ///Starts a checkpoint. Called with the lock held
+    bool startCheckpoint (unique_lock<mutex>& guard);
+    ///Opens a new log segment, closing the current one
+    void openSegment (const uint64_t& number);
+    ///Loads the latest snapshot and replays the log after it
+    void recover ();
+    ///Returns the path of a file in the directory
+    string path (const string& prefix, const uint64_t& number, const string& suffix) const;
+};
+
+#endif /* dasel_persistent_graph_h */
@@ -0,0 +1,42 @@
+/**
+ * prefetch.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_prefetch_h
+#define dasel_prefetch_h
+
+//#//////////////////////////////////////////////
+/// \brief Software prefetch hint.
+///
+/// Asks the CPU to start loading the cache line holding "addr", so that
+/// several independent misses can be in flight while other work is done.
+/// It is only a hint: it never faults, and compiles to nothing on compilers
+/// without the builtin.
+///
+inline void prefetchRead (const void* addr) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(addr, 0, 3);
+#else
+    (void)addr;
+#endif
+}
+
+#endif /* dasel_prefetch_h */
@@ -0,0 +1,112 @@
+/**
+* query-executor.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include "query-executor.hpp"
+#include "parallel.hpp"
+
+namespace {
+    ///Index of the worker running on this thread, or -1 outside the pool
+    thread_local int workerIndex = -1;
+    ///Pool owning the worker running on this thread
+    thread_local const WorkStealingPool* workerPool = nullptr;
+}
+
+//#/////////////////////////////////////////////////
+// WorkStealingPool
+//
+WorkStealingPool::WorkStealingPool (unsigned numThreads) : pending(0), steals(0), nextQueue(0), stop(false) {
+    if (numThreads == 0) {
+        numThreads = ::getNumThreads();
+    }
+    for (unsigned i = 0; i < numThreads; ++i) {
+        queues.push_back(unique_ptr<tWorkerQueue>(new tWorkerQueue));
+    }
+    for (unsigned i = 0; i < numThreads; ++i) {
+        workers.push_back(thread(&WorkStealingPool::workerLoop, this, i));
+    }
+}
+
+WorkStealingPool::~WorkStealingPool () {
+    {
+        lock_guard<mutex> guard(idleLock);
+        stop = true;
+    }
+    idle.notify_all();
+    for (auto& w : workers) {
+        w.join();
+    }
+}
+
+void WorkStealingPool::post (function<void ()> task) {
+    unsigned id = ((workerPool == this) && (workerIndex >= 0)) ? workerIndex : nextQueue.fetch_add(1) % queues.size();
+    {
+        //Counted before it is queued, so a worker taking it never takes pending below 0
+        lock_guard<mutex> guard(idleLock);
+        pending.fetch_add(1);
+    }
+    {
+        lock_guard<mutex> guard(queues[id]->lock);
+        queues[id]->tasks.push_back(move(task));
+    }
+    idle.notify_one();
+}
+
+bool WorkStealingPool::takeTask (const unsigned& id, function<void ()>& task) {
+    {
+        lock_guard<mutex> guard(queues[id]->lock);
+        if (!queues[id]->tasks.empty()) {
+            task = move(queues[id]->tasks.back());
+            queues[id]->tasks.pop_back();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+    for (unsigned i = 1; i < queues.size(); ++i) {
+        tWorkerQueue& victim = *queues[(id + i) % queues.size()];
+        lock_guard<mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = move(victim.tasks.front());
+            victim.tasks.pop_front();
+            pending.fetch_sub(1);
+            steals.fetch_add(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop (const unsigned& id) {
+    workerIndex = id;
+    workerPool = this;
+    function<void ()> task;
+    while (true) {
+        if (takeTask(id, task)) {
+            task();
+            continue;
+        }
+        unique_lock<mutex> guard(idleLock);
+        idle.wait(guard, [this] { return stop || (pending.load() > 0); });
+        if (stop && (pending.load() == 0)) {
+            return;
+        }
+    }
+}
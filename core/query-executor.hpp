@@ -0,0 +1,216 @@
+/**
+ * query-executor.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_query_executor_h
+#define dasel_query_executor_h
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <stdint.h>
+#include "graph.hpp"
+#include "compact-graph.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Thread pool with one task queue per worker and work stealing.
+///
+/// Workers take tasks from the back of their own queue, and when it is
+/// empty, steal from the front of the other queues. Tasks posted from a
+/// worker go to its own queue; tasks posted from outside are spread over
+/// the queues round robin.
+///
+class WorkStealingPool {
+    /// Task queue of one worker
+    struct tWorkerQueue {
+        mutex lock;
+        deque<function<void ()> > tasks;
+    };
+    vector<unique_ptr<tWorkerQueue> > queues;   ///One queue per worker
+    vector<thread> workers;     ///Worker threads
+    atomic<uint64_t> pending;   ///Tasks queued and not taken yet
+    atomic<uint64_t> steals;    ///Tasks taken from another worker queue
+    atomic<unsigned> nextQueue; ///Next queue for tasks posted from outside
+    bool stop;                  ///Set when the pool is being destroyed
+    mutex idleLock;             ///Protects the sleep of idle workers
+    condition_variable idle;    ///Wakes up idle workers
+
+    ///Main loop of a worker
+    void workerLoop (const unsigned& id);
+    ///Takes a task from the own queue, or steals one. Returns false if all queues are empty
+    bool takeTask (const unsigned& id, function<void ()>& task);
+    
+public:
+    ///Creates a pool with the given number of workers. 0 uses all hardware threads
+    explicit WorkStealingPool (unsigned numThreads=0);
+    ///Runs the tasks already posted, and joins all workers
+    ~WorkStealingPool ();
+    ///Queues a task
+    void post (function<void ()> task);
+    ///Queues a task and returns a future for its result
+    template <class TFunc>
+    future<typename result_of<TFunc ()>::type> submit (TFunc f) {
+        typedef typename result_of<TFunc ()>::type TResult;
+        shared_ptr<packaged_task<TResult ()> > task(new packaged_task<TResult ()>(f));
+        future<TResult> result = task->get_future();
+        post([task]() { (*task)(); });
+        return result;
+    }
+    ///Returns the number of worker threads
+    unsigned getNumThreads () const { return static_cast<unsigned>(workers.size()); }
+    ///Returns the number of tasks stolen from another worker so far
+    uint64_t getNumSteals () const { return steals.load(); }
+};
+
+//#//////////////////////////////////////////////
+/// \brief Runs batches of read-only queries over a graph on a work stealing
+/// thread pool.
+///
+/// Works with UndirectedGraph and DirectedGraph. Queries only use the const
+/// interface of the graph (findVertex, isEdge, distance, kHopSubgraph), which
+/// never modifies it, so any number of them can run at the same time. The
+/// graph must not be modified while queries are running.
+///
+/// Each batch is split in chunks of "chunkSize" queries, which are the tasks
+/// of the pool, and returns a single future for all its results.
+///
+template <class TGraph>
+class QueryExecutor {
+    const TGraph& graph;        ///Graph to query
+    uint64_t chunkSize;         ///Queries per task
+    atomic<uint64_t> completed; ///Queries completed since the last resetStats()
+    chrono::steady_clock::time_point start;    ///Time of the last resetStats()
+    WorkStealingPool pool;      ///Workers. Declared last, so it is destroyed, running the queued tasks, before the members they use
+    
+    ///Splits a batch of "n" queries in tasks, each calling query(i) for its part
+    template <class TResult, class TQuery>
+    future<vector<TResult> > runBatch (const uint64_t& n, TQuery query) {
+        struct tBatch {
+            vector<TResult> results;
+            atomic<uint64_t> remaining;
+            atomic<bool> failed;    //Set once a query has thrown
+            promise<vector<TResult> > done;
+        };
+        shared_ptr<tBatch> batch(new tBatch);
+        batch->results.resize(n);
+        uint64_t numChunks = (n + chunkSize - 1) / chunkSize;
+        batch->remaining.store(numChunks);
+        batch->failed.store(false);
+        future<vector<TResult> > result = batch->done.get_future();
+        if (!numChunks) {
+            batch->done.set_value(vector<TResult>());
+        }
+        for (uint64_t c = 0; c < numChunks; ++c) {
+            uint64_t first = c * chunkSize;
+            uint64_t last = min(n, first + chunkSize);
+            pool.post([this, batch, first, last, query]() {
+                uint64_t i = first;
+                try {
+                    for (; i < last; ++i) {
+                        batch->results[i] = query(i);
+                    }
+                }
+                catch (...) {
+                    //The first exception goes to the future, before this
+                    //chunk counts as finished
+                    if (!batch->failed.exchange(true)) {
+                        batch->done.set_exception(current_exception());
+                    }
+                }
+                completed.fetch_add(i - first);
+                if ((batch->remaining.fetch_sub(1) == 1) && !batch->failed.load()) {
+                    batch->done.set_value(move(batch->results));
+                }
+            });
+        }
+        return result;
+    }
+    
+public:
+    ///List of vertex pairs, <fromID, toID>
+    typedef vector<pair<uint64_t, uint64_t> > TPairList;
+    /// Throughput statistics
+    struct tStats {
+        uint64_t queries;   ///<Queries completed
+        double seconds;     ///<Time elapsed
+        double throughput;  ///<Queries per second
+    };
+    
+    ///
+    /// \brief Creates an executor over a graph
+    ///
+    /// \param g Graph to query. Must outlive the executor
+    /// \param numThreads Number of workers. 0 uses all hardware threads
+    /// \param queriesPerTask Queries run by each task of the pool
+    //
+    QueryExecutor (const TGraph& g, const unsigned& numThreads=0, const uint64_t& queriesPerTask=64) :
+        graph(g), chunkSize(queriesPerTask ? queriesPerTask : 1), completed(0), start(chrono::steady_clock::now()), pool(numThreads) { }
+    ///Returns the number of worker threads
+    unsigned getNumThreads () const { return pool.getNumThreads(); }
+    ///Returns the distance for each pair, -1 if there is no path
+    future<vector<int16_t> > distances (const TPairList& pairs) {
+        shared_ptr<const TPairList> input(new TPairList(pairs));
+        return runBatch<int16_t>(pairs.size(), [this, input](const uint64_t& i) {
+            return graph.distance((*input)[i].first, (*input)[i].second); });
+    }
+    ///Returns, for each pair, 1 if there is an edge and 0 otherwise
+    future<vector<uint8_t> > areEdges (const TPairList& pairs) {
+        shared_ptr<const TPairList> input(new TPairList(pairs));
+        return runBatch<uint8_t>(pairs.size(), [this, input](const uint64_t& i) {
+            return graph.isEdge((*input)[i].first, (*input)[i].second) ? 1 : 0; });
+    }
+    ///Returns the degree of each vertex, 0 if the vertex is not in the graph
+    future<vector<uint64_t> > degrees (const vector<uint64_t>& ids) {
+        shared_ptr<const vector<uint64_t> > input(new vector<uint64_t>(ids));
+        return runBatch<uint64_t>(ids.size(), [this, input](const uint64_t& i) {
+            const typename TGraph::Vertex* v = graph.findVertex((*input)[i]);
+            return (v != nullptr) ? v->getDeg() : 0; });
+    }
+    ///Returns the k-hop neighbourhood of each seed set. Each extraction runs
+    ///on a single worker, so that several run at the same time
+    future<vector<CompactGraph> > kHops (const vector<vector<uint64_t> >& seeds, const uint8_t& k, const uint64_t& maxVertices=UINT64_MAX) {
+        shared_ptr<const vector<vector<uint64_t> > > input(new vector<vector<uint64_t> >(seeds));
+        return runBatch<CompactGraph>(seeds.size(), [this, input, k, maxVertices](const uint64_t& i) {
+            return graph.kHopSubgraph((*input)[i], k, maxVertices, 1); });
+    }
+    ///Returns the queries completed and the throughput since the executor
+    ///was created or resetStats() was last called
+    tStats getStats () const {
+        tStats stats;
+        stats.queries = completed.load();
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        stats.throughput = (stats.seconds > 0) ? stats.queries / stats.seconds : 0;
+        return stats;
+    }
+    ///Resets the throughput statistics
+    void resetStats () { completed.store(0); start = chrono::steady_clock::now(); }
+};
+
+#endif /* dasel_query_executor_h */
@@ -0,0 +1,328 @@
+/**
+* radix-trie.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include "radix-trie.hpp"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+    ///Returns the number of leading bytes equal in a and b, comparing up to n
+    uint64_t commonPrefix (const char* a, const char* b, const uint64_t& n) {
+        uint64_t i = 0;
+#ifdef __SSE2__
+        for (; i + 16 <= n; i += 16) {
+            __m128i cmp = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+            uint32_t mask = _mm_movemask_epi8(cmp);
+            if (mask != 0xFFFF) {
+                return i + __builtin_ctz(~mask);
+            }
+        }
+#endif
+        while ((i < n) && (a[i] == b[i])) {
+            ++i;
+        }
+        return i;
+    }
+}
+
+const RadixTrie::TNodeIndex RadixTrie::kNoNode;
+const uint8_t RadixTrie::kNumSizeClasses;
+
+//#/////////////////////////////////////////////////
+// RadixTrie
+//
+void RadixTrie::clear () {
+    nodes = vector<tNode>();
+    freeNodes = vector<TNodeIndex>();
+    labels = vector<char>();
+    unusedLabelBytes = 0;
+    childBytes = vector<uint8_t>();
+    childNodes = vector<TNodeIndex>();
+    for (auto& blocks : freeBlocks) {
+        blocks = vector<uint32_t>();
+    }
+    dictionarySize = 0;
+    newNode(0, 0);
+}
+
+uint32_t RadixTrie::childPosition (const tNode& node, const uint8_t& byte) const {
+    const uint8_t* first = childBytes.data() + node.children;
+    if (node.numChildren <= 8) {
+        uint32_t pos = 0;
+        while ((pos < node.numChildren) && (first[pos] < byte)) {
+            ++pos;
+        }
+        return pos;
+    }
+    return lower_bound(first, first + node.numChildren, byte) - first;
+}
+
+RadixTrie::TNodeIndex RadixTrie::findChild (const TNodeIndex& idx, const uint8_t& byte) const {
+    const tNode& node = nodes[idx];
+    if (node.numChildren == 0) {
+        return kNoNode;
+    }
+    uint32_t pos = childPosition(node, byte);
+    if ((pos < node.numChildren) && (childBytes[node.children + pos] == byte)) {
+        return childNodes[node.children + pos];
+    }
+    return kNoNode;
+}
+
+RadixTrie::TNodeIndex RadixTrie::newNode (const uint32_t& label, const uint32_t& labelLength) {
+    TNodeIndex idx;
+    if (!freeNodes.empty()) {
+        idx = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    else {
+        if (nodes.size() >= kNoNode) {
+            throw length_error("RadixTrie: node pool full");
+        }
+        idx = nodes.size();
+        nodes.emplace_back();
+    }
+    tNode& node = nodes[idx];
+    node.label = label;
+    node.labelLength = labelLength;
+    node.children = 0;
+    node.numChildren = 0;
+    node.sizeClass = 0;
+    node.wordMarker = false;
+    return idx;
+}
+
+void RadixTrie::freeNode (const TNodeIndex& idx) {
+    tNode& node = nodes[idx];
+    if (node.numChildren > 0) {
+        freeBlocks[node.sizeClass].push_back(node.children);
+        node.numChildren = 0;
+    }
+    unusedLabelBytes += node.labelLength;
+    node.labelLength = 0;
+    freeNodes.push_back(idx);
+}
+
+uint32_t RadixTrie::appendLabel (const char* data, const uint64_t& size) {
+    if (labels.size() + size > UINT32_MAX) {
+        throw length_error("RadixTrie: label arena full");
+    }
+    uint32_t offset = labels.size();
+    labels.insert(labels.end(), data, data + size);
+    return offset;
+}
+
+uint32_t RadixTrie::newBlock (const uint8_t& sizeClass) {
+    if (!freeBlocks[sizeClass].empty()) {
+        uint32_t block = freeBlocks[sizeClass].back();
+        freeBlocks[sizeClass].pop_back();
+        return block;
+    }
+    uint64_t block = childNodes.size();
+    if (block + (1U << sizeClass) > UINT32_MAX) {
+        throw length_error("RadixTrie: child arena full");
+    }
+    childBytes.resize(block + (1U << sizeClass));
+    childNodes.resize(block + (1U << sizeClass));
+    return block;
+}
+
+void RadixTrie::addChild (const TNodeIndex& idx, const TNodeIndex& child) {
+    uint8_t byte = labels[nodes[child].label];
+    tNode& node = nodes[idx];
+    if (node.numChildren == 0) {
+        node.children = newBlock(0);
+        node.sizeClass = 0;
+    }
+    else if (node.numChildren == (1U << node.sizeClass)) {
+        //Full block: move the children to one twice as big
+        uint32_t block = newBlock(node.sizeClass + 1);
+        copy(childBytes.begin() + node.children, childBytes.begin() + node.children + node.numChildren, childBytes.begin() + block);
+        copy(childNodes.begin() + node.children, childNodes.begin() + node.children + node.numChildren, childNodes.begin() + block);
+        freeBlocks[node.sizeClass].push_back(node.children);
+        node.children = block;
+        ++node.sizeClass;
+    }
+    uint32_t pos = childPosition(node, byte);
+    uint8_t* bytes = childBytes.data() + node.children;
+    TNodeIndex* children = childNodes.data() + node.children;
+    memmove(bytes + pos + 1, bytes + pos, node.numChildren - pos);
+    memmove(children + pos + 1, children + pos, (node.numChildren - pos) * sizeof(TNodeIndex));
+    bytes[pos] = byte;
+    children[pos] = child;
+    ++node.numChildren;
+}
+
+void RadixTrie::removeChild (const TNodeIndex& idx, const uint8_t& byte) {
+    tNode& node = nodes[idx];
+    uint32_t pos = childPosition(node, byte);
+    uint8_t* bytes = childBytes.data() + node.children;
+    TNodeIndex* children = childNodes.data() + node.children;
+    memmove(bytes + pos, bytes + pos + 1, node.numChildren - pos - 1);
+    memmove(children + pos, children + pos + 1, (node.numChildren - pos - 1) * sizeof(TNodeIndex));
+    if (--node.numChildren == 0) {
+        freeBlocks[node.sizeClass].push_back(node.children);
+    }
+}
+
+void RadixTrie::replaceChild (const TNodeIndex& idx, const uint8_t& byte, const TNodeIndex& child) {
+    childNodes[nodes[idx].children + childPosition(nodes[idx], byte)] = child;
+}
+
+RadixTrie::TNodeIndex RadixTrie::mergeWithChild (const TNodeIndex& parent, const TNodeIndex& idx) {
+    TNodeIndex child = childNodes[nodes[idx].children];
+    uint8_t childByte = labels[nodes[child].label];
+    uint8_t byte = labels[nodes[idx].label];
+    //The two labels are rarely next to each other in the arena, so the joined one is appended
+    string joined = getLabel(idx) + getLabel(child);
+    unusedLabelBytes += nodes[child].labelLength;
+    nodes[child].label = appendLabel(joined.data(), joined.size());
+    nodes[child].labelLength = joined.size();
+    replaceChild(parent, byte, child);
+    removeChild(idx, childByte);
+    freeNode(idx);
+    return child;
+}
+
+void RadixTrie::compactLabels () {
+    vector<char> compacted;
+    compacted.reserve(labels.size() - unusedLabelBytes);
+    for (auto& node : nodes) {
+        uint32_t offset = compacted.size();
+        compacted.insert(compacted.end(), labels.begin() + node.label, labels.begin() + node.label + node.labelLength);
+        node.label = offset;
+    }
+    labels.swap(compacted);
+    unusedLabelBytes = 0;
+}
+
+void RadixTrie::insertWord (const string& word) {
+    TNodeIndex current = 0;
+    uint64_t pos = 0;
+    while (pos < word.size()) {
+        uint8_t byte = word[pos];
+        TNodeIndex child = findChild(current, byte);
+        if (child == kNoNode) {
+            //The rest of the word becomes the label of a new leaf
+            uint32_t label = appendLabel(word.data() + pos, word.size() - pos);
+            TNodeIndex leaf = newNode(label, word.size() - pos);
+            nodes[leaf].wordMarker = true;
+            addChild(current, leaf);
+            ++dictionarySize;
+            return;
+        }
+        uint32_t label = nodes[child].label;
+        uint32_t length = nodes[child].labelLength;
+        uint64_t common = commonPrefix(labels.data() + label, word.data() + pos, min<uint64_t>(length, word.size() - pos));
+        if (common < length) {
+            //Split the edge: a new node takes the common part of the label
+            TNodeIndex middle = newNode(label, common);
+            nodes[child].label += common;
+            nodes[child].labelLength -= common;
+            replaceChild(current, byte, middle);
+            addChild(middle, child);
+            child = middle;
+        }
+        current = child;
+        pos += common;
+    }
+    if (!nodes[current].wordMarker) {
+        nodes[current].wordMarker = true;
+        ++dictionarySize;
+    }
+}
+
+void RadixTrie::removeWord (const string& word) {
+    //Nodes along the word, the root first
+    vector<TNodeIndex> path(1, 0);
+    uint64_t pos = 0;
+    while (pos < word.size()) {
+        TNodeIndex child = findChild(path.back(), word[pos]);
+        if ((child == kNoNode) || (nodes[child].labelLength > word.size() - pos) ||
+            (memcmp(labels.data() + nodes[child].label, word.data() + pos, nodes[child].labelLength) != 0)) {
+            return;
+        }
+        pos += nodes[child].labelLength;
+        path.push_back(child);
+    }
+    TNodeIndex idx = path.back();
+    if (!nodes[idx].wordMarker) {
+        return;
+    }
+    nodes[idx].wordMarker = false;
+    --dictionarySize;
+    if (idx == 0) {
+        return;
+    }
+    TNodeIndex parent = path[path.size() - 2];
+    if (nodes[idx].numChildren == 0) {
+        removeChild(parent, labels[nodes[idx].label]);
+        freeNode(idx);
+        //The parent may be left as a plain link between 2 edges
+        if ((parent != 0) && !nodes[parent].wordMarker && (nodes[parent].numChildren == 1)) {
+            mergeWithChild(path[path.size() - 3], parent);
+        }
+    }
+    else if (nodes[idx].numChildren == 1) {
+        mergeWithChild(parent, idx);
+    }
+    if (unusedLabelBytes * 2 > labels.size()) {
+        compactLabels();
+    }
+}
+
+RadixTrie::TNodeIndex RadixTrie::searchWord (const string& word, const bool& isWhole) const {
+    TNodeIndex current = 0;
+    uint64_t pos = 0;
+    while (pos < word.size()) {
+        TNodeIndex child = findChild(current, word[pos]);
+        if (child == kNoNode) {
+            return kNoNode;
+        }
+        uint64_t length = nodes[child].labelLength;
+        uint64_t compared = min<uint64_t>(length, word.size() - pos);
+        if (memcmp(labels.data() + nodes[child].label, word.data() + pos, compared) != 0) {
+            return kNoNode;
+        }
+        if (compared < length) {
+            //The word ends inside the edge
+            return isWhole ? kNoNode : child;
+        }
+        current = child;
+        pos += length;
+    }
+    return (nodes[current].wordMarker || !isWhole) ? current : kNoNode;
+}
+
+uint64_t RadixTrie::getMemoryUsage () const {
+    uint64_t bytes = nodes.capacity() * sizeof(tNode) + freeNodes.capacity() * sizeof(TNodeIndex) + labels.capacity() +
+                     childBytes.capacity() + childNodes.capacity() * sizeof(TNodeIndex);
+    for (auto& blocks : freeBlocks) {
+        bytes += blocks.capacity() * sizeof(uint32_t);
+    }
+    return bytes;
+}
@@ -0,0 +1,157 @@
+/**
+ * radix-trie.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_radix_trie_h
+#define dasel_radix_trie_h
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Implements a path compressed (radix, or Patricia) trie over byte
+/// strings.
+///
+/// Chains of nodes with a single child are collapsed into one edge, and the
+/// edge into every node carries a label of one or more bytes. A lookup
+/// takes one child search and one label comparison per edge, instead of a
+/// node per byte, which pays off on long keys with few shared prefixes.
+/// Labels are compared with memcmp, and the mismatch position needed to
+/// split an edge is found 16 bytes at a time with SSE2 when available.
+///
+/// Inserting a key that diverges in the middle of an edge splits the edge
+/// at that point. Removing a key merges a node left with a single child
+/// and no word into that child.
+///
+/// Storage follows the other tries, with no allocation per node:
+///   * Nodes are 16 bytes in a pool, referred to by 32 bit index.
+///   * Labels are slices of a byte arena. Splitting an edge only changes
+///     the slices. Merging appends the joined label, and the arena is
+///     compacted once more than half of it is unused.
+///   * The children of a node are a block of first bytes, kept sorted, and
+///     node indexes in a child arena. Blocks hold a power of 2 of children,
+///     and freed blocks are reused by size.
+///
+/// Keys are case sensitive. The API follows Trie.
+///
+class RadixTrie {
+public:
+    /// Index of a node in the pool
+    typedef uint32_t TNodeIndex;
+    /// Index standing for no node
+    static const TNodeIndex kNoNode = UINT32_MAX;
+    
+    /// Creates an empty trie, with just the root node
+    RadixTrie () { clear(); }
+    ///  \brief Inserts a word in the trie. Words already in the trie are ignored
+    ///
+    ///  \param word Word to be inserted in the tree
+    //
+    void insertWord (const string& word);
+    ///
+    ///  \brief Removes a word from the trie
+    ///
+    ///  \param word Word to be removed from the tree
+    //
+    void removeWord (const string& word);
+    ///
+    ///  \brief Searches a word in the trie
+    ///
+    ///  \param word Word to search for
+    ///  \param isWhole True if it should match whole words only
+    ///  \return Index of the node ending the word or, for a prefix ending
+    /// inside an edge, of the node the edge leads to. kNoNode if the word is
+    /// not part of the trie
+    //
+    TNodeIndex searchWord (const string& word, const bool& isWhole=true) const;
+    /// Returns true if the given string is a prefix or word in the dictionary
+    bool isPrefix (const string& prefix) const { return searchWord(prefix, false) != kNoNode; }
+    /// Returns true if the given string is a word in the dictionary
+    bool isWord (const string& word) const { return searchWord(word, true) != kNoNode; }
+    ///Returns the number of whole words in the dictionary
+    uint64_t getDictionarySize () const { return dictionarySize; }
+    ///Removes all words, freeing the pools in bulk
+    void clear ();
+    ///Returns the root node, which has an empty label
+    TNodeIndex getRoot () const { return 0; }
+    ///Returns the label of the edge into a node
+    string getLabel (const TNodeIndex& idx) const { return string(labels.data() + nodes[idx].label, nodes[idx].labelLength); }
+    ///Returns true if a node is the end of a whole word
+    bool isWordNode (const TNodeIndex& idx) const { return nodes[idx].wordMarker; }
+    ///Returns the number of children of a node
+    uint64_t getNumChildren (const TNodeIndex& idx) const { return nodes[idx].numChildren; }
+    ///Returns the child of a node in a given position, in increasing order of label
+    TNodeIndex getChild (const TNodeIndex& idx, const uint64_t& pos) const { return childNodes[nodes[idx].children + pos]; }
+    ///Returns the number of nodes in the trie, the root included
+    uint64_t getNumNodes () const { return nodes.size() - freeNodes.size(); }
+    ///Returns the bytes allocated by the pools and arenas
+    uint64_t getMemoryUsage () const;
+    
+private:
+    static const uint8_t kNumSizeClasses = 9;   ///Child blocks hold 1 to 256 children
+    
+    /// Node, with the label of the edge into it and its block of children
+    struct tNode {
+        uint32_t label;         ///Offset of the label in the label arena
+        uint32_t labelLength;   ///Bytes of the label
+        uint32_t children;      ///Offset of the child block in the child arena
+        uint16_t numChildren;   ///Number of children
+        uint8_t sizeClass;      ///The child block holds 2^sizeClass children
+        bool wordMarker;        ///True if the node is the end of a whole word
+    };
+    
+    vector<tNode> nodes;                ///Node pool
+    vector<TNodeIndex> freeNodes;       ///Removed nodes
+    vector<char> labels;                ///Label arena
+    uint64_t unusedLabelBytes;          ///Bytes of the label arena no node refers to
+    vector<uint8_t> childBytes;         ///Child arena: first byte of the label of each child
+    vector<TNodeIndex> childNodes;      ///Child arena: index of each child
+    vector<uint32_t> freeBlocks[kNumSizeClasses];   ///Free child blocks, by size class
+    uint64_t dictionarySize;            ///Number of words
+    
+    ///Returns the position of byte among the children of a node, or where it should be inserted
+    uint32_t childPosition (const tNode& node, const uint8_t& byte) const;
+    ///Returns the child of a node whose label starts with byte, kNoNode if there is none
+    TNodeIndex findChild (const TNodeIndex& idx, const uint8_t& byte) const;
+    ///Creates a node with the given label slice
+    TNodeIndex newNode (const uint32_t& label, const uint32_t& labelLength);
+    ///Returns a node, and its child block, to the pools
+    void freeNode (const TNodeIndex& idx);
+    ///Appends bytes to the label arena, and returns their offset
+    uint32_t appendLabel (const char* data, const uint64_t& size);
+    ///Adds a child to a node, keeping the children sorted
+    void addChild (const TNodeIndex& idx, const TNodeIndex& child);
+    ///Removes the child whose label starts with byte from a node
+    void removeChild (const TNodeIndex& idx, const uint8_t& byte);
+    ///Points the child of a node whose label starts with byte to another node
+    void replaceChild (const TNodeIndex& idx, const uint8_t& byte, const TNodeIndex& child);
+    ///Returns a child block of the given size class
+    uint32_t newBlock (const uint8_t& sizeClass);
+    ///Merges a node with no word and a single child into the child, and returns the child
+    TNodeIndex mergeWithChild (const TNodeIndex& parent, const TNodeIndex& idx);
+    ///Copies the labels in use to a new arena
+    void compactLabels ();
+};
+
+#endif /* dasel_radix_trie_h */
@@ -0,0 +1,152 @@
+/**
+* random-walk.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include "random-walk.hpp"
+#include "parallel.hpp"
+#include "rng.hpp"
+#include <stdexcept>
+
+//#/////////////////////////////////////////////////
+// RandomWalker
+//
+void RandomWalker::uniformWalks (const vector<uint64_t>& starts, const uint64_t& walkLength, vector<uint64_t>& walks) const {
+    if (walks.size() < starts.size() * walkLength) {
+        walks.resize(starts.size() * walkLength);
+    }
+    parallelFor(0, starts.size(), [&](uint64_t w) {
+        SplitMix64 rng(streamSeed(seed, w));
+        uint64_t* out = walks.data() + w * walkLength;
+        uint64_t current = starts[w];
+        uint64_t step = 0;
+        for (; step < walkLength; ++step) {
+            out[step] = current;
+            uint64_t deg = graph.getDeg(current);
+            if (!deg) {
+                ++step;
+                break;
+            }
+            current = graph.getAdj(current, rng.nextBelow(deg));
+        }
+        for (; step < walkLength; ++step) {
+            out[step] = kNoVertex;
+        }
+    }, 256);
+}
+
+void RandomWalker::node2vecWalks (const vector<uint64_t>& starts, const uint64_t& walkLength, const double& p, const double& q, vector<uint64_t>& walks) const {
+    //Also rejects NaN
+    if (!(p > 0) || !(q > 0)) {
+        throw invalid_argument("RandomWalker: node2vec p and q must be positive");
+    }
+    if (walks.size() < starts.size() * walkLength) {
+        walks.resize(starts.size() * walkLength);
+    }
+    double returnWeight = 1.0 / p;
+    double outWeight = 1.0 / q;
+    double maxWeight = max(1.0, max(returnWeight, outWeight));
+    
+    parallelFor(0, starts.size(), [&](uint64_t w) {
+        SplitMix64 rng(streamSeed(seed, w));
+        uint64_t* out = walks.data() + w * walkLength;
+        uint64_t step = 0;
+        if (walkLength) {
+            out[step++] = starts[w];
+        }
+        for (; step < walkLength; ++step) {
+            uint64_t current = out[step - 1];
+            uint64_t deg = graph.getDeg(current);
+            if (!deg) {
+                break;
+            }
+            if (step == 1) {
+                out[step] = graph.getAdj(current, rng.nextBelow(deg));
+                continue;
+            }
+            uint64_t previous = out[step - 2];
+            while (true) {
+                uint64_t candidate = graph.getAdj(current, rng.nextBelow(deg));
+                double weight;
+                if (candidate == previous) {
+                    weight = returnWeight;
+                }
+                else if (graph.isEdge(previous, candidate)) {
+                    weight = 1.0;
+                }
+                else {
+                    weight = outWeight;
+                }
+                if (rng.nextDouble() * maxWeight < weight) {
+                    out[step] = candidate;
+                    break;
+                }
+            }
+        }
+        for (; step < walkLength; ++step) {
+            out[step] = kNoVertex;
+        }
+    }, 256);
+}
+
+void RandomWalker::sampleNeighbours (const vector<uint64_t>& vertices, const uint64_t& fanout, vector<uint64_t>& samples) const {
+    if (samples.size() < vertices.size() * fanout) {
+        samples.resize(vertices.size() * fanout);
+    }
+    parallelFor(0, vertices.size(), [&](uint64_t i) {
+        uint64_t* out = samples.data() + i * fanout;
+        uint64_t deg = graph.getDeg(vertices[i]);
+        const uint64_t* adj = graph.adjBegin(vertices[i]);
+        if (deg <= fanout) {
+            uint64_t pos = 0;
+            for (; pos < deg; ++pos) {
+                out[pos] = adj[pos];
+            }
+            for (; pos < fanout; ++pos) {
+                out[pos] = kNoVertex;
+            }
+            return;
+        }
+        //Floyd's algorithm: "fanout" distinct positions in O(fanout^2), whatever the degree
+        SplitMix64 rng(streamSeed(seed, i));
+        uint64_t count = 0;
+        for (uint64_t j = deg - fanout; j < deg; ++j) {
+            uint64_t candidate = rng.nextBelow(j + 1);
+            if (find(out, out + count, candidate) != out + count) {
+                candidate = j;
+            }
+            out[count++] = candidate;
+        }
+        for (uint64_t pos = 0; pos < fanout; ++pos) {
+            out[pos] = adj[out[pos]];
+        }
+    }, 256);
+}
+
+vector<uint64_t> RandomWalker::allVertexStarts (const uint64_t& walksPerVertex) const {
+    vector<uint64_t> starts;
+    starts.reserve(graph.getNumVertex() * walksPerVertex);
+    for (uint64_t r = 0; r < walksPerVertex; ++r) {
+        for (uint64_t v = 0; v < graph.getNumVertex(); ++v) {
+            starts.push_back(v);
+        }
+    }
+    return starts;
+}
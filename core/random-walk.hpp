@@ -0,0 +1,97 @@
+/**
+ * random-walk.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_random_walk_h
+#define dasel_random_walk_h
+
+#include <vector>
+#include <stdint.h>
+#include "compact-graph.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Generates random walks and neighbour samples over a CompactGraph.
+///
+/// Walks run in parallel, one walk per work item. Each walk draws from its
+/// own random stream, derived from the walker seed and the walk number, so
+/// the output only depends on the seed, never on the number of threads.
+///
+/// Walks and samples contain vertex indexes of the CompactGraph, and are
+/// written into a caller provided buffer: walk i takes positions
+/// [i * walkLength, (i + 1) * walkLength). A walk reaching a vertex without
+/// out edges stops, and the rest of its slots are set to kNoVertex.
+///
+class RandomWalker {
+    const CompactGraph& graph;  ///Graph to walk
+    uint64_t seed;              ///Seed for all random streams
+    
+public:
+    ///Creates a walker over the given graph. The graph must outlive the walker
+    RandomWalker (const CompactGraph& g, const uint64_t& rngSeed=0) : graph(g), seed(rngSeed) { }
+    ///Changes the seed used by all following walks
+    void setSeed (const uint64_t& rngSeed) { seed = rngSeed; }
+    ///
+    /// \brief Runs uniform (DeepWalk) random walks
+    ///
+    /// \param starts Vertex index where each walk starts
+    /// \param walkLength Number of vertex in each walk, including the start
+    /// \param walks Output buffer. Resized only if smaller than starts.size() * walkLength
+    //
+    void uniformWalks (const vector<uint64_t>& starts, const uint64_t& walkLength, vector<uint64_t>& walks) const;
+    ///
+    /// \brief Runs second order node2vec random walks
+    ///
+    /// Moving from v (reached from t) to x is weighted 1/p if x == t, 1 if x
+    /// is adjacent to t, and 1/q otherwise. Steps are drawn by rejection
+    /// sampling: a uniform neighbour is proposed and accepted with
+    /// probability weight / maxWeight, which needs no per-edge tables.
+    /// A step takes maxWeight / (mean weight over the neighbours of v)
+    /// proposals on average, so extreme values are slow: with a tiny p a
+    /// step at a vertex of degree d takes about d proposals, and with p and
+    /// q above 1 a step at a vertex sharing no neighbours with t takes
+    /// about q proposals (p at a vertex of degree 1).
+    ///
+    /// \param starts Vertex index where each walk starts
+    /// \param walkLength Number of vertex in each walk, including the start
+    /// \param p Return parameter. Must be positive, or invalid_argument is thrown
+    /// \param q In-out parameter. Must be positive, or invalid_argument is thrown
+    /// \param walks Output buffer. Resized only if smaller than starts.size() * walkLength
+    //
+    void node2vecWalks (const vector<uint64_t>& starts, const uint64_t& walkLength, const double& p, const double& q, vector<uint64_t>& walks) const;
+    ///
+    /// \brief Samples a fixed number of neighbours for each vertex
+    ///
+    /// Vertex with at least "fanout" neighbours get "fanout" distinct
+    /// neighbours. Vertex with fewer neighbours get all of them, and the
+    /// remaining slots are set to kNoVertex.
+    ///
+    /// \param vertices Vertex indexes to sample
+    /// \param fanout Number of neighbours per vertex
+    /// \param samples Output buffer. Resized only if smaller than vertices.size() * fanout
+    //
+    void sampleNeighbours (const vector<uint64_t>& vertices, const uint64_t& fanout, vector<uint64_t>& samples) const;
+    ///Returns a start list with "walksPerVertex" walks from every vertex in the graph
+    vector<uint64_t> allVertexStarts (const uint64_t& walksPerVertex) const;
+};
+
+#endif /* dasel_random_walk_h */
@@ -0,0 +1,272 @@
+/**
+* reachability.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <stdexcept>
+#include <unordered_set>
+#include "reachability.hpp"
+#include "parallel.hpp"
+#include "rng.hpp"
+
+namespace {
+    ///Returns the vertex in Kahn order. Vertex on or after a cycle are left out
+    vector<uint64_t> kahnOrder (const CompactGraph& g) {
+        uint64_t n = g.getNumVertex();
+        vector<uint64_t> inDeg(n, 0);
+        for (auto to : g.getAdjacency()) {
+            ++inDeg[to];
+        }
+        vector<uint64_t> order;
+        order.reserve(n);
+        for (uint64_t v = 0; v < n; ++v) {
+            if (inDeg[v] == 0) {
+                order.push_back(v);
+            }
+        }
+        for (uint64_t head = 0; head < order.size(); ++head) {
+            uint64_t v = order[head];
+            for (const uint64_t* a = g.adjBegin(v); a != g.adjEnd(v); ++a) {
+                if (--inDeg[*a] == 0) {
+                    order.push_back(*a);
+                }
+            }
+        }
+        return order;
+    }
+}
+
+//#/////////////////////////////////////////////////
+// ReachabilityIndex
+//
+ReachabilityIndex::ReachabilityIndex (const DirectedGraph& g, const uint8_t& labelCount, const uint64_t& seed, const unsigned& numThreads) :
+    graph(g), numLabels(labelCount), acyclic(true), numQueries(0), numFallbacks(0) {
+    build(seed, numThreads);
+}
+
+ReachabilityIndex::ReachabilityIndex (const CompactGraph& g, const uint8_t& labelCount, const uint64_t& seed, const unsigned& numThreads) :
+    graph(g), numLabels(labelCount), acyclic(true), numQueries(0), numFallbacks(0) {
+    if (!graph.isDirected()) {
+        throw invalid_argument("ReachabilityIndex: graph must be directed");
+    }
+    build(seed, numThreads);
+}
+
+void ReachabilityIndex::build (const uint64_t& seed, const unsigned& numThreads) {
+    uint64_t n = graph.getNumVertex();
+    strongComponents();
+    uint64_t numComponents = 0;
+    for (auto c : component) {
+        numComponents = max(numComponents, c + 1);
+    }
+    acyclic = (numComponents == n);
+    vector<pair<uint64_t, uint64_t> > edges;
+    for (uint64_t v = 0; v < n; ++v) {
+        for (const uint64_t* a = graph.adjBegin(v); a != graph.adjEnd(v); ++a) {
+            if (component[v] != component[*a]) {
+                edges.push_back(make_pair(component[v], component[*a]));
+            }
+            else if (v == *a) {
+                acyclic = false;
+            }
+        }
+    }
+    dag = CompactGraph::fromEdges(numComponents, edges, true);
+    labels.assign(numComponents * numLabels * 2, 0);
+    parallelFor(0, numLabels, [&](uint64_t l) { intervalLabel(static_cast<uint8_t>(l), seed); }, 1, numThreads);
+}
+
+void ReachabilityIndex::strongComponents () {
+    uint64_t n = graph.getNumVertex();
+    const uint64_t kUnvisited = UINT64_MAX;
+    vector<uint64_t> index(n, kUnvisited);
+    vector<uint64_t> lowLink(n, 0);
+    vector<uint8_t> onStack(n, 0);
+    vector<uint64_t> sccStack;
+    vector<pair<uint64_t, uint64_t> > callStack;    //<vertex, next adjacency position>
+    component.assign(n, 0);
+    uint64_t nextIndex = 0;
+    uint64_t found = 0;
+    for (uint64_t root = 0; root < n; ++root) {
+        if (index[root] != kUnvisited) {
+            continue;
+        }
+        callStack.push_back(make_pair(root, 0));
+        while (!callStack.empty()) {
+            uint64_t v = callStack.back().first;
+            uint64_t& pos = callStack.back().second;
+            if (pos == 0 && index[v] == kUnvisited) {
+                index[v] = lowLink[v] = nextIndex++;
+                sccStack.push_back(v);
+                onStack[v] = 1;
+            }
+            if (pos < graph.getDeg(v)) {
+                uint64_t w = graph.getAdj(v, pos++);
+                if (index[w] == kUnvisited) {
+                    callStack.push_back(make_pair(w, 0));
+                }
+                else if (onStack[w]) {
+                    lowLink[v] = min(lowLink[v], index[w]);
+                }
+                continue;
+            }
+            //All edges done, v is finished
+            if (lowLink[v] == index[v]) {
+                uint64_t w;
+                do {
+                    w = sccStack.back();
+                    sccStack.pop_back();
+                    onStack[w] = 0;
+                    component[w] = found;
+                } while (w != v);
+                ++found;
+            }
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                uint64_t parent = callStack.back().first;
+                lowLink[parent] = min(lowLink[parent], lowLink[v]);
+            }
+        }
+    }
+    //Tarjan finds sink components first. Reverse to get a topological order
+    for (auto& c : component) {
+        c = found - 1 - c;
+    }
+}
+
+void ReachabilityIndex::intervalLabel (const uint8_t& l, const uint64_t& seed) {
+    uint64_t n = dag.getNumVertex();
+    SplitMix64 rng(streamSeed(seed, l));
+    vector<uint64_t> roots;
+    for (uint64_t c = 0; c < n; ++c) {
+        roots.push_back(c);
+    }
+    for (uint64_t i = n; i > 1; --i) {
+        swap(roots[i - 1], roots[rng.nextBelow(i)]);
+    }
+    //Children are visited starting from a random position, wrapping around
+    vector<uint8_t> visited(n, 0);
+    vector<uint64_t> start(n, 0);
+    struct tFrame { uint64_t c; uint64_t done; };
+    vector<tFrame> stack;
+    uint64_t post = 0;
+    for (auto root : roots) {
+        if (visited[root]) {
+            continue;
+        }
+        stack.push_back(tFrame{root, 0});
+        visited[root] = 1;
+        while (!stack.empty()) {
+            tFrame& f = stack.back();
+            uint64_t c = f.c;
+            uint64_t deg = dag.getDeg(c);
+            if (f.done == 0) {
+                start[c] = (deg > 1) ? rng.nextBelow(deg) : 0;
+                labels[(c * numLabels + l) * 2] = UINT64_MAX;
+            }
+            if (f.done < deg) {
+                uint64_t child = dag.getAdj(c, (start[c] + f.done) % deg);
+                ++f.done;
+                if (!visited[child]) {
+                    visited[child] = 1;
+                    stack.push_back(tFrame{child, 0});
+                }
+                else {
+                    uint64_t& low = labels[(c * numLabels + l) * 2];
+                    low = min(low, labels[(child * numLabels + l) * 2]);
+                }
+                continue;
+            }
+            uint64_t& low = labels[(c * numLabels + l) * 2];
+            labels[(c * numLabels + l) * 2 + 1] = post;
+            low = min(low, post);
+            ++post;
+            stack.pop_back();
+            if (!stack.empty()) {
+                uint64_t& parentLow = labels[(stack.back().c * numLabels + l) * 2];
+                parentLow = min(parentLow, low);
+            }
+        }
+    }
+}
+
+bool ReachabilityIndex::mayReach (const uint64_t& from, const uint64_t& to) const {
+    if (from > to) {
+        return false;
+    }
+    const uint64_t* lf = labels.data() + from * numLabels * 2;
+    const uint64_t* lt = labels.data() + to * numLabels * 2;
+    for (uint8_t l = 0; l < numLabels; ++l) {
+        if ((lt[2 * l] < lf[2 * l]) || (lt[2 * l + 1] > lf[2 * l + 1])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReachabilityIndex::isReachable (const uint64_t& fromID, const uint64_t& toID) const {
+    numQueries.fetch_add(1, memory_order_relaxed);
+    uint64_t from = getComponent(fromID);
+    uint64_t to = getComponent(toID);
+    if ((from == kNoVertex) || (to == kNoVertex)) {
+        return false;
+    }
+    if (from == to) {
+        return true;
+    }
+    if (!mayReach(from, to)) {
+        return false;
+    }
+    //Pruned DFS on the condensation
+    numFallbacks.fetch_add(1, memory_order_relaxed);
+    unordered_set<uint64_t> visited;
+    vector<uint64_t> stack(1, from);
+    visited.insert(from);
+    while (!stack.empty()) {
+        uint64_t c = stack.back();
+        stack.pop_back();
+        for (const uint64_t* a = dag.adjBegin(c); a != dag.adjEnd(c); ++a) {
+            if (*a == to) {
+                return true;
+            }
+            if (mayReach(*a, to) && visited.insert(*a).second) {
+                stack.push_back(*a);
+            }
+        }
+    }
+    return false;
+}
+
+uint64_t ReachabilityIndex::getComponent (const uint64_t& vID) const {
+    uint64_t idx = graph.getIndex(vID);
+    return (idx == kNoVertex) ? kNoVertex : component[idx];
+}
+
+vector<uint64_t> ReachabilityIndex::topologicalSort (const CompactGraph& g) {
+    vector<uint64_t> order = kahnOrder(g);
+    if (order.size() != g.getNumVertex()) {
+        throw runtime_error("ReachabilityIndex: graph has cycles");
+    }
+    return order;
+}
+
+bool ReachabilityIndex::hasCycle (const CompactGraph& g) {
+    return kahnOrder(g).size() != g.getNumVertex();
+}
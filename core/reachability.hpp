@@ -0,0 +1,112 @@
+/**
+ * reachability.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_reachability_h
+#define dasel_reachability_h
+
+#include <vector>
+#include <atomic>
+#include <stdint.h>
+#include "compact-graph.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Answers "can A reach B?" queries on a directed graph.
+///
+/// The graph is condensed into its strongly connected components (SCC),
+/// found with an iterative Tarjan algorithm. Components are numbered in
+/// topological order of the condensation DAG, so an edge between components
+/// always goes from a smaller to a bigger number.
+///
+/// Every component gets a number of GRAIL interval labels [low, post], one
+/// per randomized post-order DFS of the DAG, computed in parallel. If A
+/// reaches B the interval of B is inside the interval of A in every label.
+/// A query is answered without traversal when:
+///   * Both vertex are in the same component (reachable).
+///   * B comes before A in topological order (unreachable).
+///   * Some label of B is not inside the one of A (unreachable).
+/// Only the rest fall back to a DFS of the condensation, pruned with the same
+/// tests.
+///
+/// The index works on a snapshot and does not follow later changes to the
+/// graph. Queries are const and can run from several threads.
+///
+class ReachabilityIndex {
+    CompactGraph graph;         ///Snapshot of the indexed graph
+    vector<uint64_t> component; ///Component number of every vertex index
+    CompactGraph dag;           ///Condensation DAG, one vertex per component
+    uint8_t numLabels;          ///Number of interval labels per component
+    vector<uint64_t> labels;    ///Pairs of <low, post> for every component and label
+    bool acyclic;               ///True if the graph has no cycles
+    mutable atomic<uint64_t> numQueries;    ///Queries answered
+    mutable atomic<uint64_t> numFallbacks;  ///Queries that needed a DFS
+    
+public:
+    ///
+    /// \brief Builds the index for a directed graph
+    ///
+    /// \param g Graph to index
+    /// \param labelCount Number of interval labels per component
+    /// \param seed Seed for the randomized traversals
+    /// \param numThreads Number of threads to build the labels. 0 uses all hardware threads
+    //
+    explicit ReachabilityIndex (const DirectedGraph& g, const uint8_t& labelCount=3, const uint64_t& seed=0, const unsigned& numThreads=0);
+    ///Builds the index for a directed compact graph
+    explicit ReachabilityIndex (const CompactGraph& g, const uint8_t& labelCount=3, const uint64_t& seed=0, const unsigned& numThreads=0);
+    ///Returns true if there is a path from the first vertex ID to the second.
+    ///A vertex always reaches itself
+    bool isReachable (const uint64_t& fromID, const uint64_t& toID) const;
+    ///Returns true if the graph has no cycles (self loops included)
+    bool isAcyclic () const { return acyclic; }
+    ///Returns the number of strongly connected components
+    uint64_t getNumComponents () const { return dag.getNumVertex(); }
+    ///Returns the component of the vertex ID, or kNoVertex if it is not in the graph
+    uint64_t getComponent (const uint64_t& vID) const;
+    ///Returns the condensation DAG. Vertex IDs are component numbers, in topological order
+    const CompactGraph& getCondensation () const { return dag; }
+    ///Returns the number of queries answered
+    uint64_t getNumQueries () const { return numQueries.load(); }
+    ///Returns the number of queries that needed a DFS
+    uint64_t getNumFallbacks () const { return numFallbacks.load(); }
+    ///
+    /// \brief Returns the vertex indexes of a directed compact graph in
+    /// topological order, with Kahn's algorithm
+    ///
+    /// \throws runtime_error if the graph has cycles
+    //
+    static vector<uint64_t> topologicalSort (const CompactGraph& g);
+    ///Returns true if the directed compact graph has any cycle
+    static bool hasCycle (const CompactGraph& g);
+    
+private:
+    ///Builds the components, the condensation and the labels
+    void build (const uint64_t& seed, const unsigned& numThreads);
+    ///Runs Tarjan's algorithm, numbering the components in topological order
+    void strongComponents ();
+    ///Fills label number "l" with a randomized post-order DFS of the DAG
+    void intervalLabel (const uint8_t& l, const uint64_t& seed);
+    ///Returns false if the labels prove "to" is unreachable from "from". Both are components
+    bool mayReach (const uint64_t& from, const uint64_t& to) const;
+};
+
+#endif /* dasel_reachability_h */
@@ -0,0 +1,60 @@
+/**
+ * rng.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_rng_h
+#define dasel_rng_h
+
+#include <stdint.h>
+
+//#//////////////////////////////////////////////
+/// \brief Small and fast pseudo random number generator (SplitMix64).
+///
+/// The whole state is a single 64 bit word, so it is cheap to create one
+/// generator per thread, or even per work item. Creating one per work item
+/// from streamSeed() makes parallel results independent of the number of
+/// threads and of the scheduling.
+///
+class SplitMix64 {
+    uint64_t state;     ///Generator state
+public:
+    ///Creates a generator from the given seed
+    SplitMix64 (const uint64_t& seed) : state(seed) { }
+    ///Returns the next 64 bit random value
+    uint64_t next () {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    ///Returns a random value in [0, n). n must be bigger than 0
+    uint64_t nextBelow (const uint64_t& n) { return next() % n; }
+    ///Returns a random value in [0, 1)
+    double nextDouble () { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+///Returns the seed for the independent random stream number "stream" derived from "seed"
+inline uint64_t streamSeed (const uint64_t& seed, const uint64_t& stream) {
+    SplitMix64 mixer(seed ^ (stream * 0xD1B54A32D192ED03ULL));
+    return mixer.next();
+}
+
+#endif /* dasel_rng_h */
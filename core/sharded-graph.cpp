@@ -0,0 +1,332 @@
+/**
+* sharded-graph.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <stdexcept>
+#include "sharded-graph.hpp"
+#include "parallel.hpp"
+
+namespace {
+    ///Calls f for every neighbour of an owned vertex of a shard, in both directions for a directed graph
+    template <class TFunc>
+    void forEachNeighbour (const ShardedGraph::tShard& shard, const bool& directed, const uint64_t& v, TFunc f) {
+        for (const uint64_t* a = shard.graph.adjBegin(v); a != shard.graph.adjEnd(v); ++a) {
+            f(*a);
+        }
+        if (directed) {
+            for (const uint64_t* a = shard.in.adjBegin(v); a != shard.in.adjEnd(v); ++a) {
+                f(*a);
+            }
+        }
+    }
+    
+    ///Builds the local lists of the owned vertex of a shard, mapping global to local indexes
+    CompactGraph localGraph (const CompactGraph& g, const vector<uint64_t>& global, const vector<uint64_t>& owner,
+                             const uint64_t& shard, const vector<uint64_t>& localIndex) {
+        vector<uint64_t> ids(global.size());
+        vector<uint64_t> offs(global.size() + 1, 0);
+        vector<uint64_t> adj;
+        for (uint64_t i = 0; i < global.size(); ++i) {
+            ids[i] = g.getId(global[i]);
+            if (owner[i] == shard) {
+                //Local indexes follow the global ones, so the lists stay sorted
+                for (const uint64_t* a = g.adjBegin(global[i]); a != g.adjEnd(global[i]); ++a) {
+                    adj.push_back(localIndex[*a]);
+                }
+            }
+            offs[i + 1] = adj.size();
+        }
+        return CompactGraph(move(ids), move(offs), move(adj), g.isDirected());
+    }
+}
+
+//#/////////////////////////////////////////////////
+// InProcessTransport
+//
+void InProcessTransport::reset (const uint64_t& numShards) {
+    locks.reset(new mutex[numShards]);
+    filling.assign(numShards, vector<tMessage>());
+    delivered.assign(numShards, vector<tMessage>());
+}
+
+void InProcessTransport::send (const uint64_t& from, const uint64_t& to, vector<tMessage>& batch) {
+    if ((from >= filling.size()) || (to >= filling.size())) {
+        throw out_of_range("InProcessTransport: shard out of range");
+    }
+    if (batch.empty()) {
+        return;
+    }
+    countBatch(batch.size());
+    lock_guard<mutex> guard(locks[to]);
+    if (filling[to].empty()) {
+        filling[to].swap(batch);
+    }
+    else {
+        filling[to].insert(filling[to].end(), batch.begin(), batch.end());
+        batch.clear();
+    }
+}
+
+uint64_t InProcessTransport::exchange () {
+    uint64_t total = 0;
+    for (uint64_t s = 0; s < filling.size(); ++s) {
+        delivered[s].swap(filling[s]);
+        filling[s].clear();
+        total += delivered[s].size();
+    }
+    return total;
+}
+
+void InProcessTransport::receive (const uint64_t& shard, vector<tMessage>& messages) {
+    messages.clear();
+    messages.swap(delivered[shard]);
+}
+
+//#/////////////////////////////////////////////////
+// ShardedGraph
+//
+ShardedGraph::ShardedGraph (const GraphPartitioner& partitioner, const GraphPartitioner::tPartition& partition,
+                            shared_ptr<ShardTransport> transport, const unsigned& numThreads) :
+    numVertex(partitioner.getGraph().getNumVertex()), numGhosts(0), directed(partitioner.getGraph().isDirected()),
+    transport(transport ? transport : make_shared<InProcessTransport>()), threads((numThreads == 0) ? getNumThreads() : numThreads) {
+    const CompactGraph& g = partitioner.getGraph();
+    const CompactGraph& r = partitioner.getReverse();
+    const vector<uint64_t>& part = partition.part;
+    if ((partition.numParts == 0) || (part.size() != numVertex)) {
+        throw invalid_argument("ShardedGraph: partition does not match the graph");
+    }
+    shards.resize(partition.numParts);
+    for (uint64_t v = 0; v < numVertex; ++v) {
+        shards[part[v]].global.push_back(v);
+    }
+    vector<uint64_t> localIndex(numVertex, kNoVertex);
+    for (uint64_t s = 0; s < shards.size(); ++s) {
+        tShard& shard = shards[s];
+        shard.numOwned = shard.global.size();
+        for (auto v : shard.global) {
+            localIndex[v] = 0;
+        }
+        //Neighbours owned by other shards become ghosts. v is taken by value, as global grows
+        auto addGhosts = [&](const CompactGraph& adjGraph, uint64_t v) {
+            for (const uint64_t* a = adjGraph.adjBegin(v); a != adjGraph.adjEnd(v); ++a) {
+                if (localIndex[*a] == kNoVertex) {
+                    localIndex[*a] = 0;
+                    shard.global.push_back(*a);
+                }
+            }
+        };
+        for (uint64_t i = 0; i < shard.numOwned; ++i) {
+            addGhosts(g, shard.global[i]);
+            if (directed) {
+                addGhosts(r, shard.global[i]);
+            }
+        }
+        shard.numGhosts = shard.global.size() - shard.numOwned;
+        numGhosts += shard.numGhosts;
+        sort(shard.global.begin(), shard.global.end());
+        shard.owner.resize(shard.global.size());
+        for (uint64_t i = 0; i < shard.global.size(); ++i) {
+            localIndex[shard.global[i]] = i;
+            shard.owner[i] = part[shard.global[i]];
+        }
+        shard.graph = localGraph(g, shard.global, shard.owner, s, localIndex);
+        if (directed) {
+            shard.in = localGraph(r, shard.global, shard.owner, s, localIndex);
+        }
+        for (auto v : shard.global) {
+            localIndex[v] = kNoVertex;
+        }
+    }
+    //Where every ghost lives in its owner
+    for (uint64_t s = 0; s < shards.size(); ++s) {
+        tShard& shard = shards[s];
+        shard.remote.resize(shard.global.size());
+        for (uint64_t i = 0; i < shard.global.size(); ++i) {
+            const vector<uint64_t>& ownerGlobal = shards[shard.owner[i]].global;
+            shard.remote[i] = lower_bound(ownerGlobal.begin(), ownerGlobal.end(), shard.global[i]) - ownerGlobal.begin();
+        }
+    }
+}
+
+template <class TFunc>
+ShardedGraph::tRunStats ShardedGraph::run (TFunc step) const {
+    uint64_t k = shards.size();
+    uint64_t firstMessages = transport->getNumMessages();
+    uint64_t firstBatches = transport->getNumBatches();
+    transport->reset(k);
+    vector<vector<ShardTransport::tMessage> > inbox(k);
+    tRunStats stats = {0, 0, 0, 0};
+    while (true) {
+        atomic<uint64_t> busy(0);
+        parallelFor(0, k, [&](uint64_t s) {
+            transport->receive(s, inbox[s]);
+            if (step(s, inbox[s])) {
+                busy.fetch_add(1, memory_order_relaxed);
+            }
+        }, 1, threads);
+        ++stats.supersteps;
+        if ((transport->exchange() == 0) && (busy.load() == 0)) {
+            break;
+        }
+    }
+    stats.messages = transport->getNumMessages() - firstMessages;
+    stats.batches = transport->getNumBatches() - firstBatches;
+    stats.bytes = stats.messages * sizeof(ShardTransport::tMessage);
+    return stats;
+}
+
+ShardedGraph::tRunStats ShardedGraph::bfs (const uint64_t& srcIdx, vector<uint64_t>& dist) const {
+    if (srcIdx >= numVertex) {
+        throw out_of_range("ShardedGraph: vertex index out of range");
+    }
+    uint64_t k = shards.size();
+    vector<vector<uint64_t> > localDist(k);
+    vector<vector<uint64_t> > frontier(k);
+    vector<vector<uint64_t> > next(k);
+    vector<vector<vector<ShardTransport::tMessage> > > outbox(k, vector<vector<ShardTransport::tMessage> >(k));
+    for (uint64_t s = 0; s < k; ++s) {
+        localDist[s].assign(shards[s].global.size(), kNoVertex);
+    }
+    //The source starts the frontier of its owner
+    for (uint64_t s = 0; s < k; ++s) {
+        const vector<uint64_t>& global = shards[s].global;
+        uint64_t local = lower_bound(global.begin(), global.end(), srcIdx) - global.begin();
+        if ((local < global.size()) && (global[local] == srcIdx) && (shards[s].owner[local] == s)) {
+            localDist[s][local] = 0;
+            frontier[s].push_back(local);
+        }
+    }
+    tRunStats stats = run([&](const uint64_t& s, vector<ShardTransport::tMessage>& messages) {
+        const tShard& shard = shards[s];
+        vector<uint64_t>& d = localDist[s];
+        for (auto& m : messages) {
+            if (d[m.vertex] == kNoVertex) {
+                d[m.vertex] = m.value;
+                frontier[s].push_back(m.vertex);
+            }
+        }
+        next[s].clear();
+        for (auto v : frontier[s]) {
+            for (const uint64_t* a = shard.graph.adjBegin(v); a != shard.graph.adjEnd(v); ++a) {
+                if (d[*a] != kNoVertex) {
+                    continue;
+                }
+                //A ghost is only sent the first time it is reached, at its smallest distance
+                d[*a] = d[v] + 1;
+                if (shard.owner[*a] == s) {
+                    next[s].push_back(*a);
+                }
+                else {
+                    outbox[s][shard.owner[*a]].push_back({shard.remote[*a], d[*a]});
+                }
+            }
+        }
+        frontier[s].swap(next[s]);
+        for (uint64_t to = 0; to < k; ++to) {
+            transport->send(s, to, outbox[s][to]);
+        }
+        return !frontier[s].empty();
+    });
+    dist.assign(numVertex, kNoVertex);
+    parallelFor(0, k, [&](uint64_t s) {
+        for (uint64_t i = 0; i < shards[s].global.size(); ++i) {
+            if (shards[s].owner[i] == s) {
+                dist[shards[s].global[i]] = localDist[s][i];
+            }
+        }
+    }, 1, threads);
+    return stats;
+}
+
+ShardedGraph::tRunStats ShardedGraph::components (vector<uint64_t>& label) const {
+    uint64_t k = shards.size();
+    vector<vector<uint64_t> > localLabel(k);
+    vector<vector<uint64_t> > work(k);
+    vector<vector<uint8_t> > queued(k);
+    vector<vector<vector<ShardTransport::tMessage> > > outbox(k, vector<vector<ShardTransport::tMessage> >(k));
+    vector<uint8_t> started(k, 0);
+    tRunStats stats = run([&](const uint64_t& s, vector<ShardTransport::tMessage>& messages) {
+        const tShard& shard = shards[s];
+        vector<uint64_t>& l = localLabel[s];
+        vector<uint64_t>& w = work[s];
+        vector<uint8_t>& q = queued[s];
+        if (!started[s]) {
+            //Every vertex, ghosts included, starts with its own index: it is in its component.
+            //Owned vertex take the smallest among their neighbours right away
+            started[s] = 1;
+            l = shard.global;
+            q.assign(l.size(), 0);
+            for (uint64_t v = 0; v < l.size(); ++v) {
+                if (shard.owner[v] == s) {
+                    forEachNeighbour(shard, directed, v, [&](const uint64_t& a) { l[v] = min(l[v], shard.global[a]); });
+                    w.push_back(v);
+                    q[v] = 1;
+                }
+            }
+        }
+        for (auto& m : messages) {
+            if ((m.value < l[m.vertex]) && !q[m.vertex]) {
+                w.push_back(m.vertex);
+                q[m.vertex] = 1;
+            }
+            l[m.vertex] = min(l[m.vertex], m.value);
+        }
+        vector<uint64_t> dirty;
+        while (!w.empty()) {
+            uint64_t v = w.back();
+            w.pop_back();
+            q[v] = 0;
+            forEachNeighbour(shard, directed, v, [&](const uint64_t& a) {
+                if (l[a] <= l[v]) {
+                    return;
+                }
+                l[a] = l[v];
+                if (!q[a]) {
+                    //Ghosts are queued only to be sent once
+                    q[a] = 1;
+                    if (shard.owner[a] == s) {
+                        w.push_back(a);
+                    }
+                    else {
+                        dirty.push_back(a);
+                    }
+                }
+            });
+        }
+        for (auto g : dirty) {
+            q[g] = 0;
+            outbox[s][shard.owner[g]].push_back({shard.remote[g], l[g]});
+        }
+        for (uint64_t to = 0; to < k; ++to) {
+            transport->send(s, to, outbox[s][to]);
+        }
+        return false;
+    });
+    label.assign(numVertex, kNoVertex);
+    parallelFor(0, k, [&](uint64_t s) {
+        for (uint64_t i = 0; i < shards[s].global.size(); ++i) {
+            if (shards[s].owner[i] == s) {
+                label[shards[s].global[i]] = localLabel[s][i];
+            }
+        }
+    }, 1, threads);
+    return stats;
+}
@@ -0,0 +1,196 @@
+/**
+ * sharded-graph.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_sharded_graph_h
+#define dasel_sharded_graph_h
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <stdint.h>
+#include "compact-graph.hpp"
+#include "partition.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Moves messages between the shards of a ShardedGraph.
+///
+/// Shards talk in supersteps. During a superstep every shard may send
+/// batches of messages to others, from its own thread. Between supersteps
+/// the driver calls exchange(), and the messages sent become available to
+/// receive() in the next superstep. This is the only interface the shards
+/// see, so an implementation over shared memory or sockets can replace
+/// InProcessTransport.
+///
+class ShardTransport {
+public:
+    /// Message addressed to a vertex of the destination shard
+    struct tMessage {
+        uint64_t vertex;    ///< Local index of the vertex in the destination shard
+        uint64_t value;     ///< Payload
+    };
+    
+    ///Creates a transport with no traffic
+    ShardTransport () : numMessages(0), numBatches(0) { }
+    virtual ~ShardTransport () { }
+    ///Prepares the transport for a number of shards, dropping any pending message
+    virtual void reset (const uint64_t& numShards) = 0;
+    ///Sends a batch of messages. Can be called from several threads. The batch may be left empty.
+    ///Throws out_of_range if a shard is not below the number of shards
+    virtual void send (const uint64_t& from, const uint64_t& to, vector<tMessage>& batch) = 0;
+    ///Makes the messages sent available to receive(). Returns the number of messages delivered
+    virtual uint64_t exchange () = 0;
+    ///Moves the messages delivered to a shard into the given vector. Can be called from several threads, for different shards
+    virtual void receive (const uint64_t& shard, vector<tMessage>& messages) = 0;
+    ///Returns the number of messages sent
+    uint64_t getNumMessages () const { return numMessages; }
+    ///Returns the number of batches sent
+    uint64_t getNumBatches () const { return numBatches; }
+    ///Returns the bytes of message payload sent
+    uint64_t getBytes () const { return numMessages * sizeof(tMessage); }
+    
+protected:
+    ///Adds a batch to the traffic statistics
+    void countBatch (const uint64_t& size) {
+        numMessages.fetch_add(size, memory_order_relaxed);
+        numBatches.fetch_add(1, memory_order_relaxed);
+    }
+    
+private:
+    atomic<uint64_t> numMessages;   ///Messages sent
+    atomic<uint64_t> numBatches;    ///Batches sent
+};
+
+//#//////////////////////////////////////////////
+/// \brief Transport between shards in the same process.
+///
+/// Each shard has an inbox being filled, protected by its own mutex, and an
+/// inbox being read. exchange() swaps them.
+///
+class InProcessTransport : public ShardTransport {
+public:
+    void reset (const uint64_t& numShards);
+    void send (const uint64_t& from, const uint64_t& to, vector<tMessage>& batch);
+    uint64_t exchange ();
+    void receive (const uint64_t& shard, vector<tMessage>& messages);
+    
+private:
+    unique_ptr<mutex[]> locks;              ///Protects the filling inbox of each shard
+    vector<vector<tMessage> > filling;      ///Messages sent in this superstep, by destination
+    vector<vector<tMessage> > delivered;    ///Messages sent in the previous superstep, by destination
+};
+
+//#//////////////////////////////////////////////
+/// \brief Runs traversals over a graph split in shards, as separate workers
+/// would, exchanging messages through a ShardTransport.
+///
+/// Each shard holds the vertex of its part and a ghost copy of every
+/// neighbour owned by another shard. Owned vertex keep their adjacency
+/// lists (and in lists for a directed graph) in local indexes; ghosts only
+/// know their owner and their index there. Vertex are identified across
+/// shards by their index in the partitioned graph ("global index").
+///
+/// Traversals run in supersteps, with every shard on its own thread:
+///   * bfs(): level synchronous. A shard expands its frontier; neighbours
+///     owned by other shards are sent to their owner, at most once per ghost,
+///     and join the owner's next frontier.
+///   * components(): min label propagation (weakly connected components for
+///     a directed graph). Each shard propagates labels locally until nothing
+///     changes, and sends the ghosts whose label dropped to their owner.
+/// Both stop after a superstep without messages and without local work.
+///
+/// Traversals of the same ShardedGraph must not run at the same time, as
+/// they share the transport.
+///
+class ShardedGraph {
+public:
+    /// Piece of the graph owned by one worker
+    struct tShard {
+        CompactGraph graph;         ///< Owned vertex and ghosts, with the (out) lists of the owned ones
+        CompactGraph in;            ///< In lists of the owned vertex, for a directed graph
+        vector<uint64_t> global;    ///< Global index of every local index
+        vector<uint64_t> owner;     ///< Shard owning every local index
+        vector<uint64_t> remote;    ///< Local index in the owner shard, for every local index
+        uint64_t numOwned;          ///< Vertex owned by the shard
+        uint64_t numGhosts;         ///< Ghost vertex in the shard
+    };
+    /// Traffic of a traversal
+    struct tRunStats {
+        uint64_t supersteps;    ///< Supersteps run
+        uint64_t messages;      ///< Messages exchanged
+        uint64_t batches;       ///< Message batches exchanged
+        uint64_t bytes;         ///< Bytes of message payload exchanged
+    };
+    
+    ///
+    /// \brief Splits a graph in shards
+    ///
+    /// \param partitioner Partitioner holding the graph
+    /// \param partition Assignment of the vertex to shards, one shard per part
+    /// \param transport Transport between shards. Null uses an InProcessTransport
+    /// \param numThreads Number of threads running the shards. 0 uses all hardware threads
+    //
+    ShardedGraph (const GraphPartitioner& partitioner, const GraphPartitioner::tPartition& partition,
+                  shared_ptr<ShardTransport> transport=nullptr, const unsigned& numThreads=0);
+    ///Returns the number of shards
+    uint64_t getNumShards () const { return shards.size(); }
+    ///Returns a shard
+    const tShard& getShard (const uint64_t& s) const { return shards[s]; }
+    ///Returns the number of vertex in the graph
+    uint64_t getNumVertex () const { return numVertex; }
+    ///Returns the total number of ghost vertex
+    uint64_t getNumGhosts () const { return numGhosts; }
+    ///Returns the transport between shards
+    const ShardTransport& getTransport () const { return *transport; }
+    ///
+    /// \brief Computes the distance from a vertex to all others, following out edges
+    ///
+    /// \param srcIdx Global index of the source vertex
+    /// \param dist Output, distance to every global index, kNoVertex if unreached
+    /// \return Traffic of the traversal
+    //
+    tRunStats bfs (const uint64_t& srcIdx, vector<uint64_t>& dist) const;
+    ///
+    /// \brief Computes the connected components, weakly connected for a directed graph
+    ///
+    /// \param label Output, smallest global index in the component of every global index
+    /// \return Traffic of the traversal
+    //
+    tRunStats components (vector<uint64_t>& label) const;
+    
+private:
+    vector<tShard> shards;                  ///All shards
+    uint64_t numVertex;                     ///Vertex in the graph
+    uint64_t numGhosts;                     ///Ghosts in all shards
+    bool directed;                          ///True for a directed graph
+    shared_ptr<ShardTransport> transport;   ///Transport between shards
+    unsigned threads;                       ///Threads running the shards
+    
+    ///Runs supersteps until one has no messages and step() reports no pending work.
+    ///step(s, messages) runs a shard with the messages it received
+    template <class TFunc>
+    tRunStats run (TFunc step) const;
+};
+
+#endif /* dasel_sharded_graph_h */
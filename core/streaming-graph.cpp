@@ -0,0 +1,264 @@
+/**
+* streaming-graph.cpp
+*
+* Copyright (c) 2017 by Javier G. Visiedo
+*
+* This file is part of dasel
+*
+* Dasel is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Dasel is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+*
+*/
+
+#include <stdexcept>
+#include "streaming-graph.hpp"
+
+namespace {
+    ///Returns the edge with the smallest ID first
+    pair<uint64_t, uint64_t> edgeKey (const uint64_t& a, const uint64_t& b) {
+        return (a < b) ? make_pair(a, b) : make_pair(b, a);
+    }
+}
+
+const uint64_t StreamingGraph::kMaxPending;
+const uint64_t StreamingGraph::EdgeTimes::kEmpty;
+
+//#/////////////////////////////////////////////////
+// StreamingGraph::EdgeTimes
+//
+StreamingGraph::EdgeTimes::EdgeTimes () : slots(16, tSlot{kEmpty, 0, 0}), mask(15), numEdges(0) { }
+
+uint64_t StreamingGraph::EdgeTimes::probe (const uint64_t& from, const uint64_t& to) const {
+    uint64_t i = home(from, to);
+    while ((slots[i].from != kEmpty) && ((slots[i].from != from) || (slots[i].to != to))) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void StreamingGraph::EdgeTimes::grow () {
+    vector<tSlot> old(2 * slots.size(), tSlot{kEmpty, 0, 0});
+    old.swap(slots);
+    mask = slots.size() - 1;
+    for (auto& slot : old) {
+        if (slot.from != kEmpty) {
+            slots[probe(slot.from, slot.to)] = slot;
+        }
+    }
+}
+
+uint64_t* StreamingGraph::EdgeTimes::find (const uint64_t& from, const uint64_t& to) {
+    tSlot& slot = slots[probe(from, to)];
+    return (slot.from != kEmpty) ? &slot.time : nullptr;
+}
+
+const uint64_t* StreamingGraph::EdgeTimes::find (const uint64_t& from, const uint64_t& to) const {
+    const tSlot& slot = slots[probe(from, to)];
+    return (slot.from != kEmpty) ? &slot.time : nullptr;
+}
+
+uint64_t* StreamingGraph::EdgeTimes::insert (const uint64_t& from, const uint64_t& to, const uint64_t& time, bool& added) {
+    uint64_t i = probe(from, to);
+    added = (slots[i].from == kEmpty);
+    if (added) {
+        //At most half of the slots are used
+        if (2 * (numEdges + 1) > slots.size()) {
+            grow();
+            i = probe(from, to);
+        }
+        slots[i] = tSlot{from, to, time};
+        ++numEdges;
+    }
+    return &slots[i].time;
+}
+
+void StreamingGraph::EdgeTimes::erase (const uint64_t& from, const uint64_t& to) {
+    uint64_t i = probe(from, to);
+    if (slots[i].from == kEmpty) {
+        return;
+    }
+    //Move back every later slot of the run which may take the hole
+    for (uint64_t j = (i + 1) & mask; slots[j].from != kEmpty; j = (j + 1) & mask) {
+        if (((j - home(slots[j].from, slots[j].to)) & mask) >= ((j - i) & mask)) {
+            slots[i] = slots[j];
+            i = j;
+        }
+    }
+    slots[i].from = kEmpty;
+    --numEdges;
+}
+
+//#/////////////////////////////////////////////////
+// StreamingGraph
+//
+StreamingGraph::StreamingGraph (const uint64_t& windowLength, const uint64_t& bucketWidth, const double& compactionRatio) :
+    window(windowLength), width(bucketWidth), maxTombstones(compactionRatio), now(0), numExpired(0) {
+    if (window == 0) {
+        throw invalid_argument("StreamingGraph: the window length must be positive");
+    }
+    if (width == 0) {
+        width = max<uint64_t>(window / 16, 1);
+    }
+    if (width > window) {
+        throw invalid_argument("StreamingGraph: the bucket width must not exceed the window length");
+    }
+}
+
+bool StreamingGraph::addEdge (const uint64_t& from, const uint64_t& to, const uint64_t& time) {
+    advance(time);
+    if (isExpired(time)) {
+        return false;
+    }
+    pair<uint64_t, uint64_t> key = edgeKey(from, to);
+    bool added;
+    uint64_t* seen = lastSeen.insert(key.first, key.second, time, added);
+    if (added) {
+        pending.push_back(key);
+        if (pending.size() >= kMaxPending) {
+            flush();
+        }
+    }
+    else if (time > *seen) {
+        //The bucket of the previous insertion expires it no earlier
+        bool sameBucket = (time - time % width == *seen - *seen % width);
+        *seen = time;
+        if (sameBucket) {
+            return true;
+        }
+    }
+    else {
+        return true;    //An insertion at the same or a later time is already logged
+    }
+    bucketOf(time).edges.push_back(key);
+    return true;
+}
+
+uint64_t StreamingGraph::addEdges (const vector<tTimedEdge>& edges) {
+    const uint64_t kAhead = 8;      //Edges between a prefetch and its lookup
+    uint64_t dropped = 0;
+    for (uint64_t i = 0; i < edges.size(); ++i) {
+        if (i + kAhead < edges.size()) {
+            pair<uint64_t, uint64_t> key = edgeKey(edges[i + kAhead].from, edges[i + kAhead].to);
+            lastSeen.prefetch(key.first, key.second);
+        }
+        dropped += !addEdge(edges[i].from, edges[i].to, edges[i].time);
+    }
+    return dropped;
+}
+
+void StreamingGraph::advance (const uint64_t& time) {
+    if (time <= now) {
+        return;
+    }
+    now = time;
+    if (!buckets.empty() && isExpired(buckets.front().start + width - 1)) {
+        expire();
+    }
+}
+
+void StreamingGraph::flush () {
+    if (pending.empty()) {
+        return;
+    }
+    //Drop the edges which expired while buffered
+    const uint64_t kAhead = 8;      //Edges between a prefetch and its lookup
+    uint64_t live = 0;
+    for (uint64_t i = 0; i < pending.size(); ++i) {
+        if (i + kAhead < pending.size()) {
+            lastSeen.prefetch(pending[i + kAhead].first, pending[i + kAhead].second);
+        }
+        if (lastSeen.find(pending[i].first, pending[i].second) != nullptr) {
+            pending[live++] = pending[i];
+        }
+    }
+    pending.resize(live);
+    graph.addEdges(pending);
+    pending.clear();
+}
+
+uint64_t StreamingGraph::getDeg (const uint64_t& vID) {
+    flush();
+    const UndirectedGraph::Vertex* v = graph.findVertex(vID);
+    return (v != nullptr) ? v->getDeg() : 0;
+}
+
+bool StreamingGraph::isEdge (const uint64_t& fromID, const uint64_t& toID) const {
+    //Edges of a bucket only partly out of the window are still in the table
+    pair<uint64_t, uint64_t> key = edgeKey(fromID, toID);
+    const uint64_t* time = lastSeen.find(key.first, key.second);
+    return (time != nullptr) && !isExpired(*time);
+}
+
+uint64_t StreamingGraph::getEdgeTime (const uint64_t& fromID, const uint64_t& toID) const {
+    pair<uint64_t, uint64_t> key = edgeKey(fromID, toID);
+    const uint64_t* time = lastSeen.find(key.first, key.second);
+    return ((time != nullptr) && !isExpired(*time)) ? *time : 0;
+}
+
+int16_t StreamingGraph::distance (const uint64_t& from, const uint64_t& to) {
+    flush();
+    return graph.distance(from, to);
+}
+
+StreamingGraph::tBucket& StreamingGraph::bucketOf (const uint64_t& time) {
+    uint64_t start = time - time % width;
+    //Almost every insertion goes to the newest bucket
+    if (buckets.empty() || (buckets.back().start < start)) {
+        buckets.push_back(tBucket());
+        buckets.back().start = start;
+        return buckets.back();
+    }
+    deque<tBucket>::iterator it = buckets.end();
+    while ((it != buckets.begin()) && ((it - 1)->start >= start)) {
+        --it;
+    }
+    if ((it == buckets.end()) || (it->start != start)) {
+        it = buckets.insert(it, tBucket());
+        it->start = start;
+    }
+    return *it;
+}
+
+void StreamingGraph::expire () {
+    //Buffered edges stay in the buffer: those expiring now are not in the
+    //graph, which ignores their removal, and flush() drops them
+    vector<pair<uint64_t, uint64_t> > removed;
+    while (!buckets.empty() && isExpired(buckets.front().start + width - 1)) {
+        const uint64_t kAhead = 8;      //Edges between a prefetch and its lookup
+        uint64_t end = buckets.front().start + width;
+        const vector<pair<uint64_t, uint64_t> >& edges = buckets.front().edges;
+        for (uint64_t i = 0; i < edges.size(); ++i) {
+            if (i + kAhead < edges.size()) {
+                lastSeen.prefetch(edges[i + kAhead].first, edges[i + kAhead].second);
+            }
+            //Skip the edges inserted again in a later bucket, or already removed
+            const uint64_t* time = lastSeen.find(edges[i].first, edges[i].second);
+            if ((time != nullptr) && (*time < end)) {
+                lastSeen.erase(edges[i].first, edges[i].second);
+                removed.push_back(edges[i]);
+            }
+        }
+        buckets.pop_front();
+    }
+    if (removed.empty()) {
+        return;
+    }
+    vector<uint64_t> isolated;
+    graph.removeEdges(removed, true, &isolated);
+    numExpired += removed.size();
+    graph.removeVertices(isolated, true);
+    //Each edge takes 2 adjacency entries
+    if (graph.getNumTombstones() > maxTombstones * 2 * graph.getNumEdges()) {
+        graph.compact();
+    }
+}
@@ -0,0 +1,191 @@
+/**
+ * streaming-graph.hpp
+ *
+ * Copyright (c) 2017 by Javier G. Visiedo
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#ifndef dasel_streaming_graph_h
+#define dasel_streaming_graph_h
+
+#include <deque>
+#include <vector>
+#include <stdint.h>
+#include "graph.hpp"
+#include "prefetch.hpp"
+
+using namespace std;
+
+//#//////////////////////////////////////////////
+/// \brief Implements an undirected graph over a sliding time window.
+///
+/// Every edge carries the timestamp of its last insertion, and expires once
+/// it falls out of the window, so a stream of interactions can be fed
+/// continuously without rebuilding the graph. Timestamps are plain integers
+/// in any unit (seconds, milliseconds...), and the latest one seen is the
+/// current time.
+///
+/// Expiry is batched. The window is split in buckets of "bucketWidth" time
+/// units, and each bucket keeps a log of the edges inserted in it. When a
+/// whole bucket falls out of the window, its edges not inserted again
+/// since are removed in one batch, as tombstones: adjacency lists are only
+/// compacted once the tombstones reach a fraction of the adjacency entries.
+/// Vertex left without edges are removed too. Edges may then outlive the
+/// window by up to one bucket width.
+///
+/// Inserted edges are buffered, and merged into the graph in one batch
+/// before the next query, or when the buffer is full. Expiry does not
+/// need the buffer merged: edges expiring while buffered are dropped from
+/// it instead.
+///
+/// The timestamps live in a flat hash table with open addressing, with no
+/// allocation per edge. Batches of edges prefetch their slots a few edges
+/// ahead, both on insertion and on expiry.
+///
+class StreamingGraph {
+public:
+    /// Edge with a timestamp
+    struct tTimedEdge {
+        uint64_t from;      ///< Vertex ID of one end
+        uint64_t to;        ///< Vertex ID of the other end
+        uint64_t time;      ///< Time of the interaction
+    };
+    /// Edges buffered before they are merged into the graph
+    static const uint64_t kMaxPending = 1 << 20;
+    
+    ///
+    /// \brief Creates an empty graph
+    ///
+    /// \param windowLength Edges older than this, relative to the current time, expire
+    /// \param bucketWidth Time span of each expiry bucket. 0 splits the window in 16 buckets
+    /// \param compactionRatio Adjacency lists are compacted when the tombstones
+    /// exceed this fraction of the adjacency entries
+    /// \throw invalid_argument if the window is 0 or shorter than a bucket
+    //
+    explicit StreamingGraph (const uint64_t& windowLength, const uint64_t& bucketWidth=0, const double& compactionRatio=0.25);
+    //#//////////////////////////////////////////////
+    // Modifiers
+    ///
+    /// \brief Inserts an edge, adding its ends if needed
+    ///
+    /// Inserting an edge already in the window refreshes its timestamp.
+    /// Timestamps may arrive out of order, as long as they are still in the
+    /// window. A later timestamp moves the current time forward, expiring
+    /// the buckets which fall out of the window.
+    ///
+    /// \param from Vertex ID of one end
+    /// \param to Vertex ID of the other end
+    /// \param time Time of the interaction
+    /// \return False if the edge was already out of the window and was dropped
+    //
+    bool addEdge (const uint64_t& from, const uint64_t& to, const uint64_t& time);
+    ///Inserts a batch of edges, as addEdge() does. Returns the number of edges dropped
+    ///for being out of the window
+    uint64_t addEdges (const vector<tTimedEdge>& edges);
+    ///Moves the current time forward, expiring the edges which fall out of the window.
+    ///Earlier times are ignored
+    void advance (const uint64_t& time);
+    ///Merges the buffered edges into the graph
+    void flush ();
+    //#//////////////////////////////////////////////
+    // Access
+    ///Returns the current time: the latest timestamp or time passed to advance()
+    uint64_t getTime () const { return now; }
+    ///Returns the window length
+    uint64_t getWindowLength () const { return window; }
+    ///Returns the width of the expiry buckets
+    uint64_t getBucketWidth () const { return width; }
+    ///Returns the number of live expiry buckets
+    uint64_t getNumBuckets () const { return buckets.size(); }
+    ///Returns the total number of edges expired so far
+    uint64_t getNumExpired () const { return numExpired; }
+    ///Returns the number of vertex in the window
+    uint64_t getNumVertex () { flush(); return graph.getNumVertex(); }
+    ///Returns the number of edges in the window
+    uint64_t getNumEdges () { flush(); return graph.getNumEdges(); }
+    ///Returns the degree of the vertex, 0 if it is not in the window
+    uint64_t getDeg (const uint64_t& vID);
+    ///Returns true if there is an edge between the 2 vertex in the window. Unlike
+    ///getNumEdges(), edges of a partly expired bucket are checked one by one
+    bool isEdge (const uint64_t& fromID, const uint64_t& toID) const;
+    ///Returns the timestamp of an edge, or 0 if it is not in the window
+    uint64_t getEdgeTime (const uint64_t& fromID, const uint64_t& toID) const;
+    ///Returns the distance between 2 vertex in the window, or -1 if there is no path
+    int16_t distance (const uint64_t& from, const uint64_t& to);
+    ///Returns the graph holding the edges in the window
+    const UndirectedGraph& getGraph () { flush(); return graph; }
+    
+private:
+    /// Log of the edges inserted in a time bucket
+    struct tBucket {
+        uint64_t start;                             ///Time of the first slot in the bucket
+        vector<pair<uint64_t, uint64_t> > edges;    ///Edges inserted, with the smallest ID first
+    };
+    /// Timestamp of every edge in the window, in a hash table with linear
+    /// probing. Edges have the smallest ID first
+    class EdgeTimes {
+        /// Table slot, empty when "from" is kEmpty
+        struct tSlot {
+            uint64_t from;
+            uint64_t to;
+            uint64_t time;
+        };
+        static const uint64_t kEmpty = UINT64_MAX;
+        vector<tSlot> slots;    ///Power of 2 array of slots
+        uint64_t mask;          ///slots.size() - 1
+        uint64_t numEdges;
+        ///Returns the first slot probed for an edge
+        uint64_t home (const uint64_t& from, const uint64_t& to) const {
+            return ((from * 0x9E3779B97F4A7C15ULL) ^ to) * 0xBF58476D1CE4E5B9ULL >> 20 & mask; }
+        ///Returns the slot holding an edge, or the empty slot where it goes
+        uint64_t probe (const uint64_t& from, const uint64_t& to) const;
+        ///Doubles the number of slots
+        void grow ();
+    public:
+        EdgeTimes ();
+        ///Returns the timestamp of an edge, or nullptr if it is not in the table
+        uint64_t* find (const uint64_t& from, const uint64_t& to);
+        const uint64_t* find (const uint64_t& from, const uint64_t& to) const;
+        ///Adds an edge with the given timestamp. Returns the timestamp of the edge in
+        ///the table, and sets "added" to false if it was already there
+        uint64_t* insert (const uint64_t& from, const uint64_t& to, const uint64_t& time, bool& added);
+        ///Removes an edge from the table
+        void erase (const uint64_t& from, const uint64_t& to);
+        ///Starts loading the first slot probed for an edge
+        void prefetch (const uint64_t& from, const uint64_t& to) const { prefetchRead(&slots[home(from, to)]); }
+    };
+    
+    uint64_t window;            ///Window length
+    uint64_t width;             ///Bucket width
+    double maxTombstones;       ///Fraction of tombstones triggering a compaction
+    uint64_t now;               ///Current time
+    uint64_t numExpired;        ///Edges expired so far
+    UndirectedGraph graph;      ///Edges in the window
+    deque<tBucket> buckets;     ///Edge logs, oldest first
+    EdgeTimes lastSeen;         ///Timestamp of every edge in the window
+    vector<pair<uint64_t, uint64_t> > pending;  ///Edges not merged into the graph yet
+    
+    ///Returns true if the given time has already fallen out of the window
+    bool isExpired (const uint64_t& time) const { return (time + window) <= now; }
+    ///Returns the log of the bucket holding the given time, adding buckets as needed
+    tBucket& bucketOf (const uint64_t& time);
+    ///Removes the buckets which fell out of the window, and their edges
+    void expire ();
+};
+
+#endif /* dasel_streaming_graph_h */
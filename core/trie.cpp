@@ -24,93 +24,215 @@
 
 #include <stdexcept>
 #include <stdint.h>
+#include <queue>
+#include <algorithm>
 #include "trie.hpp"
 
-void Trie::TrieNode::setChild(TrieNode *newNode){
-    if (newNode != nullptr) {
-        uint8_t idx = sanitizeContent(newNode->getContent()) - 'a';
-        children[idx] = newNode;
+const Trie::TNodeIndex Trie::kNoNode;
+const uint32_t Trie::kBlockBits;
+const uint32_t Trie::kBlockSize;
+
+void Trie::TrieNode::setChild(char letter, TNodeIndex child){
+    uint8_t idx = sanitizeContent(letter) - 'a';
+    if ((children[idx] == kNoNode) && (child != kNoNode)) {
+        ++numChildren;
+    }
+    else if ((children[idx] != kNoNode) && (child == kNoNode)) {
+        --numChildren;
     }
+    children[idx] = child;
 }
 
 void Trie::TrieNode::removeChild(char letter){
-    uint8_t idx = sanitizeContent(letter) - 'a';
-    if ( children[idx] != nullptr) {
-        if ( !children[idx]->getNumChildren() ) {
-            delete(children[idx]);
-            children[idx] = nullptr;
-        }
+    setChild(letter, kNoNode);
+}
+
+void Trie::TrieNode::clearChildren () {
+    for (uint8_t i = 0; i < kAlphabetSize; ++i) {
+        children[i] = kNoNode;
     }
 }
 
-char Trie::TrieNode::sanitizeContent (const char& letter) {
-    char c = tolower(letter);
-    if ((c < 'a') || (c >'z') ){
-        throw out_of_range("TrieNode: Character out of range");
+Trie& Trie::operator = (const Trie& t) {
+    if (&t != this) {
+        blocks.clear();
+        for (auto& b : t.blocks) {
+            blocks.emplace_back(new TrieNode[kBlockSize]);
+            copy(b.get(), b.get() + kBlockSize, blocks.back().get());
+        }
+        numNodes = t.numNodes;
+        freeList = t.freeList;
+        numFree = t.numFree;
+        dictionarySize = t.dictionarySize;
     }
-    return c;
+    return *this;
 }
 
-void Trie::deleteTrie(TrieNode *node){
-    if (node == nullptr) {
-        return;
+void Trie::clear () {
+    //Node pointers are only held by the pool, so freeing the blocks is enough
+    blocks.clear();
+    blocks.emplace_back(new TrieNode[kBlockSize]);
+    numNodes = 1;       //The root
+    freeList = kNoNode;
+    numFree = 0;
+    dictionarySize = 0;
+}
+
+Trie::TNodeIndex Trie::newNode (const char& letter, const TNodeIndex& parent) {
+    TNodeIndex idx;
+    if (freeList != kNoNode) {
+        idx = freeList;
+        freeList = node(idx).parent;
+        --numFree;
     }
-    for (uint8_t i=0; i < kAlphabetSize; ++i) {
-        if (node->getChild(i + 'a') != nullptr) {
-            deleteTrie(node->getChild(i + 'a'));
-            node->removeChild(i + 'a');
+    else {
+        if (numNodes == kNoNode) {
+            throw length_error("Trie: node pool full");
+        }
+        if ((numNodes >> kBlockBits) == blocks.size()) {
+            blocks.emplace_back(new TrieNode[kBlockSize]);
         }
+        idx = numNodes++;
     }
+    node(idx) = TrieNode(letter, parent);
+    return idx;
 }
 
-void Trie::insertWord (const string& word){
-    TrieNode* currentNode = root;
-    TrieNode* newNode;
+void Trie::freeNode (const TNodeIndex& idx) {
+    node(idx).parent = freeList;
+    freeList = idx;
+    ++numFree;
+}
+
+Trie::TNodeIndex Trie::addWord (const string& word) {
+    //Check the whole word first, so a bad character leaves the trie untouched
+    for (auto c : word) {
+        TrieNode::sanitizeContent(c);
+    }
+    TNodeIndex current = 0;
     for (auto c : word){
-        newNode = currentNode->getChild(c);
-        if ( newNode == nullptr) {
-            newNode = new TrieNode (c, currentNode);
-            currentNode->setChild(newNode);
+        TNodeIndex next = node(current).getChild(c);
+        if (next == kNoNode) {
+            next = newNode(c, current);
+            node(current).setChild(c, next);
         }
-        currentNode = newNode;
+        current = next;
+    }
+    if (!node(current).isWord()) {
+        node(current).setWordMarker(true);
+        ++dictionarySize;
     }
-    currentNode->setWordMarker(true);
-    ++dictionarySize;
+    return current;
 }
 
-void Trie::removeWord (const string& word) {
-    TrieNode* leaf;
-    if ((leaf = searchWord (word)) != nullptr) {
-        leaf->setWordMarker(false);
-        while ((leaf != root)){
-            if (leaf->getNumChildren() || leaf->isWord()) { //Done deleting nodes
-                leaf = root;
-            }
-            else {
-                char letter = leaf->getContent();
-                leaf = leaf->getParent();
-                leaf->removeChild(letter);
+void Trie::insertWord (const string& word){
+    addWord(word);
+}
+
+void Trie::insertWord (const string& word, const uint64_t& score){
+    TNodeIndex leaf = addWord(word);
+    node(leaf).score = score;
+    updateMaxScore(leaf);
+}
+
+void Trie::updateMaxScore (TNodeIndex idx) {
+    while (idx != kNoNode) {
+        TrieNode& n = node(idx);
+        uint64_t best = n.score;
+        for (uint8_t i = 0; i < kAlphabetSize; ++i) {
+            if (n.children[i] != kNoNode) {
+                best = max(best, node(n.children[i]).maxScore);
             }
         }
-        --dictionarySize;
+        //Nodes above only depend on this one through its highest score
+        if (best == n.maxScore) {
+            return;
+        }
+        n.maxScore = best;
+        idx = n.parent;
+    }
+}
+
+void Trie::removeWord (const string& word) {
+    TNodeIndex leaf = findNode(word);
+    if ((leaf == kNoNode) || !node(leaf).isWord()) {
+        return;
+    }
+    node(leaf).setWordMarker(false);
+    node(leaf).score = 0;
+    //Prune the nodes left without words under them
+    while ((leaf != 0) && !node(leaf).getNumChildren() && !node(leaf).isWord()) {
+        TNodeIndex parent = node(leaf).getParent();
+        node(parent).removeChild(node(leaf).getContent());
+        freeNode(leaf);
+        leaf = parent;
     }
+    updateMaxScore(leaf);
+    --dictionarySize;
 }
 
-Trie::TrieNode* Trie::searchWord (const string& word, const bool& searchWholeWord) const {
-    TrieNode * currentNode = root;
-    TrieNode * nextNode;
-    
+Trie::TNodeIndex Trie::findNode (const string& word) const {
+    TNodeIndex current = 0;
     for (auto c : word){
-        if ( (nextNode = currentNode->getChild(c)) == nullptr){
-            return nullptr;
+        if ((current = node(current).getChild(c)) == kNoNode) {
+            return kNoNode;
         }
-        currentNode = nextNode;
     }
-    if ((currentNode->isWord()) || (!searchWholeWord)) {
-        return currentNode;
+    return current;
+}
+
+const Trie::TrieNode* Trie::searchWord (const string& word, const bool& searchWholeWord) const {
+    TNodeIndex found = findNode(word);
+    if ((found != kNoNode) && (node(found).isWord() || !searchWholeWord)) {
+        return &node(found);
     }
     else {
         return nullptr;
     }
 }
 
+vector<Trie::tCompletion> Trie::topK (const string& prefix, const uint64_t& k) const {
+    vector<tCompletion> result;
+    TNodeIndex start = findNode(prefix);
+    if ((start == kNoNode) || (k == 0)) {
+        return result;
+    }
+    //Best first search on the highest subtree scores. A node goes in the heap
+    //twice: once to open its children, with the highest score under it, and
+    //once as a finished word, with its own score. A word leaves the heap
+    //before any node with the same score, since nothing under them beats it
+    struct tItem {
+        uint64_t score;
+        bool isWord;
+        TNodeIndex idx;
+        bool operator < (const tItem& i) const { return (score < i.score) || ((score == i.score) && (isWord < i.isWord)); }
+    };
+    priority_queue<tItem> heap;
+    heap.push({node(start).maxScore, false, start});
+    while (!heap.empty() && (result.size() < k)) {
+        tItem item = heap.top();
+        heap.pop();
+        const TrieNode& n = node(item.idx);
+        if (item.isWord) {
+            //Rebuild the word walking up to the prefix
+            string suffix;
+            for (TNodeIndex i = item.idx; i != start; i = node(i).parent) {
+                suffix += node(i).content;
+            }
+            string word(prefix.size(), 0);
+            transform(prefix.begin(), prefix.end(), word.begin(), ::tolower);
+            word.append(suffix.rbegin(), suffix.rend());
+            result.push_back({word, item.score});
+            continue;
+        }
+        if (n.wordMarker) {
+            heap.push({n.score, true, item.idx});
+        }
+        for (uint8_t i = 0; i < kAlphabetSize; ++i) {
+            if (n.children[i] != kNoNode) {
+                heap.push({node(n.children[i]).maxScore, false, n.children[i]});
+            }
+        }
+    }
+    return result;
+}
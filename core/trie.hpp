@@ -27,9 +27,11 @@
 
 #include <string>
 #include <vector>
-#include <stdint.h>
+#include <memory>
 #include <stdint.h>
 #include <cstddef>
+#include <cctype>
+#include <stdexcept>
 
 using namespace std;
 
@@ -41,62 +43,111 @@ const unsigned short kAlphabetSize = 26;    //Using only lowercase english lette
 /// The trie supports only english letters, and it is not case sensitive.
 /// The Trie class contains a TrieNode class representing each node in the tree
 ///
+/// Nodes live in a pool owned by the trie: fixed size blocks of nodes,
+/// allocated as the trie grows and never moved, so a TrieNode pointer stays
+/// valid until its node is removed. Nodes refer to their parent and children
+/// by 32 bit index in the pool instead of by pointer, which halves the links
+/// of a node. Removed nodes go to a free list and are reused by later inserts.
+/// Destroying or clearing the trie frees whole blocks, without visiting the
+/// nodes.
+///
+/// Words may carry a score, used to rank completions in topK. Every node
+/// keeps the highest score in its subtree, updated along the path of each
+/// insert and remove, so topK is a best first search which only opens the
+/// nodes leading to the k best words instead of walking the whole subtree
+/// under the prefix. The 2 scores take 16 of the 136 bytes of a node, and
+/// make lookups slower than with the smaller nodes without scores.
+///
 class Trie {
     
 public:
+    /// Index of a node in the pool
+    typedef uint32_t TNodeIndex;
+    /// Index standing for no node
+    static const TNodeIndex kNoNode = UINT32_MAX;
+    /// A completion returned by topK
+    struct tCompletion {
+        string word;        ///< Whole word, in lowercase
+        uint64_t score;     ///< Score of the word
+    };
+    
     /// Represents a node in the trie, containing a single character in a word or prefix
     class TrieNode {
         
     public:
         /// Creates an empty trie node. To be used for the root node only
-        TrieNode (): parent(nullptr), content(0), numChildren(0), wordMarker (false) {}
+        TrieNode (): parent(kNoNode), content(0), numChildren(0), wordMarker (false), score(0), maxScore(0) { clearChildren(); }
         //#//////////////////////////////////////////////
         ///
         /// \brief Creates a trie node for the specified character
         ///
         /// Must be used to create any regular node (i.e. not root), since
         /// the class interface does not offer any other way to set the
-        /// content or pointer to the parent node.
+        /// content or index of the parent node.
         ///
         ///  \param letter the caracter represented by the node
-        ///  \param p pointer to the parent node
+        ///  \param p index of the parent node
         //
-        TrieNode (char letter, TrieNode *p): parent(p), content(sanitizeContent(letter)), numChildren(0), wordMarker(false) {}
+        TrieNode (char letter, TNodeIndex p): parent(p), content(sanitizeContent(letter)), numChildren(0), wordMarker(false), score(0), maxScore(0) { clearChildren(); }
         /// Returns the number of direct descendants of the node
-        uint8_t getNumChildren () { return numChildren; }
-        /// Returns a pointer to the children representing a given letter
-        TrieNode *getChild (char letter) { return children[sanitizeContent(letter) - 'a']; }
+        uint8_t getNumChildren () const { return numChildren; }
+        /// Returns the index of the children representing a given letter, kNoNode if there is none
+        TNodeIndex getChild (char letter) const { return children[sanitizeContent(letter) - 'a']; }
         /// Returns the letter represented by the node
-        char getContent () { return content; }
+        char getContent () const { return content; }
         /// Indicates if the node represents the end of a whole word
-        bool isWord () { return wordMarker; }
-        /// Returns a TrieNode pointer to the parent node
-        TrieNode *getParent () { return parent; }
-        /// Insert a pointer to a new child node. The new node must have a valid conten within the allowed alphabet
-        void setChild (TrieNode *newNode);
-        /// Removes the pointer to a specific child
+        bool isWord () const { return wordMarker; }
+        /// Returns the index of the parent node, kNoNode for the root
+        TNodeIndex getParent () const { return parent; }
+        /// Returns the score of the word ending at the node, 0 if it is not a word
+        uint64_t getScore () const { return score; }
+        /// Returns the highest score of the words in the subtree of the node
+        uint64_t getMaxScore () const { return maxScore; }
+        /// Sets the index of the child for a letter in the allowed alphabet
+        void setChild (char letter, TNodeIndex child);
+        /// Removes the index of the child for a letter
         void removeChild (char letter);
         /// Sets the value of the whole word marker
         void setWordMarker (bool flag) {wordMarker = flag;}
         
     private:
-        TrieNode* parent;  ///< Pointer to the parent node
+        TNodeIndex parent;  ///< Index of the parent node. Next free node while in the free list
         char content;       /// letter represented by the node
-        TrieNode* children[kAlphabetSize] = { nullptr };    ///< Pointers to children nodes
+        TNodeIndex children[kAlphabetSize];     ///< Indexes of children nodes
         uint8_t numChildren;    ///NUmber of direct descendants
         bool wordMarker;    ///< True if the node is the end of a whole word
+        uint64_t score;     ///< Score of the word ending at the node
+        uint64_t maxScore;  ///< Highest score in the subtree of the node
+        /// Sets all children to kNoNode
+        void clearChildren ();
         /// Check that the letter represented by the node fits the allowed alphabet
-        char sanitizeContent (const char& letter);
+        static char sanitizeContent (const char& letter) {
+            char c = tolower(letter);
+            if ((c < 'a') || (c >'z') ){
+                throw out_of_range("TrieNode: Character out of range");
+            }
+            return c;
+        }
+        friend class Trie;
     };
 
     /// The default constructor, creates an empty tree with just the root node
-    Trie (): root(new TrieNode), dictionarySize(0) {}
-    ~Trie () { deleteTrie(root); }
-    ///  \brief Inserts a word in the trie
+    Trie (): numNodes(0), freeList(kNoNode), numFree(0), dictionarySize(0) { clear(); }
+    /// Copy constructor, copies the node pool as is
+    Trie (const Trie& t) : numNodes(0), freeList(kNoNode), numFree(0), dictionarySize(0) { *this = t; }
+    /// Assignment operator, copies the node pool as is
+    Trie& operator = (const Trie& t);
+    ///  \brief Inserts a word in the trie. Words already in the trie are ignored
     ///
     ///  \param word Word to be inserted in the tree
     //
     void insertWord (const string& word);
+    ///  \brief Inserts a word with a score. Words already in the trie take the new score
+    ///
+    ///  \param word Word to be inserted in the tree
+    ///  \param score Score of the word, used to rank completions in topK
+    //
+    void insertWord (const string& word, const uint64_t& score);
     ///
     ///  \brief Removes a word from the trie
     ///
@@ -112,21 +163,54 @@ public:
     ///  \return Pointer to the ending node for the word. Null if the word is not
     /// part of the trie
     //
-    TrieNode *searchWord (const string& word, const bool& isWhole=true) const;
+    const TrieNode *searchWord (const string& word, const bool& isWhole=true) const;
     /// Returns true if the given string is a prefix or word in the dictionary
     bool isPrefix (const string& prefix) const { return (searchWord(prefix, false) != nullptr) ? true : false; }
     /// Returns true if the given string is a word in the dictionary
     bool isWord (const string& word) const { return (searchWord(word, true) != nullptr) ? true : false; }
+    ///
+    ///  \brief Returns the best scored words starting with a prefix
+    ///
+    ///  \param prefix Prefix of the words, which may be a word itself
+    ///  \param k Maximum number of words returned
+    ///  \return Up to k words, from the highest score down. Words with the
+    /// same score come in no particular order
+    //
+    vector<tCompletion> topK (const string& prefix, const uint64_t& k) const;
     ///Returns the number of whole words in the dictionary
-    uint64_t getDictionarySize() {return dictionarySize;}
+    uint64_t getDictionarySize() const {return dictionarySize;}
+    ///Removes all words, freeing the node pool in bulk
+    void clear ();
+    ///Returns the root node
+    const TrieNode& getRoot () const { return node(0); }
+    ///Returns the node with the given index
+    const TrieNode& getNode (const TNodeIndex& idx) const { return node(idx); }
+    ///Returns the number of nodes in the trie, the root included
+    uint64_t getNumNodes () const { return numNodes - numFree; }
+    ///Returns the bytes allocated by the node pool
+    uint64_t getMemoryUsage () const { return blocks.size() * (kBlockSize * sizeof(TrieNode) + sizeof(blocks[0])); }
     
 private:
-    TrieNode *root;
+    static const uint32_t kBlockBits = 10;              ///Log2 of the nodes per block
+    static const uint32_t kBlockSize = 1 << kBlockBits; ///Nodes per block
+    vector<unique_ptr<TrieNode[]> > blocks; ///Node pool
+    TNodeIndex numNodes;        ///Nodes handed out by the pool, free ones included
+    TNodeIndex freeList;        ///First removed node, kNoNode if none
+    uint64_t numFree;           ///Nodes in the free list
     uint64_t dictionarySize;
-    ///
-    /// \brief Removes all nodes in the tree under a given node, and frees up
-    /// memory by making a post order traversal
-    void deleteTrie (TrieNode *node);
+    ///Returns the node with the given index
+    TrieNode& node (const TNodeIndex& idx) { return blocks[idx >> kBlockBits][idx & (kBlockSize - 1)]; }
+    const TrieNode& node (const TNodeIndex& idx) const { return blocks[idx >> kBlockBits][idx & (kBlockSize - 1)]; }
+    ///Takes a node from the pool, and returns its index
+    TNodeIndex newNode (const char& letter, const TNodeIndex& parent);
+    ///Returns a node to the pool
+    void freeNode (const TNodeIndex& idx);
+    ///Returns the index of the node reached by a string, kNoNode if there is none
+    TNodeIndex findNode (const string& word) const;
+    ///Adds the nodes of a word, and returns the index of its last node
+    TNodeIndex addWord (const string& word);
+    ///Recomputes the highest subtree score from a node up to the root
+    void updateMaxScore (TNodeIndex idx);
 };
 
 
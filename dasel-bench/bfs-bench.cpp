@@ -0,0 +1,89 @@
+//
+//  bfs-bench.cpp
+//  BFS traversal throughput benchmark
+//
+//  Compares plain and group-prefetched BFS on graphs much bigger than the
+//  last level cache: an R-MAT CompactGraph, and a uniform random
+//  UndirectedGraph. Usage: bfs-bench [scale] [edgeFactor] [hashScale]
+//    scale       log2 of the vertex of the CompactGraph (default 22)
+//    edgeFactor  edges per vertex (default 8)
+//    hashScale   log2 of the vertex of the UndirectedGraph (default 18)
+//
+//  Copyright © 2017 visiedo. All rights reserved.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include "graph.hpp"
+#include "compact-graph.hpp"
+#include "graph-generator.hpp"
+
+using namespace std;
+
+namespace {
+    double secondsSince (const chrono::steady_clock::time_point& start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, const char * argv[]) {
+    uint8_t scale = (argc > 1) ? atoi(argv[1]) : 22;
+    uint64_t edgeFactor = (argc > 2) ? atoi(argv[2]) : 8;
+    uint8_t hashScale = (argc > 3) ? atoi(argv[3]) : 18;
+    const uint64_t numSources = 8;
+    GraphGenerator gen(1);
+    
+    //CompactGraph: edges traversed per second
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    uint64_t n = 1ULL << scale;
+    CompactGraph cg = CompactGraph::fromEdges(n, gen.rmat(scale, edgeFactor), false);
+    cout << "CompactGraph: " << cg.getNumVertex() << " vertex, " << cg.getNumEdges() << " edges, "
+         << (cg.getAdjacency().size() * sizeof(uint64_t) >> 20) << " MB of adjacency. Built in " << secondsSince(start) << " s" << endl;
+    vector<uint64_t> dist;
+    uint64_t groups[] = {0, 4, 8, 16, 32, 64};
+    double baseline = 0;
+    for (auto g : groups) {
+        uint64_t edges = 0;
+        double seconds = 0;
+        for (uint64_t s = 0; s < numSources; ++s) {
+            uint64_t src = (s * 2654435761ULL) % n;
+            start = chrono::steady_clock::now();
+            cg.bfs(src, dist, g);
+            seconds += secondsSince(start);
+            //Edges of the reached vertex, counted out of the timed region
+            for (uint64_t v = 0; v < n; ++v) {
+                if (dist[v] != kNoVertex) {
+                    edges += cg.getDeg(v);
+                }
+            }
+        }
+        double mteps = edges / seconds / 1e6;
+        if (g == 0) {
+            baseline = mteps;
+        }
+        cout << "\tgroup " << g << ":\t" << mteps << " MTEPS\t(x" << mteps / baseline << ")" << endl;
+    }
+    
+    //UndirectedGraph: full traversals (unreachable target) per second
+    start = chrono::steady_clock::now();
+    uint64_t hn = 1ULL << hashScale;
+    UndirectedGraph ug(hn);
+    ug.addEdges(gen.gnm(hn, hn * edgeFactor / 2, false));
+    ug.addVertex(hn);
+    cout << "UndirectedGraph: " << ug.getNumVertex() << " vertex, " << ug.getNumEdges() << " edges. Built in " << secondsSince(start) << " s" << endl;
+    uint64_t hashGroups[] = {0, 8, 16, 32};
+    for (auto g : hashGroups) {
+        start = chrono::steady_clock::now();
+        for (uint64_t s = 0; s < numSources; ++s) {
+            uint64_t src = (s * 2654435761ULL) % hn;
+            int16_t d = (g == 0) ? ug.distance(src, hn) : ug.distance(src, hn, g);
+            if (d != -1) {
+                cout << "Unexpected path" << endl;
+            }
+        }
+        double seconds = secondsSince(start);
+        cout << "\tgroup " << g << ":\t" << seconds / numSources * 1000 << " ms per traversal" << endl;
+    }
+    return 0;
+}
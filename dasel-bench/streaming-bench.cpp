@@ -0,0 +1,60 @@
+//
+//  streaming-bench.cpp
+//  StreamingGraph insert throughput benchmark
+//
+//  Streams random edges with increasing timestamps, one per edge, into a
+//  StreamingGraph, without expiry and with a window holding a fraction of
+//  the stream. Usage:
+//  streaming-bench [numEdges] [numVertex] [window]
+//    numEdges    edges streamed (default 10000000)
+//    numVertex   vertex IDs drawn from [0, numVertex) (default 1000000)
+//    window      window length, in edges (default 2000000)
+//
+//  Copyright © 2017 visiedo. All rights reserved.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include "streaming-graph.hpp"
+#include "rng.hpp"
+
+using namespace std;
+
+namespace {
+    double secondsSince (const chrono::steady_clock::time_point& start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    
+    ///Streams the edges in batches, and prints the throughput
+    void run (const string& name, const vector<StreamingGraph::tTimedEdge>& edges, const uint64_t& window) {
+        const uint64_t kBatch = 1 << 16;
+        StreamingGraph g(window);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (uint64_t i = 0; i < edges.size(); i += kBatch) {
+            vector<StreamingGraph::tTimedEdge> batch(edges.begin() + i, edges.begin() + min<uint64_t>(edges.size(), i + kBatch));
+            g.addEdges(batch);
+        }
+        g.flush();
+        double seconds = secondsSince(start);
+        cout << name << ":\t" << edges.size() / seconds / 1e6 << " M edges/s\t" << g.getNumEdges() << " edges and "
+             << g.getNumVertex() << " vertex in the window, " << g.getNumExpired() << " expired" << endl;
+    }
+}
+
+int main(int argc, const char * argv[]) {
+    uint64_t numEdges = (argc > 1) ? atoll(argv[1]) : 10000000;
+    uint64_t numVertex = (argc > 2) ? atoll(argv[2]) : 1000000;
+    uint64_t window = (argc > 3) ? atoll(argv[3]) : 2000000;
+    SplitMix64 rng(1);
+    vector<StreamingGraph::tTimedEdge> edges(numEdges);
+    for (uint64_t i = 0; i < numEdges; ++i) {
+        edges[i].from = rng.nextBelow(numVertex);
+        edges[i].to = rng.nextBelow(numVertex);
+        edges[i].time = i + 1;
+    }
+    run("No expiry", edges, numEdges + 1);
+    run("Window", edges, window);
+    return 0;
+}
@@ -0,0 +1,171 @@
+//
+//  trie-bench.cpp
+//  Trie insert and search throughput benchmark
+//
+//  Compares the pooled Trie with the previous design, one heap allocation
+//  per node with 8 byte child pointers, and with AdaptiveTrie and RadixTrie,
+//  on random short and long words. LoudsTrie, which is built from a Trie
+//  rather than by insertions, reports its freeze time as insert time. The
+//  words come from a fixed seed, so every run uses the same input. Usage:
+//  trie-bench [numWords] [fileName]
+//    numWords    words inserted (default 1000000)
+//    fileName    scratch file for LoudsTrie (default trie-bench.louds)
+//
+//  Copyright © 2017 visiedo. All rights reserved.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include "trie.hpp"
+#include "louds-trie.hpp"
+#include "adaptive-trie.hpp"
+#include "radix-trie.hpp"
+#include "rng.hpp"
+
+using namespace std;
+
+namespace {
+    double secondsSince (const chrono::steady_clock::time_point& start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    
+    ///Trie with a heap allocated node per character, as Trie was before the node pool
+    class HeapTrie {
+        struct tNode {
+            tNode* parent;
+            char content;
+            tNode* children[kAlphabetSize];
+            uint8_t numChildren;
+            bool wordMarker;
+            tNode (char c, tNode* p) : parent(p), content(c), children(), numChildren(0), wordMarker(false) { }
+        };
+        tNode* root;
+        uint64_t numNodes;
+        
+        void deleteTrie (tNode* node) {
+            for (auto child : node->children) {
+                if (child != nullptr) {
+                    deleteTrie(child);
+                }
+            }
+            delete node;
+        }
+    public:
+        HeapTrie () : root(new tNode(0, nullptr)), numNodes(1) { }
+        ~HeapTrie () { deleteTrie(root); }
+        void insertWord (const string& word) {
+            tNode* current = root;
+            for (auto c : word) {
+                tNode*& child = current->children[tolower(c) - 'a'];
+                if (child == nullptr) {
+                    child = new tNode(tolower(c), current);
+                    ++current->numChildren;
+                    ++numNodes;
+                }
+                current = child;
+            }
+            current->wordMarker = true;
+        }
+        bool isWord (const string& word) const {
+            tNode* current = root;
+            for (auto c : word) {
+                if ((current = current->children[tolower(c) - 'a']) == nullptr) {
+                    return false;
+                }
+            }
+            return current->wordMarker;
+        }
+        ///Bytes of the nodes, plus 16 bytes of allocator header each
+        uint64_t getMemoryUsage () const { return numNodes * (sizeof(tNode) + 16); }
+        ///Returns the bytes of a node, without the allocator header
+        static uint64_t getNodeSize () { return sizeof(tNode); }
+    };
+    
+    ///Runs the benchmark for one trie type
+    template <class TTrie>
+    void run (const string& name, const vector<string>& words, const vector<string>& queries) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        TTrie* t = new TTrie();
+        for (auto& w : words) {
+            t->insertWord(w);
+        }
+        double insertSeconds = secondsSince(start);
+        start = chrono::steady_clock::now();
+        uint64_t found = 0;
+        for (auto& q : queries) {
+            found += t->isWord(q);
+        }
+        double searchSeconds = secondsSince(start);
+        uint64_t bytes = t->getMemoryUsage();
+        start = chrono::steady_clock::now();
+        delete t;
+        double deleteSeconds = secondsSince(start);
+        cout << name << ":\tinsert " << words.size() / insertSeconds / 1e6 << " M words/s\tsearch "
+             << queries.size() / searchSeconds / 1e6 << " M words/s (" << found << " found)\t"
+             << static_cast<double>(bytes) / words.size() << " bytes/word\tteardown " << deleteSeconds * 1000 << " ms" << endl;
+    }
+    
+    ///Runs the benchmark for LoudsTrie, frozen from a Trie of the words
+    void runLouds (const vector<string>& words, const vector<string>& queries, const string& fileName) {
+        Trie t;
+        for (auto& w : words) {
+            t.insertWord(w);
+        }
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        LoudsTrie::freeze(t, fileName);
+        double freezeSeconds = secondsSince(start);
+        LoudsTrie* l = new LoudsTrie(fileName);
+        start = chrono::steady_clock::now();
+        uint64_t found = 0;
+        for (auto& q : queries) {
+            found += l->isWord(q);
+        }
+        double searchSeconds = secondsSince(start);
+        uint64_t bytes = l->getMemoryUsage();
+        start = chrono::steady_clock::now();
+        delete l;
+        double deleteSeconds = secondsSince(start);
+        remove(fileName.c_str());
+        cout << "LOUDS:\tfreeze " << words.size() / freezeSeconds / 1e6 << " M words/s\tsearch "
+             << queries.size() / searchSeconds / 1e6 << " M words/s (" << found << " found)\t"
+             << static_cast<double>(bytes) / words.size() << " bytes/word\tteardown " << deleteSeconds * 1000 << " ms" << endl;
+    }
+}
+
+int main(int argc, const char * argv[]) {
+    uint64_t numWords = (argc > 1) ? atoll(argv[1]) : 1000000;
+    string fileName = (argc > 2) ? argv[2] : "trie-bench.louds";
+    SplitMix64 rng(1);
+    cout << "Node size: heap " << HeapTrie::getNodeSize() << " bytes, pool " << sizeof(Trie::TrieNode) << " bytes" << endl;
+    //Short words: 4 to 15 letters, skewed towards the first letters of the
+    //alphabet so prefixes are shared. Long words: 30 to 59 letters, a
+    //quarter as many
+    for (uint64_t minLength : {4, 30}) {
+        vector<string> words((minLength < 30) ? numWords : numWords / 4);
+        for (auto& w : words) {
+            uint64_t len = minLength + rng.nextBelow(minLength < 30 ? 12 : 30);
+            for (uint64_t i = 0; i < len; ++i) {
+                w += static_cast<char>('a' + rng.nextBelow(1 + rng.nextBelow(kAlphabetSize)));
+            }
+        }
+        //Half the queries hit, half miss
+        vector<string> queries(words.begin(), words.end());
+        for (uint64_t i = 0; i < queries.size(); i += 2) {
+            queries[i] += 'z';
+        }
+        for (uint64_t i = queries.size(); i > 1; --i) {
+            swap(queries[i - 1], queries[rng.nextBelow(i)]);
+        }
+        cout << words.size() << " words of " << minLength << " letters or more" << endl;
+        run<HeapTrie>("Heap nodes", words, queries);
+        run<Trie>("Node pool", words, queries);
+        run<AdaptiveTrie>("Adaptive", words, queries);
+        run<RadixTrie>("Radix", words, queries);
+        runLouds(words, queries, fileName);
+    }
+    return 0;
+}
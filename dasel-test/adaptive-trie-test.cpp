@@ -0,0 +1,146 @@
+/**
+ *  adaptive-trie-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+
+#include <set>
+#include "gtest/gtest.h"
+#include "adaptive-trie.hpp"
+#include "rng.hpp"
+
+
+TEST(AdaptiveTrieTest, ByteKeysWork) {
+    AdaptiveTrie t;
+    EXPECT_EQ(0, t.getDictionarySize());
+    EXPECT_EQ(1, t.getNumNodes());
+    t.insertWord("https://example.com/a?b=1");
+    t.insertWord("https://example.com/");
+    t.insertWord("Hello");
+    t.insertWord(string("nul\0byte", 8));
+    t.insertWord("\xff\xfe");
+    t.insertWord("");
+    t.insertWord("hello");
+    t.insertWord("Hello");
+    EXPECT_EQ(7, t.getDictionarySize());
+    EXPECT_EQ(true, t.isWord("https://example.com/"));
+    EXPECT_EQ(true, t.isWord(""));
+    EXPECT_EQ(true, t.isWord(string("nul\0byte", 8)));
+    EXPECT_EQ(false, t.isWord("nul"));
+    EXPECT_EQ(true, t.isPrefix("nul"));
+    EXPECT_EQ(true, t.isWord("\xff\xfe"));
+    EXPECT_EQ(false, t.isWord("HELLO"));
+    EXPECT_EQ(true, t.isPrefix("https://ex"));
+    EXPECT_EQ(false, t.isPrefix("http:"));
+    t.removeWord("https://example.com/");
+    EXPECT_EQ(false, t.isWord("https://example.com/"));
+    EXPECT_EQ(true, t.isWord("https://example.com/a?b=1"));
+    t.removeWord("https://example.com/a?b=1");
+    EXPECT_EQ(false, t.isPrefix("ht"));
+    EXPECT_EQ(true, t.isPrefix("H"));
+    t.removeWord("missing");
+    t.removeWord("Hell");
+    EXPECT_EQ(5, t.getDictionarySize());
+    t.clear();
+    EXPECT_EQ(0, t.getDictionarySize());
+    EXPECT_EQ(false, t.isWord(""));
+}
+
+TEST(AdaptiveTrieTest, NodesGrowAndShrink) {
+    AdaptiveTrie t;
+    //Children of the root, one byte at a time
+    AdaptiveTrie::tNodeType types[] = {AdaptiveTrie::kNode4, AdaptiveTrie::kNode16, AdaptiveTrie::kNode48, AdaptiveTrie::kNode256};
+    uint64_t limits[] = {4, 16, 48, 256};
+    for (uint64_t b = 0; b < 256; ++b) {
+        t.insertWord(string(1, static_cast<char>(b)) + "x");
+        uint64_t n = b + 1;
+        uint64_t expected = 0;
+        while (n > limits[expected]) {
+            ++expected;
+        }
+        EXPECT_EQ(types[expected], AdaptiveTrie::getType(t.getRoot()));
+        EXPECT_EQ(n, t.getNumChildren(t.getRoot()));
+    }
+    EXPECT_EQ(1, t.getNumNodes(AdaptiveTrie::kNode256));
+    for (uint64_t b = 0; b < 256; ++b) {
+        EXPECT_EQ(true, t.isWord(string(1, static_cast<char>(b)) + "x"));
+        EXPECT_NE(AdaptiveTrie::kNoNode, t.getChild(t.getRoot(), b));
+    }
+    //Removing shrinks the root back, with some slack
+    for (uint64_t b = 0; b < 216; ++b) {
+        t.removeWord(string(1, static_cast<char>(b)) + "x");
+    }
+    EXPECT_EQ(AdaptiveTrie::kNode48, AdaptiveTrie::getType(t.getRoot()));
+    for (uint64_t b = 216; b < 244; ++b) {
+        t.removeWord(string(1, static_cast<char>(b)) + "x");
+    }
+    EXPECT_EQ(AdaptiveTrie::kNode16, AdaptiveTrie::getType(t.getRoot()));
+    for (uint64_t b = 244; b < 253; ++b) {
+        t.removeWord(string(1, static_cast<char>(b)) + "x");
+    }
+    EXPECT_EQ(AdaptiveTrie::kNode4, AdaptiveTrie::getType(t.getRoot()));
+    EXPECT_EQ(3, t.getDictionarySize());
+    for (uint64_t b = 0; b < 256; ++b) {
+        EXPECT_EQ(b >= 253, t.isWord(string(1, static_cast<char>(b)) + "x"));
+    }
+    EXPECT_EQ(7, t.getNumNodes());
+    EXPECT_EQ(0, t.getNumNodes(AdaptiveTrie::kNode256));
+}
+
+TEST(AdaptiveTrieTest, MatchesSet) {
+    //Random keys over a small and a full alphabet, checked against a set
+    for (uint64_t alphabet : {4, 256}) {
+        SplitMix64 rng(alphabet);
+        AdaptiveTrie t;
+        set<string> words;
+        for (uint64_t i = 0; i < 20000; ++i) {
+            string w;
+            for (uint64_t len = rng.nextBelow(8); len > 0; --len) {
+                w += static_cast<char>(rng.nextBelow(alphabet));
+            }
+            if (rng.nextBelow(3) == 0) {
+                t.removeWord(w);
+                words.erase(w);
+            }
+            else {
+                t.insertWord(w);
+                words.insert(w);
+            }
+        }
+        EXPECT_EQ(words.size(), t.getDictionarySize());
+        for (uint64_t i = 0; i < 20000; ++i) {
+            string w;
+            for (uint64_t len = rng.nextBelow(8); len > 0; --len) {
+                w += static_cast<char>(rng.nextBelow(alphabet));
+            }
+            EXPECT_EQ(words.count(w) == 1, t.isWord(w));
+            set<string>::iterator it = words.lower_bound(w);
+            EXPECT_EQ((it != words.end()) && (it->compare(0, w.size(), w) == 0), t.isPrefix(w));
+        }
+        //Removing every word leaves the root alone
+        for (auto& w : words) {
+            t.removeWord(w);
+        }
+        EXPECT_EQ(0, t.getDictionarySize());
+        EXPECT_EQ(1, t.getNumNodes());
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ *  betweenness-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+#include "gtest/gtest.h"
+#include "betweenness.hpp"
+#include "graph-generator.hpp"
+
+
+TEST(BetweennessTest, ExactWorks) {
+    //Path 0-1-2-3-4: vertex i is between i * (4 - i) pairs
+    GraphGenerator::TEdgeList path = {{0, 1}, {1, 2}, {2, 3}, {3, 4}};
+    CompactGraph cg = CompactGraph::fromEdges(5, path, false);
+    vector<double> score = Betweenness(cg).exact();
+    double expected[] = {0, 3, 4, 3, 0};
+    for (uint64_t i = 0; i < 5; ++i) {
+        EXPECT_DOUBLE_EQ(expected[i], score[i]);
+    }
+    //Directed, only 0->1->2->3->4
+    CompactGraph dg = CompactGraph::fromEdges(5, path, true);
+    score = Betweenness(dg, 2).exact();
+    for (uint64_t i = 0; i < 5; ++i) {
+        EXPECT_DOUBLE_EQ(expected[i], score[i]);
+    }
+    //Square 0-1-2-3-0: the two shortest paths between opposite corners split
+    GraphGenerator::TEdgeList square = {{0, 1}, {1, 2}, {2, 3}, {3, 0}};
+    score = Betweenness(CompactGraph::fromEdges(4, square, false), 3).exact();
+    for (uint64_t i = 0; i < 4; ++i) {
+        EXPECT_DOUBLE_EQ(0.5, score[i]);
+    }
+    //Star: the centre is between every pair of leaves
+    GraphGenerator::TEdgeList star = {{0, 1}, {0, 2}, {0, 3}, {0, 4}, {0, 5}};
+    score = Betweenness(CompactGraph::fromEdges(6, star, false)).exact();
+    EXPECT_DOUBLE_EQ(10, score[0]);
+    EXPECT_DOUBLE_EQ(0, score[3]);
+}
+
+TEST(BetweennessTest, ThreadsAndSamplingWork) {
+    GraphGenerator gen(21);
+    uint64_t n = 500;
+    CompactGraph cg = CompactGraph::fromEdges(n, gen.barabasiAlbert(n, 3), false);
+    vector<double> single = Betweenness(cg, 1).exact();
+    vector<double> multi = Betweenness(cg, 4).exact();
+    for (uint64_t v = 0; v < n; ++v) {
+        EXPECT_NEAR(single[v], multi[v], 1e-6 * (1 + single[v]));
+    }
+    //All sources sampled is the exact result
+    vector<double> all = Betweenness(cg, 2).approximate(n);
+    EXPECT_NEAR(single[7], all[7], 1e-6 * (1 + single[7]));
+    
+    uint64_t k = 200;
+    double delta = 0.1;
+    vector<double> approx = Betweenness(cg, 3).approximate(k, 5);
+    vector<double> again = Betweenness(cg, 1).approximate(k, 5);
+    double bound = Betweenness::errorBound(n, k, delta) * n * (n - 2) / 2;
+    for (uint64_t v = 0; v < n; ++v) {
+        EXPECT_NEAR(approx[v], again[v], 1e-6 * (1 + approx[v]));
+        EXPECT_NEAR(single[v], approx[v], bound);
+    }
+    EXPECT_LE(Betweenness::errorBound(n, Betweenness::sampleSize(n, 0.05, delta), delta), 0.05);
+}
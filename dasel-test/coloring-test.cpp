@@ -0,0 +1,79 @@
+/**
+ *  coloring-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+#include "gtest/gtest.h"
+#include "coloring.hpp"
+#include "kcore.hpp"
+#include "graph-generator.hpp"
+
+
+TEST(GraphColoringTest, SmallGraphsWork) {
+    //Odd cycle 0..4 needs 3 colors, vertex 5 hangs from 0, 6 has a self loop
+    UndirectedGraph g;
+    for (uint64_t i = 0; i <= 6; ++i) {
+        g.addVertex(i);
+    }
+    for (uint64_t i = 0; i < 5; ++i) {
+        g.addEdge(i, (i + 1) % 5);
+    }
+    g.addEdge(0, 5);
+    g.addEdge(6, 6);
+    GraphColoring coloring(g, 3, 2);
+    GraphColoring::tOrdering orderings[] = {GraphColoring::kRandom, GraphColoring::kLargestFirst, GraphColoring::kSmallestLast};
+    for (auto ordering : orderings) {
+        GraphColoring::tResult results[] = {coloring.sequential(ordering), coloring.speculative(ordering), coloring.jonesPlassmann(ordering)};
+        for (auto& r : results) {
+            EXPECT_EQ(true, coloring.isValid(r.color));
+            EXPECT_EQ(3, r.numColors);
+            EXPECT_LE(1, r.rounds);
+            EXPECT_LE(0, r.orderingSeconds);
+            EXPECT_LE(0, r.coloringSeconds);
+        }
+        EXPECT_EQ(results[0].color, results[2].color);
+    }
+    vector<uint64_t> bad(7, 0);
+    EXPECT_EQ(false, coloring.isValid(bad));
+}
+
+TEST(GraphColoringTest, ParallelColoringsWork) {
+    GraphGenerator gen(31);
+    uint64_t n = 5000;
+    CompactGraph cg = CompactGraph::fromEdges(n, gen.barabasiAlbert(n, 5), false);
+    uint64_t degeneracy = CoreDecomposition(cg, CoreDecomposition::kBucket).getMaxCore();
+    GraphColoring single(cg, 1, 1);
+    GraphColoring multi(cg, 1, 4);
+    GraphColoring::tOrdering orderings[] = {GraphColoring::kRandom, GraphColoring::kLargestFirst, GraphColoring::kSmallestLast};
+    for (auto ordering : orderings) {
+        GraphColoring::tResult seq = single.sequential(ordering);
+        GraphColoring::tResult spec = multi.speculative(ordering);
+        GraphColoring::tResult jp = multi.jonesPlassmann(ordering);
+        EXPECT_EQ(true, single.isValid(seq.color));
+        EXPECT_EQ(true, multi.isValid(spec.color));
+        EXPECT_EQ(true, multi.isValid(jp.color));
+        EXPECT_EQ(seq.color, jp.color);
+        EXPECT_GE(seq.numColors + 2, spec.numColors);
+        EXPECT_LE(0, spec.conflictSeconds);
+    }
+    EXPECT_GE(degeneracy + 1, single.sequential(GraphColoring::kSmallestLast).numColors);
+}
@@ -0,0 +1,92 @@
+/**
+ *  community-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+#include "gtest/gtest.h"
+#include "community.hpp"
+#include "graph-generator.hpp"
+
+namespace {
+    ///Four groups of 50 vertex, dense inside and sparse across
+    CompactGraph plantedPartition (const uint64_t& seed) {
+        GraphGenerator gen(seed);
+        GraphGenerator::TEdgeList edges;
+        for (uint64_t g = 0; g < 4; ++g) {
+            for (auto& e : gen.gnp(50, 0.3)) {
+                edges.push_back(make_pair(e.first + g * 50, e.second + g * 50));
+            }
+        }
+        for (auto& e : gen.gnm(200, 40, false)) {
+            edges.push_back(e);
+        }
+        return CompactGraph::fromEdges(200, edges, false);
+    }
+}
+
+TEST(CommunityDetectorTest, TwoCliquesWork) {
+    //Two 6-cliques joined by the edge 5-6, and an isolated vertex 12
+    UndirectedGraph g;
+    for (uint64_t i = 0; i <= 12; ++i) {
+        g.addVertex(i);
+    }
+    for (uint64_t base = 0; base <= 6; base += 6) {
+        for (uint64_t i = 0; i < 6; ++i) {
+            for (uint64_t j = i + 1; j < 6; ++j) {
+                g.addEdge(base + i, base + j);
+            }
+        }
+    }
+    g.addEdge(5, 6);
+    CommunityDetector detector(g, 1, 2);
+    CommunityDetector::tResult results[] = {detector.labelPropagation(), detector.louvain()};
+    for (auto& r : results) {
+        EXPECT_EQ(3, r.numCommunities);
+        EXPECT_EQ(r.community[0], r.community[5]);
+        EXPECT_EQ(r.community[6], r.community[11]);
+        EXPECT_NE(r.community[0], r.community[6]);
+        EXPECT_NE(r.community[0], r.community[12]);
+        EXPECT_NEAR(detector.modularity(r.community), r.modularity, 1e-12);
+        EXPECT_LT(0.45, r.modularity);
+        EXPECT_LE(1, r.iterations);
+    }
+    //Everything in one community has modularity 0
+    EXPECT_NEAR(0, detector.modularity(vector<uint64_t>(13, 0)), 1e-12);
+    EXPECT_EQ(31, g.getNumEdges());
+}
+
+TEST(CommunityDetectorTest, PlantedPartitionWorks) {
+    CompactGraph cg = plantedPartition(4);
+    CommunityDetector single(cg, 7, 1);
+    CommunityDetector::tResult lp = single.labelPropagation();
+    CommunityDetector::tResult again = single.labelPropagation();
+    EXPECT_EQ(lp.community, again.community);
+    
+    CommunityDetector multi(cg, 7, 4);
+    CommunityDetector::tResult results[] = {lp, single.louvain(), multi.labelPropagation(), multi.louvain()};
+    for (auto& r : results) {
+        EXPECT_LT(0.6, r.modularity);
+        EXPECT_GE(6, r.numCommunities);
+        EXPECT_GT(20, r.iterations);
+    }
+    EXPECT_EQ(1, single.labelPropagation(1).iterations);
+}
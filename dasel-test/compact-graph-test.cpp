@@ -0,0 +1,158 @@
+/**
+ *  compact-graph-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+#include "gtest/gtest.h"
+#include "compact-graph.hpp"
+
+
+class CompactGraphTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        //Path 10-20-30-40-50, plus 20-60 and loop 60-60
+        for (uint64_t i = 10; i <= 60; i += 10) {
+            ug.addVertex(i);
+            dg.addVertex(i);
+        }
+        ug.addEdge(10, 20);
+        ug.addEdge(20, 30);
+        ug.addEdge(30, 40);
+        ug.addEdge(40, 50);
+        ug.addEdge(20, 60);
+        ug.addEdge(60, 60);
+        dg.addEdge(10, 20);
+        dg.addEdge(20, 30);
+        dg.addEdge(30, 40);
+        dg.addEdge(40, 50);
+        dg.addEdge(60, 20);
+    }
+    
+    UndirectedGraph ug;
+    DirectedGraph dg;
+};
+
+TEST_F(CompactGraphTest, SnapshotWorks) {
+    CompactGraph cg(ug);
+    EXPECT_EQ(6, cg.getNumVertex());
+    EXPECT_EQ(6, cg.getNumEdges());
+    EXPECT_EQ(false, cg.isDirected());
+    EXPECT_EQ(1, cg.getIndex(20));
+    EXPECT_EQ(kNoVertex, cg.getIndex(25));
+    EXPECT_EQ(3, cg.getDeg(cg.getIndex(20)));
+    EXPECT_EQ(true, cg.isEdge(cg.getIndex(60), cg.getIndex(60)));
+    EXPECT_EQ(true, cg.isEdge(cg.getIndex(30), cg.getIndex(20)));
+    
+    CompactGraph cd(dg);
+    EXPECT_EQ(true, cd.isDirected());
+    EXPECT_EQ(5, cd.getNumEdges());
+    EXPECT_EQ(true, cd.isEdge(cd.getIndex(60), cd.getIndex(20)));
+    EXPECT_EQ(false, cd.isEdge(cd.getIndex(20), cd.getIndex(60)));
+}
+
+TEST_F(CompactGraphTest, KHopWorks) {
+    vector<uint64_t> seeds = {10, 99};
+    CompactGraph h0 = ug.kHopSubgraph(seeds, 0);
+    EXPECT_EQ(1, h0.getNumVertex());
+    EXPECT_EQ(0, h0.getNumEdges());
+    
+    CompactGraph h2 = ug.kHopSubgraph(seeds, 2);
+    EXPECT_EQ(4, h2.getNumVertex());    // 10, 20, 30, 60
+    EXPECT_EQ(4, h2.getNumEdges());     // 10-20, 20-30, 20-60, 60-60
+    EXPECT_EQ(kNoVertex, h2.getIndex(40));
+    EXPECT_EQ(true, h2.isEdge(h2.getIndex(60), h2.getIndex(20)));
+    
+    CompactGraph capped = ug.kHopSubgraph(seeds, 5, 3);
+    EXPECT_EQ(3, capped.getNumVertex());
+    EXPECT_EQ(30, capped.getId(2));
+    
+    seeds = {60};
+    CompactGraph d2 = dg.kHopSubgraph(seeds, 2);
+    EXPECT_EQ(3, d2.getNumVertex());    // 60, 20, 30
+    EXPECT_EQ(2, d2.getNumEdges());
+    EXPECT_EQ(true, d2.isEdge(d2.getIndex(20), d2.getIndex(30)));
+}
+
+TEST_F(CompactGraphTest, InducedSkipsRemovedEdges) {
+    vector<pair<uint64_t, uint64_t> > edges = {{20, 30}};
+    ug.removeEdges(edges, true);
+    vector<uint64_t> ids = {10, 20, 30, 40};
+    CompactGraph sub = ug.inducedSubgraph(ids);
+    EXPECT_EQ(4, sub.getNumVertex());
+    EXPECT_EQ(2, sub.getNumEdges());
+    EXPECT_EQ(false, sub.isEdge(sub.getIndex(20), sub.getIndex(30)));
+}
+
+TEST_F(CompactGraphTest, GroupedBfsWorks) {
+    //Two rows of a ladder, 0..99 and 100..199, plus an unreachable vertex 200
+    vector<pair<uint64_t, uint64_t> > edges;
+    for (uint64_t i = 0; i < 100; ++i) {
+        edges.push_back(make_pair(i, i + 100));
+        if (i + 1 < 100) {
+            edges.push_back(make_pair(i, i + 1));
+            edges.push_back(make_pair(i + 100, i + 101));
+        }
+    }
+    CompactGraph ladder = CompactGraph::fromEdges(201, edges, false);
+    vector<uint64_t> plain, grouped;
+    EXPECT_EQ(200, ladder.bfs(0, plain));
+    EXPECT_EQ(99, plain[99]);
+    EXPECT_EQ(100, plain[199]);
+    EXPECT_EQ(kNoVertex, plain[200]);
+    uint64_t groups[] = {1, 4, 16, 1000};
+    for (auto g : groups) {
+        EXPECT_EQ(200, ladder.bfs(0, grouped, g));
+        EXPECT_EQ(plain, grouped);
+    }
+    
+    //Same distances from the hash based graphs, with and without groups
+    vector<uint64_t> ids = ug.getVertexIDs();
+    for (auto from : ids) {
+        for (auto to : ids) {
+            EXPECT_EQ(ug.distance(from, to), ug.distance(from, to, 2));
+            EXPECT_EQ(dg.distance(from, to), dg.distance(from, to, 3));
+        }
+    }
+    EXPECT_EQ(-1, ug.distance(1, 10, 4));
+}
+
+TEST_F(CompactGraphTest, TransposeWorks) {
+    CompactGraph cg(dg);
+    CompactGraph t = cg.transpose();
+    EXPECT_EQ(true, t.isDirected());
+    EXPECT_EQ(cg.getNumEdges(), t.getNumEdges());
+    EXPECT_EQ(cg.getVertexIDs(), t.getVertexIDs());
+    EXPECT_EQ(2, t.getDeg(t.getIndex(20)));
+    EXPECT_EQ(true, t.isEdge(t.getIndex(20), t.getIndex(60)));
+    EXPECT_EQ(false, t.isEdge(t.getIndex(60), t.getIndex(20)));
+    //Same result whatever the number of threads, with sorted lists
+    vector<pair<uint64_t, uint64_t> > edges;
+    for (uint64_t i = 0; i < 5000; ++i) {
+        edges.push_back(make_pair((i * 7919) % 1000, (i * 104729 + 13) % 1000));
+    }
+    CompactGraph big = CompactGraph::fromEdges(1000, edges, true);
+    CompactGraph t1 = big.transpose(1);
+    CompactGraph t4 = big.transpose(4);
+    EXPECT_EQ(t1.getOffsets(), t4.getOffsets());
+    EXPECT_EQ(t1.getAdjacency(), t4.getAdjacency());
+    EXPECT_EQ(big.getAdjacency(), t1.transpose(4).getAdjacency());
+    CompactGraph u(ug);
+    EXPECT_EQ(u.getAdjacency(), u.transpose().getAdjacency());
+}
@@ -0,0 +1,109 @@
+/**
+ *  diameter-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+#include "gtest/gtest.h"
+#include "diameter.hpp"
+#include "graph-generator.hpp"
+
+namespace {
+    ///Eccentricities with a plain BFS from every vertex
+    vector<uint64_t> bruteForce (const CompactGraph& g) {
+        vector<uint64_t> result(g.getNumVertex(), 0);
+        for (uint64_t s = 0; s < g.getNumVertex(); ++s) {
+            vector<uint64_t> dist(g.getNumVertex(), kNoVertex);
+            vector<uint64_t> queue(1, s);
+            dist[s] = 0;
+            for (uint64_t head = 0; head < queue.size(); ++head) {
+                uint64_t v = queue[head];
+                result[s] = dist[v];
+                for (const uint64_t* a = g.adjBegin(v); a != g.adjEnd(v); ++a) {
+                    if (dist[*a] == kNoVertex) {
+                        dist[*a] = dist[v] + 1;
+                        queue.push_back(*a);
+                    }
+                }
+            }
+        }
+        return result;
+    }
+}
+
+TEST(DiameterCalculatorTest, SmallGraphsWork) {
+    //Path 0..9 plus a separate triangle 10-11-12
+    GraphGenerator::TEdgeList edges;
+    for (uint64_t i = 0; i < 9; ++i) {
+        edges.push_back(make_pair(i, i + 1));
+    }
+    edges.push_back(make_pair(10, 11));
+    edges.push_back(make_pair(11, 12));
+    edges.push_back(make_pair(12, 10));
+    CompactGraph cg = CompactGraph::fromEdges(13, edges, false);
+    DiameterCalculator path(cg, 3, 2);
+    EXPECT_EQ(10, path.getComponent().getNumVertex());
+    EXPECT_EQ(9, path.diameter());
+    EXPECT_EQ(5, path.radius());
+    EXPECT_EQ(9, path.eccentricity(0));
+    EXPECT_EQ(5, path.eccentricity(4));
+    EXPECT_EQ(kNoVertex, path.eccentricity(11));
+    DiameterCalculator triangle(cg, 11);
+    EXPECT_EQ(1, triangle.diameter());
+    EXPECT_LT(0, triangle.getNumBFS());
+    
+    //Directed cycle 0->1->...->5->0 with a chord 0->3: strongly connected
+    GraphGenerator::TEdgeList cycle;
+    for (uint64_t i = 0; i < 6; ++i) {
+        cycle.push_back(make_pair(i, (i + 1) % 6));
+    }
+    cycle.push_back(make_pair(0, 3));
+    cycle.push_back(make_pair(7, 0));
+    CompactGraph dg = CompactGraph::fromEdges(8, cycle, true);
+    DiameterCalculator directed(dg, 0);
+    //Vertex 7 only has out edges and 6 is isolated, so both are left out
+    EXPECT_EQ(6, directed.getComponent().getNumVertex());
+    EXPECT_EQ(5, directed.diameter());
+    vector<uint64_t> expected = bruteForce(directed.getComponent());
+    EXPECT_EQ(expected, directed.eccentricities());
+    EXPECT_EQ(3, directed.radius());
+}
+
+TEST(DiameterCalculatorTest, MatchesBruteForce) {
+    GraphGenerator gen(23);
+    uint64_t n = 1500;
+    CompactGraph cg = CompactGraph::fromEdges(n, gen.gnm(n, 2 * n, false), false);
+    DiameterCalculator calc(cg, kNoVertex, 3);
+    vector<uint64_t> expected = bruteForce(calc.getComponent());
+    uint64_t d = calc.diameter();
+    uint64_t diameterBFS = calc.getNumBFS();
+    EXPECT_EQ(*max_element(expected.begin(), expected.end()), d);
+    EXPECT_GT(calc.getComponent().getNumVertex() / 4, diameterBFS);
+    EXPECT_EQ(expected, calc.eccentricities());
+    EXPECT_EQ(*min_element(expected.begin(), expected.end()), calc.radius());
+    
+    CompactGraph dg = CompactGraph::fromEdges(n, gen.gnm(n, 4 * n, true), true);
+    DiameterCalculator dcalc(dg, kNoVertex, 2);
+    expected = bruteForce(dcalc.getComponent());
+    EXPECT_LT(n / 2, dcalc.getComponent().getNumVertex());
+    EXPECT_EQ(*max_element(expected.begin(), expected.end()), dcalc.diameter());
+    EXPECT_EQ(expected, dcalc.eccentricities());
+}
@@ -0,0 +1,158 @@
+/**
+ *  dynamic-distance-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+#include <stdexcept>
+#include "gtest/gtest.h"
+#include "dynamic-distance.hpp"
+#include "rng.hpp"
+
+
+class DynamicDistancesTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        //Path 0-1-2-...-9
+        for (uint64_t i = 0; i < 10; ++i) {
+            path.addVertex(i);
+        }
+        for (uint64_t i = 0; i < 9; ++i) {
+            path.addEdge(i, i + 1);
+        }
+    }
+    
+    ///Checks every distance and parent against a full BFS
+    void expectExact (UndirectedGraph& g, const DynamicDistances& dd) {
+        for (auto root : dd.getRoots()) {
+            for (auto vID : g.getVertexIDs()) {
+                int16_t d = g.distance(root, vID);
+                uint64_t got = dd.getDistance(root, vID);
+                EXPECT_EQ((d < 0) ? kNoVertex : static_cast<uint64_t>(d), got);
+                uint64_t p = dd.getParent(root, vID);
+                if ((got != kNoVertex) && (got != 0)) {
+                    EXPECT_EQ(true, g.isEdge(p, vID));
+                    EXPECT_EQ(got - 1, dd.getDistance(root, p));
+                }
+                else {
+                    EXPECT_EQ(kNoVertex, p);
+                }
+            }
+        }
+    }
+    
+    UndirectedGraph path;
+};
+
+TEST_F(DynamicDistancesTest, RootsWork) {
+    DynamicDistances dd(path);
+    EXPECT_THROW(dd.addRoot(20), invalid_argument);
+    dd.addRoot(0);
+    dd.addRoot(9);
+    dd.addRoot(0);
+    EXPECT_EQ(2, dd.getRoots().size());
+    EXPECT_EQ(9, dd.getDistance(0, 9));
+    EXPECT_EQ(3, dd.getDistance(9, 6));
+    EXPECT_EQ(kNoVertex, dd.getDistance(0, 20));
+    EXPECT_THROW(dd.getDistance(5, 1), out_of_range);
+    vector<uint64_t> expected = {9, 8, 7};
+    EXPECT_EQ(expected, dd.getPath(9, 7));
+    dd.removeRoot(9);
+    EXPECT_EQ(1, dd.getRoots().size());
+    EXPECT_THROW(dd.getParent(9, 1), out_of_range);
+}
+
+TEST_F(DynamicDistancesTest, InsertionsAreLocal) {
+    DynamicDistances dd(path);
+    dd.addRoot(0);
+    //A shortcut moves the far end of the path closer
+    DynamicDistances::tUpdate u = dd.addEdge(0, 7);
+    EXPECT_EQ(1, dd.getDistance(0, 7));
+    EXPECT_EQ(3, dd.getDistance(0, 9));
+    EXPECT_EQ(3, dd.getDistance(0, 5));
+    EXPECT_EQ(5, u.changed);
+    EXPECT_EQ(u.changed, u.touched);
+    //An edge which shortens nothing touches nothing
+    u = dd.addEdge(3, 5);
+    EXPECT_EQ(0, u.touched);
+    u = dd.addEdge(3, 5);
+    EXPECT_EQ(0, u.scanned);
+    //New vertex are reached as soon as they are connected
+    dd.addEdge(20, 21);
+    EXPECT_EQ(kNoVertex, dd.getDistance(0, 21));
+    dd.addEdge(9, 20);
+    EXPECT_EQ(5, dd.getDistance(0, 21));
+    expectExact(path, dd);
+}
+
+TEST_F(DynamicDistancesTest, RemovalsRepairTheTree) {
+    DynamicDistances dd(path);
+    dd.addRoot(0);
+    dd.addEdge(0, 5);
+    dd.addEdge(3, 8);
+    //Not in the tree
+    DynamicDistances::tUpdate u = dd.removeEdge(3, 4);
+    EXPECT_EQ(0, u.touched);
+    expectExact(path, dd);
+    //Cuts off 5..9 from the root
+    u = dd.removeEdge(0, 5);
+    EXPECT_LT(0, u.changed);
+    expectExact(path, dd);
+    //Disconnects 4 entirely
+    dd.removeEdge(4, 5);
+    EXPECT_EQ(kNoVertex, dd.getDistance(0, 4));
+    expectExact(path, dd);
+    EXPECT_EQ(0, dd.removeEdge(4, 5).touched);
+}
+
+TEST_F(DynamicDistancesTest, MatchesFullBfs) {
+    //Random updates on a random graph, checked against a full BFS after each batch
+    UndirectedGraph g;
+    SplitMix64 rng(17);
+    vector<pair<uint64_t, uint64_t> > edges;
+    for (uint64_t i = 0; i < 200; ++i) {
+        edges.push_back(make_pair(rng.nextBelow(120), rng.nextBelow(120)));
+    }
+    g.addEdges(edges);
+    DynamicDistances dd(g, 2);
+    dd.addRoot(edges[0].first);
+    dd.addRoot(edges[1].first);
+    dd.addRoot(edges[2].second);
+    uint64_t touched = 0;
+    for (uint64_t batch = 0; batch < 20; ++batch) {
+        for (uint64_t i = 0; i < 10; ++i) {
+            uint64_t a = rng.nextBelow(130);
+            uint64_t b = rng.nextBelow(130);
+            touched += (rng.nextBelow(2) == 0) ? dd.addEdge(a, b).touched : dd.removeEdge(a, b).touched;
+            if (rng.nextBelow(3) == 0) {
+                //Remove an existing edge, likely in some tree
+                const UndirectedGraph::Vertex* v = g.findVertex(dd.getRoots()[i % 3]);
+                if ((v != nullptr) && (v->getDeg() > 0)) {
+                    touched += dd.removeEdge(v->getId(), v->getAdjID(0)).touched;
+                }
+            }
+        }
+        expectExact(g, dd);
+    }
+    EXPECT_LT(0, touched);
+    dd.rebuild();
+    expectExact(g, dd);
+}
@@ -0,0 +1,108 @@
+/**
+ *  external-graph-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+#include <cstdio>
+#include <fstream>
+#include "gtest/gtest.h"
+#include "external-graph.hpp"
+#include "graph-generator.hpp"
+
+
+TEST(ExternalGraphTest, WriteAndQueryWorks) {
+    //2 components: a 300 vertex random graph, and a path 1000-1001-1002
+    GraphGenerator gen(11);
+    GraphGenerator::TEdgeList edges = gen.gnm(300, 900);
+    UndirectedGraph g;
+    g.addEdges(edges);
+    g.addVertex(1000);
+    g.addVertex(1001);
+    g.addVertex(1002);
+    g.addEdge(1000, 1001);
+    g.addEdge(1001, 1002);
+    CompactGraph cg(g);
+    const string fileName = "external-graph-test.dat";
+    ExternalGraph::write(cg, fileName, 256);
+    {
+        ExternalGraph eg(fileName);
+        EXPECT_EQ(cg.getNumVertex(), eg.getNumVertex());
+        EXPECT_EQ(cg.getNumEdges(), eg.getNumEdges());
+        EXPECT_LT(4, eg.getNumBlocks());
+        uint64_t v = eg.getIndex(17);
+        vector<uint64_t> adj = eg.getAdjacency(v);
+        EXPECT_EQ(vector<uint64_t>(cg.adjBegin(v), cg.adjEnd(v)), adj);
+        EXPECT_EQ(1, eg.getBlocksRead());
+        
+        uint64_t from = eg.getIndex(1000), to = eg.getIndex(1002);
+        EXPECT_EQ(2, eg.distance(from, to));
+        EXPECT_EQ(-1, eg.distance(from, eg.getIndex(edges[0].first)));
+        EXPECT_EQ(g.distance(3, 250), eg.distance(eg.getIndex(3), eg.getIndex(250)));
+        
+        vector<uint32_t> dist = eg.bfs(eg.getIndex(5));
+        EXPECT_LT(0, eg.getBytesRead());
+        for (uint64_t i = 0; i < 20; ++i) {
+            int16_t expected = g.distance(5, eg.getId(i));
+            EXPECT_EQ(expected, (dist[i] == kUnreached) ? -1 : static_cast<int16_t>(dist[i]));
+        }
+        
+        vector<uint64_t> comp = eg.components();
+        EXPECT_EQ(comp[from], comp[to]);
+        EXPECT_EQ(from, comp[to]);
+        EXPECT_NE(comp[from], comp[eg.getIndex(edges[0].first)]);
+    }
+    remove(fileName.c_str());
+}
+
+TEST(ExternalGraphTest, BuildFromEdgeListWorks) {
+    const string textName = "external-graph-test.txt";
+    const string fileName = "external-graph-test.dat";
+    {
+        ofstream text(textName.c_str());
+        text << "# FromNodeId\tToNodeId\n";
+        text << "10\t20\n20\t30\n30\t10\n30\t40\n40\t40\n20\t10\n50\t40\n";
+    }
+    //Tiny runs, to force a multi-way merge
+    ExternalGraph::build(textName, fileName, true, 2, 4);
+    {
+        ExternalGraph eg(fileName);
+        EXPECT_EQ(true, eg.isDirected());
+        EXPECT_EQ(5, eg.getNumVertex());
+        EXPECT_EQ(7, eg.getNumEdges());
+        EXPECT_EQ(2, eg.getDeg(eg.getIndex(20)));
+        EXPECT_EQ(1, eg.getDeg(eg.getIndex(40)));
+        EXPECT_EQ(3, eg.distance(eg.getIndex(10), eg.getIndex(40)));
+        EXPECT_EQ(3, eg.getBlocksRead());
+        EXPECT_EQ(-1, eg.distance(eg.getIndex(40), eg.getIndex(10)));
+    }
+    ExternalGraph::build(textName, fileName, false, 3);
+    {
+        ExternalGraph eg(fileName);
+        EXPECT_EQ(false, eg.isDirected());
+        EXPECT_EQ(6, eg.getNumEdges());
+        EXPECT_EQ(1, eg.distance(eg.getIndex(40), eg.getIndex(50)));
+        vector<uint64_t> comp = eg.components();
+        EXPECT_EQ(0, comp[eg.getIndex(50)]);
+    }
+    remove(textName.c_str());
+    remove(fileName.c_str());
+    EXPECT_THROW(ExternalGraph eg(fileName), runtime_error);
+}
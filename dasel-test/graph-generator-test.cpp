@@ -0,0 +1,122 @@
+/**
+ *  graph-generator-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+#include <algorithm>
+#include "gtest/gtest.h"
+#include "graph-generator.hpp"
+#include "compact-graph.hpp"
+
+
+TEST(GraphGeneratorTest, RmatWorks) {
+    GraphGenerator gen(3);
+    GraphGenerator::TEdgeList edges = gen.rmat(10, 8);
+    EXPECT_EQ(8 * 1024, edges.size());
+    for (auto& e : edges) {
+        EXPECT_LT(e.first, 1024);
+        EXPECT_LT(e.second, 1024);
+    }
+    EXPECT_EQ(edges, gen.rmat(10, 8));
+    gen.setSeed(4);
+    EXPECT_NE(edges, gen.rmat(10, 8));
+    
+    CompactGraph cg = CompactGraph::fromEdges(1024, edges, true);
+    EXPECT_EQ(1024, cg.getNumVertex());
+    EXPECT_LT(0, cg.getNumEdges());
+    EXPECT_GE(edges.size(), cg.getNumEdges());
+    EXPECT_EQ(true, cg.isEdge(edges[0].first, edges[0].second));
+}
+
+TEST(GraphGeneratorTest, GnpWorks) {
+    GraphGenerator gen(5);
+    uint64_t n = 2000;
+    GraphGenerator::TEdgeList edges = gen.gnp(n, 0.01);
+    double expected = 0.01 * n * (n - 1) / 2;
+    EXPECT_LT(expected * 0.9, edges.size());
+    EXPECT_GT(expected * 1.1, edges.size());
+    for (auto& e : edges) {
+        EXPECT_GT(e.first, e.second);
+    }
+    EXPECT_EQ(edges, gen.gnp(n, 0.01));
+    EXPECT_EQ(20 * 19, gen.gnp(20, 1.0, true).size());
+    EXPECT_EQ(0, gen.gnp(20, 0.0).size());
+}
+
+TEST(GraphGeneratorTest, GnmWorks) {
+    GraphGenerator gen(6);
+    GraphGenerator::TEdgeList edges = gen.gnm(1000, 5000);
+    EXPECT_EQ(5000, edges.size());
+    UndirectedGraph g;
+    g.addEdges(edges);
+    EXPECT_EQ(5000, g.getNumEdges());
+    EXPECT_EQ(45, gen.gnm(10, 100).size());
+    EXPECT_EQ(90, gen.gnm(10, 100, true).size());
+    //Dense graphs visit every possible edge
+    for (bool directed : {false, true}) {
+        GraphGenerator::TEdgeList dense = gen.gnm(1000, UINT64_MAX, directed);
+        EXPECT_EQ(directed ? 999000 : 499500, dense.size());
+        dense = gen.gnm(300, 40000, directed);
+        EXPECT_EQ(40000, dense.size());
+        EXPECT_EQ(true, is_sorted(dense.begin(), dense.end()));
+        EXPECT_EQ(dense.end(), adjacent_find(dense.begin(), dense.end()));
+        for (auto& e : dense) {
+            EXPECT_NE(e.first, e.second);
+            EXPECT_EQ(true, directed || (e.first > e.second));
+        }
+        EXPECT_EQ(dense, gen.gnm(300, 40000, directed));
+    }
+}
+
+TEST(GraphGeneratorTest, BarabasiAlbertWorks) {
+    GraphGenerator gen(7);
+    uint64_t n = 5000;
+    GraphGenerator::TEdgeList edges = gen.barabasiAlbert(n, 4);
+    EXPECT_EQ(n * 4, edges.size());
+    for (uint64_t i = 0; i < edges.size(); ++i) {
+        EXPECT_EQ(i / 4, edges[i].first);
+        EXPECT_LE(edges[i].second, edges[i].first);
+    }
+    //Preferential attachment: early vertex become hubs
+    CompactGraph cg = CompactGraph::fromEdges(n, edges, false);
+    EXPECT_LT(40, cg.getDeg(0));
+    EXPECT_EQ(edges, gen.barabasiAlbert(n, 4));
+}
+
+TEST(GraphGeneratorTest, BulkAddEdgesWorks) {
+    GraphGenerator::TEdgeList edges = {{1, 2}, {2, 1}, {3, 3}, {1, 4}, {1, 2}};
+    UndirectedGraph ug;
+    ug.addVertex(1);
+    ug.addEdge(1, 1);
+    ug.addEdges(edges);
+    EXPECT_EQ(4, ug.getNumVertex());
+    EXPECT_EQ(4, ug.getNumEdges());
+    EXPECT_EQ(3, ug.getVertex(1).getDeg());
+    EXPECT_EQ(true, ug.isEdge(3, 3));
+    
+    DirectedGraph dg;
+    dg.addEdges(edges);
+    EXPECT_EQ(4, dg.getNumVertex());
+    EXPECT_EQ(4, dg.getNumEdges());
+    EXPECT_EQ(2, dg.getVertex(1).getOutDeg());
+    EXPECT_EQ(1, dg.getVertex(1).getInDeg());
+    EXPECT_EQ(true, dg.isEdge(2, 1));
+}
@@ -24,6 +24,7 @@
 #include <iostream>
 #include "gtest/gtest.h"
 #include "graph.hpp"
+#include "compact-graph.hpp"
 
 
 class UndirectedGraphTest : public ::testing::Test {
@@ -131,6 +132,131 @@ TEST_F(UndirectedGraphTest, RemoveEdgeWorks) {
     EXPECT_EQ(11, g2.getNumEdges());
 }
 
+TEST_F(UndirectedGraphTest, BatchRemoveWorks) {
+    vector<uint64_t> ids = {1, 4, 234};
+    g2.removeVertices(ids, true);
+    EXPECT_EQ(4, g2.getNumVertex());
+    EXPECT_EQ(5, g2.getNumEdges());
+    EXPECT_LT(0, g2.getNumTombstones());
+    //Tombstones are skipped before compaction
+    EXPECT_EQ(3, g2.getVertex(6).getDeg());
+    EXPECT_EQ(2, g2.getVertex(6).getAdjID(0));
+    EXPECT_EQ(5, g2.getVertex(6).getAdjID(2));
+    EXPECT_EQ(false, g2.isEdge(6, 1));
+    EXPECT_EQ(1, g2.distance(5, 6));
+    g2.compact();
+    EXPECT_EQ(0, g2.getNumTombstones());
+    EXPECT_EQ(3, g2.getVertex(6).getDeg());
+    
+    vector<pair<uint64_t, uint64_t> > edges = {{2, 3}, {6, 5}, {5, 3}, {2, 34}};
+    g2.removeEdges(edges);
+    EXPECT_EQ(2, g2.getNumEdges());
+    EXPECT_EQ(0, g2.getNumTombstones());
+    EXPECT_EQ(false, g2.isEdge(3, 2));
+    EXPECT_EQ(true, g2.isEdge(2, 6));
+    g2.addEdge(3, 5);
+    EXPECT_EQ(3, g2.getNumEdges());
+    EXPECT_EQ(true, g2.isEdge(5, 3));
+    //Single edge changes revive or drop pending tombstones
+    edges = {{3, 5}, {2, 6}};
+    g2.removeEdges(edges, true);
+    EXPECT_EQ(4, g2.getNumTombstones());
+    g2.addEdge(3, 5);
+    EXPECT_EQ(2, g2.getNumTombstones());
+    g2.removeEdge(2, 6);
+    EXPECT_EQ(0, g2.getNumTombstones());
+}
+
+TEST_F(UndirectedGraphTest, IndexedAccessSkipsTombstones) {
+    UndirectedGraph g;
+    vector<pair<uint64_t, uint64_t> > edges;
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        edges.push_back(make_pair(0, i));
+    }
+    g.addEdges(edges);
+    vector<uint64_t> ids;
+    for (uint64_t i = 3; i <= 1000; i += 3) {
+        ids.push_back(i);
+    }
+    g.removeVertices(ids, true);
+    const UndirectedGraph::Vertex& v = g.getVertex(0);
+    vector<uint64_t> live;
+    v.forEachAdj([&](const uint64_t& adjID) { live.push_back(adjID); });
+    ASSERT_EQ(live.size(), v.getDeg());
+    for (uint64_t pos = 0; pos < v.getDeg(); ++pos) {
+        EXPECT_EQ(live[pos], v.getAdjID(pos));
+    }
+    //Going back, and changes to the list, start over
+    EXPECT_EQ(live[5], v.getAdjID(5));
+    vector<pair<uint64_t, uint64_t> > removed = {{0, 1}};
+    g.removeEdges(removed, true);
+    EXPECT_EQ(live[6], v.getAdjID(5));
+    g.addVertex(3);
+    g.addEdge(0, 3);
+    EXPECT_EQ(3, v.getAdjID(1));
+    EXPECT_EQ(live.back(), v.getAdjID(v.getDeg() - 1));
+}
+
+TEST_F(UndirectedGraphTest, EdgeIndexWorks) {
+    vector<pair<uint64_t, uint64_t> > pairs;
+    for (uint64_t i = 0; i <= 8; ++i) {
+        for (uint64_t j = 0; j <= 8; ++j) {
+            pairs.push_back(make_pair(i, j));
+        }
+    }
+    vector<uint8_t> expected;
+    for (auto& p : pairs) {
+        expected.push_back(g2.isEdge(p.first, p.second));
+    }
+    EXPECT_EQ(expected, g2.areEdges(pairs));
+    g2.enableEdgeIndex(4);
+    EXPECT_EQ(4, g2.getEdgeIndex().getNumHubs());
+    EXPECT_EQ(true, g2.getEdgeIndex().isHub(1));
+    EXPECT_EQ(false, g2.getEdgeIndex().isHub(2));
+    EXPECT_EQ(expected, g2.areEdges(pairs));
+    EXPECT_EQ(true, g2.isEdge(1, 5));
+    EXPECT_EQ(false, g2.isEdge(1, 4));
+    //Every change goes to the index
+    g2.removeEdge(1, 5);
+    EXPECT_EQ(false, g2.isEdge(1, 5));
+    EXPECT_EQ(false, g2.isEdge(5, 1));
+    g2.addEdge(2, 4);
+    EXPECT_EQ(true, g2.getEdgeIndex().isHub(2));
+    EXPECT_EQ(true, g2.isEdge(2, 4));
+    g2.removeVertex(6);
+    EXPECT_EQ(false, g2.getEdgeIndex().isHub(6));
+    EXPECT_EQ(false, g2.isEdge(2, 6));
+    EXPECT_EQ(false, g2.isEdge(3, 6));
+    vector<pair<uint64_t, uint64_t> > edges = {{3, 2}};
+    g2.removeEdges(edges, true);
+    EXPECT_EQ(false, g2.isEdge(3, 2));
+    EXPECT_EQ(false, g2.isEdge(2, 3));
+    edges = {{3, 4}, {3, 7}};
+    g2.addEdges(edges);
+    EXPECT_EQ(true, g2.isEdge(3, 7));
+    EXPECT_EQ(true, g2.isEdge(3, 4));
+    EXPECT_EQ(g2.getVertex(3).getDeg(), g2.getEdgeIndex().find(3)->size());
+    edges = {{3, 8}, {3, 4}};
+    g2.addEdges(edges);
+    EXPECT_EQ(true, g2.isEdge(3, 8));
+    EXPECT_EQ(true, g2.isEdge(8, 3));
+    EXPECT_EQ(g2.getVertex(3).getDeg(), g2.getEdgeIndex().find(3)->size());
+    vector<uint64_t> ids = {5};
+    g2.removeVertices(ids);
+    EXPECT_EQ(false, g2.isEdge(3, 5));
+    EXPECT_EQ(false, g2.getEdgeIndex().isHub(5));
+    //The index gives the same answers as the adjacency lists
+    UndirectedGraph copy(g2);
+    EXPECT_EQ(g2.getEdgeIndex().getNumHubs(), copy.getEdgeIndex().getNumHubs());
+    expected = copy.areEdges(pairs);
+    copy.disableEdgeIndex();
+    EXPECT_EQ(0, copy.getEdgeIndex().getNumHubs());
+    EXPECT_EQ(expected, copy.areEdges(pairs));
+    for (uint64_t i = 0; i < pairs.size(); ++i) {
+        EXPECT_EQ(expected[i], g2.isEdge(pairs[i].first, pairs[i].second));
+    }
+}
+
 TEST_F(UndirectedGraphTest, RightNumEdges) {
     uint64_t count;
     for (UndirectedGraph::VertexIterator vertexI = g2.begin(); vertexI != g2.end(); vertexI++) {
@@ -348,6 +474,143 @@ TEST_F(DirectedGraphTest, RemoveEdgeWorks) {
     EXPECT_EQ(13, g2.getNumEdges());
 }
 
+TEST_F(DirectedGraphTest, BatchRemoveWorks) {
+    vector<uint64_t> ids = {1, 4, 234};
+    g2.removeVertices(ids, true);
+    EXPECT_EQ(4, g2.getNumVertex());
+    EXPECT_EQ(6, g2.getNumEdges());
+    EXPECT_LT(0, g2.getNumTombstones());
+    //Tombstones are skipped before compaction
+    EXPECT_EQ(3, g2.getVertex(6).getOutDeg());
+    EXPECT_EQ(1, g2.getVertex(6).getInDeg());
+    EXPECT_EQ(2, g2.getVertex(6).getOutAdjID(0));
+    EXPECT_EQ(false, g2.isEdge(6, 1));
+    EXPECT_EQ(-1, g2.distance(5, 6));
+    EXPECT_EQ(2, g2.distance(2, 5));
+    g2.compact();
+    EXPECT_EQ(0, g2.getNumTombstones());
+    EXPECT_EQ(3, g2.getVertex(6).getOutDeg());
+    
+    vector<pair<uint64_t, uint64_t> > edges = {{2, 3}, {6, 5}, {3, 5}, {2, 34}};
+    g2.removeEdges(edges);
+    EXPECT_EQ(4, g2.getNumEdges());
+    EXPECT_EQ(0, g2.getNumTombstones());
+    EXPECT_EQ(false, g2.isEdge(2, 3));
+    EXPECT_EQ(0, g2.getVertex(5).getInDeg());
+    g2.addEdge(2, 3);
+    EXPECT_EQ(5, g2.getNumEdges());
+    EXPECT_EQ(true, g2.isEdge(2, 3));
+    //Single edge changes revive or drop pending tombstones
+    edges = {{2, 3}, {6, 2}};
+    g2.removeEdges(edges, true);
+    EXPECT_EQ(4, g2.getNumTombstones());
+    g2.addEdge(2, 3);
+    EXPECT_EQ(2, g2.getNumTombstones());
+    g2.removeEdge(6, 2);
+    EXPECT_EQ(0, g2.getNumTombstones());
+}
+
+TEST_F(DirectedGraphTest, EdgeIndexWorks) {
+    vector<pair<uint64_t, uint64_t> > pairs;
+    for (uint64_t i = 0; i <= 8; ++i) {
+        for (uint64_t j = 0; j <= 8; ++j) {
+            pairs.push_back(make_pair(i, j));
+        }
+    }
+    vector<uint8_t> expected = g2.areEdges(pairs);
+    EXPECT_EQ(14, count(expected.begin(), expected.end(), 1));
+    g2.enableEdgeIndex(3);
+    EXPECT_EQ(2, g2.getEdgeIndex().getNumHubs());
+    EXPECT_EQ(expected, g2.areEdges(pairs));
+    EXPECT_EQ(true, g2.isEdge(6, 1));
+    EXPECT_EQ(false, g2.isEdge(1, 6));
+    g2.removeEdge(6, 1);
+    EXPECT_EQ(false, g2.isEdge(6, 1));
+    g2.addEdge(2, 4);
+    EXPECT_EQ(true, g2.getEdgeIndex().isHub(2));
+    EXPECT_EQ(true, g2.isEdge(2, 4));
+    EXPECT_EQ(false, g2.isEdge(4, 2));
+    g2.removeVertex(3);
+    EXPECT_EQ(false, g2.isEdge(1, 3));
+    EXPECT_EQ(false, g2.isEdge(2, 3));
+    vector<pair<uint64_t, uint64_t> > edges = {{1, 2}};
+    g2.removeEdges(edges, true);
+    EXPECT_EQ(false, g2.isEdge(1, 2));
+    edges = {{4, 1}, {4, 2}};
+    g2.addEdges(edges);
+    EXPECT_EQ(true, g2.getEdgeIndex().isHub(4));
+    EXPECT_EQ(true, g2.isEdge(4, 1));
+    //An existing hub only takes the new entries
+    edges = {{2, 7}, {2, 8}, {2, 4}};
+    g2.addEdges(edges);
+    EXPECT_EQ(true, g2.isEdge(2, 8));
+    EXPECT_EQ(g2.getVertex(2).getOutDeg(), g2.getEdgeIndex().find(2)->size());
+    vector<uint64_t> ids = {1};
+    g2.removeVertices(ids);
+    EXPECT_EQ(false, g2.getEdgeIndex().isHub(1));
+    EXPECT_EQ(false, g2.isEdge(4, 1));
+    expected = g2.areEdges(pairs);
+    g2.disableEdgeIndex();
+    EXPECT_EQ(expected, g2.areEdges(pairs));
+}
+
+TEST_F(DirectedGraphTest, OutOnlyStorageWorks) {
+    DirectedGraph g(DirectedGraph::kOutOnly);
+    vector<pair<uint64_t, uint64_t> > edges;
+    for (auto v = g2.begin(); v != g2.end(); v++) {
+        v->second.forEachOutAdj([&](const uint64_t& adjID) { edges.push_back(make_pair(v->first, adjID)); });
+    }
+    g.addEdges(edges);
+    EXPECT_EQ(14, g.getNumEdges());
+    //The in connections are only reachable through the transpose
+    EXPECT_THROW(g.getVertex(6).getInDeg(), logic_error);
+    EXPECT_THROW(g.getVertex(6).getDeg(), logic_error);
+    EXPECT_THROW(g.getVertex(6).isInEdge(1), logic_error);
+    EXPECT_THROW(g.getVertex(6).getInAdjID(0), logic_error);
+    EXPECT_THROW(g.getVertex(6).forEachInAdj([](const uint64_t&) { }), logic_error);
+    EXPECT_EQ(4, g.getVertex(6).getOutDeg());
+    //The transpose holds the in connections, and is kept until the graph changes
+    shared_ptr<const CompactGraph> in = g.transpose();
+    EXPECT_EQ(in, g.transpose());
+    EXPECT_EQ(g2.getNumVertex(), in->getNumVertex());
+    for (uint64_t i = 0; i < in->getNumVertex(); ++i) {
+        vector<uint64_t> ids;
+        for (const uint64_t* a = in->adjBegin(i); a != in->adjEnd(i); ++a) {
+            ids.push_back(in->getId(*a));
+        }
+        vector<uint64_t> expected;
+        g2.getVertex(in->getId(i)).forEachInAdj([&](const uint64_t& adjID) { expected.push_back(adjID); });
+        EXPECT_EQ(expected, ids);
+    }
+    g.addEdge(4, 1);
+    EXPECT_NE(in, g.transpose());
+    EXPECT_EQ(4, g.transpose()->getDeg(0));
+    g.removeVertex(3);
+    EXPECT_EQ(5, g.getNumVertex());
+    EXPECT_EQ(10, g.getNumEdges());
+    EXPECT_EQ(false, g.isEdge(1, 3));
+    EXPECT_EQ(false, g.isEdge(6, 3));
+    vector<uint64_t> ids = {1, 234};
+    g.removeVertices(ids, true);
+    EXPECT_EQ(5, g.getNumEdges());
+    EXPECT_EQ(false, g.isEdge(6, 1));
+    EXPECT_EQ(2, g.getVertex(6).getOutDeg());
+    //Switching back rebuilds the in connection lists
+    g.setStorage(DirectedGraph::kOutAndIn);
+    EXPECT_EQ(DirectedGraph::kOutAndIn, g.getStorage());
+    EXPECT_EQ(2, g.getVertex(5).getInDeg());
+    EXPECT_EQ(true, g.getVertex(2).isInEdge(6));
+    g.removeVertex(6);
+    EXPECT_EQ(1, g.getNumEdges());
+    EXPECT_EQ(0, g.getVertex(2).getInDeg());
+    g.setStorage(DirectedGraph::kOutOnly);
+    EXPECT_THROW(g.getVertex(5).getInDeg(), logic_error);
+    EXPECT_EQ(true, g.isEdge(4, 5));
+    g.removeEdge(4, 5);
+    EXPECT_EQ(false, g.isEdge(4, 5));
+    EXPECT_EQ(0, g.getNumEdges());
+}
+
 TEST_F(DirectedGraphTest, RightNumEdges) {
     uint64_t count = 0;
     for (DirectedGraph::VertexIterator vertexI = g2.begin(); vertexI != g2.end(); vertexI++) {
@@ -0,0 +1,92 @@
+/**
+ *  hyper-anf-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+#include "gtest/gtest.h"
+#include "hyper-anf.hpp"
+#include "graph-generator.hpp"
+
+
+TEST(HyperANFTest, PathWorks) {
+    uint64_t n = 100;
+    GraphGenerator::TEdgeList edges;
+    for (uint64_t i = 0; i + 1 < n; ++i) {
+        edges.push_back(make_pair(i, i + 1));
+    }
+    CompactGraph cg = CompactGraph::fromEdges(n, edges, false);
+    HyperANF anf(cg, 8, 1, 2);
+    EXPECT_EQ(0, anf.getNeighbourhoodFunction().size());
+    uint64_t iterations = anf.run();
+    EXPECT_GE(n - 1, iterations);
+    EXPECT_EQ(iterations + 1, anf.getNeighbourhoodFunction().size());
+    //Exact average distance on a path is (n + 1) / 3
+    EXPECT_NEAR((n + 1) / 3.0, anf.getAverageDistance(), 0.15 * (n + 1) / 3.0);
+    EXPECT_NEAR(n, anf.getReachableSize(0), 0.15 * n);
+    EXPECT_LT(50, anf.getEffectiveDiameter());
+    EXPECT_GT(n, anf.getEffectiveDiameter());
+    
+    //Directed, each vertex reaches the ones after it
+    CompactGraph dg = CompactGraph::fromEdges(n, edges, true);
+    HyperANF danf(dg, 8, 1);
+    //Counters can stop changing a little before the diameter
+    iterations = danf.run();
+    EXPECT_GE(n - 1, iterations);
+    EXPECT_LT(n - 10, iterations);
+    EXPECT_NEAR(n, danf.getReachableSize(0), 0.15 * n);
+    EXPECT_NEAR(1, danf.getReachableSize(n - 1), 0.1);
+    EXPECT_EQ(3, danf.run(3));
+    EXPECT_THROW(HyperANF(cg, 3), out_of_range);
+}
+
+TEST(HyperANFTest, MatchesExactDistances) {
+    GraphGenerator gen(17);
+    uint64_t n = 1000;
+    CompactGraph cg = CompactGraph::fromEdges(n, gen.barabasiAlbert(n, 2), false);
+    //Exact average distance with a BFS from every vertex
+    double sum = 0;
+    double pairs = 0;
+    for (uint64_t s = 0; s < n; ++s) {
+        vector<int64_t> dist(n, -1);
+        vector<uint64_t> queue(1, s);
+        dist[s] = 0;
+        for (uint64_t head = 0; head < queue.size(); ++head) {
+            uint64_t v = queue[head];
+            for (const uint64_t* a = cg.adjBegin(v); a != cg.adjEnd(v); ++a) {
+                if (dist[*a] < 0) {
+                    dist[*a] = dist[v] + 1;
+                    sum += dist[*a];
+                    pairs += 1;
+                    queue.push_back(*a);
+                }
+            }
+        }
+    }
+    HyperANF anf(cg, 7, 3, 4);
+    anf.run();
+    EXPECT_NEAR(sum / pairs, anf.getAverageDistance(), 0.1 * sum / pairs);
+    EXPECT_NEAR(n * n, anf.getNeighbourhoodFunction().back(), 0.1 * n * n);
+    //Results only depend on the seed
+    HyperANF single(cg, 7, 3, 1);
+    single.run();
+    EXPECT_EQ(anf.getNeighbourhoodFunction(), single.getNeighbourhoodFunction());
+}
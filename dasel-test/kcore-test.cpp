@@ -0,0 +1,91 @@
+/**
+ *  kcore-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+#include "gtest/gtest.h"
+#include "kcore.hpp"
+#include "graph-generator.hpp"
+
+
+TEST(CoreDecompositionTest, CoreNumbersWork) {
+    //K4 on 1-4, a triangle 5-6-7 hanging from 4, a tail 8-9 and an isolated 10
+    UndirectedGraph g;
+    for (uint64_t i = 1; i <= 10; ++i) {
+        g.addVertex(i);
+    }
+    for (uint64_t i = 1; i <= 4; ++i) {
+        for (uint64_t j = i + 1; j <= 4; ++j) {
+            g.addEdge(i, j);
+        }
+    }
+    g.addEdge(4, 5);
+    g.addEdge(5, 6);
+    g.addEdge(6, 7);
+    g.addEdge(7, 5);
+    g.addEdge(7, 8);
+    g.addEdge(8, 9);
+    g.addEdge(9, 9);
+    uint64_t numEdges = g.getNumEdges();
+    
+    CoreDecomposition::tAlgorithm algorithms[] = {CoreDecomposition::kBucket, CoreDecomposition::kPeeling};
+    for (auto algorithm : algorithms) {
+        CoreDecomposition cd(g, algorithm);
+        EXPECT_EQ(3, cd.getMaxCore());
+        for (uint64_t i = 1; i <= 4; ++i) {
+            EXPECT_EQ(3, cd.getCoreNumber(i));
+        }
+        EXPECT_EQ(2, cd.getCoreNumber(5));
+        EXPECT_EQ(2, cd.getCoreNumber(7));
+        EXPECT_EQ(1, cd.getCoreNumber(8));
+        EXPECT_EQ(1, cd.getCoreNumber(9));
+        EXPECT_EQ(0, cd.getCoreNumber(10));
+        EXPECT_EQ(0, cd.getCoreNumber(11));
+        
+        CompactGraph maxCore = cd.getMaxCoreSubgraph();
+        EXPECT_EQ(4, maxCore.getNumVertex());
+        EXPECT_EQ(6, maxCore.getNumEdges());
+        EXPECT_EQ(4, maxCore.getId(3));
+        CompactGraph twoCore = cd.getCore(2);
+        EXPECT_EQ(7, twoCore.getNumVertex());
+        EXPECT_EQ(10, twoCore.getNumEdges());
+    }
+    //The source graph is untouched
+    EXPECT_EQ(numEdges, g.getNumEdges());
+    EXPECT_EQ(10, g.getNumVertex());
+}
+
+TEST(CoreDecompositionTest, PeelingMatchesBucket) {
+    GraphGenerator gen(11);
+    uint64_t n = 3000;
+    CompactGraph cg = CompactGraph::fromEdges(n, gen.barabasiAlbert(n, 4), false);
+    CoreDecomposition bucket(cg, CoreDecomposition::kBucket);
+    EXPECT_LE(4, bucket.getMaxCore());
+    for (unsigned threads = 1; threads <= 4; ++threads) {
+        CoreDecomposition peeling(cg, CoreDecomposition::kPeeling, threads);
+        EXPECT_EQ(bucket.getCoreNumbers(), peeling.getCoreNumbers());
+    }
+    //Every vertex in the max core has at least max core neighbours inside it
+    CompactGraph maxCore = bucket.getMaxCoreSubgraph();
+    for (uint64_t v = 0; v < maxCore.getNumVertex(); ++v) {
+        EXPECT_LE(bucket.getMaxCore(), maxCore.getDeg(v));
+    }
+}
@@ -0,0 +1,141 @@
+/**
+ *  louds-trie-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+#include <stdexcept>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include "gtest/gtest.h"
+#include "louds-trie.hpp"
+
+
+TEST(LoudsTrieTest, LookupsWork) {
+    const string fileName = "louds-trie-test.dat";
+    Trie t;
+    for (string w : {"hello", "Octopus", "Octogonal", "ornitorrinco", "Advice", "files", "file",
+                     "Supercalifragilisticexpialidocious", "super", "supra", "north"}) {
+        t.insertWord(w);
+    }
+    LoudsTrie::freeze(t, fileName);
+    {
+        LoudsTrie l(fileName);
+        EXPECT_EQ(11, l.getDictionarySize());
+        EXPECT_EQ(t.getNumNodes(), l.getNumNodes());
+        EXPECT_EQ(true, l.isWord("file"));
+        EXPECT_EQ(true, l.isWord("aDvIcE"));
+        EXPECT_EQ(true, l.isWord("supercalifraGILIsticexpialidocious"));
+        EXPECT_EQ(true, l.isPrefix("sup"));
+        EXPECT_EQ(true, l.isPrefix("no"));
+        EXPECT_EQ(false, l.isWord("supr"));
+        EXPECT_EQ(false, l.isWord("superc"));
+        EXPECT_EQ(false, l.isPrefix("melon"));
+        EXPECT_EQ(false, l.isPrefix("orth"));
+        EXPECT_THROW(l.isWord("a1"), out_of_range);
+        //Root children are a, f, h, n, o and s, in order
+        EXPECT_EQ(6, l.getNumChildren(l.getRoot()));
+        EXPECT_EQ(1, l.getChild(l.getRoot(), 'a'));
+        EXPECT_EQ(6, l.getChild(l.getRoot(), 'S'));
+        EXPECT_EQ('s', l.getContent(6));
+        EXPECT_EQ(LoudsTrie::kNoNode, l.getChild(l.getRoot(), 'b'));
+        EXPECT_EQ(l.searchWord("file"), l.getChild(l.searchWord("fil", false), 'e'));
+        EXPECT_EQ(true, l.isWordNode(l.searchWord("file")));
+        EXPECT_EQ(1, l.getNumChildren(l.searchWord("file")));
+        //Far smaller than the node pool
+        EXPECT_GT(t.getMemoryUsage() / 100, l.getMemoryUsage());
+    }
+    //The same bytes can be used from memory
+    ifstream in(fileName, ios::binary);
+    vector<uint64_t> data(1024);
+    in.read(reinterpret_cast<char*>(data.data()), data.size() * 8);
+    uint64_t bytes = in.gcount();
+    {
+        LoudsTrie l(data.data(), bytes);
+        EXPECT_EQ(true, l.isWord("octogonal"));
+        EXPECT_EQ(false, l.isWord("octo"));
+    }
+    EXPECT_THROW(LoudsTrie(data.data(), bytes - 8), runtime_error);
+    {
+        //A degree sequence with no 0 bit is not followed past its end
+        vector<uint64_t> corrupt(data);
+        uint64_t loudsWords = (2 * corrupt[2] - 1 + 63) / 64;
+        fill(corrupt.begin() + 5, corrupt.begin() + 5 + loudsWords, ~0ULL);
+        LoudsTrie l(corrupt.data(), bytes);
+        EXPECT_THROW(l.getNumChildren(l.getRoot()), runtime_error);
+        EXPECT_THROW(l.isWord("octogonal"), runtime_error);
+    }
+    data[0] = 0;
+    EXPECT_THROW(LoudsTrie(data.data(), bytes), runtime_error);
+    remove(fileName.c_str());
+    EXPECT_THROW(LoudsTrie l(fileName), runtime_error);
+}
+
+TEST(LoudsTrieTest, MatchesTrie) {
+    //Enough nodes for several blocks of the select index
+    const string fileName = "louds-trie-test.dat";
+    Trie t;
+    set<string> words;
+    uint64_t x = 7;
+    for (uint64_t i = 0; i < 20000; ++i) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        string w;
+        for (uint64_t len = 1 + (x >> 59) % 10, y = x >> 8; len > 0; --len, y /= 26) {
+            w += static_cast<char>('a' + y % (1 + i % 26));
+        }
+        words.insert(w);
+        t.insertWord(w);
+    }
+    Trie empty;
+    LoudsTrie::freeze(empty, fileName);
+    {
+        LoudsTrie l(fileName);
+        EXPECT_EQ(1, l.getNumNodes());
+        EXPECT_EQ(0, l.getNumChildren(l.getRoot()));
+        EXPECT_EQ(false, l.isPrefix("a"));
+        EXPECT_EQ(true, l.isPrefix(""));
+        EXPECT_EQ(false, l.isWord(""));
+    }
+    LoudsTrie::freeze(t, fileName);
+    LoudsTrie l(fileName);
+    EXPECT_EQ(words.size(), l.getDictionarySize());
+    EXPECT_EQ(t.getNumNodes(), l.getNumNodes());
+    //At most 10 bits per node with the indexes
+    EXPECT_GT(10 * l.getNumNodes() / 8 + 100, l.getMemoryUsage());
+    for (auto& w : words) {
+        EXPECT_EQ(true, l.isWord(w));
+        string p = w.substr(0, w.size() / 2);
+        EXPECT_EQ(t.isWord(p), l.isWord(p));
+        EXPECT_EQ(true, l.isPrefix(p));
+        string q = w + "z";
+        EXPECT_EQ(t.isPrefix(q), l.isPrefix(q));
+        EXPECT_EQ(t.isWord(q), l.isWord(q));
+    }
+    //Every node has the degree of its Trie counterpart
+    for (auto& w : words) {
+        for (uint64_t i = 0; i <= w.size(); ++i) {
+            string p = w.substr(0, i);
+            EXPECT_EQ(t.searchWord(p, false)->getNumChildren(), l.getNumChildren(l.searchWord(p, false)));
+        }
+    }
+    remove(fileName.c_str());
+}
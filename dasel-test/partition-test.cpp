@@ -0,0 +1,117 @@
+/**
+ *  partition-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+
+#include <stdexcept>
+#include "gtest/gtest.h"
+#include "partition.hpp"
+#include "graph-generator.hpp"
+#include "rng.hpp"
+
+namespace {
+    ///Eight groups of 100 vertex, dense inside and sparse across
+    CompactGraph plantedPartition (const uint64_t& seed) {
+        GraphGenerator gen(seed);
+        GraphGenerator::TEdgeList edges;
+        for (uint64_t g = 0; g < 8; ++g) {
+            for (auto& e : gen.gnp(100, 0.1)) {
+                edges.push_back(make_pair(e.first + g * 100, e.second + g * 100));
+            }
+        }
+        for (auto& e : gen.gnm(800, 200, false)) {
+            edges.push_back(e);
+        }
+        return CompactGraph::fromEdges(800, edges, false);
+    }
+}
+
+TEST(GraphPartitionerTest, RejectsBadParameters) {
+    UndirectedGraph g;
+    g.addEdges({{1, 2}});
+    GraphPartitioner p(g);
+    EXPECT_THROW(p.partition(0), invalid_argument);
+    EXPECT_THROW(p.partition(2, GraphPartitioner::kLDG, 0), invalid_argument);
+    EXPECT_THROW(p.partition(2, GraphPartitioner::kLDG, 1, 0.5), invalid_argument);
+    EXPECT_THROW(p.evaluate({0}, 2), invalid_argument);
+    EXPECT_THROW(p.evaluate({0, 2}, 2), invalid_argument);
+}
+
+TEST(GraphPartitionerTest, EvaluateWorks) {
+    //Square 1-2-3-4 with a self loop on 1
+    UndirectedGraph g;
+    g.addEdges({{1, 2}, {2, 3}, {3, 4}, {4, 1}, {1, 1}});
+    GraphPartitioner p(g);
+    GraphPartitioner::tPartition r = p.evaluate({0, 0, 1, 1}, 2);
+    EXPECT_EQ(2, r.edgeCut);
+    EXPECT_DOUBLE_EQ(0.4, r.cutFraction);
+    EXPECT_DOUBLE_EQ(1.0, r.balance);
+    EXPECT_EQ(vector<uint64_t>({2, 2}), r.partSize);
+    r = p.evaluate({0, 1, 0, 1}, 2);
+    EXPECT_EQ(4, r.edgeCut);
+    r = p.evaluate({0, 0, 0, 1}, 3);
+    EXPECT_EQ(2, r.edgeCut);
+    EXPECT_DOUBLE_EQ(2.25, r.balance);
+    //Every edge of a directed graph counts once
+    DirectedGraph d;
+    d.addEdges({{1, 2}, {2, 1}, {2, 3}});
+    GraphPartitioner dp(d);
+    EXPECT_EQ(3, dp.evaluate({0, 1, 0}, 2).edgeCut);
+    EXPECT_EQ(1, dp.evaluate({0, 0, 1}, 2).edgeCut);
+}
+
+TEST(GraphPartitionerTest, FindsPlantedParts) {
+    GraphPartitioner p(plantedPartition(3), 5);
+    uint64_t n = p.getGraph().getNumVertex();
+    //A random assignment cuts about 7/8 of the edges
+    SplitMix64 rng(1);
+    vector<uint64_t> random(n);
+    for (auto& part : random) {
+        part = rng.nextBelow(8);
+    }
+    GraphPartitioner::tPartition base = p.evaluate(random, 8);
+    EXPECT_LT(0.8, base.cutFraction);
+    for (auto method : {GraphPartitioner::kLDG, GraphPartitioner::kFennel}) {
+        GraphPartitioner::tPartition r = p.partition(8, method, 3, 1.1);
+        EXPECT_EQ(n, r.part.size());
+        EXPECT_GE(1.1 + 1e-9, r.balance);
+        EXPECT_GT(0.3, r.cutFraction);
+        EXPECT_EQ(r.edgeCut, p.evaluate(r.part, 8).edgeCut);
+        //Restreaming does not make the cut worse here
+        EXPECT_GE(p.partition(8, method, 1, 1.1).edgeCut, r.edgeCut);
+    }
+    //Same seed, same result
+    EXPECT_EQ(p.partition(8).part, GraphPartitioner(p.getGraph(), 5).partition(8).part);
+    EXPECT_EQ(vector<uint64_t>(n, 0), p.partition(1).part);
+}
+
+TEST(GraphPartitionerTest, DirectedGraphWorks) {
+    GraphGenerator gen(9);
+    CompactGraph g = CompactGraph::fromEdges(500, gen.gnm(500, 2000, true), true);
+    GraphPartitioner p(g);
+    EXPECT_EQ(500, p.getReverse().getNumVertex());
+    GraphPartitioner::tPartition r = p.partition(4, GraphPartitioner::kFennel, 2, 1.02);
+    EXPECT_GE(1.02 + 1e-9, r.balance);
+    EXPECT_EQ(4, r.partSize.size());
+    EXPECT_GT(0.75, r.cutFraction);
+}
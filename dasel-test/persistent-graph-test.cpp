@@ -0,0 +1,265 @@
+/**
+ *  persistent-graph-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+
+#include <set>
+#include <thread>
+#include <cstdio>
+#include <csignal>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include "gtest/gtest.h"
+#include "persistent-graph.hpp"
+
+
+namespace {
+    const char kDir[] = "persistent-graph-test.d";
+    
+    ///Lists the files in the test directory, sorted
+    vector<string> listDir () {
+        vector<string> names;
+        DIR* d = opendir(kDir);
+        if (d != nullptr) {
+            for (dirent* entry = readdir(d); entry != nullptr; entry = readdir(d)) {
+                string name(entry->d_name);
+                if ((name != ".") && (name != "..")) {
+                    names.push_back(name);
+                }
+            }
+            closedir(d);
+        }
+        sort(names.begin(), names.end());
+        return names;
+    }
+    
+    ///Removes the test directory and its files
+    void removeDir () {
+        for (auto& name : listDir()) {
+            remove((string(kDir) + "/" + name).c_str());
+        }
+        rmdir(kDir);
+    }
+    
+    ///Returns the edges of a graph, each one once from its smaller end
+    set<pair<uint64_t, uint64_t> > edgeSet (const UndirectedGraph& g) {
+        set<pair<uint64_t, uint64_t> > edges;
+        for (auto vID : g.getVertexIDs()) {
+            g.findVertex(vID)->forEachAdj([&](const uint64_t& adjID) {
+                if (vID <= adjID) {
+                    edges.insert(make_pair(vID, adjID));
+                }
+            });
+        }
+        return edges;
+    }
+    
+    ///Returns the sorted vertex IDs of a graph
+    vector<uint64_t> vertexSet (const UndirectedGraph& g) {
+        vector<uint64_t> ids = g.getVertexIDs();
+        sort(ids.begin(), ids.end());
+        return ids;
+    }
+}
+
+TEST(PersistentGraphTest, RecoversFromLog) {
+    removeDir();
+    UndirectedGraph expected;
+    {
+        PersistentGraph g(kDir);
+        EXPECT_EQ(0, g.getRecovery().records);
+        g.addEdge(1, 2);
+        g.addEdge(2, 3);
+        g.addEdge(3, 1);
+        g.addVertex(10);
+        g.addEdges({{4, 5}, {5, 6}, {6, 4}, {1, 4}});
+        g.removeEdge(1, 2);
+        g.removeEdge(7, 8);
+        g.removeVertex(6);
+        g.addVertex(6);
+        expected = g.getGraph();
+    }
+    PersistentGraph g(kDir);
+    EXPECT_EQ(0, g.getRecovery().snapshot);
+    EXPECT_EQ(1, g.getRecovery().segments);
+    EXPECT_EQ(12, g.getRecovery().records);
+    EXPECT_EQ(0, g.getRecovery().truncatedBytes);
+    EXPECT_EQ(2, g.getSegment());
+    EXPECT_EQ(vertexSet(expected), vertexSet(g.getGraph()));
+    EXPECT_EQ(edgeSet(expected), edgeSet(g.getGraph()));
+    EXPECT_EQ(4, g.getGraph().getNumEdges());
+    EXPECT_EQ(0, g.getGraph().findVertex(6)->getDeg());
+    removeDir();
+}
+
+TEST(PersistentGraphTest, CheckpointAndReplay) {
+    removeDir();
+    UndirectedGraph expected;
+    {
+        PersistentGraph g(kDir, 1 << 16, 0);
+        for (uint64_t i = 0; i < 1000; ++i) {
+            g.addEdge(i, (i * 7 + 3) % 1000);
+        }
+        g.commit();
+        EXPECT_EQ(true, g.checkpoint());
+        g.waitCheckpoint();
+        EXPECT_EQ(1, g.getNumCheckpoints());
+        //Mutations after the checkpoint go to the new segment
+        for (uint64_t i = 0; i < 100; ++i) {
+            g.removeVertex(i * 10);
+        }
+        g.addEdge(5000, 5001);
+        expected = g.getGraph();
+    }
+    //The first segment was dropped with the checkpoint
+    EXPECT_EQ(vector<string>({"snapshot-00000000000000000002.bin", "wal-00000000000000000002.log"}), listDir());
+    PersistentGraph g(kDir);
+    EXPECT_EQ(2, g.getRecovery().snapshot);
+    EXPECT_EQ(1000, g.getRecovery().snapshotVertex);
+    EXPECT_EQ(1, g.getRecovery().segments);
+    EXPECT_EQ(101, g.getRecovery().records);
+    EXPECT_EQ(vertexSet(expected), vertexSet(g.getGraph()));
+    EXPECT_EQ(edgeSet(expected), edgeSet(g.getGraph()));
+    EXPECT_EQ(expected.getNumEdges(), g.getGraph().getNumEdges());
+    removeDir();
+}
+
+TEST(PersistentGraphTest, AutomaticCheckpoints) {
+    removeDir();
+    UndirectedGraph expected;
+    {
+        //A frame every 10 records, a checkpoint every ~100
+        PersistentGraph g(kDir, 170, 1700);
+        for (uint64_t i = 0; i < 2000; ++i) {
+            g.addEdge(i % 300, (i * 13) % 300);
+            if (i % 50 == 0) {
+                g.removeVertex(i % 300);
+            }
+        }
+        EXPECT_LE(200, g.getNumFrames());
+        EXPECT_LE(1, g.getNumCheckpoints());
+        expected = g.getGraph();
+    }
+    PersistentGraph g(kDir);
+    EXPECT_LT(0, g.getRecovery().snapshot);
+    EXPECT_EQ(vertexSet(expected), vertexSet(g.getGraph()));
+    EXPECT_EQ(edgeSet(expected), edgeSet(g.getGraph()));
+    removeDir();
+}
+
+TEST(PersistentGraphTest, TruncatesTornTail) {
+    removeDir();
+    UndirectedGraph expected;
+    {
+        PersistentGraph g(kDir);
+        g.addEdges({{1, 2}, {2, 3}});
+        g.commit();
+        expected = g.getGraph();
+    }
+    //A frame cut short by a crash
+    string name = string(kDir) + "/wal-00000000000000000001.log";
+    FILE* f = fopen(name.c_str(), "ab");
+    uint64_t header[2] = {34, 0};
+    fwrite(header, sizeof(header), 1, f);
+    fwrite("partial", 7, 1, f);
+    fclose(f);
+    {
+        PersistentGraph g(kDir);
+        EXPECT_EQ(23, g.getRecovery().truncatedBytes);
+        EXPECT_EQ(2, g.getRecovery().records);
+        EXPECT_EQ(edgeSet(expected), edgeSet(g.getGraph()));
+        g.addEdge(3, 4);
+    }
+    PersistentGraph g(kDir);
+    EXPECT_EQ(0, g.getRecovery().truncatedBytes);
+    EXPECT_EQ(3, g.getRecovery().records);
+    EXPECT_EQ(2, g.getRecovery().segments);
+    EXPECT_EQ(true, g.getGraph().isEdge(3, 4));
+    removeDir();
+}
+
+TEST(PersistentGraphTest, RetriesFailedWrites) {
+    removeDir();
+    string name = string(kDir) + "/wal-00000000000000000001.log";
+    struct stat st;
+    {
+        PersistentGraph g(kDir, 1 << 16, 0, true);
+        g.addEdge(1, 2);
+        ASSERT_EQ(0, stat(name.c_str(), &st));
+        off_t size = st.st_size;
+        //A file size limit lets the next frame be written only in part
+        void (*handler)(int) = signal(SIGXFSZ, SIG_IGN);
+        rlimit saved;
+        getrlimit(RLIMIT_FSIZE, &saved);
+        rlimit limit = saved;
+        limit.rlim_cur = size + 100;
+        setrlimit(RLIMIT_FSIZE, &limit);
+        vector<pair<uint64_t, uint64_t> > edges;
+        for (uint64_t i = 0; i < 100; ++i) {
+            edges.push_back(make_pair(10 + i, 11 + i));
+        }
+        EXPECT_THROW(g.addEdges(edges), runtime_error);
+        setrlimit(RLIMIT_FSIZE, &saved);
+        signal(SIGXFSZ, handler);
+        //The torn frame is cut, and its records are written with the next one
+        ASSERT_EQ(0, stat(name.c_str(), &st));
+        EXPECT_EQ(size, st.st_size);
+        g.addEdge(500, 501);
+        EXPECT_EQ(102, g.getGraph().getNumEdges());
+    }
+    PersistentGraph g(kDir);
+    EXPECT_EQ(0, g.getRecovery().truncatedBytes);
+    EXPECT_EQ(102, g.getRecovery().records);
+    EXPECT_EQ(102, g.getGraph().getNumEdges());
+    removeDir();
+}
+
+TEST(PersistentGraphTest, GroupCommit) {
+    removeDir();
+    const uint64_t kThreads = 4;
+    const uint64_t kEdges = 200;
+    {
+        PersistentGraph g(kDir, 1 << 16, 0, true);
+        vector<thread> workers;
+        for (uint64_t t = 0; t < kThreads; ++t) {
+            workers.push_back(thread([&g, t, kEdges]() {
+                for (uint64_t i = 0; i < kEdges; ++i) {
+                    g.addEdge(t * kEdges + i, t * kEdges + i + 1);
+                }
+            }));
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        //Threads waiting on a write share the next frame
+        EXPECT_GT(g.getMaxFrameRecords(), 1);
+        EXPECT_LT(g.getNumFrames(), kThreads * kEdges);
+        EXPECT_EQ(kThreads * kEdges, g.getGraph().getNumEdges());
+    }
+    PersistentGraph g(kDir);
+    EXPECT_EQ(kThreads * kEdges, g.getRecovery().records);
+    EXPECT_EQ(kThreads * kEdges, g.getGraph().getNumEdges());
+    removeDir();
+}
@@ -0,0 +1,116 @@
+/**
+ *  query-executor-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+#include "gtest/gtest.h"
+#include "query-executor.hpp"
+#include "graph-generator.hpp"
+
+namespace {
+    ///Graph whose edge queries throw on one vertex
+    struct tFailingGraph {
+        bool isEdge (const uint64_t& from, const uint64_t& to) const {
+            if (from == 13) {
+                throw runtime_error("tFailingGraph: bad vertex");
+            }
+            return from < to;
+        }
+    };
+}
+
+TEST(WorkStealingPoolTest, RunsAllTasks) {
+    WorkStealingPool pool(4);
+    EXPECT_EQ(4, pool.getNumThreads());
+    atomic<uint64_t> sum(0);
+    vector<future<uint64_t> > results;
+    for (uint64_t i = 0; i < 1000; ++i) {
+        results.push_back(pool.submit([i, &sum]() { sum.fetch_add(i); return i * 2; }));
+    }
+    uint64_t total = 0;
+    for (auto& r : results) {
+        total += r.get();
+    }
+    EXPECT_EQ(999 * 1000, total);
+    EXPECT_EQ(999 * 500, sum.load());
+}
+
+TEST(QueryExecutorTest, BatchesMatchSequentialQueries) {
+    GraphGenerator gen(21);
+    UndirectedGraph g;
+    g.addEdges(gen.gnm(500, 1500));
+    vector<uint64_t> ids = g.getVertexIDs();
+    QueryExecutor<UndirectedGraph>::TPairList pairs;
+    for (uint64_t i = 0; i < 300; ++i) {
+        pairs.push_back(make_pair(ids[(i * 7) % ids.size()], ids[(i * 13 + 5) % ids.size()]));
+    }
+    pairs.push_back(make_pair(ids[0], 100000));
+    
+    QueryExecutor<UndirectedGraph> executor(g, 3, 16);
+    future<vector<int16_t> > dist = executor.distances(pairs);
+    future<vector<uint8_t> > edges = executor.areEdges(pairs);
+    future<vector<uint64_t> > deg = executor.degrees(ids);
+    vector<vector<uint64_t> > seeds(10, vector<uint64_t>(1, ids[3]));
+    future<vector<CompactGraph> > hops = executor.kHops(seeds, 2);
+    
+    vector<int16_t> d = dist.get();
+    vector<uint8_t> e = edges.get();
+    vector<uint64_t> dg = deg.get();
+    vector<CompactGraph> h = hops.get();
+    ASSERT_EQ(pairs.size(), d.size());
+    for (uint64_t i = 0; i < pairs.size(); ++i) {
+        EXPECT_EQ(g.distance(pairs[i].first, pairs[i].second), d[i]);
+        EXPECT_EQ(g.isEdge(pairs[i].first, pairs[i].second), e[i] == 1);
+    }
+    EXPECT_EQ(-1, d.back());
+    for (uint64_t i = 0; i < ids.size(); ++i) {
+        EXPECT_EQ(g.findVertex(ids[i])->getDeg(), dg[i]);
+    }
+    EXPECT_EQ(g.kHopSubgraph(seeds[0], 2).getNumEdges(), h[9].getNumEdges());
+    
+    //Queries never add vertex
+    EXPECT_EQ(ids.size(), g.getNumVertex());
+    EXPECT_EQ(pairs.size() * 2 + ids.size() + seeds.size(), executor.getStats().queries);
+    executor.resetStats();
+    EXPECT_EQ(0, executor.getStats().queries);
+    EXPECT_EQ(0, executor.distances(QueryExecutor<UndirectedGraph>::TPairList()).get().size());
+}
+
+TEST(QueryExecutorTest, QueryExceptionsReachTheFuture) {
+    tFailingGraph g;
+    QueryExecutor<tFailingGraph>::TPairList pairs;
+    for (uint64_t i = 0; i < 100; ++i) {
+        pairs.push_back(make_pair(i, 50));
+    }
+    {
+        QueryExecutor<tFailingGraph> executor(g, 2, 8);
+        future<vector<uint8_t> > edges = executor.areEdges(pairs);
+        EXPECT_THROW(edges.get(), runtime_error);
+        //The workers survive, and the other chunks still run
+        pairs.resize(13);
+        vector<uint8_t> e = executor.areEdges(pairs).get();
+        EXPECT_EQ(1, e[0]);
+        //Tasks still queued at destruction run before the counters go away
+        for (uint64_t i = 0; i < 20; ++i) {
+            executor.areEdges(pairs);
+        }
+    }
+}
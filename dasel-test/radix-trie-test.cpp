@@ -0,0 +1,154 @@
+/**
+ *  radix-trie-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+
+#include <set>
+#include "gtest/gtest.h"
+#include "radix-trie.hpp"
+#include "rng.hpp"
+
+
+TEST(RadixTrieTest, EdgesSplitAndMerge) {
+    RadixTrie t;
+    t.insertWord("supercalifragilisticexpialidocious");
+    //A single edge out of the root
+    EXPECT_EQ(2, t.getNumNodes());
+    EXPECT_EQ("supercalifragilisticexpialidocious", t.getLabel(t.getChild(t.getRoot(), 0)));
+    EXPECT_EQ(true, t.isPrefix("supercali"));
+    EXPECT_EQ(false, t.isWord("supercali"));
+    //Ends inside the edge: split it
+    t.insertWord("super");
+    EXPECT_EQ(3, t.getNumNodes());
+    RadixTrie::TNodeIndex super = t.searchWord("super");
+    EXPECT_EQ("super", t.getLabel(super));
+    EXPECT_EQ("califragilisticexpialidocious", t.getLabel(t.getChild(super, 0)));
+    //Diverges inside an edge: split it and add a leaf
+    t.insertWord("supra");
+    EXPECT_EQ(5, t.getNumNodes());
+    RadixTrie::TNodeIndex sup = t.searchWord("sup", false);
+    EXPECT_EQ("sup", t.getLabel(sup));
+    EXPECT_EQ(false, t.isWordNode(sup));
+    EXPECT_EQ(2, t.getNumChildren(sup));
+    EXPECT_EQ("er", t.getLabel(t.getChild(sup, 0)));
+    EXPECT_EQ("ra", t.getLabel(t.getChild(sup, 1)));
+    //A prefix ending inside an edge finds the node below it
+    EXPECT_EQ(super, t.searchWord("supe", false));
+    EXPECT_EQ(RadixTrie::kNoNode, t.searchWord("supe"));
+    EXPECT_EQ(3, t.getDictionarySize());
+    //Removing "supra" leaves "sup" with a single child: merged back
+    t.removeWord("supra");
+    EXPECT_EQ(3, t.getNumNodes());
+    EXPECT_EQ("super", t.getLabel(t.getChild(t.getRoot(), 0)));
+    //Removing "super" leaves a single edge again
+    t.removeWord("super");
+    EXPECT_EQ(2, t.getNumNodes());
+    EXPECT_EQ("supercalifragilisticexpialidocious", t.getLabel(t.getChild(t.getRoot(), 0)));
+    EXPECT_EQ(true, t.isWord("supercalifragilisticexpialidocious"));
+    t.removeWord("supercalifragilisticexpialidocious");
+    EXPECT_EQ(1, t.getNumNodes());
+    EXPECT_EQ(0, t.getDictionarySize());
+}
+
+TEST(RadixTrieTest, TrieWordsWork) {
+    RadixTrie t;
+    const char* words[] = {"hello", "octopus", "octogonal", "ornitorrinco", "advice", "files", "file",
+                           "supercalifragilisticexpialidocious", "super", "supra", "north"};
+    for (auto w : words) {
+        t.insertWord(w);
+    }
+    t.insertWord("file");
+    EXPECT_EQ(11, t.getDictionarySize());
+    EXPECT_EQ(true, t.isWord("file"));
+    EXPECT_EQ(true, t.isPrefix("ornito"));
+    EXPECT_EQ(true, t.isPrefix("no"));
+    EXPECT_EQ(false, t.isWord("supr"));
+    EXPECT_EQ(false, t.isPrefix("orth"));
+    EXPECT_EQ(false, t.isPrefix("calamarido"));
+    EXPECT_EQ(true, t.isPrefix(""));
+    EXPECT_EQ(false, t.isWord(""));
+    //Case sensitive
+    EXPECT_EQ(false, t.isWord("File"));
+    t.removeWord("file");
+    EXPECT_EQ(false, t.isWord("file"));
+    EXPECT_EQ(true, t.isWord("files"));
+    t.removeWord("fil");
+    EXPECT_EQ(10, t.getDictionarySize());
+    //Far fewer nodes than characters
+    EXPECT_GT(20, t.getNumNodes());
+}
+
+TEST(RadixTrieTest, MatchesSet) {
+    //Long random keys with shared prefixes, checked against a set
+    for (uint64_t alphabet : {3, 256}) {
+        SplitMix64 rng(alphabet);
+        RadixTrie t;
+        set<string> words;
+        auto randomWord = [&]() {
+            string w(rng.nextBelow(4) * 10, 'x');
+            for (uint64_t len = rng.nextBelow(30); len > 0; --len) {
+                w += static_cast<char>(rng.nextBelow(alphabet));
+            }
+            return w;
+        };
+        for (uint64_t i = 0; i < 20000; ++i) {
+            string w = randomWord();
+            if (rng.nextBelow(3) == 0) {
+                t.removeWord(w);
+                words.erase(w);
+            }
+            else {
+                t.insertWord(w);
+                words.insert(w);
+            }
+        }
+        EXPECT_EQ(words.size(), t.getDictionarySize());
+        for (auto& w : words) {
+            EXPECT_EQ(true, t.isWord(w));
+        }
+        for (uint64_t i = 0; i < 20000; ++i) {
+            string w = randomWord().substr(0, rng.nextBelow(40));
+            EXPECT_EQ(words.count(w) == 1, t.isWord(w));
+            set<string>::iterator it = words.lower_bound(w);
+            EXPECT_EQ((it != words.end()) && (it->compare(0, w.size(), w) == 0), t.isPrefix(w));
+        }
+        //No node below the root is a plain link between 2 edges
+        vector<RadixTrie::TNodeIndex> stack(1, t.getRoot());
+        uint64_t visited = 0;
+        while (!stack.empty()) {
+            RadixTrie::TNodeIndex n = stack.back();
+            stack.pop_back();
+            ++visited;
+            EXPECT_EQ(true, (n == t.getRoot()) || t.isWordNode(n) || (t.getNumChildren(n) >= 2));
+            for (uint64_t c = 0; c < t.getNumChildren(n); ++c) {
+                stack.push_back(t.getChild(n, c));
+            }
+        }
+        EXPECT_EQ(t.getNumNodes(), visited);
+        for (auto& w : words) {
+            t.removeWord(w);
+        }
+        EXPECT_EQ(0, t.getDictionarySize());
+        EXPECT_EQ(1, t.getNumNodes());
+    }
+}
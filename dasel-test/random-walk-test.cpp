@@ -0,0 +1,117 @@
+/**
+ *  random-walk-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+#include "gtest/gtest.h"
+#include "random-walk.hpp"
+#include <cmath>
+#include <stdexcept>
+
+
+class RandomWalkTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        //Star around 0 (1..4), path 4-5-6, and 7 with no edges
+        for (uint64_t i = 0; i < 8; ++i) {
+            g.addVertex(i);
+        }
+        for (uint64_t i = 1; i < 5; ++i) {
+            g.addEdge(0, i);
+        }
+        g.addEdge(4, 5);
+        g.addEdge(5, 6);
+        cg = CompactGraph(g);
+    }
+    
+    UndirectedGraph g;
+    CompactGraph cg;
+};
+
+TEST_F(RandomWalkTest, UniformWalksFollowEdges) {
+    RandomWalker walker(cg, 42);
+    vector<uint64_t> starts = walker.allVertexStarts(10);
+    vector<uint64_t> walks;
+    uint64_t length = 12;
+    walker.uniformWalks(starts, length, walks);
+    ASSERT_EQ(starts.size() * length, walks.size());
+    for (uint64_t w = 0; w < starts.size(); ++w) {
+        EXPECT_EQ(starts[w], walks[w * length]);
+        for (uint64_t s = 1; s < length; ++s) {
+            if (walks[w * length + s] != kNoVertex) {
+                EXPECT_EQ(true, cg.isEdge(walks[w * length + s - 1], walks[w * length + s]));
+            }
+        }
+    }
+    //Vertex 7 has no edges: the walk stops
+    uint64_t w7 = 7;
+    EXPECT_EQ(kNoVertex, walks[w7 * length + 1]);
+    
+    //Same seed, same walks
+    vector<uint64_t> again;
+    walker.uniformWalks(starts, length, again);
+    EXPECT_EQ(walks, again);
+}
+
+TEST_F(RandomWalkTest, Node2vecWalksFollowEdges) {
+    RandomWalker walker(cg, 7);
+    vector<uint64_t> starts = walker.allVertexStarts(20);
+    vector<uint64_t> walks;
+    uint64_t length = 8;
+    //Very low p: walks mostly go back where they came from
+    walker.node2vecWalks(starts, length, 0.001, 1.0, walks);
+    uint64_t returns = 0, steps = 0;
+    for (uint64_t w = 0; w < starts.size(); ++w) {
+        for (uint64_t s = 2; s < length; ++s) {
+            uint64_t v = walks[w * length + s];
+            if (v != kNoVertex) {
+                EXPECT_EQ(true, cg.isEdge(walks[w * length + s - 1], v));
+                returns += (v == walks[w * length + s - 2]);
+                ++steps;
+            }
+        }
+    }
+    EXPECT_LT(steps * 9, returns * 10);
+    
+    //p and q must be positive
+    EXPECT_THROW(walker.node2vecWalks(starts, length, 0.0, 1.0, walks), invalid_argument);
+    EXPECT_THROW(walker.node2vecWalks(starts, length, 1.0, -2.0, walks), invalid_argument);
+    EXPECT_THROW(walker.node2vecWalks(starts, length, 1.0, nan(""), walks), invalid_argument);
+}
+
+TEST_F(RandomWalkTest, SampleNeighboursWorks) {
+    RandomWalker walker(cg, 1);
+    vector<uint64_t> vertices = {0, 5, 7};
+    vector<uint64_t> samples;
+    walker.sampleNeighbours(vertices, 3, samples);
+    ASSERT_EQ(9, samples.size());
+    //Distinct neighbours of the hub
+    sort(samples.begin(), samples.begin() + 3);
+    EXPECT_EQ(samples.begin() + 3, unique(samples.begin(), samples.begin() + 3));
+    for (uint64_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(true, cg.isEdge(0, samples[i]));
+    }
+    //Vertex 5 has 2 neighbours, vertex 7 none
+    EXPECT_EQ(4, samples[3]);
+    EXPECT_EQ(6, samples[4]);
+    EXPECT_EQ(kNoVertex, samples[5]);
+    EXPECT_EQ(kNoVertex, samples[6]);
+}
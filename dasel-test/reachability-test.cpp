@@ -0,0 +1,116 @@
+/**
+ *  reachability-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+#include "gtest/gtest.h"
+#include "reachability.hpp"
+#include "graph-generator.hpp"
+
+
+TEST(ReachabilityIndexTest, ComponentsAndOrderWork) {
+    //Cycle 1->2->3->1, then 3->4->5, and 6->4. Vertex 7 is isolated
+    DirectedGraph g;
+    for (uint64_t i = 1; i <= 7; ++i) {
+        g.addVertex(i);
+    }
+    g.addEdge(1, 2);
+    g.addEdge(2, 3);
+    g.addEdge(3, 1);
+    g.addEdge(3, 4);
+    g.addEdge(4, 5);
+    g.addEdge(6, 4);
+    
+    ReachabilityIndex index(g);
+    EXPECT_EQ(false, index.isAcyclic());
+    EXPECT_EQ(5, index.getNumComponents());
+    EXPECT_EQ(index.getComponent(1), index.getComponent(3));
+    EXPECT_NE(index.getComponent(1), index.getComponent(4));
+    EXPECT_LT(index.getComponent(2), index.getComponent(4));
+    EXPECT_LT(index.getComponent(4), index.getComponent(5));
+    EXPECT_EQ(kNoVertex, index.getComponent(8));
+    EXPECT_EQ(true, index.isReachable(2, 1));
+    EXPECT_EQ(true, index.isReachable(1, 5));
+    EXPECT_EQ(true, index.isReachable(6, 5));
+    EXPECT_EQ(false, index.isReachable(6, 1));
+    EXPECT_EQ(false, index.isReachable(5, 4));
+    EXPECT_EQ(false, index.isReachable(7, 5));
+    EXPECT_EQ(false, index.isReachable(1, 8));
+    EXPECT_EQ(true, index.isReachable(7, 7));
+    
+    CompactGraph cg(g);
+    EXPECT_EQ(true, ReachabilityIndex::hasCycle(cg));
+    EXPECT_THROW(ReachabilityIndex::topologicalSort(cg), runtime_error);
+    g.removeEdge(3, 1);
+    CompactGraph dagGraph(g);
+    EXPECT_EQ(false, ReachabilityIndex::hasCycle(dagGraph));
+    vector<uint64_t> order = ReachabilityIndex::topologicalSort(dagGraph);
+    vector<uint64_t> position(order.size());
+    for (uint64_t i = 0; i < order.size(); ++i) {
+        position[order[i]] = i;
+    }
+    for (uint64_t v = 0; v < dagGraph.getNumVertex(); ++v) {
+        for (const uint64_t* a = dagGraph.adjBegin(v); a != dagGraph.adjEnd(v); ++a) {
+            EXPECT_LT(position[v], position[*a]);
+        }
+    }
+    EXPECT_EQ(true, ReachabilityIndex(dagGraph).isAcyclic());
+    g.addEdge(5, 5);
+    EXPECT_EQ(false, ReachabilityIndex(g).isAcyclic());
+}
+
+TEST(ReachabilityIndexTest, MatchesBFS) {
+    //Random DAG (edges from smaller to bigger index) plus a few back edges
+    GraphGenerator gen(9);
+    uint64_t n = 400;
+    GraphGenerator::TEdgeList edges = gen.gnm(n, 900, true);
+    for (auto& e : edges) {
+        if (e.first > e.second) {
+            swap(e.first, e.second);
+        }
+    }
+    edges.push_back(make_pair(350, 20));
+    CompactGraph cg = CompactGraph::fromEdges(n, edges, true);
+    ReachabilityIndex index(cg, 4, 1, 2);
+    
+    uint64_t negatives = 0;
+    for (uint64_t s = 0; s < n; s += 7) {
+        vector<uint8_t> seen(n, 0);
+        vector<uint64_t> queue(1, s);
+        seen[s] = 1;
+        for (uint64_t head = 0; head < queue.size(); ++head) {
+            for (const uint64_t* a = cg.adjBegin(queue[head]); a != cg.adjEnd(queue[head]); ++a) {
+                if (!seen[*a]) {
+                    seen[*a] = 1;
+                    queue.push_back(*a);
+                }
+            }
+        }
+        for (uint64_t t = 0; t < n; ++t) {
+            EXPECT_EQ(seen[t] == 1, index.isReachable(s, t));
+            negatives += (seen[t] == 0);
+        }
+    }
+    EXPECT_EQ(58 * n, index.getNumQueries());
+    //Most negative queries never reach the DFS
+    EXPECT_GT(negatives / 4, index.getNumFallbacks());
+}
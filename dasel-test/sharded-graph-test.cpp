@@ -0,0 +1,135 @@
+/**
+ *  sharded-graph-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+
+#include <numeric>
+#include <functional>
+#include "gtest/gtest.h"
+#include "sharded-graph.hpp"
+#include "graph-generator.hpp"
+
+namespace {
+    ///Returns the smallest vertex index in the component of every vertex, ignoring edge directions
+    vector<uint64_t> componentLabels (const CompactGraph& g) {
+        uint64_t n = g.getNumVertex();
+        vector<uint64_t> parent(n);
+        iota(parent.begin(), parent.end(), 0);
+        function<uint64_t(uint64_t)> find = [&](uint64_t v) { return (parent[v] == v) ? v : (parent[v] = find(parent[v])); };
+        for (uint64_t v = 0; v < n; ++v) {
+            for (const uint64_t* a = g.adjBegin(v); a != g.adjEnd(v); ++a) {
+                uint64_t x = find(v);
+                uint64_t y = find(*a);
+                parent[max(x, y)] = min(x, y);
+            }
+        }
+        vector<uint64_t> label(n);
+        for (uint64_t v = 0; v < n; ++v) {
+            label[v] = find(v);
+        }
+        return label;
+    }
+}
+
+TEST(ShardedGraphTest, BuildsShardsWithGhosts) {
+    //Path 10-20-30-40 split in the middle
+    UndirectedGraph g;
+    g.addEdges({{10, 20}, {20, 30}, {30, 40}});
+    GraphPartitioner p(g);
+    ShardedGraph sg(p, p.evaluate({0, 0, 1, 1}, 2));
+    EXPECT_EQ(2, sg.getNumShards());
+    EXPECT_EQ(2, sg.getNumGhosts());
+    const ShardedGraph::tShard& s0 = sg.getShard(0);
+    EXPECT_EQ(vector<uint64_t>({0, 1, 2}), s0.global);
+    EXPECT_EQ(vector<uint64_t>({0, 0, 1}), s0.owner);
+    EXPECT_EQ(vector<uint64_t>({0, 1, 1}), s0.remote);
+    EXPECT_EQ(2, s0.numOwned);
+    EXPECT_EQ(1, s0.numGhosts);
+    EXPECT_EQ(30, s0.graph.getId(2));
+    EXPECT_EQ(0, s0.graph.getDeg(2));
+    EXPECT_EQ(true, s0.graph.isEdge(1, 2));
+    const ShardedGraph::tShard& s1 = sg.getShard(1);
+    EXPECT_EQ(vector<uint64_t>({1, 2, 3}), s1.global);
+    EXPECT_EQ(vector<uint64_t>({1, 1, 2}), s1.remote);
+    
+    vector<uint64_t> dist;
+    ShardedGraph::tRunStats st = sg.bfs(0, dist);
+    EXPECT_EQ(vector<uint64_t>({0, 1, 2, 3}), dist);
+    //30 reaches shard 1, which also offers 20 back, as it cannot know it was visited
+    EXPECT_EQ(2, st.messages);
+    EXPECT_EQ(2 * sizeof(ShardTransport::tMessage), st.bytes);
+    EXPECT_EQ(4, st.supersteps);
+    vector<uint64_t> label;
+    sg.components(label);
+    EXPECT_EQ(vector<uint64_t>(4, 0), label);
+    EXPECT_THROW(sg.bfs(4, dist), out_of_range);
+}
+
+TEST(ShardedGraphTest, MatchesSingleGraph) {
+    GraphGenerator gen(11);
+    //Sparse enough to leave several components
+    GraphGenerator::TEdgeList edges = gen.gnm(2000, 1800, false);
+    for (auto& e : gen.barabasiAlbert(1000, 3)) {
+        edges.push_back(make_pair(e.first + 2000, e.second + 2000));
+    }
+    for (bool directed : {false, true}) {
+        CompactGraph g = CompactGraph::fromEdges(3000, edges, directed);
+        vector<uint64_t> expectedLabel = componentLabels(g);
+        GraphPartitioner p(g, 3);
+        for (uint64_t k : {1, 3, 8}) {
+            for (unsigned threads : {1, 4}) {
+                ShardedGraph sg(p, p.partition(k), nullptr, threads);
+                for (uint64_t src : {0, 1500, 2500}) {
+                    vector<uint64_t> expected;
+                    g.bfs(src, expected);
+                    vector<uint64_t> dist;
+                    ShardedGraph::tRunStats st = sg.bfs(src, dist);
+                    EXPECT_EQ(expected, dist);
+                    if (k == 1) {
+                        EXPECT_EQ(0, st.messages);
+                    }
+                }
+                vector<uint64_t> label;
+                ShardedGraph::tRunStats st = sg.components(label);
+                EXPECT_EQ(expectedLabel, label);
+                EXPECT_EQ(k == 1, st.messages == 0);
+                EXPECT_EQ(st.messages * sizeof(ShardTransport::tMessage), st.bytes);
+                EXPECT_GE(st.messages, st.batches);
+            }
+        }
+    }
+}
+
+TEST(ShardedGraphTest, TransportChecksShards) {
+    InProcessTransport t;
+    t.reset(2);
+    vector<ShardTransport::tMessage> batch = {{0, 7}};
+    EXPECT_THROW(t.send(2, 0, batch), out_of_range);
+    EXPECT_THROW(t.send(0, 2, batch), out_of_range);
+    t.send(0, 1, batch);
+    EXPECT_EQ(1, t.exchange());
+    vector<ShardTransport::tMessage> received;
+    t.receive(1, received);
+    ASSERT_EQ(1, received.size());
+    EXPECT_EQ(7, received[0].value);
+}
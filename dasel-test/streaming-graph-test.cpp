@@ -0,0 +1,129 @@
+/**
+ *  streaming-graph-test.cpp
+ *
+ *    Copyright © 2017 Javier Garcia Visiedo. All rights reserved.
+ *
+ * This file is part of dasel
+ *
+ * Dasel is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dasel is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dasel.  If not, see <http://www.gnu.org/licenses/>
+ *
+ */
+
+
+
+#include <stdexcept>
+#include "gtest/gtest.h"
+#include "streaming-graph.hpp"
+
+
+TEST(StreamingGraphTest, RejectsBadWindow) {
+    EXPECT_THROW(StreamingGraph(0), invalid_argument);
+    EXPECT_THROW(StreamingGraph(10, 20), invalid_argument);
+    StreamingGraph g(100);
+    EXPECT_EQ(6, g.getBucketWidth());
+}
+
+TEST(StreamingGraphTest, EdgesExpire) {
+    //Window of 100 time units, in buckets of 10
+    StreamingGraph g(100, 10);
+    EXPECT_EQ(true, g.addEdge(1, 2, 5));
+    EXPECT_EQ(true, g.addEdge(2, 3, 15));
+    EXPECT_EQ(true, g.addEdge(3, 4, 25));
+    EXPECT_EQ(true, g.addEdge(4, 1, 25));
+    EXPECT_EQ(4, g.getNumEdges());
+    EXPECT_EQ(4, g.getNumVertex());
+    EXPECT_EQ(2, g.getDeg(2));
+    EXPECT_EQ(2, g.distance(1, 3));
+    EXPECT_EQ(15, g.getEdgeTime(3, 2));
+    //Refreshing 2-3 keeps it past its first bucket
+    EXPECT_EQ(true, g.addEdge(3, 2, 50));
+    EXPECT_EQ(50, g.getEdgeTime(2, 3));
+    EXPECT_EQ(true, g.addEdge(3, 2, 40));
+    EXPECT_EQ(50, g.getEdgeTime(2, 3));
+    //A later time in the same bucket keeps the bucket it is logged in
+    EXPECT_EQ(true, g.addEdge(2, 3, 58));
+    EXPECT_EQ(58, g.getEdgeTime(3, 2));
+    //The bucket of time 5 ends at 9, and expires once 9 is out of the window
+    g.advance(108);
+    EXPECT_EQ(4, g.getNumEdges());
+    g.advance(109);
+    EXPECT_EQ(3, g.getNumEdges());
+    EXPECT_EQ(false, g.isEdge(1, 2));
+    EXPECT_EQ(1, g.getDeg(2));
+    EXPECT_EQ(3, g.distance(1, 2));
+    EXPECT_EQ(1, g.getNumExpired());
+    //Out of the window already
+    EXPECT_EQ(false, g.addEdge(7, 8, 9));
+    EXPECT_EQ(false, g.isEdge(7, 8));
+    g.advance(130);
+    EXPECT_EQ(1, g.getNumEdges());
+    EXPECT_EQ(true, g.isEdge(2, 3));
+    //Vertex without edges leave the window too
+    EXPECT_EQ(2, g.getNumVertex());
+    EXPECT_EQ(0, g.getDeg(4));
+    EXPECT_EQ(-1, g.distance(1, 4));
+    g.advance(158);
+    EXPECT_EQ(1, g.getNumEdges());
+    g.advance(159);
+    EXPECT_EQ(0, g.getNumEdges());
+    g.advance(160);
+    EXPECT_EQ(0, g.getNumEdges());
+    EXPECT_EQ(0, g.getNumVertex());
+    EXPECT_EQ(0, g.getNumBuckets());
+}
+
+TEST(StreamingGraphTest, MatchesRebuiltGraph) {
+    //Random stream, checked against a graph rebuilt from the edges in the window
+    StreamingGraph g(1000, 50, 0.1);
+    vector<StreamingGraph::tTimedEdge> stream;
+    uint64_t x = 12345;
+    for (uint64_t t = 0; t < 20000; ++t) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint64_t jitter = (x >> 20) % 30;
+        stream.push_back({(x >> 33) % 200, (x >> 45) % 200, (t > jitter) ? t - jitter : 0});
+    }
+    for (uint64_t base = 0; base < stream.size(); base += 5000) {
+        vector<StreamingGraph::tTimedEdge> batch(stream.begin() + base, stream.begin() + base + 5000);
+        EXPECT_EQ(0, g.addEdges(batch));
+        //Edges are expired by whole buckets, so they can outlive the window by one bucket
+        unordered_map<uint64_t, uint64_t> lastTime;
+        for (uint64_t i = 0; i < base + 5000; ++i) {
+            uint64_t a = min(stream[i].from, stream[i].to);
+            uint64_t b = max(stream[i].from, stream[i].to);
+            uint64_t& last = lastTime[(a << 32) | b];
+            last = max(last, stream[i].time);
+        }
+        UndirectedGraph expected;
+        uint64_t bucketEnd = g.getTime() - g.getWindowLength() + 1;
+        bucketEnd -= bucketEnd % 50;
+        for (auto& l : lastTime) {
+            if (l.second >= bucketEnd) {
+                expected.addVertex(l.first >> 32);
+                expected.addVertex(l.first & 0xFFFFFFFF);
+                expected.addEdge(l.first >> 32, l.first & 0xFFFFFFFF);
+                //Edge lookups already skip the edges out of the window
+                bool live = l.second + g.getWindowLength() > g.getTime();
+                EXPECT_EQ(live ? l.second : 0, g.getEdgeTime(l.first >> 32, l.first & 0xFFFFFFFF));
+                EXPECT_EQ(live, g.isEdge(l.first >> 32, l.first & 0xFFFFFFFF));
+            }
+        }
+        EXPECT_EQ(expected.getNumEdges(), g.getNumEdges());
+        EXPECT_EQ(expected.getNumVertex(), g.getNumVertex());
+        for (uint64_t v = 0; v < 200; v += 7) {
+            const UndirectedGraph::Vertex* ev = expected.findVertex(v);
+            EXPECT_EQ((ev != nullptr) ? ev->getDeg() : 0, g.getDeg(v));
+            EXPECT_EQ(expected.distance(3, v), g.distance(3, v));
+        }
+    }
+}
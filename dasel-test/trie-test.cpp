@@ -22,6 +22,9 @@
  */
 
 
+#include <stdexcept>
+#include <map>
+#include <algorithm>
 #include "gtest/gtest.h"
 #include "trie.hpp"
 
@@ -91,3 +94,144 @@ TEST_F(TrieTest, RemoveWordWorks) {
     t1.removeWord("noThere");
     EXPECT_EQ(10, t1.getDictionarySize());
 }
+
+TEST_F(TrieTest, RemoveKeepsLongerWords) {
+    t1.removeWord("file");
+    EXPECT_EQ(false, t1.isWord("file"));
+    EXPECT_EQ(true, t1.isWord("files"));
+    EXPECT_EQ(true, t1.isPrefix("file"));
+    t1.removeWord("file");
+    EXPECT_EQ(10, t1.getDictionarySize());
+    //A prefix which is not a word is not removed
+    t1.removeWord("octo");
+    EXPECT_EQ(true, t1.isWord("octopus"));
+    EXPECT_EQ(10, t1.getDictionarySize());
+}
+
+TEST_F(TrieTest, NodePoolWorks) {
+    EXPECT_EQ(1, t0.getNumNodes());
+    EXPECT_EQ(6, t1.getRoot().getNumChildren());
+    uint64_t nodes = t1.getNumNodes();
+    //Inserting a word twice counts it once
+    t1.insertWord("FILE");
+    EXPECT_EQ(11, t1.getDictionarySize());
+    EXPECT_EQ(nodes, t1.getNumNodes());
+    //Removed nodes are reused
+    const Trie::TrieNode* node = t1.searchWord("north");
+    EXPECT_EQ('h', node->getContent());
+    EXPECT_EQ('t', t1.getNode(node->getParent()).getContent());
+    t1.removeWord("north");
+    EXPECT_EQ(nodes - 5, t1.getNumNodes());
+    t1.insertWord("waltz");
+    EXPECT_EQ(nodes, t1.getNumNodes());
+    EXPECT_EQ(true, t1.isWord("waltz"));
+    //A bad character leaves the trie untouched
+    EXPECT_THROW(t1.insertWord("north-east"), out_of_range);
+    EXPECT_EQ(false, t1.isPrefix("n"));
+    EXPECT_THROW(t1.isWord("a1"), out_of_range);
+    //Copies are independent
+    Trie copy(t1);
+    copy.removeWord("waltz");
+    EXPECT_EQ(true, t1.isWord("waltz"));
+    EXPECT_EQ(false, copy.isWord("waltz"));
+    t1.clear();
+    EXPECT_EQ(0, t1.getDictionarySize());
+    EXPECT_EQ(1, t1.getNumNodes());
+    EXPECT_EQ(false, t1.isPrefix("s"));
+    EXPECT_EQ(true, copy.isWord("supra"));
+}
+
+TEST_F(TrieTest, ManyWordsWork) {
+    //Enough nodes to take several blocks of the pool
+    Trie t;
+    vector<string> words;
+    for (uint64_t i = 0; i < 5000; ++i) {
+        string w;
+        for (uint64_t x = i * 2654435761ULL + 1; x > 0; x /= 26) {
+            w += static_cast<char>('a' + x % 26);
+        }
+        words.push_back(w);
+        t.insertWord(w);
+    }
+    uint64_t size = t.getDictionarySize();
+    EXPECT_LT(2, t.getMemoryUsage() / (1024 * sizeof(Trie::TrieNode)));
+    for (auto& w : words) {
+        EXPECT_EQ(true, t.isWord(w));
+    }
+    for (uint64_t i = 0; i < words.size(); i += 2) {
+        t.removeWord(words[i]);
+    }
+    for (uint64_t i = 0; i < words.size(); ++i) {
+        EXPECT_EQ(i % 2 == 1, t.isWord(words[i]));
+    }
+    EXPECT_EQ(size - 2500, t.getDictionarySize());
+}
+
+TEST_F(TrieTest, TopKWorks) {
+    t1.insertWord("super", 50);
+    t1.insertWord("supra", 20);
+    t1.insertWord("supercalifragilisticexpialidocious", 30);
+    t1.insertWord("Superb", 40);
+    vector<Trie::tCompletion> best = t1.topK("SUP", 3);
+    ASSERT_EQ(3, best.size());
+    EXPECT_EQ("super", best[0].word);
+    EXPECT_EQ(50, best[0].score);
+    EXPECT_EQ("superb", best[1].word);
+    EXPECT_EQ("supercalifragilisticexpialidocious", best[2].word);
+    EXPECT_EQ(50, t1.searchWord("s", false)->getMaxScore());
+    //Words without a score come last, and the prefix may be a word
+    EXPECT_EQ(12, t1.topK("", 20).size());
+    EXPECT_EQ(0, t1.topK("", 20).back().score);
+    EXPECT_EQ(3, t1.topK("super", 10).size());
+    EXPECT_EQ("super", t1.topK("super", 10)[0].word);
+    EXPECT_EQ(0, t1.topK("melon", 10).size());
+    EXPECT_EQ(0, t1.topK("sup", 0).size());
+    //Scores go down as well as up, and removed words drop out
+    t1.insertWord("super", 10);
+    EXPECT_EQ("superb", t1.topK("s", 1)[0].word);
+    t1.removeWord("superb");
+    EXPECT_EQ(30, t1.searchWord("s", false)->getMaxScore());
+    EXPECT_EQ("supercalifragilisticexpialidocious", t1.topK("s", 1)[0].word);
+    //Inserting without a score keeps the score
+    t1.insertWord("supra");
+    EXPECT_EQ(20, t1.searchWord("supra")->getScore());
+    EXPECT_EQ(30, t1.getRoot().getMaxScore());
+}
+
+TEST_F(TrieTest, TopKMatchesSortedScores) {
+    Trie t;
+    map<string, uint64_t> scores;
+    uint64_t x = 12345;
+    for (uint64_t i = 0; i < 20000; ++i) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        string w;
+        for (uint64_t len = 1 + (x >> 60) % 7, y = x >> 20; len > 0; --len, y /= 5) {
+            w += static_cast<char>('a' + y % 5);
+        }
+        if ((x >> 8) % 4 == 0) {
+            t.removeWord(w);
+            scores.erase(w);
+        }
+        else {
+            //Distinct scores, so the order is fixed
+            t.insertWord(w, i);
+            scores[w] = i;
+        }
+    }
+    EXPECT_EQ(scores.size(), t.getDictionarySize());
+    for (string prefix : {"", "a", "bc", "eee", "dab"}) {
+        vector<pair<uint64_t, string> > expected;
+        for (auto& s : scores) {
+            if (s.first.compare(0, prefix.size(), prefix) == 0) {
+                expected.push_back(make_pair(s.second, s.first));
+            }
+        }
+        sort(expected.rbegin(), expected.rend());
+        vector<Trie::tCompletion> best = t.topK(prefix, 25);
+        ASSERT_EQ(min<size_t>(25, expected.size()), best.size());
+        for (uint64_t i = 0; i < best.size(); ++i) {
+            EXPECT_EQ(expected[i].second, best[i].word);
+            EXPECT_EQ(expected[i].first, best[i].score);
+        }
+    }
+}